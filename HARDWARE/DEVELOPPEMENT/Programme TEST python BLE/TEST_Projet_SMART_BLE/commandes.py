@@ -0,0 +1,97 @@
+# === COMMANDES BINAIRES VERS L’ESP32 ===
+# Une écriture sur la caractéristique COMMAND enchaîne autant de commandes
+# qu’on veut : opcode, identifiant (0-255, choisi par le pont), longueur de
+# l’argument, argument. L’ESP32 répond à chacune, dans l’ordre, par des
+# notifications sur STATUS : opcode | 0x80, identifiant, statut, longueur,
+# données.
+# Format : voir ble_cmd.h dans le firmware (mêmes octets de référence dans
+# les deux tests).
+import struct
+
+REPONSE = 0x80
+
+# Nom -> opcode
+OPCODES = {
+    "select_user": 0x01,
+    "set_budget": 0x02,
+    "start": 0x03,
+    "stop": 0x04,
+    "status": 0x05,
+    "history": 0x06,
+    "set_clock": 0x07,
+    "reboot": 0x08,
+}
+NOMS = {op: nom for nom, op in OPCODES.items()}
+
+STATUTS = ["ok", "inconnue", "longueur", "argument", "occupe", "tronquee"]
+
+ETATS = ["arrete", "en_cours", "depassement"]             # timer_state_t
+STALL_STATUS = struct.Struct("<BBIHHI")                    # ble_cmd_stall_status_t
+
+
+def _nom(commande):
+    return commande.get("user", "").encode("utf-8")[:31]
+
+
+# Nom -> argument à partir du dictionnaire de la commande
+ARGUMENTS = {
+    "select_user": lambda c: bytes([c["stall"]]) + _nom(c),
+    "set_budget": lambda c: struct.pack("<BH", c.get("stall", 0), c["seconds"]) + _nom(c),
+    "start": lambda c: bytes([c["stall"]]) + _nom(c),
+    "stop": lambda c: bytes([c["stall"]]),
+    "status": lambda c: bytes([c["stall"]]),
+    "history": lambda c: struct.pack("<I", c["after"]),
+    "set_clock": lambda c: struct.pack("<I", c["epoch"]),
+    "reboot": lambda c: b"",
+}
+
+
+def coder_commande(ident, commande):
+    """
+    Dictionnaire {"op": "start", "stall": 0, "user": "alice"} -> octets
+    d’une commande. Lève KeyError / ValueError si la commande est invalide.
+    """
+    op = commande["op"]
+    argument = ARGUMENTS[op](commande)
+    return bytes([OPCODES[op], ident & 0xFF, len(argument)]) + argument
+
+
+def coder_commandes(commandes, premier_ident=1):
+    """
+    Liste de commandes -> (écriture unique, identifiants attribués).
+    """
+    idents = [(premier_ident + i) & 0xFF for i in range(len(commandes))]
+    return b"".join(coder_commande(i, c) for i, c in zip(idents, commandes)), idents
+
+
+def decoder_reponses(data):
+    """
+    Notification de STATUS -> liste de réponses (dictionnaires). Une
+    réponse à STATUS porte l’état de la cabine, une réponse à SET_CLOCK
+    les secondes écoulées depuis le démarrage de l’ESP32.
+    Une réponse incomplète (notification abîmée) termine la liste.
+    """
+    reponses, pos = [], 0
+    while pos + 4 <= len(data):
+        op, ident, statut, longueur = data[pos:pos + 4]
+        donnees = data[pos + 4:pos + 4 + longueur]
+        if len(donnees) != longueur:
+            break
+        pos += 4 + longueur
+
+        reponse = {
+            "op": NOMS.get(op & ~REPONSE, op & ~REPONSE),
+            "id": ident,
+            "status": STATUTS[statut] if statut < len(STATUTS) else statut,
+        }
+        if reponse["op"] == "status" and longueur == STALL_STATUS.size:
+            stall, etat, elapsed_s, duration_s, budget_s, sessions = STALL_STATUS.unpack(donnees)
+            reponse.update(stall=stall, state=ETATS[etat] if etat < len(ETATS) else etat,
+                           elapsed_s=elapsed_s, duration_s=duration_s, budget_s=budget_s,
+                           sessions=sessions)
+        elif reponse["op"] == "set_clock" and longueur == 4:
+            reponse["uptime_s"] = struct.unpack("<I", donnees)[0]
+        elif longueur:
+            reponse["data"] = donnees.hex()
+        reponses.append(reponse)
+    return reponses
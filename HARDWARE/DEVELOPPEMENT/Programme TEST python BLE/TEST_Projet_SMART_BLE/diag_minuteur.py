@@ -0,0 +1,114 @@
+# === DIAGNOSTIC DU MINUTEUR (tâches, piles, tas) ===
+# Lit la caractéristique de diagnostic de l’ESP32 (0xABF6) et affiche le
+# relevé : marge de pile et charge CPU de chaque tâche, état du tas.
+#
+#   python diag_minuteur.py             un relevé
+#   python diag_minuteur.py --suivre    un relevé à chaque notification (10 s)
+#   python diag_minuteur.py --hex 01..  décode un relevé copié (nRF Connect...)
+#
+# L’ESP32 n’accepte qu’une connexion : arrêter le pont (main.py) avant.
+# Format : voir diag_record.h dans le firmware.
+import argparse
+import asyncio
+import struct
+from bleak import BleakScanner, BleakClient
+
+DEVICE_NAME = "MinuteurESP32"
+DIAG_CHAR_UUID = "0000abf6-0000-1000-8000-00805f9b34fb"
+DIAG_RECORD_VERSION = 1
+
+HEADER = struct.Struct("<BBBBIIIIIHH")     # diag_record_header_t
+TASK = struct.Struct("<12sHHBBBB")         # diag_record_task_t
+ETATS = ["running", "ready", "blocked", "suspended", "deleted", "invalid"]
+DIAG_TASK_IDLE = 0x01
+DIAG_CORE_ANY = 0xFF
+PILE_JUSTE = 256                           # Comme DIAG_STACK_WARN_BYTES
+
+
+# === DÉCODAGE D’UN RELEVÉ ===
+def decoder(data):
+    """
+    Relevé binaire -> dictionnaire (None si vide ou d’une autre version).
+    """
+    if len(data) < HEADER.size or data[0] != DIAG_RECORD_VERSION:
+        return None
+    (version, total, count, _, uptime_s, period_ms, free_heap, min_free_heap,
+     largest_block, cpu0, cpu1) = HEADER.unpack_from(data, 0)
+    taches = []
+    for i in range(count):
+        offset = HEADER.size + i * TASK.size
+        if offset + TASK.size > len(data):
+            break
+        name, stack_free, load, prio, state, core, flags = TASK.unpack_from(data, offset)
+        taches.append({
+            "nom": name.rstrip(b"\0").decode(errors="replace"),
+            "pile_libre": stack_free,
+            "charge": load / 10,
+            "prio": prio,
+            "etat": ETATS[state] if state < len(ETATS) else str(state),
+            "coeur": "-" if core == DIAG_CORE_ANY else str(core),
+            "idle": bool(flags & DIAG_TASK_IDLE),
+        })
+    return {
+        "uptime_s": uptime_s, "periode_ms": period_ms, "taches_total": total,
+        "tas_libre": free_heap, "tas_min": min_free_heap, "plus_grand_bloc": largest_block,
+        "cpu": (cpu0 / 10, cpu1 / 10), "taches": taches,
+    }
+
+
+# === AFFICHAGE ===
+def afficher(releve):
+    if releve is None:
+        print("Pas encore de relevé (ou version de firmware différente)")
+        return
+    frag = 0.0
+    if releve["tas_libre"]:
+        frag = 100 * (1 - releve["plus_grand_bloc"] / releve["tas_libre"])
+    h, reste = divmod(releve["uptime_s"], 3600)
+    print(f"\n=== Relevé à {h} h {reste // 60:02d} min {reste % 60:02d} s "
+          f"(charges sur {releve['periode_ms'] / 1000:.1f} s) ===")
+    print(f"Tas : {releve['tas_libre']} o libres, minimum {releve['tas_min']} o, "
+          f"plus grand bloc {releve['plus_grand_bloc']} o (fragmentation {frag:.0f} %)")
+    print(f"CPU : cœur 0 {releve['cpu'][0]:.1f} %, cœur 1 {releve['cpu'][1]:.1f} %")
+    print(f"{'Tâche':<13}{'Pile libre':>11}{'CPU %':>8}{'Prio':>6}  {'État':<10}Cœur")
+    for t in releve["taches"]:
+        alerte = "  <-- pile juste" if t["pile_libre"] < PILE_JUSTE else ""
+        print(f"{t['nom']:<13}{t['pile_libre']:>11}{t['charge']:>8.1f}{t['prio']:>6}  "
+              f"{t['etat']:<10}{t['coeur']}{alerte}")
+    manquantes = releve["taches_total"] - len(releve["taches"])
+    if manquantes > 0:
+        print(f"(+{manquantes} tâche(s) hors relevé : MTU trop petit ou trop de tâches)")
+
+
+# === LECTURE EN BLE ===
+async def lire(suivre):
+    devices = await BleakScanner.discover()
+    esp_device = next((d for d in devices if d.name and DEVICE_NAME in d.name), None)
+    if not esp_device:
+        print("❌ ESP32 non trouvé")
+        return
+    async with BleakClient(esp_device.address) as client:
+        # La lecture rend le relevé complet (lecture longue si besoin)
+        afficher(decoder(await client.read_gatt_char(DIAG_CHAR_UUID)))
+        if not suivre:
+            return
+
+        # La notification peut être tronquée au MTU : relire le relevé complet
+        nouveau = asyncio.Event()
+        await client.start_notify(DIAG_CHAR_UUID, lambda sender, data: nouveau.set())
+        while client.is_connected:
+            await nouveau.wait()
+            nouveau.clear()
+            afficher(decoder(await client.read_gatt_char(DIAG_CHAR_UUID)))
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Diagnostic du minuteur de douche")
+    parser.add_argument("--suivre", action="store_true", help="afficher chaque nouveau relevé")
+    parser.add_argument("--hex", help="décoder un relevé donné en hexadécimal")
+    args = parser.parse_args()
+
+    if args.hex:
+        afficher(decoder(bytes.fromhex(args.hex.replace(" ", "").replace("-", ""))))
+    else:
+        asyncio.run(lire(args.suivre))
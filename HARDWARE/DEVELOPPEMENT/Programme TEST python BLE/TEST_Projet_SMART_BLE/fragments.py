@@ -0,0 +1,52 @@
+# === REASSEMBLAGE DES BLOCS FRAGMENTÉS PAR L’ESP32 ===
+# Un bloc plus long qu’une notification (MTU - 3) arrive en fragments,
+# chacun précédé de 4 octets : '#', drapeaux (FIRST / LAST), numéro sur
+# 16 bits (little endian, repasse par 0 après 65535).
+# Format : voir ble_tx.h dans le firmware. Une notification qui ne
+# commence pas par '#' est un bloc entier.
+FRAG_MAGIC = ord("#")
+FRAG_HEADER = 4
+FRAG_FIRST = 0x01
+FRAG_LAST = 0x02
+
+
+class Reassembleur:
+    """
+    Rassemble les fragments d’une caractéristique, dans l’ordre d’arrivée.
+    Un fragment manquant fait abandonner le bloc en cours (compté dans
+    incomplets) : l’émetteur devra le renvoyer.
+    """
+
+    def __init__(self):
+        self.bloc = None                     # Bloc en cours (bytearray), None : aucun
+        self.suivant = 0
+        self.incomplets = 0
+
+    def _abandonner(self):
+        if self.bloc is not None:
+            self.incomplets += 1
+        self.bloc = None
+
+    def ajouter(self, data):
+        """Ajoute une notification ; retourne le bloc s’il est complet, sinon None."""
+        if len(data) < FRAG_HEADER or data[0] != FRAG_MAGIC:
+            self._abandonner()
+            return bytes(data)
+
+        flags = data[1]
+        numero = data[2] | data[3] << 8
+        if flags & FRAG_FIRST:
+            self._abandonner()
+            if numero != 0:
+                return None
+            self.bloc = bytearray()
+        elif self.bloc is None or numero != self.suivant:
+            self._abandonner()
+            return None
+
+        self.bloc += data[FRAG_HEADER:]
+        self.suivant = (numero + 1) & 0xFFFF
+        if flags & FRAG_LAST:
+            bloc, self.bloc = bytes(self.bloc), None
+            return bloc
+        return None
@@ -5,12 +5,20 @@ import requests  # Pour envoyer les données au backend
 from flask import Flask, request, jsonify  # Pour créer l’API Flask
 import threading  # Pour lancer BLE et Flask en parallèle
 import time  # Pour les délais
+from session_record import est_trame, decoder_trame, age_secondes  # Trames binaires du journal
+from fragments import Reassembleur  # Blocs plus longs qu’une notification
+from commandes import coder_commandes, decoder_reponses  # Commandes binaires enchaînées
 
 # === PARAMÈTRES À PERSONNALISER ===
 DEVICE_NAME = "MinuteurESP32"  # Nom de l’appareil BLE à scanner
 NOTIFY_CHAR_UUID = "0000abf2-0000-1000-8000-00805f9b34fb"  # UUID de la caractéristique de notification
 WRITE_CHAR_UUID = "0000abf1-0000-1000-8000-00805f9b34fb"  # UUID de la caractéristique d’écriture
+COMMAND_CHAR_UUID = "0000abf3-0000-1000-8000-00805f9b34fb"  # Commandes binaires (commandes.py)
+STATUS_CHAR_UUID = "0000abf4-0000-1000-8000-00805f9b34fb"  # Réponses aux commandes
 BACKEND_URL = "http://localhost:8080/douches"  # URL de l’API backend pour recevoir les données de douche
+DELAI_RELANCE_SYNC = 30  # Secondes avant de redemander le journal si le backend a échoué
+DELAI_REPONSES = 5  # Secondes d’attente des réponses à une écriture de commandes
+COMMANDES_MAX_OCTETS = 512  # Une écriture (longueur max de la caractéristique COMMAND)
 
 # === INITIALISATION DE FLASK ===
 app = Flask(__name__)
@@ -19,43 +27,186 @@ app = Flask(__name__)
 ble_client = None  # Instance du client BLE connecté
 ble_loop = asyncio.new_event_loop()  # Nouvelle boucle asyncio pour BLE
 ble_lock = threading.Lock()  # Verrou pour sécuriser l'accès au client BLE
+reassembleur = Reassembleur()  # Fragments des notifications (remis à zéro à chaque connexion)
+reponses_attendues = {}  # Identifiant de commande -> Future (boucle BLE)
+prochain_ident = 1  # Identifiant de la prochaine commande (un octet)
 
 # === PARSING DU MESSAGE BLE REÇU ===
 def parse_ble_message(msg):
     """
-    Extrait le nom d’utilisateur et la durée depuis une chaîne BLE.
-    Format attendu : "User: Nom; Time: 300 s"
+    Extrait les champs d’une ligne texte (une douche) des anciens firmwares :
+    "J:12;User:Nom;Time:300 s;Over:0 s;Stall:1;Vol:41250 mL;Peak:9800 mL/min;Age:40 s"
+    (J, Stall et Age absents des plus anciens : "User: Nom; Time: 300 s" ;
+    Vol et Peak absents sans débitmètre sur la cabine)
+    Retourne (seq, user, time_s, age_s, stall, vol_ml, peak_ml_min), None
+    pour un champ absent.
     """
-    user, time_s = None, None
+    seq, user, time_s, age_s, stall = None, None, None, None, None
+    vol_ml, peak_ml_min = None, None
     try:
         parts = msg.split(";")
         for p in parts:
-            if p.strip().startswith("User:"):
+            p = p.strip()
+            if p.startswith("J:"):
+                seq = int(p.split(":", 1)[1])
+            elif p.startswith("User:"):
                 user = p.split(":", 1)[1].strip()
-            elif p.strip().startswith("Time:"):
+            elif p.startswith("Time:"):
                 time_s = int(p.split(":", 1)[1].strip().split()[0])
+            elif p.startswith("Age:"):
+                age_s = int(p.split(":", 1)[1].strip().split()[0])
+            elif p.startswith("Stall:"):
+                stall = int(p.split(":", 1)[1].strip())
+            elif p.startswith("Vol:"):
+                vol_ml = int(p.split(":", 1)[1].strip().split()[0])
+            elif p.startswith("Peak:"):
+                peak_ml_min = int(p.split(":", 1)[1].strip().split()[0])
     except Exception as e:
         print("Erreur parsing BLE :", e)
-    return user, time_s
+    return seq, user, time_s, age_s, stall, vol_ml, peak_ml_min
+
+# === ENREGISTREMENT D’UNE DOUCHE DANS LE BACKEND ===
+def enregistrer_douche(seq, user, time_s, age_s, stall, vol_ml, peak_ml_min, over_s=None):
+    """
+    Envoie une douche au backend.
+    Retourne True si elle est enregistrée (ou refusée définitivement :
+    utilisateur inconnu), False si l’envoi est à refaire plus tard.
+    """
+    r = requests.get(f"http://localhost:8080/users/username/{user}")
+    if r.status_code == 404:
+        print("❌ Utilisateur non trouvé dans le backend :", user)
+        return True
+    if r.status_code != 200:
+        return False
+
+    payload = {"userId": r.json()["id"], "timeSeconds": time_s,
+               "journalSeq": seq, "ageSeconds": age_s, "stall": stall,
+               "volumeMl": vol_ml, "peakFlowMlMin": peak_ml_min,
+               "overtimeSeconds": over_s}
+    resp = requests.post(BACKEND_URL, json=payload)
+    print("✅ Donnée envoyée au backend :", resp.status_code)
+    return resp.ok
 
 # === GESTION DES NOTIFICATIONS BLE ===
+def lire_notification(data):
+    """
+    Douches d’une notification : trame binaire (session_record.py) ou
+    lignes texte des anciens firmwares.
+    Retourne la liste des arguments de enregistrer_douche, None si la
+    trame est abîmée.
+    """
+    if not est_trame(data):
+        msg = data.decode(errors='ignore')
+        print(f"🔔 Notification reçue : {msg}")
+        return [parse_ble_message(ligne) for ligne in msg.splitlines()]
+
+    trame = decoder_trame(data)
+    if trame is None:
+        print(f"❌ Trame invalide ({len(data)} octets) : {data.hex()}")
+        return None
+    entete, douches = trame
+    print(f"🔔 Trame reçue : {len(douches)} douche(s)")
+    return [(d["seq"], d["user"], round(d["duration_ms"] / 1000), age_secondes(entete, d),
+             d["stall"], d["volume_ml"], d["peak_ml_min"], round(d["overtime_ms"] / 1000))
+            for d in douches]
+
+
 def notification_handler(sender, data):
-    msg = data.decode(errors='ignore')
-    print(f"🔔 Notification reçue : {msg}")
-    user, time_s = parse_ble_message(msg)
+    """
+    Un bloc (une ou plusieurs notifications, voir fragments.py) contient
+    une ou plusieurs douches du journal de l’ESP32. Les douches
+    enregistrées sont acquittées par "ACK:<dernier numéro>", ce qui
+    déclenche l’envoi du lot suivant. En cas d’échec (backend, trame
+    abîmée, fragment perdu), le journal est redemandé ("SYNC") un peu
+    plus tard.
+    """
+    dernier_ok, echec = None, False
+    incomplets = reassembleur.incomplets
+    bloc = reassembleur.ajouter(data)
+    if reassembleur.incomplets != incomplets:
+        print("❌ Bloc incomplet abandonné (fragment perdu)")
+        echec = True
+    douches = [] if bloc is None else lire_notification(bloc)
+    if douches is None:
+        douches, echec = [], True
 
-    if user and time_s is not None:
+    for douche in douches:
+        seq, user, time_s = douche[0], douche[1], douche[2]
+        if not user or time_s is None:
+            continue
         try:
-            r = requests.get(f"http://localhost:8080/users/username/{user}")
-            if r.status_code == 200:
-                user_id = r.json()["id"]
-                payload = {"userId": user_id, "timeSeconds": time_s}
-                resp = requests.post(BACKEND_URL, json=payload)
-                print("✅ Donnée envoyée au backend :", resp.status_code)
-            else:
-                print("❌ Utilisateur non trouvé dans le backend :", user)
+            ok = enregistrer_douche(*douche)
         except Exception as e:
             print("❌ Erreur HTTP vers backend :", e)
+            ok = False
+        if not ok:
+            echec = True
+            break
+        if seq is not None:
+            dernier_ok = seq
+
+    if dernier_ok is not None:
+        ble_loop.create_task(ecrire_ble(f"ACK:{dernier_ok}"))
+    if echec:
+        ble_loop.call_later(DELAI_RELANCE_SYNC, lambda: ble_loop.create_task(ecrire_ble("SYNC")))
+
+# === ÉCRITURE SUR LA CARACTÉRISTIQUE BLE DE L’ESP32 ===
+async def ecrire_ble(message):
+    with ble_lock:
+        client = ble_client
+    if client and client.is_connected:
+        try:
+            await client.write_gatt_char(WRITE_CHAR_UUID, message.encode('utf-8'))
+            print(f"📤 Message BLE envoyé à l'ESP32 : {message}")
+        except Exception as e:
+            print("Erreur écriture BLE :", e)
+    else:
+        print("❌ ESP32 non connecté !")
+
+
+# === COMMANDES BINAIRES ENCHAÎNÉES ===
+def status_handler(sender, data):
+    """
+    Réponses de l’ESP32 sur STATUS : chacune complète la commande de même
+    identifiant.
+    """
+    for reponse in decoder_reponses(bytes(data)):
+        attente = reponses_attendues.pop(reponse["id"], None)
+        if attente is not None and not attente.done():
+            attente.set_result(reponse)
+
+
+async def envoyer_commandes(commandes):
+    """
+    Envoie toutes les commandes en une seule écriture (l’ESP32 les exécute
+    dans l’ordre) puis attend leurs réponses.
+    Retourne la liste des réponses, dans l’ordre des commandes ("status":
+    "sans_reponse" après DELAI_REPONSES), None si l’ESP32 n’est pas
+    connecté.
+    """
+    global prochain_ident
+    with ble_lock:
+        client = ble_client
+    if not (client and client.is_connected):
+        print("❌ ESP32 non connecté !")
+        return None
+
+    ecriture, idents = coder_commandes(commandes, prochain_ident)
+    prochain_ident = (prochain_ident + len(idents)) & 0xFF
+    attentes = [ble_loop.create_future() for _ in idents]
+    reponses_attendues.update(zip(idents, attentes))
+    try:
+        # Avec réponse : écriture longue si elle dépasse une notification
+        await client.write_gatt_char(COMMAND_CHAR_UUID, ecriture, response=True)
+        print(f"📤 {len(idents)} commande(s) envoyée(s) en {len(ecriture)} octets")
+        await asyncio.wait(attentes, timeout=DELAI_REPONSES)
+    except Exception as e:
+        print("Erreur écriture des commandes :", e)
+    finally:
+        for ident in idents:
+            reponses_attendues.pop(ident, None)
+    return [a.result() if a.done() else {"op": c["op"], "id": i, "status": "sans_reponse"}
+            for a, c, i in zip(attentes, commandes, idents)]
 
 
 # === CONNEXION ET ABONNEMENT AUX NOTIFICATIONS BLE ===
@@ -64,7 +215,7 @@ async def connect_ble():
     Recherche l’ESP32 BLE, s’y connecte et s’abonne aux notifications.
     Se reconnecte automatiquement en cas de déconnexion.
     """
-    global ble_client
+    global ble_client, reassembleur
     while True:
         try:
             print("🔍 Recherche de l'ESP32 BLE...")
@@ -85,12 +236,15 @@ async def connect_ble():
                 await asyncio.sleep(5)
                 continue
 
-            print("✅ Connecté. Abonnement aux notifications...")
-            await client.start_notify(NOTIFY_CHAR_UUID, notification_handler)
-
-            # Stocker le client connecté
+            # Stocker le client connecté (avant l’abonnement : l’ESP32 envoie
+            # aussitôt son journal, les acquittements doivent pouvoir partir)
             with ble_lock:
                 ble_client = client
+            reassembleur = Reassembleur()
+
+            print("✅ Connecté. Abonnement aux notifications...")
+            await client.start_notify(NOTIFY_CHAR_UUID, notification_handler)
+            await client.start_notify(STATUS_CHAR_UUID, status_handler)
 
             # Boucle tant que la connexion est active
             while client.is_connected:
@@ -121,28 +275,40 @@ def send_to_esp32():
     """
     Reçoit une requête POST contenant un message à transmettre à l’ESP32 via BLE.
     Exemple JSON : { "message": "START" }
+    Durée allouée à un utilisateur (gardée en NVS par l’ESP32) : { "message": "BUDGET:Dupont=240" }
     """
     data = request.json
     message = data.get("message", "")
     print(f"Reçu du backend pour envoi BLE : {message}")
 
-    # Fonction asynchrone interne pour écrire sur la caractéristique BLE
-    async def write_ble():
-        with ble_lock:
-            client = ble_client
-        if client and client.is_connected:
-            try:
-                await client.write_gatt_char(WRITE_CHAR_UUID, message.encode('utf-8'))
-                print(f"📤 Message BLE envoyé à l'ESP32 : {message}")
-            except Exception as e:
-                print("Erreur écriture BLE :", e)
-        else:
-            print("❌ ESP32 non connecté !")
-
     # Exécution sécurisée dans la boucle BLE
-    asyncio.run_coroutine_threadsafe(write_ble(), ble_loop)
+    asyncio.run_coroutine_threadsafe(ecrire_ble(message), ble_loop)
     return jsonify({"status": "sent"}), 200
 
+# === FLASK - ENDPOINT DES COMMANDES BINAIRES ===
+@app.route('/commandes', methods=['POST'])
+def commandes_esp32():
+    """
+    Envoie une liste de commandes à l’ESP32 en une seule écriture BLE et
+    rend leurs réponses (voir commandes.py). Exemple JSON :
+    [ {"op": "select_user", "stall": 0, "user": "Dupont"},
+      {"op": "set_budget", "seconds": 240, "user": "Dupont"},
+      {"op": "start", "stall": 0}, {"op": "status", "stall": 0} ]
+    """
+    commandes = request.json
+    try:
+        ecriture, idents = coder_commandes(commandes)
+    except (KeyError, ValueError, TypeError, AttributeError) as e:
+        return jsonify({"error": f"Commande invalide : {e}"}), 400
+    if len(idents) > 128 or len(ecriture) > COMMANDES_MAX_OCTETS:
+        return jsonify({"error": "Trop de commandes pour une écriture"}), 400
+
+    futur = asyncio.run_coroutine_threadsafe(envoyer_commandes(commandes), ble_loop)
+    reponses = futur.result(timeout=DELAI_REPONSES + 10)
+    if reponses is None:
+        return jsonify({"error": "ESP32 non connecté"}), 503
+    return jsonify(reponses), 200
+
 # === LANCEMENT DE L’APPLICATION ===
 if __name__ == "__main__":
     # Lancer BLE dans un thread secondaire (non-bloquant)
@@ -0,0 +1,69 @@
+# === DÉCODAGE DES TRAMES DE DOUCHES DE L’ESP32 ===
+# Une notification du journal est une trame binaire : un en-tête puis des
+# douches de taille fixe, chacune avec son CRC-32 (zlib.crc32).
+# Format : voir session_record.h dans le firmware (même trame de
+# référence dans les deux tests).
+import struct
+import zlib
+
+SESSION_FRAME_MAGIC = 0xD5
+SESSION_RECORD_VERSION = 1
+SESSION_RECORD_FLOW = 0x01                  # Eau mesurée par un débitmètre
+
+HEADER = struct.Struct("<BBBBHI")           # session_frame_header_t
+RECORD = struct.Struct("<IHBBIIIIH32sI")    # session_record_wire_t
+
+
+def est_trame(data):
+    """
+    True si la notification est une trame binaire (et non une ligne texte
+    d’un ancien firmware).
+    """
+    return len(data) > 0 and data[0] == SESSION_FRAME_MAGIC
+
+
+def decoder_trame(data):
+    """
+    Trame -> (en-tête, liste de douches), dictionnaires.
+    Retourne None si la trame est invalide (version, longueur, CRC) : elle
+    ne doit pas être acquittée.
+    """
+    if len(data) < HEADER.size:
+        return None
+    magic, version, count, record_size, boot, uptime_s = HEADER.unpack_from(data, 0)
+    if (magic != SESSION_FRAME_MAGIC or version != SESSION_RECORD_VERSION
+            or record_size != RECORD.size or len(data) != HEADER.size + count * RECORD.size):
+        return None
+
+    entete = {"version": version, "boot": boot, "uptime_s": uptime_s}
+    douches = []
+    for i in range(count):
+        offset = HEADER.size + i * RECORD.size
+        (seq, rec_boot, stall, flags, start_s, duration_ms, overtime_ms,
+         volume_ml, peak_ml_min, user, crc) = RECORD.unpack_from(data, offset)
+        if zlib.crc32(data[offset:offset + RECORD.size - 4]) != crc:
+            return None
+        mesure = bool(flags & SESSION_RECORD_FLOW)
+        douches.append({
+            "seq": seq or None,                # 0 : douche hors journal, pas d’acquittement
+            "boot": rec_boot,
+            "stall": stall,
+            "start_s": start_s,
+            "duration_ms": duration_ms,
+            "overtime_ms": overtime_ms,
+            "volume_ml": volume_ml if mesure else None,
+            "peak_ml_min": peak_ml_min if mesure else None,
+            "user": user.split(b"\0", 1)[0].decode("utf-8", errors="replace"),
+        })
+    return entete, douches
+
+
+def age_secondes(entete, douche):
+    """
+    Secondes écoulées entre la fin de la douche et l’envoi de la trame.
+    None pour une douche d’un démarrage précédent (pas d’horloge commune).
+    """
+    if douche["boot"] != entete["boot"]:
+        return None
+    fin_s = douche["start_s"] + round(douche["duration_ms"] / 1000)
+    return max(0, entete["uptime_s"] - fin_s)
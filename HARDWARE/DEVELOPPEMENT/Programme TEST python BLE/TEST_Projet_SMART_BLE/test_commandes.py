@@ -0,0 +1,75 @@
+# === TEST DES COMMANDES BINAIRES ===
+#   python -m unittest test_commandes
+# Octets de référence du firmware (host/ble_cmd_test.c) : à modifier des
+# deux côtés.
+import unittest
+
+from commandes import coder_commande, coder_commandes, decoder_reponses
+
+GOLDEN_REQ = bytes.fromhex(
+    "01010601616c696365"
+    "02020300f000"
+    "03030100"
+    "04040109"
+    "05050100"
+    "0606042a000000"
+    "7f0700"
+    "08080100"
+)
+GOLDEN_RESP = bytes.fromhex(
+    "81010000"
+    "82020000"
+    "83030000"
+    "84040300"
+    "8505000e" "00017d0000002c01f00003000000"
+    "86060000"
+    "ff070100"
+    "88080200"
+)
+
+
+class TestCommandes(unittest.TestCase):
+
+    def test_ecriture_de_reference(self):
+        ecriture, idents = coder_commandes([
+            {"op": "select_user", "stall": 1, "user": "alice"},
+            {"op": "set_budget", "stall": 0, "seconds": 240},
+            {"op": "start", "stall": 0},
+            {"op": "stop", "stall": 9},
+            {"op": "status", "stall": 0},
+            {"op": "history", "after": 42},
+        ])
+        self.assertEqual(idents, [1, 2, 3, 4, 5, 6])
+        # Opcode inconnu et REBOOT avec argument : non produits par le codeur
+        ecriture += bytes.fromhex("7f0700") + bytes.fromhex("08080100")
+        self.assertEqual(ecriture, GOLDEN_REQ)
+
+    def test_reponses_de_reference(self):
+        reponses = decoder_reponses(GOLDEN_RESP)
+        self.assertEqual([r["id"] for r in reponses], list(range(1, 9)))
+        self.assertEqual([r["status"] for r in reponses],
+                         ["ok", "ok", "ok", "argument", "ok", "ok", "inconnue", "longueur"])
+        self.assertEqual(reponses[4], {
+            "op": "status", "id": 5, "status": "ok", "stall": 0, "state": "en_cours",
+            "elapsed_s": 125, "duration_s": 300, "budget_s": 240, "sessions": 3})
+        self.assertEqual(reponses[0]["op"], "select_user")
+        self.assertEqual(reponses[6]["op"], 0x7F)
+
+    def test_horloge_et_redemarrage(self):
+        self.assertEqual(coder_commande(9, {"op": "set_clock", "epoch": 1760000000}),
+                         bytes.fromhex("070904") + (1760000000).to_bytes(4, "little"))
+        self.assertEqual(coder_commande(10, {"op": "reboot"}), bytes.fromhex("080a00"))
+        self.assertEqual(decoder_reponses(bytes.fromhex("8709000410270000")),
+                         [{"op": "set_clock", "id": 9, "status": "ok", "uptime_s": 10000}])
+
+    def test_identifiants_sur_un_octet(self):
+        _, idents = coder_commandes([{"op": "stop", "stall": 0}] * 3, premier_ident=255)
+        self.assertEqual(idents, [255, 0, 1])
+
+    def test_notification_abimee(self):
+        self.assertEqual(len(decoder_reponses(GOLDEN_RESP[:-1])), 7)
+        self.assertEqual(decoder_reponses(b""), [])
+
+
+if __name__ == "__main__":
+    unittest.main()
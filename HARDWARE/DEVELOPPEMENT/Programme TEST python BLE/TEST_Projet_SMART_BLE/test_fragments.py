@@ -0,0 +1,68 @@
+# === TEST DU RÉASSEMBLAGE DES FRAGMENTS ===
+#   python -m unittest test_fragments
+# Le découpage côté firmware est testé dans host/ble_tx_test.c.
+import struct
+import unittest
+
+from fragments import FRAG_FIRST, FRAG_LAST, Reassembleur
+
+
+def fragmenter(bloc, taille):
+    """Découpage de ble_tx.c : fragments de taille octets de données."""
+    morceaux = [bloc[i:i + taille] for i in range(0, len(bloc), taille)]
+    fragments = []
+    for i, morceau in enumerate(morceaux):
+        flags = (FRAG_FIRST if i == 0 else 0) | (FRAG_LAST if i == len(morceaux) - 1 else 0)
+        fragments.append(b"#" + struct.pack("<BH", flags, i & 0xFFFF) + morceau)
+    return fragments
+
+
+class TestFragments(unittest.TestCase):
+
+    def test_bloc_entier(self):
+        r = Reassembleur()
+        self.assertEqual(r.ajouter(b"\xd5\x01\x00"), b"\xd5\x01\x00")
+
+    def test_plus_de_255_fragments(self):
+        bloc = bytes(range(256)) * 20
+        r = Reassembleur()
+        fragments = fragmenter(bloc, 16)
+        self.assertEqual(len(fragments), 320)
+        for f in fragments[:-1]:
+            self.assertIsNone(r.ajouter(f))
+        self.assertEqual(r.ajouter(fragments[-1]), bloc)
+        self.assertEqual(r.incomplets, 0)
+
+    def test_numero_qui_repasse_par_zero(self):
+        bloc = bytes(i & 0xFF for i in range(66000))
+        r = Reassembleur()
+        blocs = [r.ajouter(f) for f in fragmenter(bloc, 1)]
+        self.assertEqual(blocs[-1], bloc)
+        self.assertEqual(r.incomplets, 0)
+
+    def test_bloc_court_commencant_par_diese(self):
+        r = Reassembleur()
+        self.assertEqual(r.ajouter(fragmenter(b"#ok", 20)[0]), b"#ok")
+
+    def test_fragment_perdu(self):
+        r = Reassembleur()
+        fragments = fragmenter(bytes(100), 16)
+        r.ajouter(fragments[0])
+        self.assertIsNone(r.ajouter(fragments[2]))
+        self.assertEqual(r.incomplets, 1)
+        for f in fragments[3:]:
+            self.assertIsNone(r.ajouter(f))
+        self.assertEqual(r.incomplets, 1)
+        # Le renvoi complet passe
+        blocs = [r.ajouter(f) for f in fragmenter(bytes(100), 16)]
+        self.assertEqual(blocs[-1], bytes(100))
+
+    def test_bloc_interrompu(self):
+        r = Reassembleur()
+        r.ajouter(fragmenter(bytes(100), 16)[0])
+        self.assertEqual(r.ajouter(b"J:1"), b"J:1")
+        self.assertEqual(r.incomplets, 1)
+
+
+if __name__ == "__main__":
+    unittest.main()
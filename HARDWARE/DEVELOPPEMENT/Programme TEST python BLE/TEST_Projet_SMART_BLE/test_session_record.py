@@ -0,0 +1,76 @@
+# === TEST DU DÉCODEUR DES TRAMES DE DOUCHES ===
+#   python -m unittest test_session_record
+# Trame de référence produite par le firmware (host/session_record_test.c) :
+# à modifier des deux côtés.
+import struct
+import unittest
+import zlib
+
+from session_record import (HEADER, RECORD, SESSION_FRAME_MAGIC, SESSION_RECORD_FLOW,
+                            age_secondes, decoder_trame, est_trame)
+
+GOLDEN_HEX = (
+    "d501023e0700100e0000"
+    "2a00000007000101c4090000c89304008c3c0000227f00004826"
+    "616c696365000000000000000000000000000000000000000000000000000000a4d6b1c3"
+    "2b000000060000005802000090d0030000000000000000000000"
+    "626f620000000000000000000000000000000000000000000000000000000000bbc46fb4"
+)
+GOLDEN = bytes.fromhex(GOLDEN_HEX)
+
+
+def coder(boot, uptime_s, douches):
+    """Codeur de test (même description que session_record.c)."""
+    trame = HEADER.pack(SESSION_FRAME_MAGIC, 1, len(douches), RECORD.size, boot, uptime_s)
+    for d in douches:
+        flags = SESSION_RECORD_FLOW if d["volume_ml"] is not None else 0
+        corps = RECORD.pack(d["seq"] or 0, d["boot"], d["stall"], flags, d["start_s"],
+                            d["duration_ms"], d["overtime_ms"], d["volume_ml"] or 0,
+                            d["peak_ml_min"] or 0, d["user"].encode(), 0)[:-4]
+        trame += corps + struct.pack("<I", zlib.crc32(corps))
+    return trame
+
+
+class TestSessionRecord(unittest.TestCase):
+
+    def test_trame_de_reference(self):
+        entete, douches = decoder_trame(GOLDEN)
+        self.assertEqual(entete, {"version": 1, "boot": 7, "uptime_s": 3600})
+        self.assertEqual(douches[0], {
+            "seq": 42, "boot": 7, "stall": 1, "start_s": 2500, "duration_ms": 299976,
+            "overtime_ms": 15500, "volume_ml": 32546, "peak_ml_min": 9800, "user": "alice"})
+        self.assertEqual(douches[1], {
+            "seq": 43, "boot": 6, "stall": 0, "start_s": 600, "duration_ms": 250000,
+            "overtime_ms": 0, "volume_ml": None, "peak_ml_min": None, "user": "bob"})
+
+    def test_aller_retour(self):
+        entete, douches = decoder_trame(GOLDEN)
+        self.assertEqual(coder(entete["boot"], entete["uptime_s"], douches), GOLDEN)
+
+    def test_age(self):
+        entete, douches = decoder_trame(GOLDEN)
+        self.assertEqual(age_secondes(entete, douches[0]), 3600 - 2500 - 300)
+        self.assertIsNone(age_secondes(entete, douches[1]))      # Démarrage précédent
+
+    def test_douche_hors_journal(self):
+        _, douches = decoder_trame(GOLDEN)
+        douche = dict(douches[0], seq=None)
+        _, relues = decoder_trame(coder(7, 3600, [douche]))
+        self.assertIsNone(relues[0]["seq"])
+
+    def test_trames_abimees(self):
+        abimee = bytearray(GOLDEN)
+        abimee[HEADER.size + 20] ^= 0x01
+        self.assertIsNone(decoder_trame(bytes(abimee)))
+        self.assertIsNone(decoder_trame(GOLDEN[:-1]))
+        self.assertIsNone(decoder_trame(GOLDEN[:HEADER.size]))
+        self.assertIsNone(decoder_trame(bytes([GOLDEN[0], 2]) + GOLDEN[2:]))
+
+    def test_lignes_texte(self):
+        self.assertTrue(est_trame(GOLDEN))
+        self.assertFalse(est_trame(b"J:12;User:alice;Time:300 s"))
+        self.assertFalse(est_trame(b""))
+
+
+if __name__ == "__main__":
+    unittest.main()
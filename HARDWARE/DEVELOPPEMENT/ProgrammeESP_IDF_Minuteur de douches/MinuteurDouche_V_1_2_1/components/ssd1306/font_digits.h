@@ -0,0 +1,111 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: font_digits.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Grands chiffres 7 segments (18x32) pour le compte à rebours MM:SS,
+   stockés au format page : l’affichage est une recopie d’octets.
+
+   Fichier généré par tools/gen_fonts.py : ne pas modifier à la main.
+-- ========================================================================== */
+
+#ifndef FONT_DIGITS_H
+#define FONT_DIGITS_H
+
+#include <stdint.h>
+
+// Chiffres 7 segments de 32 pixels de haut (4 pages) pour le compte à rebours.
+#define FONT_DIGITS_PAGES   4
+#define FONT_DIGITS_ADVANCE 20
+#define FONT_DIGITS_COLON_W 8
+
+// Caractères disponibles, dans l'ordre de la table
+static const char font_digits_chars[] = "0123456789: -";
+
+// [caractère][page][colonne] ; le ":" n'utilise que les 8 premières colonnes
+static const uint8_t font_digits[13][4][20] = {
+    { // '0'
+        {0xF0,0xF8,0xF8,0xF6,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0xF6,0xF8,0xF8,0xF0,0x00,0x00},
+        {0x3F,0x7F,0x7F,0x3F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3F,0x7F,0x7F,0x3F,0x00,0x00},
+        {0xFC,0xFE,0xFE,0xFC,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFC,0xFE,0xFE,0xFC,0x00,0x00},
+        {0x0F,0x1F,0x1F,0x6F,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0x6F,0x1F,0x1F,0x0F,0x00,0x00},
+    },
+    { // '1'
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0xF8,0xF8,0xF0,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3F,0x7F,0x7F,0x3F,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFC,0xFE,0xFE,0xFC,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0F,0x1F,0x1F,0x0F,0x00,0x00},
+    },
+    { // '2'
+        {0x00,0x00,0x00,0x06,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0xF6,0xF8,0xF8,0xF0,0x00,0x00},
+        {0x00,0x00,0x00,0x80,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xBF,0x7F,0x7F,0x3F,0x00,0x00},
+        {0xFC,0xFE,0xFE,0xFD,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x01,0x00,0x00,0x00,0x00,0x00},
+        {0x0F,0x1F,0x1F,0x6F,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0x60,0x00,0x00,0x00,0x00,0x00},
+    },
+    { // '3'
+        {0x00,0x00,0x00,0x06,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0xF6,0xF8,0xF8,0xF0,0x00,0x00},
+        {0x00,0x00,0x00,0x80,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xBF,0x7F,0x7F,0x3F,0x00,0x00},
+        {0x00,0x00,0x00,0x01,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0xFD,0xFE,0xFE,0xFC,0x00,0x00},
+        {0x00,0x00,0x00,0x60,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0x6F,0x1F,0x1F,0x0F,0x00,0x00},
+    },
+    { // '4'
+        {0xF0,0xF8,0xF8,0xF0,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0xF8,0xF8,0xF0,0x00,0x00},
+        {0x3F,0x7F,0x7F,0xBF,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xBF,0x7F,0x7F,0x3F,0x00,0x00},
+        {0x00,0x00,0x00,0x01,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0xFD,0xFE,0xFE,0xFC,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0F,0x1F,0x1F,0x0F,0x00,0x00},
+    },
+    { // '5'
+        {0xF0,0xF8,0xF8,0xF6,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x06,0x00,0x00,0x00,0x00,0x00},
+        {0x3F,0x7F,0x7F,0xBF,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0x80,0x00,0x00,0x00,0x00,0x00},
+        {0x00,0x00,0x00,0x01,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0xFD,0xFE,0xFE,0xFC,0x00,0x00},
+        {0x00,0x00,0x00,0x60,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0x6F,0x1F,0x1F,0x0F,0x00,0x00},
+    },
+    { // '6'
+        {0xF0,0xF8,0xF8,0xF6,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x06,0x00,0x00,0x00,0x00,0x00},
+        {0x3F,0x7F,0x7F,0xBF,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0x80,0x00,0x00,0x00,0x00,0x00},
+        {0xFC,0xFE,0xFE,0xFD,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0xFD,0xFE,0xFE,0xFC,0x00,0x00},
+        {0x0F,0x1F,0x1F,0x6F,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0x6F,0x1F,0x1F,0x0F,0x00,0x00},
+    },
+    { // '7'
+        {0x00,0x00,0x00,0x06,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0xF6,0xF8,0xF8,0xF0,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x3F,0x7F,0x7F,0x3F,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFC,0xFE,0xFE,0xFC,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x0F,0x1F,0x1F,0x0F,0x00,0x00},
+    },
+    { // '8'
+        {0xF0,0xF8,0xF8,0xF6,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0xF6,0xF8,0xF8,0xF0,0x00,0x00},
+        {0x3F,0x7F,0x7F,0xBF,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xBF,0x7F,0x7F,0x3F,0x00,0x00},
+        {0xFC,0xFE,0xFE,0xFD,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0xFD,0xFE,0xFE,0xFC,0x00,0x00},
+        {0x0F,0x1F,0x1F,0x6F,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0x6F,0x1F,0x1F,0x0F,0x00,0x00},
+    },
+    { // '9'
+        {0xF0,0xF8,0xF8,0xF6,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0x0F,0xF6,0xF8,0xF8,0xF0,0x00,0x00},
+        {0x3F,0x7F,0x7F,0xBF,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xBF,0x7F,0x7F,0x3F,0x00,0x00},
+        {0x00,0x00,0x00,0x01,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0xFD,0xFE,0xFE,0xFC,0x00,0x00},
+        {0x00,0x00,0x00,0x60,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0xF0,0x6F,0x1F,0x1F,0x0F,0x00,0x00},
+    },
+    { // ':'
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+        {0x00,0x00,0x1E,0x1E,0x1E,0x1E,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+        {0x00,0x00,0x78,0x78,0x78,0x78,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+    },
+    { // ' '
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+    },
+    { // '-'
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+        {0x00,0x00,0x00,0x80,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0x80,0x00,0x00,0x00,0x00,0x00},
+        {0x00,0x00,0x00,0x01,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x03,0x01,0x00,0x00,0x00,0x00,0x00},
+        {0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+    },
+};
+
+#endif // FONT_DIGITS_H
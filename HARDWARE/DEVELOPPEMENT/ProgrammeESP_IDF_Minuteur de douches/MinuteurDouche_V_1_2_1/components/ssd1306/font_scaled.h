@@ -0,0 +1,318 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: font_scaled.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Police font6x8 agrandie x2, x3 et x4, précalculée à partir de
+   font6x8.h : chaque colonne est étirée verticalement et découpée en
+   pages, la répétition horizontale se fait à l’affichage.
+
+   Fichier généré par tools/gen_fonts.py : ne pas modifier à la main.
+-- ========================================================================== */
+
+#ifndef FONT_SCALED_H
+#define FONT_SCALED_H
+
+#include <stdint.h>
+
+// Colonnes de font6x8 étirées verticalement : [caractère][page][colonne].
+// Chaque colonne est répétée "scale" fois à l'écran.
+static const uint8_t font6x8_x2[95][2][6] = {
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x20 ' '
+    {{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0x33,0x00,0x00,0x00}}, // 0x21 '!'
+    {{0x00,0x3F,0x00,0x3F,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x22 '"'
+    {{0x30,0xFF,0x30,0xFF,0x30,0x00},{0x03,0x3F,0x03,0x3F,0x03,0x00}}, // 0x23 '#'
+    {{0x30,0xCC,0xFF,0xCC,0x0C,0x00},{0x0C,0x0C,0x3F,0x0C,0x03,0x00}}, // 0x24 '$'
+    {{0x0F,0x0F,0xC0,0x30,0x0C,0x00},{0x0C,0x03,0x00,0x3C,0x3C,0x00}}, // 0x25 '%'
+    {{0x3C,0xC3,0x33,0x0C,0x00,0x00},{0x0F,0x30,0x33,0x0C,0x33,0x00}}, // 0x26 '&'
+    {{0x00,0x33,0x0F,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x27 '''
+    {{0x00,0xF0,0x0C,0x03,0x00,0x00},{0x00,0x03,0x0C,0x30,0x00,0x00}}, // 0x28 '('
+    {{0x00,0x03,0x0C,0xF0,0x00,0x00},{0x00,0x30,0x0C,0x03,0x00,0x00}}, // 0x29 ')'
+    {{0x30,0xC0,0xFC,0xC0,0x30,0x00},{0x03,0x00,0x0F,0x00,0x03,0x00}}, // 0x2A '*'
+    {{0xC0,0xC0,0xFC,0xC0,0xC0,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00}}, // 0x2B '+'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x33,0x0F,0x00,0x00,0x00}}, // 0x2C ','
+    {{0xC0,0xC0,0xC0,0xC0,0xC0,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x2D '-'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x3C,0x3C,0x00,0x00,0x00}}, // 0x2E '.'
+    {{0x00,0x00,0xC0,0x30,0x0C,0x00},{0x0C,0x03,0x00,0x00,0x00,0x00}}, // 0x2F '/'
+    {{0xFC,0x03,0xC3,0x33,0xFC,0x00},{0x0F,0x33,0x30,0x30,0x0F,0x00}}, // 0x30 '0'
+    {{0x00,0x0C,0xFF,0x00,0x00,0x00},{0x00,0x30,0x3F,0x30,0x00,0x00}}, // 0x31 '1'
+    {{0x0C,0x03,0x03,0xC3,0x3C,0x00},{0x30,0x3C,0x33,0x30,0x30,0x00}}, // 0x32 '2'
+    {{0x03,0x03,0x33,0xCF,0x03,0x00},{0x0C,0x30,0x30,0x30,0x0F,0x00}}, // 0x33 '3'
+    {{0xC0,0x30,0x0C,0xFF,0x00,0x00},{0x03,0x03,0x03,0x3F,0x03,0x00}}, // 0x34 '4'
+    {{0x3F,0x33,0x33,0x33,0xC3,0x00},{0x0C,0x30,0x30,0x30,0x0F,0x00}}, // 0x35 '5'
+    {{0xF0,0xCC,0xC3,0xC3,0x00,0x00},{0x0F,0x30,0x30,0x30,0x0F,0x00}}, // 0x36 '6'
+    {{0x03,0x03,0xC3,0x33,0x0F,0x00},{0x00,0x3F,0x00,0x00,0x00,0x00}}, // 0x37 '7'
+    {{0x3C,0xC3,0xC3,0xC3,0x3C,0x00},{0x0F,0x30,0x30,0x30,0x0F,0x00}}, // 0x38 '8'
+    {{0x3C,0xC3,0xC3,0xC3,0xFC,0x00},{0x00,0x30,0x30,0x0C,0x03,0x00}}, // 0x39 '9'
+    {{0x00,0x3C,0x3C,0x00,0x00,0x00},{0x00,0x0F,0x0F,0x00,0x00,0x00}}, // 0x3A ':'
+    {{0x00,0x3C,0x3C,0x00,0x00,0x00},{0x00,0x33,0x0F,0x00,0x00,0x00}}, // 0x3B ';'
+    {{0xC0,0x30,0x0C,0x03,0x00,0x00},{0x00,0x03,0x0C,0x30,0x00,0x00}}, // 0x3C '<'
+    {{0x30,0x30,0x30,0x30,0x30,0x00},{0x03,0x03,0x03,0x03,0x03,0x00}}, // 0x3D '='
+    {{0x00,0x03,0x0C,0x30,0xC0,0x00},{0x00,0x30,0x0C,0x03,0x00,0x00}}, // 0x3E '>'
+    {{0x0C,0x03,0x03,0xC3,0x3C,0x00},{0x00,0x00,0x33,0x00,0x00,0x00}}, // 0x3F '?'
+    {{0x0C,0xC3,0xC3,0x03,0xFC,0x00},{0x0F,0x30,0x3F,0x30,0x0F,0x00}}, // 0x40 '@'
+    {{0xFC,0x03,0x03,0x03,0xFC,0x00},{0x3F,0x03,0x03,0x03,0x3F,0x00}}, // 0x41 'A'
+    {{0xFF,0xC3,0xC3,0xC3,0x3C,0x00},{0x3F,0x30,0x30,0x30,0x0F,0x00}}, // 0x42 'B'
+    {{0xFC,0x03,0x03,0x03,0x0C,0x00},{0x0F,0x30,0x30,0x30,0x0C,0x00}}, // 0x43 'C'
+    {{0xFF,0x03,0x03,0x0C,0xF0,0x00},{0x3F,0x30,0x30,0x0C,0x03,0x00}}, // 0x44 'D'
+    {{0xFF,0xC3,0xC3,0xC3,0x03,0x00},{0x3F,0x30,0x30,0x30,0x30,0x00}}, // 0x45 'E'
+    {{0xFF,0xC3,0xC3,0xC3,0x03,0x00},{0x3F,0x00,0x00,0x00,0x00,0x00}}, // 0x46 'F'
+    {{0xFC,0x03,0xC3,0xC3,0xCC,0x00},{0x0F,0x30,0x30,0x30,0x3F,0x00}}, // 0x47 'G'
+    {{0xFF,0xC0,0xC0,0xC0,0xFF,0x00},{0x3F,0x00,0x00,0x00,0x3F,0x00}}, // 0x48 'H'
+    {{0x00,0x03,0xFF,0x03,0x00,0x00},{0x00,0x30,0x3F,0x30,0x00,0x00}}, // 0x49 'I'
+    {{0x00,0x00,0x03,0xFF,0x03,0x00},{0x0C,0x30,0x30,0x0F,0x00,0x00}}, // 0x4A 'J'
+    {{0xFF,0xC0,0x30,0x0C,0x03,0x00},{0x3F,0x00,0x03,0x0C,0x30,0x00}}, // 0x4B 'K'
+    {{0xFF,0x00,0x00,0x00,0x00,0x00},{0x3F,0x30,0x30,0x30,0x30,0x00}}, // 0x4C 'L'
+    {{0xFF,0x0C,0xF0,0x0C,0xFF,0x00},{0x3F,0x00,0x00,0x00,0x3F,0x00}}, // 0x4D 'M'
+    {{0xFF,0x30,0xC0,0x00,0xFF,0x00},{0x3F,0x00,0x00,0x03,0x3F,0x00}}, // 0x4E 'N'
+    {{0xFC,0x03,0x03,0x03,0xFC,0x00},{0x0F,0x30,0x30,0x30,0x0F,0x00}}, // 0x4F 'O'
+    {{0xFF,0xC3,0xC3,0xC3,0x3C,0x00},{0x3F,0x00,0x00,0x00,0x00,0x00}}, // 0x50 'P'
+    {{0xFC,0x03,0x03,0x03,0xFC,0x00},{0x0F,0x30,0x33,0x0C,0x33,0x00}}, // 0x51 'Q'
+    {{0xFF,0xC3,0xC3,0xC3,0x3C,0x00},{0x3F,0x00,0x03,0x0C,0x30,0x00}}, // 0x52 'R'
+    {{0x3C,0xC3,0xC3,0xC3,0x03,0x00},{0x30,0x30,0x30,0x30,0x0F,0x00}}, // 0x53 'S'
+    {{0x03,0x03,0xFF,0x03,0x03,0x00},{0x00,0x00,0x3F,0x00,0x00,0x00}}, // 0x54 'T'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x0F,0x30,0x30,0x30,0x0F,0x00}}, // 0x55 'U'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x03,0x0C,0x30,0x0C,0x03,0x00}}, // 0x56 'V'
+    {{0xFF,0x00,0xC0,0x00,0xFF,0x00},{0x3F,0x0C,0x03,0x0C,0x3F,0x00}}, // 0x57 'W'
+    {{0x0F,0x30,0xC0,0x30,0x0F,0x00},{0x3C,0x03,0x00,0x03,0x3C,0x00}}, // 0x58 'X'
+    {{0x3F,0xC0,0x00,0xC0,0x3F,0x00},{0x00,0x00,0x3F,0x00,0x00,0x00}}, // 0x59 'Y'
+    {{0x03,0x03,0xC3,0x33,0x0F,0x00},{0x3C,0x33,0x30,0x30,0x30,0x00}}, // 0x5A 'Z'
+    {{0x00,0xFF,0x03,0x03,0x00,0x00},{0x00,0x3F,0x30,0x30,0x00,0x00}}, // 0x5B '['
+    {{0x0C,0x30,0xC0,0x00,0x00,0x00},{0x00,0x00,0x00,0x03,0x0C,0x00}}, // 0x5C '\'
+    {{0x00,0x03,0x03,0xFF,0x00,0x00},{0x00,0x30,0x30,0x3F,0x00,0x00}}, // 0x5D ']'
+    {{0x30,0x0C,0x03,0x0C,0x30,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x5E '^'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xC0,0xC0,0xC0,0xC0,0xC0,0x00}}, // 0x5F '_'
+    {{0x00,0x0F,0x33,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x60 '`'
+    {{0x00,0x30,0x30,0x30,0xC0,0x00},{0x0C,0x33,0x33,0x33,0x3F,0x00}}, // 0x61 'a'
+    {{0xFF,0xC0,0x30,0x30,0xC0,0x00},{0x3F,0x30,0x30,0x30,0x0F,0x00}}, // 0x62 'b'
+    {{0xC0,0x30,0x30,0x30,0x00,0x00},{0x0F,0x30,0x30,0x30,0x0C,0x00}}, // 0x63 'c'
+    {{0xC0,0x30,0x30,0xC0,0xFF,0x00},{0x0F,0x30,0x30,0x30,0x3F,0x00}}, // 0x64 'd'
+    {{0xC0,0x30,0x30,0x30,0xC0,0x00},{0x0F,0x33,0x33,0x33,0x03,0x00}}, // 0x65 'e'
+    {{0xC0,0xFC,0xC3,0x03,0x0C,0x00},{0x00,0x3F,0x00,0x00,0x00,0x00}}, // 0x66 'f'
+    {{0xF0,0x0C,0x0C,0x0C,0xFC,0x00},{0x00,0x33,0x33,0x33,0x0F,0x00}}, // 0x67 'g'
+    {{0xFF,0xC0,0x30,0x30,0xC0,0x00},{0x3F,0x00,0x00,0x00,0x3F,0x00}}, // 0x68 'h'
+    {{0x00,0x30,0xF3,0x00,0x00,0x00},{0x00,0x30,0x3F,0x30,0x00,0x00}}, // 0x69 'i'
+    {{0x00,0x00,0x30,0xF3,0x00,0x00},{0x0C,0x30,0x30,0x0F,0x00,0x00}}, // 0x6A 'j'
+    {{0xFF,0x00,0xC0,0x30,0x00,0x00},{0x3F,0x03,0x0C,0x30,0x00,0x00}}, // 0x6B 'k'
+    {{0x00,0x03,0xFF,0x00,0x00,0x00},{0x00,0x30,0x3F,0x30,0x00,0x00}}, // 0x6C 'l'
+    {{0xF0,0x30,0xC0,0x30,0xC0,0x00},{0x3F,0x00,0x03,0x00,0x3F,0x00}}, // 0x6D 'm'
+    {{0xF0,0xC0,0x30,0x30,0xC0,0x00},{0x3F,0x00,0x00,0x00,0x3F,0x00}}, // 0x6E 'n'
+    {{0xC0,0x30,0x30,0x30,0xC0,0x00},{0x0F,0x30,0x30,0x30,0x0F,0x00}}, // 0x6F 'o'
+    {{0xF0,0x30,0x30,0x30,0xC0,0x00},{0x3F,0x03,0x03,0x03,0x00,0x00}}, // 0x70 'p'
+    {{0xC0,0x30,0x30,0xC0,0xF0,0x00},{0x00,0x03,0x03,0x03,0x3F,0x00}}, // 0x71 'q'
+    {{0xF0,0xC0,0x30,0x30,0xC0,0x00},{0x3F,0x00,0x00,0x00,0x00,0x00}}, // 0x72 'r'
+    {{0xC0,0x30,0x30,0x30,0x00,0x00},{0x30,0x33,0x33,0x33,0x0C,0x00}}, // 0x73 's'
+    {{0x30,0xFF,0x30,0x00,0x00,0x00},{0x00,0x0F,0x30,0x30,0x0C,0x00}}, // 0x74 't'
+    {{0xF0,0x00,0x00,0x00,0xF0,0x00},{0x0F,0x30,0x30,0x0C,0x3F,0x00}}, // 0x75 'u'
+    {{0xF0,0x00,0x00,0x00,0xF0,0x00},{0x03,0x0C,0x30,0x0C,0x03,0x00}}, // 0x76 'v'
+    {{0xF0,0x00,0x00,0x00,0xF0,0x00},{0x0F,0x30,0x0F,0x30,0x0F,0x00}}, // 0x77 'w'
+    {{0x30,0xC0,0x00,0xC0,0x30,0x00},{0x30,0x0C,0x03,0x0C,0x30,0x00}}, // 0x78 'x'
+    {{0xF0,0x00,0x00,0x00,0xF0,0x00},{0x00,0x33,0x33,0x33,0x0F,0x00}}, // 0x79 'y'
+    {{0x30,0x30,0x30,0xF0,0x30,0x00},{0x30,0x3C,0x33,0x30,0x30,0x00}}, // 0x7A 'z'
+    {{0x00,0xC0,0x3C,0x03,0x00,0x00},{0x00,0x00,0x0F,0x30,0x00,0x00}}, // 0x7B '{'
+    {{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0x3F,0x00,0x00,0x00}}, // 0x7C '|'
+    {{0x00,0x03,0x3C,0xC0,0x00,0x00},{0x00,0x30,0x0F,0x00,0x00,0x00}}, // 0x7D '}'
+    {{0x00,0xC0,0xC0,0x00,0xC0,0x00},{0x03,0x00,0x00,0x03,0x00,0x00}}, // 0x7E '~'
+};
+
+static const uint8_t font6x8_x3[95][3][6] = {
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x20 ' '
+    {{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0x7F,0x00,0x00,0x00},{0x00,0x00,0x1C,0x00,0x00,0x00}}, // 0x21 '!'
+    {{0x00,0xFF,0x00,0xFF,0x00,0x00},{0x00,0x01,0x00,0x01,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x22 '"'
+    {{0xC0,0xFF,0xC0,0xFF,0xC0,0x00},{0x71,0xFF,0x71,0xFF,0x71,0x00},{0x00,0x1F,0x00,0x1F,0x00,0x00}}, // 0x23 '#'
+    {{0xC0,0x38,0xFF,0x38,0x38,0x00},{0x81,0x8E,0xFF,0x8E,0x70,0x00},{0x03,0x03,0x1F,0x03,0x00,0x00}}, // 0x24 '$'
+    {{0x3F,0x3F,0x00,0xC0,0x38,0x00},{0x80,0x70,0x0E,0x81,0x80,0x00},{0x03,0x00,0x00,0x1F,0x1F,0x00}}, // 0x25 '%'
+    {{0xF8,0x07,0xC7,0x38,0x00,0x00},{0xF1,0x0E,0x71,0x80,0x70,0x00},{0x03,0x1C,0x1C,0x03,0x1C,0x00}}, // 0x26 '&'
+    {{0x00,0xC7,0x3F,0x00,0x00,0x00},{0x00,0x01,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x27 '''
+    {{0x00,0xC0,0x38,0x07,0x00,0x00},{0x00,0x7F,0x80,0x00,0x00,0x00},{0x00,0x00,0x03,0x1C,0x00,0x00}}, // 0x28 '('
+    {{0x00,0x07,0x38,0xC0,0x00,0x00},{0x00,0x00,0x80,0x7F,0x00,0x00},{0x00,0x1C,0x03,0x00,0x00,0x00}}, // 0x29 ')'
+    {{0xC0,0x00,0xF8,0x00,0xC0,0x00},{0x71,0x0E,0xFF,0x0E,0x71,0x00},{0x00,0x00,0x03,0x00,0x00,0x00}}, // 0x2A '*'
+    {{0x00,0x00,0xF8,0x00,0x00,0x00},{0x0E,0x0E,0xFF,0x0E,0x0E,0x00},{0x00,0x00,0x03,0x00,0x00,0x00}}, // 0x2B '+'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x70,0xF0,0x00,0x00,0x00},{0x00,0x1C,0x03,0x00,0x00,0x00}}, // 0x2C ','
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x0E,0x0E,0x0E,0x0E,0x0E,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x2D '-'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x80,0x80,0x00,0x00,0x00},{0x00,0x1F,0x1F,0x00,0x00,0x00}}, // 0x2E '.'
+    {{0x00,0x00,0x00,0xC0,0x38,0x00},{0x80,0x70,0x0E,0x01,0x00,0x00},{0x03,0x00,0x00,0x00,0x00,0x00}}, // 0x2F '/'
+    {{0xF8,0x07,0x07,0xC7,0xF8,0x00},{0xFF,0x70,0x0E,0x01,0xFF,0x00},{0x03,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x30 '0'
+    {{0x00,0x38,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x1C,0x1F,0x1C,0x00,0x00}}, // 0x31 '1'
+    {{0x38,0x07,0x07,0x07,0xF8,0x00},{0x00,0x80,0x70,0x0E,0x01,0x00},{0x1C,0x1F,0x1C,0x1C,0x1C,0x00}}, // 0x32 '2'
+    {{0x07,0x07,0xC7,0x3F,0x07,0x00},{0x80,0x00,0x01,0x0E,0xF0,0x00},{0x03,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x33 '3'
+    {{0x00,0xC0,0x38,0xFF,0x00,0x00},{0x7E,0x71,0x70,0xFF,0x70,0x00},{0x00,0x00,0x00,0x1F,0x00,0x00}}, // 0x34 '4'
+    {{0xFF,0xC7,0xC7,0xC7,0x07,0x00},{0x81,0x01,0x01,0x01,0xFE,0x00},{0x03,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x35 '5'
+    {{0xC0,0x38,0x07,0x07,0x00,0x00},{0xFF,0x0E,0x0E,0x0E,0xF0,0x00},{0x03,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x36 '6'
+    {{0x07,0x07,0x07,0xC7,0x3F,0x00},{0x00,0xF0,0x0E,0x01,0x00,0x00},{0x00,0x1F,0x00,0x00,0x00,0x00}}, // 0x37 '7'
+    {{0xF8,0x07,0x07,0x07,0xF8,0x00},{0xF1,0x0E,0x0E,0x0E,0xF1,0x00},{0x03,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x38 '8'
+    {{0xF8,0x07,0x07,0x07,0xF8,0x00},{0x01,0x0E,0x0E,0x8E,0x7F,0x00},{0x00,0x1C,0x1C,0x03,0x00,0x00}}, // 0x39 '9'
+    {{0x00,0xF8,0xF8,0x00,0x00,0x00},{0x00,0xF1,0xF1,0x00,0x00,0x00},{0x00,0x03,0x03,0x00,0x00,0x00}}, // 0x3A ':'
+    {{0x00,0xF8,0xF8,0x00,0x00,0x00},{0x00,0x71,0xF1,0x00,0x00,0x00},{0x00,0x1C,0x03,0x00,0x00,0x00}}, // 0x3B ';'
+    {{0x00,0xC0,0x38,0x07,0x00,0x00},{0x0E,0x71,0x80,0x00,0x00,0x00},{0x00,0x00,0x03,0x1C,0x00,0x00}}, // 0x3C '<'
+    {{0xC0,0xC0,0xC0,0xC0,0xC0,0x00},{0x71,0x71,0x71,0x71,0x71,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x3D '='
+    {{0x00,0x07,0x38,0xC0,0x00,0x00},{0x00,0x00,0x80,0x71,0x0E,0x00},{0x00,0x1C,0x03,0x00,0x00,0x00}}, // 0x3E '>'
+    {{0x38,0x07,0x07,0x07,0xF8,0x00},{0x00,0x00,0x70,0x0E,0x01,0x00},{0x00,0x00,0x1C,0x00,0x00,0x00}}, // 0x3F '?'
+    {{0x38,0x07,0x07,0x07,0xF8,0x00},{0xF0,0x0E,0xFE,0x00,0xFF,0x00},{0x03,0x1C,0x1F,0x1C,0x03,0x00}}, // 0x40 '@'
+    {{0xF8,0x07,0x07,0x07,0xF8,0x00},{0xFF,0x70,0x70,0x70,0xFF,0x00},{0x1F,0x00,0x00,0x00,0x1F,0x00}}, // 0x41 'A'
+    {{0xFF,0x07,0x07,0x07,0xF8,0x00},{0xFF,0x0E,0x0E,0x0E,0xF1,0x00},{0x1F,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x42 'B'
+    {{0xF8,0x07,0x07,0x07,0x38,0x00},{0xFF,0x00,0x00,0x00,0x80,0x00},{0x03,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x43 'C'
+    {{0xFF,0x07,0x07,0x38,0xC0,0x00},{0xFF,0x00,0x00,0x80,0x7F,0x00},{0x1F,0x1C,0x1C,0x03,0x00,0x00}}, // 0x44 'D'
+    {{0xFF,0x07,0x07,0x07,0x07,0x00},{0xFF,0x0E,0x0E,0x0E,0x00,0x00},{0x1F,0x1C,0x1C,0x1C,0x1C,0x00}}, // 0x45 'E'
+    {{0xFF,0x07,0x07,0x07,0x07,0x00},{0xFF,0x0E,0x0E,0x0E,0x00,0x00},{0x1F,0x00,0x00,0x00,0x00,0x00}}, // 0x46 'F'
+    {{0xF8,0x07,0x07,0x07,0x38,0x00},{0xFF,0x00,0x0E,0x0E,0xFE,0x00},{0x03,0x1C,0x1C,0x1C,0x1F,0x00}}, // 0x47 'G'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x0E,0x0E,0x0E,0xFF,0x00},{0x1F,0x00,0x00,0x00,0x1F,0x00}}, // 0x48 'H'
+    {{0x00,0x07,0xFF,0x07,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x1C,0x1F,0x1C,0x00,0x00}}, // 0x49 'I'
+    {{0x00,0x00,0x07,0xFF,0x07,0x00},{0x80,0x00,0x00,0xFF,0x00,0x00},{0x03,0x1C,0x1C,0x03,0x00,0x00}}, // 0x4A 'J'
+    {{0xFF,0x00,0xC0,0x38,0x07,0x00},{0xFF,0x0E,0x71,0x80,0x00,0x00},{0x1F,0x00,0x00,0x03,0x1C,0x00}}, // 0x4B 'K'
+    {{0xFF,0x00,0x00,0x00,0x00,0x00},{0xFF,0x00,0x00,0x00,0x00,0x00},{0x1F,0x1C,0x1C,0x1C,0x1C,0x00}}, // 0x4C 'L'
+    {{0xFF,0x38,0xC0,0x38,0xFF,0x00},{0xFF,0x00,0x0F,0x00,0xFF,0x00},{0x1F,0x00,0x00,0x00,0x1F,0x00}}, // 0x4D 'M'
+    {{0xFF,0xC0,0x00,0x00,0xFF,0x00},{0xFF,0x01,0x0E,0x70,0xFF,0x00},{0x1F,0x00,0x00,0x00,0x1F,0x00}}, // 0x4E 'N'
+    {{0xF8,0x07,0x07,0x07,0xF8,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x03,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x4F 'O'
+    {{0xFF,0x07,0x07,0x07,0xF8,0x00},{0xFF,0x0E,0x0E,0x0E,0x01,0x00},{0x1F,0x00,0x00,0x00,0x00,0x00}}, // 0x50 'P'
+    {{0xF8,0x07,0x07,0x07,0xF8,0x00},{0xFF,0x00,0x70,0x80,0x7F,0x00},{0x03,0x1C,0x1C,0x03,0x1C,0x00}}, // 0x51 'Q'
+    {{0xFF,0x07,0x07,0x07,0xF8,0x00},{0xFF,0x0E,0x7E,0x8E,0x01,0x00},{0x1F,0x00,0x00,0x03,0x1C,0x00}}, // 0x52 'R'
+    {{0xF8,0x07,0x07,0x07,0x07,0x00},{0x01,0x0E,0x0E,0x0E,0xF0,0x00},{0x1C,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x53 'S'
+    {{0x07,0x07,0xFF,0x07,0x07,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0x1F,0x00,0x00,0x00}}, // 0x54 'T'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x03,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x55 'U'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x7F,0x80,0x00,0x80,0x7F,0x00},{0x00,0x03,0x1C,0x03,0x00,0x00}}, // 0x56 'V'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x80,0x7E,0x80,0xFF,0x00},{0x1F,0x03,0x00,0x03,0x1F,0x00}}, // 0x57 'W'
+    {{0x3F,0xC0,0x00,0xC0,0x3F,0x00},{0x80,0x71,0x0E,0x71,0x80,0x00},{0x1F,0x00,0x00,0x00,0x1F,0x00}}, // 0x58 'X'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x01,0x0E,0xF0,0x0E,0x01,0x00},{0x00,0x00,0x1F,0x00,0x00,0x00}}, // 0x59 'Y'
+    {{0x07,0x07,0x07,0xC7,0x3F,0x00},{0x80,0x70,0x0E,0x01,0x00,0x00},{0x1F,0x1C,0x1C,0x1C,0x1C,0x00}}, // 0x5A 'Z'
+    {{0x00,0xFF,0x07,0x07,0x00,0x00},{0x00,0xFF,0x00,0x00,0x00,0x00},{0x00,0x1F,0x1C,0x1C,0x00,0x00}}, // 0x5B '['
+    {{0x38,0xC0,0x00,0x00,0x00,0x00},{0x00,0x01,0x0E,0x70,0x80,0x00},{0x00,0x00,0x00,0x00,0x03,0x00}}, // 0x5C '\'
+    {{0x00,0x07,0x07,0xFF,0x00,0x00},{0x00,0x00,0x00,0xFF,0x00,0x00},{0x00,0x1C,0x1C,0x1F,0x00,0x00}}, // 0x5D ']'
+    {{0xC0,0x38,0x07,0x38,0xC0,0x00},{0x01,0x00,0x00,0x00,0x01,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x5E '^'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0xE0,0xE0,0xE0,0xE0,0xE0,0x00}}, // 0x5F '_'
+    {{0x00,0x3F,0xC7,0x00,0x00,0x00},{0x00,0x00,0x01,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x60 '`'
+    {{0x00,0xC0,0xC0,0xC0,0x00,0x00},{0x80,0x71,0x71,0x71,0xFE,0x00},{0x03,0x1C,0x1C,0x1C,0x1F,0x00}}, // 0x61 'a'
+    {{0xFF,0x00,0xC0,0xC0,0x00,0x00},{0xFF,0x0E,0x01,0x01,0xFE,0x00},{0x1F,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x62 'b'
+    {{0x00,0xC0,0xC0,0xC0,0x00,0x00},{0xFE,0x01,0x01,0x01,0x80,0x00},{0x03,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x63 'c'
+    {{0x00,0xC0,0xC0,0x00,0xFF,0x00},{0xFE,0x01,0x01,0x0E,0xFF,0x00},{0x03,0x1C,0x1C,0x1C,0x1F,0x00}}, // 0x64 'd'
+    {{0x00,0xC0,0xC0,0xC0,0x00,0x00},{0xFE,0x71,0x71,0x71,0x7E,0x00},{0x03,0x1C,0x1C,0x1C,0x00,0x00}}, // 0x65 'e'
+    {{0x00,0xF8,0x07,0x07,0x38,0x00},{0x0E,0xFF,0x0E,0x00,0x00,0x00},{0x00,0x1F,0x00,0x00,0x00,0x00}}, // 0x66 'f'
+    {{0xC0,0x38,0x38,0x38,0xF8,0x00},{0x0F,0x70,0x70,0x70,0xFF,0x00},{0x00,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x67 'g'
+    {{0xFF,0x00,0xC0,0xC0,0x00,0x00},{0xFF,0x0E,0x01,0x01,0xFE,0x00},{0x1F,0x00,0x00,0x00,0x1F,0x00}}, // 0x68 'h'
+    {{0x00,0xC0,0xC7,0x00,0x00,0x00},{0x00,0x01,0xFF,0x00,0x00,0x00},{0x00,0x1C,0x1F,0x1C,0x00,0x00}}, // 0x69 'i'
+    {{0x00,0x00,0xC0,0xC7,0x00,0x00},{0x80,0x00,0x01,0xFF,0x00,0x00},{0x03,0x1C,0x1C,0x03,0x00,0x00}}, // 0x6A 'j'
+    {{0xFF,0x00,0x00,0xC0,0x00,0x00},{0xFF,0x70,0x8E,0x01,0x00,0x00},{0x1F,0x00,0x03,0x1C,0x00,0x00}}, // 0x6B 'k'
+    {{0x00,0x07,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x1C,0x1F,0x1C,0x00,0x00}}, // 0x6C 'l'
+    {{0xC0,0xC0,0x00,0xC0,0x00,0x00},{0xFF,0x01,0x7E,0x01,0xFE,0x00},{0x1F,0x00,0x00,0x00,0x1F,0x00}}, // 0x6D 'm'
+    {{0xC0,0x00,0xC0,0xC0,0x00,0x00},{0xFF,0x0E,0x01,0x01,0xFE,0x00},{0x1F,0x00,0x00,0x00,0x1F,0x00}}, // 0x6E 'n'
+    {{0x00,0xC0,0xC0,0xC0,0x00,0x00},{0xFE,0x01,0x01,0x01,0xFE,0x00},{0x03,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x6F 'o'
+    {{0xC0,0xC0,0xC0,0xC0,0x00,0x00},{0xFF,0x71,0x71,0x71,0x0E,0x00},{0x1F,0x00,0x00,0x00,0x00,0x00}}, // 0x70 'p'
+    {{0x00,0xC0,0xC0,0x00,0xC0,0x00},{0x0E,0x71,0x71,0x7E,0xFF,0x00},{0x00,0x00,0x00,0x00,0x1F,0x00}}, // 0x71 'q'
+    {{0xC0,0x00,0xC0,0xC0,0x00,0x00},{0xFF,0x0E,0x01,0x01,0x0E,0x00},{0x1F,0x00,0x00,0x00,0x00,0x00}}, // 0x72 'r'
+    {{0x00,0xC0,0xC0,0xC0,0x00,0x00},{0x0E,0x71,0x71,0x71,0x80,0x00},{0x1C,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x73 's'
+    {{0xC0,0xFF,0xC0,0x00,0x00,0x00},{0x01,0xFF,0x01,0x00,0x80,0x00},{0x00,0x03,0x1C,0x1C,0x03,0x00}}, // 0x74 't'
+    {{0xC0,0x00,0x00,0x00,0xC0,0x00},{0xFF,0x00,0x00,0x80,0xFF,0x00},{0x03,0x1C,0x1C,0x03,0x1F,0x00}}, // 0x75 'u'
+    {{0xC0,0x00,0x00,0x00,0xC0,0x00},{0x7F,0x80,0x00,0x80,0x7F,0x00},{0x00,0x03,0x1C,0x03,0x00,0x00}}, // 0x76 'v'
+    {{0xC0,0x00,0x00,0x00,0xC0,0x00},{0xFF,0x00,0xF0,0x00,0xFF,0x00},{0x03,0x1C,0x03,0x1C,0x03,0x00}}, // 0x77 'w'
+    {{0xC0,0x00,0x00,0x00,0xC0,0x00},{0x01,0x8E,0x70,0x8E,0x01,0x00},{0x1C,0x03,0x00,0x03,0x1C,0x00}}, // 0x78 'x'
+    {{0xC0,0x00,0x00,0x00,0xC0,0x00},{0x0F,0x70,0x70,0x70,0xFF,0x00},{0x00,0x1C,0x1C,0x1C,0x03,0x00}}, // 0x79 'y'
+    {{0xC0,0xC0,0xC0,0xC0,0xC0,0x00},{0x01,0x81,0x71,0x0F,0x01,0x00},{0x1C,0x1F,0x1C,0x1C,0x1C,0x00}}, // 0x7A 'z'
+    {{0x00,0x00,0xF8,0x07,0x00,0x00},{0x00,0x0E,0xF1,0x00,0x00,0x00},{0x00,0x00,0x03,0x1C,0x00,0x00}}, // 0x7B '{'
+    {{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0x1F,0x00,0x00,0x00}}, // 0x7C '|'
+    {{0x00,0x07,0xF8,0x00,0x00,0x00},{0x00,0x00,0xF1,0x0E,0x00,0x00},{0x00,0x1C,0x03,0x00,0x00,0x00}}, // 0x7D '}'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x70,0x0E,0x0E,0x70,0x0E,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x7E '~'
+};
+
+static const uint8_t font6x8_x4[95][4][6] = {
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x20 ' '
+    {{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00}}, // 0x21 '!'
+    {{0x00,0xFF,0x00,0xFF,0x00,0x00},{0x00,0x0F,0x00,0x0F,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x22 '"'
+    {{0x00,0xFF,0x00,0xFF,0x00,0x00},{0x0F,0xFF,0x0F,0xFF,0x0F,0x00},{0x0F,0xFF,0x0F,0xFF,0x0F,0x00},{0x00,0x0F,0x00,0x0F,0x00,0x00}}, // 0x23 '#'
+    {{0x00,0xF0,0xFF,0xF0,0xF0,0x00},{0x0F,0xF0,0xFF,0xF0,0x00,0x00},{0xF0,0xF0,0xFF,0xF0,0x0F,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00}}, // 0x24 '$'
+    {{0xFF,0xFF,0x00,0x00,0xF0,0x00},{0x00,0x00,0xF0,0x0F,0x00,0x00},{0xF0,0x0F,0x00,0xF0,0xF0,0x00},{0x00,0x00,0x00,0x0F,0x0F,0x00}}, // 0x25 '%'
+    {{0xF0,0x0F,0x0F,0xF0,0x00,0x00},{0x0F,0xF0,0x0F,0x00,0x00,0x00},{0xFF,0x00,0x0F,0xF0,0x0F,0x00},{0x00,0x0F,0x0F,0x00,0x0F,0x00}}, // 0x26 '&'
+    {{0x00,0x0F,0xFF,0x00,0x00,0x00},{0x00,0x0F,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x27 '''
+    {{0x00,0x00,0xF0,0x0F,0x00,0x00},{0x00,0xFF,0x00,0x00,0x00,0x00},{0x00,0x0F,0xF0,0x00,0x00,0x00},{0x00,0x00,0x00,0x0F,0x00,0x00}}, // 0x28 '('
+    {{0x00,0x0F,0xF0,0x00,0x00,0x00},{0x00,0x00,0x00,0xFF,0x00,0x00},{0x00,0x00,0xF0,0x0F,0x00,0x00},{0x00,0x0F,0x00,0x00,0x00,0x00}}, // 0x29 ')'
+    {{0x00,0x00,0xF0,0x00,0x00,0x00},{0x0F,0xF0,0xFF,0xF0,0x0F,0x00},{0x0F,0x00,0xFF,0x00,0x0F,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x2A '*'
+    {{0x00,0x00,0xF0,0x00,0x00,0x00},{0xF0,0xF0,0xFF,0xF0,0xF0,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x2B '+'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x0F,0xFF,0x00,0x00,0x00},{0x00,0x0F,0x00,0x00,0x00,0x00}}, // 0x2C ','
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xF0,0xF0,0xF0,0xF0,0xF0,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x2D '-'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0xF0,0xF0,0x00,0x00,0x00},{0x00,0x0F,0x0F,0x00,0x00,0x00}}, // 0x2E '.'
+    {{0x00,0x00,0x00,0x00,0xF0,0x00},{0x00,0x00,0xF0,0x0F,0x00,0x00},{0xF0,0x0F,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x2F '/'
+    {{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0x00,0xF0,0x0F,0xFF,0x00},{0xFF,0x0F,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x30 '0'
+    {{0x00,0xF0,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x31 '1'
+    {{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0x00,0x00,0x00,0xF0,0x0F,0x00},{0x00,0xF0,0x0F,0x00,0x00,0x00},{0x0F,0x0F,0x0F,0x0F,0x0F,0x00}}, // 0x32 '2'
+    {{0x0F,0x0F,0x0F,0xFF,0x0F,0x00},{0x00,0x00,0x0F,0xF0,0x00,0x00},{0xF0,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x33 '3'
+    {{0x00,0x00,0xF0,0xFF,0x00,0x00},{0xF0,0x0F,0x00,0xFF,0x00,0x00},{0x0F,0x0F,0x0F,0xFF,0x0F,0x00},{0x00,0x00,0x00,0x0F,0x00,0x00}}, // 0x34 '4'
+    {{0xFF,0x0F,0x0F,0x0F,0x0F,0x00},{0x0F,0x0F,0x0F,0x0F,0xF0,0x00},{0xF0,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x35 '5'
+    {{0x00,0xF0,0x0F,0x0F,0x00,0x00},{0xFF,0xF0,0xF0,0xF0,0x00,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x36 '6'
+    {{0x0F,0x0F,0x0F,0x0F,0xFF,0x00},{0x00,0x00,0xF0,0x0F,0x00,0x00},{0x00,0xFF,0x00,0x00,0x00,0x00},{0x00,0x0F,0x00,0x00,0x00,0x00}}, // 0x37 '7'
+    {{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0x0F,0xF0,0xF0,0xF0,0x0F,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x38 '8'
+    {{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0x0F,0xF0,0xF0,0xF0,0xFF,0x00},{0x00,0x00,0x00,0xF0,0x0F,0x00},{0x00,0x0F,0x0F,0x00,0x00,0x00}}, // 0x39 '9'
+    {{0x00,0xF0,0xF0,0x00,0x00,0x00},{0x00,0x0F,0x0F,0x00,0x00,0x00},{0x00,0xFF,0xFF,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x3A ':'
+    {{0x00,0xF0,0xF0,0x00,0x00,0x00},{0x00,0x0F,0x0F,0x00,0x00,0x00},{0x00,0x0F,0xFF,0x00,0x00,0x00},{0x00,0x0F,0x00,0x00,0x00,0x00}}, // 0x3B ';'
+    {{0x00,0x00,0xF0,0x0F,0x00,0x00},{0xF0,0x0F,0x00,0x00,0x00,0x00},{0x00,0x0F,0xF0,0x00,0x00,0x00},{0x00,0x00,0x00,0x0F,0x00,0x00}}, // 0x3C '<'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x0F,0x0F,0x0F,0x0F,0x0F,0x00},{0x0F,0x0F,0x0F,0x0F,0x0F,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x3D '='
+    {{0x00,0x0F,0xF0,0x00,0x00,0x00},{0x00,0x00,0x00,0x0F,0xF0,0x00},{0x00,0x00,0xF0,0x0F,0x00,0x00},{0x00,0x0F,0x00,0x00,0x00,0x00}}, // 0x3E '>'
+    {{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0x00,0x00,0x00,0xF0,0x0F,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00}}, // 0x3F '?'
+    {{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0x00,0xF0,0xF0,0x00,0xFF,0x00},{0xFF,0x00,0xFF,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x40 '@'
+    {{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x0F,0x0F,0x0F,0xFF,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x41 'A'
+    {{0xFF,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0xF0,0xF0,0xF0,0x0F,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x0F,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x42 'B'
+    {{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0x00,0x00,0x00,0x00,0x00},{0xFF,0x00,0x00,0x00,0xF0,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x43 'C'
+    {{0xFF,0x0F,0x0F,0xF0,0x00,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x00,0x00,0xF0,0x0F,0x00},{0x0F,0x0F,0x0F,0x00,0x00,0x00}}, // 0x44 'D'
+    {{0xFF,0x0F,0x0F,0x0F,0x0F,0x00},{0xFF,0xF0,0xF0,0xF0,0x00,0x00},{0xFF,0x00,0x00,0x00,0x00,0x00},{0x0F,0x0F,0x0F,0x0F,0x0F,0x00}}, // 0x45 'E'
+    {{0xFF,0x0F,0x0F,0x0F,0x0F,0x00},{0xFF,0xF0,0xF0,0xF0,0x00,0x00},{0xFF,0x00,0x00,0x00,0x00,0x00},{0x0F,0x00,0x00,0x00,0x00,0x00}}, // 0x46 'F'
+    {{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0x00,0xF0,0xF0,0xF0,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x0F,0x00}}, // 0x47 'G'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0xF0,0xF0,0xF0,0xFF,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x48 'H'
+    {{0x00,0x0F,0xFF,0x0F,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x49 'I'
+    {{0x00,0x00,0x0F,0xFF,0x0F,0x00},{0x00,0x00,0x00,0xFF,0x00,0x00},{0xF0,0x00,0x00,0xFF,0x00,0x00},{0x00,0x0F,0x0F,0x00,0x00,0x00}}, // 0x4A 'J'
+    {{0xFF,0x00,0x00,0xF0,0x0F,0x00},{0xFF,0xF0,0x0F,0x00,0x00,0x00},{0xFF,0x00,0x0F,0xF0,0x00,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x4B 'K'
+    {{0xFF,0x00,0x00,0x00,0x00,0x00},{0xFF,0x00,0x00,0x00,0x00,0x00},{0xFF,0x00,0x00,0x00,0x00,0x00},{0x0F,0x0F,0x0F,0x0F,0x0F,0x00}}, // 0x4C 'L'
+    {{0xFF,0xF0,0x00,0xF0,0xFF,0x00},{0xFF,0x00,0xFF,0x00,0xFF,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x4D 'M'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x0F,0xF0,0x00,0xFF,0x00},{0xFF,0x00,0x00,0x0F,0xFF,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x4E 'N'
+    {{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x4F 'O'
+    {{0xFF,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0xF0,0xF0,0xF0,0x0F,0x00},{0xFF,0x00,0x00,0x00,0x00,0x00},{0x0F,0x00,0x00,0x00,0x00,0x00}}, // 0x50 'P'
+    {{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x00,0x0F,0xF0,0x0F,0x00},{0x00,0x0F,0x0F,0x00,0x0F,0x00}}, // 0x51 'Q'
+    {{0xFF,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0xF0,0xF0,0xF0,0x0F,0x00},{0xFF,0x00,0x0F,0xF0,0x00,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x52 'R'
+    {{0xF0,0x0F,0x0F,0x0F,0x0F,0x00},{0x0F,0xF0,0xF0,0xF0,0x00,0x00},{0x00,0x00,0x00,0x00,0xFF,0x00},{0x0F,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x53 'S'
+    {{0x0F,0x0F,0xFF,0x0F,0x0F,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00}}, // 0x54 'T'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x55 'U'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x0F,0xF0,0x00,0xF0,0x0F,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00}}, // 0x56 'V'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x00,0xF0,0x00,0xFF,0x00},{0xFF,0xF0,0x0F,0xF0,0xFF,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x57 'W'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0xF0,0x0F,0x00,0x00},{0xF0,0x0F,0x00,0x0F,0xF0,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x58 'X'
+    {{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x0F,0xF0,0x00,0xF0,0x0F,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00}}, // 0x59 'Y'
+    {{0x0F,0x0F,0x0F,0x0F,0xFF,0x00},{0x00,0x00,0xF0,0x0F,0x00,0x00},{0xF0,0x0F,0x00,0x00,0x00,0x00},{0x0F,0x0F,0x0F,0x0F,0x0F,0x00}}, // 0x5A 'Z'
+    {{0x00,0xFF,0x0F,0x0F,0x00,0x00},{0x00,0xFF,0x00,0x00,0x00,0x00},{0x00,0xFF,0x00,0x00,0x00,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x5B '['
+    {{0xF0,0x00,0x00,0x00,0x00,0x00},{0x00,0x0F,0xF0,0x00,0x00,0x00},{0x00,0x00,0x00,0x0F,0xF0,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x5C '\'
+    {{0x00,0x0F,0x0F,0xFF,0x00,0x00},{0x00,0x00,0x00,0xFF,0x00,0x00},{0x00,0x00,0x00,0xFF,0x00,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x5D ']'
+    {{0x00,0xF0,0x0F,0xF0,0x00,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x5E '^'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0xF0,0xF0,0xF0,0xF0,0xF0,0x00}}, // 0x5F '_'
+    {{0x00,0xFF,0x0F,0x00,0x00,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x60 '`'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0x0F,0x0F,0x0F,0xF0,0x00},{0xF0,0x0F,0x0F,0x0F,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x0F,0x00}}, // 0x61 'a'
+    {{0xFF,0x00,0x00,0x00,0x00,0x00},{0xFF,0xF0,0x0F,0x0F,0xF0,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x0F,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x62 'b'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xF0,0x0F,0x0F,0x0F,0x00,0x00},{0xFF,0x00,0x00,0x00,0xF0,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x63 'c'
+    {{0x00,0x00,0x00,0x00,0xFF,0x00},{0xF0,0x0F,0x0F,0xF0,0xFF,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x0F,0x00}}, // 0x64 'd'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0x0F,0x0F,0x0F,0x0F,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x65 'e'
+    {{0x00,0xF0,0x0F,0x0F,0xF0,0x00},{0xF0,0xFF,0xF0,0x00,0x00,0x00},{0x00,0xFF,0x00,0x00,0x00,0x00},{0x00,0x0F,0x00,0x00,0x00,0x00}}, // 0x66 'f'
+    {{0x00,0xF0,0xF0,0xF0,0xF0,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x67 'g'
+    {{0xFF,0x00,0x00,0x00,0x00,0x00},{0xFF,0xF0,0x0F,0x0F,0xF0,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x68 'h'
+    {{0x00,0x00,0x0F,0x00,0x00,0x00},{0x00,0x0F,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x69 'i'
+    {{0x00,0x00,0x00,0x0F,0x00,0x00},{0x00,0x00,0x0F,0xFF,0x00,0x00},{0xF0,0x00,0x00,0xFF,0x00,0x00},{0x00,0x0F,0x0F,0x00,0x00,0x00}}, // 0x6A 'j'
+    {{0xFF,0x00,0x00,0x00,0x00,0x00},{0xFF,0x00,0xF0,0x0F,0x00,0x00},{0xFF,0x0F,0xF0,0x00,0x00,0x00},{0x0F,0x00,0x00,0x0F,0x00,0x00}}, // 0x6B 'k'
+    {{0x00,0x0F,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x6C 'l'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xFF,0x0F,0xF0,0x0F,0xF0,0x00},{0xFF,0x00,0x0F,0x00,0xFF,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x6D 'm'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xFF,0xF0,0x0F,0x0F,0xF0,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x6E 'n'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xF0,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x6F 'o'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xFF,0x0F,0x0F,0x0F,0xF0,0x00},{0xFF,0x0F,0x0F,0x0F,0x00,0x00},{0x0F,0x00,0x00,0x00,0x00,0x00}}, // 0x70 'p'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xF0,0x0F,0x0F,0xF0,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0xFF,0x00},{0x00,0x00,0x00,0x00,0x0F,0x00}}, // 0x71 'q'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xFF,0xF0,0x0F,0x0F,0xF0,0x00},{0xFF,0x00,0x00,0x00,0x00,0x00},{0x0F,0x00,0x00,0x00,0x00,0x00}}, // 0x72 'r'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xF0,0x0F,0x0F,0x0F,0x00,0x00},{0x00,0x0F,0x0F,0x0F,0xF0,0x00},{0x0F,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x73 's'
+    {{0x00,0xFF,0x00,0x00,0x00,0x00},{0x0F,0xFF,0x0F,0x00,0x00,0x00},{0x00,0xFF,0x00,0x00,0xF0,0x00},{0x00,0x00,0x0F,0x0F,0x00,0x00}}, // 0x74 't'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x00,0x00,0xF0,0xFF,0x00},{0x00,0x0F,0x0F,0x00,0x0F,0x00}}, // 0x75 'u'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x0F,0xF0,0x00,0xF0,0x0F,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00}}, // 0x76 'v'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0xFF,0x00,0xFF,0x00,0xFF,0x00},{0x00,0x0F,0x00,0x0F,0x00,0x00}}, // 0x77 'w'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x0F,0xF0,0x00,0xF0,0x0F,0x00},{0x00,0xF0,0x0F,0xF0,0x00,0x00},{0x0F,0x00,0x00,0x00,0x0F,0x00}}, // 0x78 'x'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0xFF,0x00,0x00,0x00,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0xFF,0x00},{0x00,0x0F,0x0F,0x0F,0x00,0x00}}, // 0x79 'y'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x0F,0x0F,0x0F,0xFF,0x0F,0x00},{0x00,0xF0,0x0F,0x00,0x00,0x00},{0x0F,0x0F,0x0F,0x0F,0x0F,0x00}}, // 0x7A 'z'
+    {{0x00,0x00,0xF0,0x0F,0x00,0x00},{0x00,0xF0,0x0F,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0x00,0x0F,0x00,0x00}}, // 0x7B '{'
+    {{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x00,0x0F,0x00,0x00,0x00}}, // 0x7C '|'
+    {{0x00,0x0F,0xF0,0x00,0x00,0x00},{0x00,0x00,0x0F,0xF0,0x00,0x00},{0x00,0x00,0xFF,0x00,0x00,0x00},{0x00,0x0F,0x00,0x00,0x00,0x00}}, // 0x7D '}'
+    {{0x00,0x00,0x00,0x00,0x00,0x00},{0x00,0xF0,0xF0,0x00,0xF0,0x00},{0x0F,0x00,0x00,0x0F,0x00,0x00},{0x00,0x00,0x00,0x00,0x00,0x00}}, // 0x7E '~'
+};
+
+#endif // FONT_SCALED_H
@@ -10,6 +10,8 @@
    Pilote pour l’écran OLED SSD1306 via I2C (format 128x64).
    Fournit des fonctions d’initialisation, d’affichage de texte, et de
    gestion d’un framebuffer pixel à pixel.
+   Chaque panneau (port I2C + adresse) a ses propres tampons ; les
+   fonctions sans poignée agissent sur le panneau par défaut.
 
    ==========================================================================
    History:
@@ -22,222 +24,582 @@
    Include header files
 -- -------------------------------------------------------------------------- */
 #include <string.h>
-#include <stdlib.h>
-#include "driver/i2c.h"
 #include "ssd1306.h"
-#include "font6x8.h"
+#include "ssd1306_i2c.h"
 
 /** -------------------------------------------------------------------------- --
    Macro definitions
 -- -------------------------------------------------------------------------- */
-#define OLED_ADDR     0x3C            /* Adresse I2C de l’OLED */
-#define I2C_PORT      I2C_NUM_0       /* Port I2C utilisé */
 #define OLED_WIDTH    128             /* Largeur en pixels */
 #define OLED_HEIGHT   64              /* Hauteur en pixels */
+#define OLED_PAGES    8               /* Pages de 8 lignes */
+#define OLED_FB_SIZE  (OLED_WIDTH * OLED_PAGES)
+
+/* Coût fixe d’une transaction de données, en octets sur le bus : adresse
+   I2C, fenêtre 0x21/0x22 (6 commandes précédées chacune de 0x80) et octet
+   de contrôle 0x40 */
+#define WINDOW_OVERHEAD (1 + 2 * 6 + 1)
+
+/* Deux plages modifiées séparées par moins de RUN_MERGE_GAP colonnes
+   identiques sont envoyées d’un seul bloc : ouvrir une nouvelle fenêtre
+   coûte plus cher que de renvoyer quelques octets inchangés. */
+#define RUN_MERGE_GAP WINDOW_OVERHEAD
+
+/* Une plage fait au moins 1 colonne et en est séparée de la suivante par au
+   moins RUN_MERGE_GAP colonnes inchangées */
+#define MAX_RUNS_PER_PAGE ((OLED_WIDTH + RUN_MERGE_GAP) / (RUN_MERGE_GAP + 1))
+
+/** -------------------------------------------------------------------------- --
+   Types
+-- -------------------------------------------------------------------------- */
+
+/* Fenêtre de GDDRAM : pages [p0, p1] x colonnes [x0, x1] */
+typedef struct {
+    uint8_t p0, p1, x0, x1;
+} window_t;
 
 /** -------------------------------------------------------------------------- --
-   Initialisation du port I2C
+   Panneau : tampons (128 x 64 / 8 = 1024 octets chacun) et envoi en cours
+   - fb          : image en cours de dessin (tampon arrière)
+   - front       : dernière image validée, en cours d’envoi (tampon avant)
+   - shadow      : image actuellement affichée par le panneau
+   - dirty       : bit n = page n du tampon arrière modifiée depuis le
+                   dernier ssd1306_dev_commit
+   - front_dirty : bit n = page n du tampon avant pas encore planifiée (ou
+                   à renvoyer après une erreur I2C)
+   - plan        : fenêtres de l’envoi en cours ; plan_page est la prochaine
+                   page à transmettre de la fenêtre plan[plan_next]
 -- -------------------------------------------------------------------------- */
-void ssd1306_setup_i2c(gpio_num_t sda, gpio_num_t scl)
+struct ssd1306 {
+    ssd1306_link_t link;
+    bool used;
+
+    uint8_t fb[OLED_FB_SIZE];
+    uint8_t front[OLED_FB_SIZE];
+    uint8_t shadow[OLED_FB_SIZE];
+    uint8_t dirty;
+    uint8_t front_dirty;
+
+    window_t plan[OLED_PAGES * MAX_RUNS_PER_PAGE];
+    uint8_t plan_len;
+    uint8_t plan_next;
+    uint8_t plan_page;
+
+    /* Trafic du dernier appel de haut niveau (voir ssd1306_dev_bus_last_call) */
+    ssd1306_bus_stats_t call_start;
+    ssd1306_bus_stats_t last_call;
+};
+
+/** -------------------------------------------------------------------------- --
+   Static variables
+-- -------------------------------------------------------------------------- */
+static ssd1306_t panels[SSD1306_MAX_PANELS];
+
+static void bus_call_begin(ssd1306_t* dev)
+{
+    dev->call_start = dev->link.stats;
+}
+
+static void bus_call_end(ssd1306_t* dev)
 {
-    i2c_config_t conf = {
-        .mode = I2C_MODE_MASTER,
-        .sda_io_num = sda,
-        .scl_io_num = scl,
-        .sda_pullup_en = GPIO_PULLUP_ENABLE,
-        .scl_pullup_en = GPIO_PULLUP_ENABLE,
-        .master.clk_speed = 400000,
-    };
-    i2c_param_config(I2C_NUM_0, &conf);
-    i2c_driver_install(I2C_NUM_0, conf.mode, 0, 0, 0);
+    dev->last_call.transactions = dev->link.stats.transactions - dev->call_start.transactions;
+    dev->last_call.bytes = dev->link.stats.bytes - dev->call_start.bytes;
 }
 
 /** -------------------------------------------------------------------------- --
-   Envoi d’une commande à l’écran
+   Ouverture d’un panneau : réutilise l’entrée existante pour le même
+   couple (port, adresse), sinon prend une entrée libre du tableau statique
 -- -------------------------------------------------------------------------- */
-static void send_command(uint8_t cmd)
+ssd1306_t* ssd1306_open(i2c_port_t port, uint8_t addr)
 {
-    uint8_t buffer[2] = {0x00, cmd};  // 0x00 = type commande
-    i2c_master_write_to_device(I2C_PORT, OLED_ADDR, buffer, 2, 1000 / portTICK_PERIOD_MS);
+    ssd1306_t* free_slot = NULL;
+    for (int i = 0; i < SSD1306_MAX_PANELS; i++) {
+        ssd1306_t* dev = &panels[i];
+        if (dev->used && dev->link.port == port && dev->link.addr == addr) {
+            return dev;
+        }
+        if (!dev->used && !free_slot) {
+            free_slot = dev;
+        }
+    }
+    if (!free_slot) return NULL;
+
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->link.port = port;
+    free_slot->link.addr = addr;
+    free_slot->used = true;
+    return free_slot;
 }
 
 /** -------------------------------------------------------------------------- --
-   Envoi de données (ex: lignes entières, caractères)
+   Panneau par défaut (port 0, adresse 0x3C) des fonctions sans poignée
 -- -------------------------------------------------------------------------- */
-static void send_data(uint8_t* data, size_t len)
+ssd1306_t* ssd1306_default(void)
 {
-    uint8_t* buffer = malloc(len + 1);
-    buffer[0] = 0x40; // 0x40 = type data
-    memcpy(buffer + 1, data, len);
-    i2c_master_write_to_device(I2C_PORT, OLED_ADDR, buffer, len + 1, 1000 / portTICK_PERIOD_MS);
-    free(buffer);
+    static ssd1306_t* dev = NULL;
+    if (!dev) {
+        dev = ssd1306_open(I2C_NUM_0, SSD1306_ADDR_PRIMARY);
+    }
+    return dev;
 }
 
 /** -------------------------------------------------------------------------- --
    Initialisation complète du SSD1306
 -- -------------------------------------------------------------------------- */
-void ssd1306_init(void)
+static const uint8_t init_sequence[] = {
+    0xAE,       // Display off
+    0x20, 0x00, // Set Memory Addressing Mode : horizontal, les écritures
+                // passent par des fenêtres 0x21/0x22 (B0-B7 ignorés)
+    0x21, 0x00, 0x7F, // Column address window : 0-127
+    0x22, 0x00, 0x07, // Page address window : 0-7
+    0xC8,       // COM Output Scan Direction
+    0x40,       // Start line address
+    0x81, 0x7F, // Contrast control
+    0xA1,       // Segment re-map
+    0xA6,       // Normal display
+    0xA8, 0x3F, // Multiplex ratio
+    0xA4,       // Entire display on, resume to RAM content
+    0xD3, 0x00, // Display offset
+    0xD5, 0xF0, // Display clock divide
+    0xD9, 0x22, // Pre-charge period
+    0xDA, 0x12, // COM pins hardware config
+    0xDB, 0x20, // VCOMH deselect level
+    0x8D, 0x14, // Enable charge pump
+    0xAF,       // Display on
+};
+
+/** -------------------------------------------------------------------------- --
+   Écrit en GDDRAM les rows premières pages de la fenêtre pages [p0, p1] x
+   colonnes [x0, x1] : la fenêtre 0x21/0x22 et les données partent dans la
+   même transaction, le contrôleur passant seul à la page suivante en fin
+   de ligne. src pointe sur (p0, x0) dans un tampon de stride octets par page.
+-- -------------------------------------------------------------------------- */
+static esp_err_t write_window(ssd1306_t* dev, const window_t* w, size_t rows,
+                              const uint8_t* src, size_t stride)
+{
+    const uint8_t cmds[] = { 0x21, w->x0, w->x1, 0x22, w->p0, w->p1 };
+    return ssd1306_i2c_write_data(&dev->link, cmds, sizeof(cmds), src,
+                                  w->x1 - w->x0 + 1, rows, stride);
+}
+
+void ssd1306_dev_init(ssd1306_t* dev)
 {
-    send_command(0xAE); // Display off
-    send_command(0x20); send_command(0x10); // Set Memory Addressing Mode
-    send_command(0xB0); // Set page start address
-    send_command(0xC8); // COM Output Scan Direction
-    send_command(0x00); send_command(0x10); // Set low/high column address
-    send_command(0x40); // Start line address
-    send_command(0x81); send_command(0x7F); // Contrast control
-    send_command(0xA1); // Segment re-map
-    send_command(0xA6); // Normal display
-    send_command(0xA8); send_command(0x3F); // Multiplex ratio
-    send_command(0xA4); // Entire display on, resume to RAM content
-    send_command(0xD3); send_command(0x00); // Display offset
-    send_command(0xD5); send_command(0xF0); // Display clock divide
-    send_command(0xD9); send_command(0x22); // Pre-charge period
-    send_command(0xDA); send_command(0x12); // COM pins hardware config
-    send_command(0xDB); send_command(0x20); // VCOMH deselect level
-    send_command(0x8D); send_command(0x14); // Enable charge pump
-    send_command(0xAF); // Display on
-}
-
-/** -------------------------------------------------------------------------- --
-   Efface entièrement l’écran
--- -------------------------------------------------------------------------- */
-void ssd1306_clear(void)
-{
-    uint8_t blank[OLED_WIDTH] = {0};
-    for (uint8_t page = 0; page < 8; page++) {
-        send_command(0xB0 + page);
-        send_command(0x00);
-        send_command(0x10);
-        send_data(blank, OLED_WIDTH);
+    bus_call_begin(dev);
+    ssd1306_i2c_write_cmds(&dev->link, init_sequence, sizeof(init_sequence));
+    bus_call_end(dev);
+    ssd1306_dev_clear(dev);     // GDDRAM aléatoire à la mise sous tension
+}
+
+/** -------------------------------------------------------------------------- --
+   Efface entièrement l’écran (GDDRAM, framebuffer et copie d’ombre).
+   Abandonne l’envoi éventuellement en cours.
+-- -------------------------------------------------------------------------- */
+void ssd1306_dev_clear(ssd1306_t* dev)
+{
+    static const uint8_t blank[OLED_WIDTH] = {0};
+    static const window_t screen = { 0, OLED_PAGES - 1, 0, OLED_WIDTH - 1 };
+    bus_call_begin(dev);
+    write_window(dev, &screen, OLED_PAGES, blank, 0);
+    bus_call_end(dev);
+    memset(dev->fb, 0, sizeof(dev->fb));
+    memset(dev->front, 0, sizeof(dev->front));
+    memset(dev->shadow, 0, sizeof(dev->shadow));
+    dev->dirty = 0;
+    dev->front_dirty = 0;
+    dev->plan_len = 0;
+    dev->plan_next = 0;
+}
+
+/** -------------------------------------------------------------------------- --
+   Réglage de la luminosité (contraste)
+-- -------------------------------------------------------------------------- */
+void ssd1306_dev_contrast(ssd1306_t* dev, uint8_t contrast)
+{
+    const uint8_t cmds[] = {0x81, contrast};
+    bus_call_begin(dev);
+    ssd1306_i2c_write_cmds(&dev->link, cmds, sizeof(cmds));
+    bus_call_end(dev);
+}
+
+/** -------------------------------------------------------------------------- --
+   Mise en veille : écran éteint et pompe de charge arrêtée (la GDDRAM est
+   conservée, l’image réapparaît telle quelle au réveil)
+-- -------------------------------------------------------------------------- */
+void ssd1306_dev_power(ssd1306_t* dev, bool on)
+{
+    const uint8_t sleep_cmds[] = {0xAE, 0x8D, 0x10};
+    const uint8_t wake_cmds[] = {0x8D, 0x14, 0xAF};
+    bus_call_begin(dev);
+    if (on) {
+        ssd1306_i2c_write_cmds(&dev->link, wake_cmds, sizeof(wake_cmds));
+    } else {
+        ssd1306_i2c_write_cmds(&dev->link, sleep_cmds, sizeof(sleep_cmds));
     }
+    bus_call_end(dev);
 }
 
 /** -------------------------------------------------------------------------- --
-   Affiche une chaîne de caractères ASCII 6x8 sur une page donnée
+   Dessin dans le tampon arrière d’un panneau (aucun accès I2C)
 -- -------------------------------------------------------------------------- */
-void ssd1306_draw_string(uint8_t x, uint8_t page, const char* str, uint8_t scale, bool color)
+void ssd1306_dev_clear_screen(ssd1306_t* dev)
 {
-    while (*str) {
-        if (*str < 32 || *str > 126) {
-            str++;
-            continue;
-        }
+    memset(dev->fb, 0, sizeof(dev->fb));
+    dev->dirty = 0xFF;
+}
 
-        const uint8_t* chr = font6x8[*str - 32];
+void ssd1306_dev_clear_line(ssd1306_t* dev, uint8_t page)
+{
+    if (page >= OLED_PAGES) return;
+    memset(&dev->fb[page * OLED_WIDTH], 0, OLED_WIDTH);
+    dev->dirty |= (uint8_t)(1u << page);
+}
 
-        send_command(0xB0 + page);
-        send_command(0x00 + (x & 0x0F));
-        send_command(0x10 + ((x >> 4) & 0x0F));
+void ssd1306_dev_draw_string(ssd1306_t* dev, uint8_t x, uint8_t page, const char* str,
+                             uint8_t scale, bool color)
+{
+    dev->dirty |= ssd1306_gfx_draw_string(dev->fb, x, page, str, scale, !color);
+}
 
-        send_data((uint8_t*)chr, 6);
+void ssd1306_dev_draw_big_digits(ssd1306_t* dev, uint8_t x, uint8_t page, const char* str)
+{
+    dev->dirty |= ssd1306_gfx_draw_big_digits(dev->fb, x, page, str);
+}
 
-        x += 6;
-        str++;
-    }
+void ssd1306_dev_draw_pixel(ssd1306_t* dev, int x, int y, bool color)
+{
+    if (x < 0 || x >= 128 || y < 0 || y >= 64) return;
+    uint16_t byte_idx = x + (y/8)*128;
+    uint8_t bit = 1 << (y % 8);
+    if (color)
+        dev->fb[byte_idx] |= bit;
+    else
+        dev->fb[byte_idx] &= ~bit;
+    dev->dirty |= (uint8_t)(1u << (y / 8));
+}
+
+void ssd1306_dev_fill_rect(ssd1306_t* dev, int x, int y, int w, int h, ssd1306_mode_t mode)
+{
+    dev->dirty |= ssd1306_gfx_fill_rect(dev->fb, x, y, w, h, mode);
+}
+
+void ssd1306_dev_draw_frame(ssd1306_t* dev, int x, int y, int w, int h, ssd1306_mode_t mode)
+{
+    dev->dirty |= ssd1306_gfx_draw_frame(dev->fb, x, y, w, h, mode);
+}
+
+void ssd1306_dev_draw_bitmap(ssd1306_t* dev, int x, int y, int w, int h, const uint8_t* data)
+{
+    dev->dirty |= ssd1306_gfx_blit_rows(dev->fb, x, y, w, h, data, SSD1306_MODE_COPY);
+}
+
+void ssd1306_dev_draw_bitmap_pages(ssd1306_t* dev, int x, int y, int w, int h,
+                                   const uint8_t* data, ssd1306_mode_t mode)
+{
+    dev->dirty |= ssd1306_gfx_blit(dev->fb, x, y, w, h, data, mode);
 }
 
 /** -------------------------------------------------------------------------- --
-   Stub pour compatibilité (non utilisé ici)
+   Valide l’image dessinée : recopie les pages modifiées du tampon arrière
+   dans le tampon avant (aucun accès I2C). Refusé tant que l’envoi
+   précédent lit encore le tampon avant.
 -- -------------------------------------------------------------------------- */
-void ssd1306_refresh(void) { }
+bool ssd1306_dev_commit(ssd1306_t* dev)
+{
+    if (ssd1306_dev_busy(dev)) return false;
+
+    uint8_t dirty = dev->dirty;
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+        if (dirty & (1u << page)) {
+            memcpy(&dev->front[page * OLED_WIDTH], &dev->fb[page * OLED_WIDTH], OLED_WIDTH);
+        }
+    }
+    dev->dirty = 0;
+    dev->front_dirty |= dirty;
+    return dirty != 0;
+}
+
+bool ssd1306_dev_busy(const ssd1306_t* dev)
+{
+    return dev->plan_next < dev->plan_len;
+}
 
 /** -------------------------------------------------------------------------- --
-   Alias pour initialiser rapidement l’écran
+   Planification de l’envoi du tampon avant
+
+   Chaque page modifiée est comparée à la copie d’ombre : seules les plages
+   de colonnes qui diffèrent réellement sont retenues, chacune dans sa
+   fenêtre, ou toutes ensemble dans la fenêtre qui les englobe quand une
+   seule rafale revient moins cher (grands changements, redessin complet en
+   une transaction d’environ 1 Ko). Les colonnes inchangées renvoyées par
+   une rafale sont identiques à l’ombre.
 -- -------------------------------------------------------------------------- */
-void ssd1306_128x64_i2c_init(void) {
-    ssd1306_init();
+static void plan_build(ssd1306_t* dev)
+{
+    int n_runs = 0;
+    int runs_cost = 0;
+    int x0 = OLED_WIDTH, x1 = -1, p0 = OLED_PAGES, p1 = -1;
+
+    for (uint8_t page = 0; page < OLED_PAGES; page++) {
+        if (!(dev->front_dirty & (1u << page))) continue;
+
+        const uint8_t* src = &dev->front[page * OLED_WIDTH];
+        const uint8_t* shadow = &dev->shadow[page * OLED_WIDTH];
+        int x = 0;
+        while (x < OLED_WIDTH) {
+            while (x < OLED_WIDTH && src[x] == shadow[x]) x++;
+            if (x == OLED_WIDTH) break;
+
+            int start = x;
+            int end = x;        // Dernière colonne modifiée de la plage
+            int gap = 0;
+            for (x = start + 1; x < OLED_WIDTH && gap < RUN_MERGE_GAP; x++) {
+                if (src[x] != shadow[x]) {
+                    end = x;
+                    gap = 0;
+                } else {
+                    gap++;
+                }
+            }
+
+            dev->plan[n_runs++] = (window_t){ page, page, (uint8_t)start, (uint8_t)end };
+            runs_cost += end - start + 1 + WINDOW_OVERHEAD;
+            if (start < x0) x0 = start;
+            if (end > x1) x1 = end;
+            if (page < p0) p0 = page;
+            p1 = page;
+            x = end + 1;
+        }
+    }
+    dev->front_dirty = 0;
+
+    int window_cost = (x1 - x0 + 1) * (p1 - p0 + 1) + WINDOW_OVERHEAD;
+    if (n_runs > 1 && window_cost <= runs_cost) {
+        dev->plan[0] = (window_t){ (uint8_t)p0, (uint8_t)p1, (uint8_t)x0, (uint8_t)x1 };
+        n_runs = 1;
+    }
+    dev->plan_len = (uint8_t)n_runs;
+    dev->plan_next = 0;
+    dev->plan_page = n_runs ? dev->plan[0].p0 : 0;
 }
 
 /** -------------------------------------------------------------------------- --
-   Efface tout l’écran (alias)
+   Envoi d’une tranche : au plus max_bytes octets (arrondis à des pages
+   entières de la fenêtre, une au minimum) de la fenêtre courante.
+   La première tranche ouvre la fenêtre ; les suivantes prolongent
+   l’écriture sans la réadresser, le pointeur du contrôleur étant propre à
+   chaque panneau. Une tranche refusée par le bus laisse la copie d’ombre
+   intacte : le reste de la fenêtre (pointeur du contrôleur incertain) est
+   abandonné et ses pages repassent dans front_dirty, renvoyées à l’envoi
+   suivant.
 -- -------------------------------------------------------------------------- */
-void ssd1306_clear_screen(void) {
-    ssd1306_clear();
+bool ssd1306_dev_send_step(ssd1306_t* dev, size_t max_bytes)
+{
+    if (!ssd1306_dev_busy(dev)) {
+        bus_call_begin(dev);
+        plan_build(dev);
+        if (!ssd1306_dev_busy(dev)) {
+            bus_call_end(dev);
+            return false;
+        }
+    }
+
+    const window_t* w = &dev->plan[dev->plan_next];
+    size_t width = w->x1 - w->x0 + 1;
+    size_t rows = w->p1 - dev->plan_page + 1;
+    size_t max_rows = max_bytes / width;
+    if (max_rows == 0) max_rows = 1;
+    if (rows > max_rows) rows = max_rows;
+
+    size_t offset = dev->plan_page * OLED_WIDTH + w->x0;
+    esp_err_t err;
+    if (dev->plan_page == w->p0) {
+        err = write_window(dev, w, rows, &dev->front[offset], OLED_WIDTH);
+    } else {
+        err = ssd1306_i2c_write_data(&dev->link, NULL, 0, &dev->front[offset], width, rows, OLED_WIDTH);
+    }
+    if (err == ESP_OK) {
+        for (size_t r = 0; r < rows; r++) {
+            memcpy(&dev->shadow[offset + r * OLED_WIDTH], &dev->front[offset + r * OLED_WIDTH], width);
+        }
+    } else {
+        rows = w->p1 - dev->plan_page + 1;
+        for (uint8_t page = dev->plan_page; page <= w->p1; page++) {
+            dev->front_dirty |= 1u << page;
+        }
+    }
+
+    dev->plan_page += rows;
+    if (dev->plan_page > w->p1 && ++dev->plan_next < dev->plan_len) {
+        dev->plan_page = dev->plan[dev->plan_next].p0;
+    }
+
+    if (ssd1306_dev_busy(dev)) return true;
+    bus_call_end(dev);
+    return false;
 }
 
 /** -------------------------------------------------------------------------- --
-   Efface une seule ligne (page de 8 pixels)
+   Transfert complet du tampon avant, dans le contexte de l’appelant.
+   Le tampon arrière n’est pas lu : on peut continuer à dessiner pendant
+   l’envoi.
 -- -------------------------------------------------------------------------- */
-void ssd1306_clear_line(uint8_t page) {
-    uint8_t blank[128] = {0};
-    send_command(0xB0 + page);
-    send_command(0x00);
-    send_command(0x10);
-    send_data(blank, 128);
+void ssd1306_dev_send(ssd1306_t* dev)
+{
+    while (ssd1306_dev_send_step(dev, SSD1306_I2C_MAX_DATA)) {
+    }
+}
+
+void ssd1306_dev_flush(ssd1306_t* dev)
+{
+    ssd1306_dev_commit(dev);
+    ssd1306_dev_send(dev);
 }
 
 /** -------------------------------------------------------------------------- --
-   Réglage de la luminosité (contraste)
+   Ordonnanceur d’envoi : une tranche par panneau en attente et par tour.
+   Seul, un panneau envoie ses fenêtres entières ; à plusieurs, les rafales
+   sont découpées en tranches de SSD1306_SLICE_BYTES pour qu’un redessin
+   complet d’un panneau ne retarde pas la mise à jour d’un autre de plus
+   d’une tranche.
 -- -------------------------------------------------------------------------- */
-void ssd1306_contrast(uint8_t contrast) {
-    send_command(0x81);
-    send_command(contrast);
+bool ssd1306_send_round(ssd1306_t* const* devs, size_t count)
+{
+    size_t waiting = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (ssd1306_dev_busy(devs[i]) || devs[i]->front_dirty) waiting++;
+    }
+    size_t budget = (waiting > 1) ? SSD1306_SLICE_BYTES : SSD1306_I2C_MAX_DATA;
+
+    bool pending = false;
+    for (size_t i = 0; i < count; i++) {
+        pending |= ssd1306_dev_send_step(devs[i], budget);
+    }
+    return pending;
 }
 
 /** -------------------------------------------------------------------------- --
-   Affiche une ligne de texte (texte brut uniquement)
+   Diagnostic : trafic du dernier appel et image affichée
 -- -------------------------------------------------------------------------- */
-void ssd1306_display_text(uint8_t page, const char *text, uint8_t text_len, bool invert) {
-    // Ignore l’inversion pour l’instant
-    ssd1306_draw_string(0, page, text, 1, false);
+void ssd1306_dev_bus_last_call(const ssd1306_t* dev, uint32_t* transactions, uint32_t* bytes)
+{
+    if (transactions) *transactions = dev->last_call.transactions;
+    if (bytes) *bytes = dev->last_call.bytes;
+}
+
+const uint8_t* ssd1306_dev_displayed(const ssd1306_t* dev)
+{
+    return dev->shadow;
 }
 
+/**========================================================================== --
+   API historique : panneau unique (port 0, adresse 0x3C)
+-- ========================================================================== */
+
 /** -------------------------------------------------------------------------- --
-   FRAMEBUFFER : buffer mémoire (128 x 64 / 8 = 1024 octets)
+   Initialisation du contrôleur seul, sans effacement
 -- -------------------------------------------------------------------------- */
-static uint8_t ssd1306_fb[128 * 8] = {0};
+void ssd1306_init(void)
+{
+    ssd1306_t* dev = ssd1306_default();
+    bus_call_begin(dev);
+    ssd1306_i2c_write_cmds(&dev->link, init_sequence, sizeof(init_sequence));
+    bus_call_end(dev);
+}
 
 /** -------------------------------------------------------------------------- --
-   Efface le framebuffer
+   Alias pour initialiser rapidement l’écran
 -- -------------------------------------------------------------------------- */
-void ssd1306_fb_clear(void) {
-    memset(ssd1306_fb, 0, sizeof(ssd1306_fb));
+void ssd1306_128x64_i2c_init(void) {
+    ssd1306_dev_init(ssd1306_default());
+}
+
+void ssd1306_clear(void) {
+    ssd1306_dev_clear(ssd1306_default());
+}
+
+void ssd1306_clear_screen(void) {
+    ssd1306_dev_clear_screen(ssd1306_default());
+}
+
+void ssd1306_clear_line(uint8_t page) {
+    ssd1306_dev_clear_line(ssd1306_default(), page);
+}
+
+void ssd1306_contrast(uint8_t contrast) {
+    ssd1306_dev_contrast(ssd1306_default(), contrast);
+}
+
+void ssd1306_power(bool on) {
+    ssd1306_dev_power(ssd1306_default(), on);
 }
 
 /** -------------------------------------------------------------------------- --
-   Dessine un pixel dans le framebuffer
+   Affiche une ligne de texte (texte brut uniquement)
 -- -------------------------------------------------------------------------- */
+void ssd1306_display_text(uint8_t page, const char *text, uint8_t text_len, bool invert) {
+    ssd1306_t* dev = ssd1306_default();
+    dev->dirty |= ssd1306_gfx_draw_string(dev->fb, 0, page, text, 1, invert);
+}
+
+void ssd1306_draw_string(uint8_t x, uint8_t page, const char* str, uint8_t scale, bool color) {
+    ssd1306_dev_draw_string(ssd1306_default(), x, page, str, scale, color);
+}
+
+void ssd1306_draw_big_digits(uint8_t x, uint8_t page, const char* str) {
+    ssd1306_dev_draw_big_digits(ssd1306_default(), x, page, str);
+}
+
+void ssd1306_refresh(void) {
+    ssd1306_dev_flush(ssd1306_default());
+}
+
+void ssd1306_fb_clear(void) {
+    ssd1306_dev_clear_screen(ssd1306_default());
+}
+
 void ssd1306_draw_pixel(int x, int y, bool color) {
-    if (x < 0 || x >= 128 || y < 0 || y >= 64) return;
-    uint16_t byte_idx = x + (y/8)*128;
-    uint8_t bit = 1 << (y % 8);
-    if (color)
-        ssd1306_fb[byte_idx] |= bit;
-    else
-        ssd1306_fb[byte_idx] &= ~bit;
+    ssd1306_dev_draw_pixel(ssd1306_default(), x, y, color);
 }
 
 /** -------------------------------------------------------------------------- --
    Dessine un rectangle rempli (framebuffer uniquement)
 -- -------------------------------------------------------------------------- */
 void ssd1306_draw_rect(int x, int y, int w, int h, bool color) {
-    for (int dx = 0; dx < w; dx++)
-        for (int dy = 0; dy < h; dy++)
-            ssd1306_draw_pixel(x+dx, y+dy, color);
+    ssd1306_fill_rect(x, y, w, h, color ? SSD1306_MODE_SET : SSD1306_MODE_CLEAR);
+}
+
+void ssd1306_fill_rect(int x, int y, int w, int h, ssd1306_mode_t mode) {
+    ssd1306_dev_fill_rect(ssd1306_default(), x, y, w, h, mode);
+}
+
+void ssd1306_draw_frame(int x, int y, int w, int h, ssd1306_mode_t mode) {
+    ssd1306_dev_draw_frame(ssd1306_default(), x, y, w, h, mode);
 }
 
-/** -------------------------------------------------------------------------- --
-   Affiche une image bitmap monochrome 1bpp dans le framebuffer
--- -------------------------------------------------------------------------- */
 void ssd1306_draw_bitmap(int x, int y, int w, int h, const uint8_t* data) {
-    for (int j = 0; j < h; j++) {
-        for (int i = 0; i < w; i++) {
-            int byte = (j * w + i) / 8;
-            int bit = 7 - ((j * w + i) % 8);
-            bool pixel = (data[byte] >> bit) & 1;
-            ssd1306_draw_pixel(x + i, y + j, pixel);
-        }
-    }
+    ssd1306_dev_draw_bitmap(ssd1306_default(), x, y, w, h, data);
+}
+
+void ssd1306_draw_bitmap_pages(int x, int y, int w, int h, const uint8_t* data, ssd1306_mode_t mode) {
+    ssd1306_dev_draw_bitmap_pages(ssd1306_default(), x, y, w, h, data, mode);
 }
 
-/** -------------------------------------------------------------------------- --
-   Transfert du framebuffer complet à l’écran
--- -------------------------------------------------------------------------- */
 void ssd1306_fb_flush(void) {
-    for (uint8_t page = 0; page < 8; page++) {
-        send_command(0xB0 + page);
-        send_command(0x00);
-        send_command(0x10);
-        send_data(&ssd1306_fb[page * 128], 128);
-    }
+    ssd1306_dev_flush(ssd1306_default());
+}
+
+bool ssd1306_fb_commit(void) {
+    return ssd1306_dev_commit(ssd1306_default());
+}
+
+void ssd1306_fb_send(void) {
+    ssd1306_dev_send(ssd1306_default());
+}
+
+void ssd1306_bus_last_call(uint32_t* transactions, uint32_t* bytes) {
+    ssd1306_dev_bus_last_call(ssd1306_default(), transactions, bytes);
+}
+
+const uint8_t* ssd1306_fb_displayed(void) {
+    return ssd1306_dev_displayed(ssd1306_default());
 }
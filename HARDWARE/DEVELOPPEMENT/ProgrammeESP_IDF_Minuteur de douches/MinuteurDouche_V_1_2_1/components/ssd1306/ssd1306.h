@@ -11,6 +11,18 @@
    Déclare les fonctions de configuration, d’affichage de texte,
    de dessin pixel à pixel, et de gestion d’un framebuffer.
 
+   Toutes les fonctions de dessin et d’effacement écrivent uniquement dans
+   le framebuffer (tampon arrière). Le panneau n’est mis à jour que par
+   ssd1306_refresh() (ou ssd1306_fb_flush()), qui n’envoie que ce qui a
+   changé. Pour envoyer depuis une autre tâche, l’image est d’abord validée
+   par ssd1306_fb_commit() (copie mémoire) puis transmise par
+   ssd1306_fb_send(), pendant que le dessin suivant peut commencer.
+
+   Plusieurs panneaux (deux adresses 0x3C / 0x3D, un ou deux ports I2C)
+   sont pilotés par poignée ssd1306_t*, chacun avec ses propres tampons.
+   ssd1306_send_round() entrelace leurs envois. Les fonctions sans poignée
+   agissent sur le panneau par défaut (port 0, adresse 0x3C).
+
    ==========================================================================
    History:
    --------------------------------------------------------------------------
@@ -22,25 +34,169 @@
 #define SSD1306_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include "driver/i2c.h"
 #include "driver/gpio.h"
+#include "ssd1306_gfx.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Nombre maximal de panneaux ouverts (tampons réservés statiquement) */
+#ifndef SSD1306_MAX_PANELS
+#define SSD1306_MAX_PANELS      2
+#endif
+
+#define SSD1306_ADDR_PRIMARY    0x3C    /* Broche SA0 à la masse */
+#define SSD1306_ADDR_SECONDARY  0x3D    /* Broche SA0 au +3V3 */
+
+/* Tranche d’envoi quand plusieurs panneaux attendent (deux pages pleines,
+   environ 6 ms à 400 kHz) */
+#define SSD1306_SLICE_BYTES     256
+
+/**
+ * @brief Panneau SSD1306 (poignée opaque)
+ */
+typedef struct ssd1306 ssd1306_t;
+
 /* -------------------------------------------------------------------------- */
 /*                      Fonctions de configuration / init                     */
 /* -------------------------------------------------------------------------- */
 
 /**
- * @brief Initialise le port I2C avec les broches spécifiées
+ * @brief Initialise un port I2C maître à 400 kHz
+ * @param port I2C_NUM_0 ou I2C_NUM_1
+ * @param sda Broche SDA
+ * @param scl Broche SCL
+ */
+void ssd1306_setup_i2c_port(i2c_port_t port, gpio_num_t sda, gpio_num_t scl);
+
+/**
+ * @brief Initialise le port I2C 0 avec les broches spécifiées
  * @param sda Broche SDA
  * @param scl Broche SCL
  */
 void ssd1306_setup_i2c(gpio_num_t sda, gpio_num_t scl);
 
+/* -------------------------------------------------------------------------- */
+/*                           Panneaux (API par poignée)                       */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Réserve les tampons d’un panneau (aucun accès I2C)
+ * @param port Port I2C, déjà configuré par ssd1306_setup_i2c_port()
+ * @param addr Adresse du panneau (SSD1306_ADDR_PRIMARY / SECONDARY)
+ * @return Poignée (la même pour un couple port / adresse déjà ouvert), ou
+ *         NULL si SSD1306_MAX_PANELS panneaux sont déjà ouverts
+ */
+ssd1306_t* ssd1306_open(i2c_port_t port, uint8_t addr);
+
+/**
+ * @brief Panneau utilisé par les fonctions sans poignée (port 0, 0x3C)
+ */
+ssd1306_t* ssd1306_default(void);
+
+/**
+ * @brief Initialise le contrôleur (adressage horizontal) et efface la GDDRAM
+ */
+void ssd1306_dev_init(ssd1306_t* dev);
+
+/**
+ * @brief Efface immédiatement la GDDRAM, les tampons et la copie d’ombre
+ *        (une rafale I2C, abandonne l’envoi en cours)
+ */
+void ssd1306_dev_clear(ssd1306_t* dev);
+
+/**
+ * @brief Régle le contraste (0x00 à 0xFF)
+ */
+void ssd1306_dev_contrast(ssd1306_t* dev, uint8_t contrast);
+
+/**
+ * @brief Allume ou met en veille le panneau (0xAF / 0xAE et pompe de
+ *        charge) ; la GDDRAM est conservée pendant la veille
+ */
+void ssd1306_dev_power(ssd1306_t* dev, bool on);
+
+/**
+ * @brief Dessin dans le tampon arrière du panneau : mêmes paramètres que
+ *        les fonctions sans poignée correspondantes (ssd1306_clear_screen,
+ *        ssd1306_clear_line, ssd1306_draw_string...)
+ */
+void ssd1306_dev_clear_screen(ssd1306_t* dev);
+void ssd1306_dev_clear_line(ssd1306_t* dev, uint8_t page);
+void ssd1306_dev_draw_string(ssd1306_t* dev, uint8_t x, uint8_t page, const char* str,
+                             uint8_t scale, bool color);
+void ssd1306_dev_draw_big_digits(ssd1306_t* dev, uint8_t x, uint8_t page, const char* str);
+void ssd1306_dev_draw_pixel(ssd1306_t* dev, int x, int y, bool color);
+void ssd1306_dev_fill_rect(ssd1306_t* dev, int x, int y, int w, int h, ssd1306_mode_t mode);
+void ssd1306_dev_draw_frame(ssd1306_t* dev, int x, int y, int w, int h, ssd1306_mode_t mode);
+void ssd1306_dev_draw_bitmap(ssd1306_t* dev, int x, int y, int w, int h, const uint8_t* data);
+void ssd1306_dev_draw_bitmap_pages(ssd1306_t* dev, int x, int y, int w, int h,
+                                   const uint8_t* data, ssd1306_mode_t mode);
+
+/**
+ * @brief Recopie les pages modifiées du tampon arrière dans le tampon avant
+ * @return true si une nouvelle image est à envoyer ; false si rien n’a
+ *         changé ou si l’envoi précédent est en cours (le dessin est alors
+ *         conservé pour le prochain appel)
+ */
+bool ssd1306_dev_commit(ssd1306_t* dev);
+
+/**
+ * @brief true tant qu’une image validée n’est pas entièrement envoyée
+ */
+bool ssd1306_dev_busy(const ssd1306_t* dev);
+
+/**
+ * @brief Envoie la prochaine tranche de l’image validée
+ * @param max_bytes Octets de données au plus (arrondis à des pages
+ *                  entières de la fenêtre courante, une au minimum)
+ * @return true s’il reste des données à envoyer
+ */
+bool ssd1306_dev_send_step(ssd1306_t* dev, size_t max_bytes);
+
+/**
+ * @brief Envoie toute l’image validée (ssd1306_dev_send_step jusqu’au bout)
+ */
+void ssd1306_dev_send(ssd1306_t* dev);
+
+/**
+ * @brief ssd1306_dev_commit() puis ssd1306_dev_send()
+ */
+void ssd1306_dev_flush(ssd1306_t* dev);
+
+/**
+ * @brief Un tour d’envoi entrelacé : une tranche par panneau en attente,
+ *        de SSD1306_SLICE_BYTES si plusieurs panneaux attendent
+ * @param devs Panneaux à servir
+ * @param count Nombre de panneaux
+ * @return true si au moins un panneau a encore des données à envoyer
+ * @note Les panneaux dont l’image vient d’être validée sont servis dès ce
+ *       tour, même si un autre est au milieu d’un redessin complet
+ */
+bool ssd1306_send_round(ssd1306_t* const* devs, size_t count);
+
+/**
+ * @brief Trafic du dernier appel (init, clear, contrast, power) ou de la dernière
+ *        image entièrement envoyée
+ * @param transactions Nombre de transactions I2C (peut être NULL)
+ * @param bytes Nombre d’octets émis, hors adresse (peut être NULL)
+ */
+void ssd1306_dev_bus_last_call(const ssd1306_t* dev, uint32_t* transactions, uint32_t* bytes);
+
+/**
+ * @brief Image que le pilote considère affichée par le panneau
+ *        (1024 octets, format page)
+ */
+const uint8_t* ssd1306_dev_displayed(const ssd1306_t* dev);
+
+/* -------------------------------------------------------------------------- */
+/*                     Panneau par défaut : initialisation                    */
+/* -------------------------------------------------------------------------- */
+
 /**
  * @brief Initialise l’écran OLED SSD1306 (128x64) via I2C
  */
@@ -51,12 +207,18 @@ void ssd1306_128x64_i2c_init(void);
 /* -------------------------------------------------------------------------- */
 
 /**
- * @brief Efface complètement l’écran
+ * @brief Efface immédiatement la GDDRAM du panneau, le framebuffer et la
+ *        copie d’ombre (accès I2C direct)
+ */
+void ssd1306_clear(void);
+
+/**
+ * @brief Efface complètement l’écran (framebuffer)
  */
 void ssd1306_clear_screen(void);
 
 /**
- * @brief Efface une ligne (page) de l’écran (8 pixels de haut)
+ * @brief Efface une ligne (page) de l’écran (8 pixels de haut, framebuffer)
  * @param page Numéro de la ligne (0 à 7)
  */
 void ssd1306_clear_line(uint8_t page);
@@ -67,6 +229,12 @@ void ssd1306_clear_line(uint8_t page);
  */
 void ssd1306_contrast(uint8_t contrast);
 
+/**
+ * @brief Allume ou met en veille l’écran
+ * @param on false : écran éteint, image conservée
+ */
+void ssd1306_power(bool on);
+
 /* -------------------------------------------------------------------------- */
 /*                           Fonctions d'affichage                            */
 /* -------------------------------------------------------------------------- */
@@ -76,10 +244,35 @@ void ssd1306_contrast(uint8_t contrast);
  * @param page Ligne (0 à 7)
  * @param text Pointeur vers la chaîne à afficher
  * @param text_len Longueur maximale (non utilisée ici)
- * @param invert Inverser les pixels (non supporté pour le moment)
+ * @param invert Inverser les pixels (texte noir sur fond blanc)
  */
 void ssd1306_display_text(uint8_t page, const char *text, uint8_t text_len, bool invert);
 
+/**
+ * @brief Écrit une chaîne ASCII 6x8 à partir de la colonne x
+ * @param x Colonne de départ (0 à 127)
+ * @param page Ligne du haut (0 à 7)
+ * @param str Chaîne à afficher
+ * @param scale Facteur d’agrandissement 1 à 4 : le texte occupe scale
+ *              lignes et 6 * scale colonnes par caractère
+ * @param color true = texte blanc, false = texte noir sur fond blanc
+ */
+void ssd1306_draw_string(uint8_t x, uint8_t page, const char* str, uint8_t scale, bool color);
+
+/**
+ * @brief Écrit une chaîne en grands chiffres 7 segments (4 lignes de haut)
+ * @param x Colonne de départ
+ * @param page Ligne du haut (0 à 4)
+ * @param str Caractères parmi "0123456789: -" (les autres sont ignorés)
+ * @note Largeur : ssd1306_gfx_big_digits_width(str)
+ */
+void ssd1306_draw_big_digits(uint8_t x, uint8_t page, const char* str);
+
+/**
+ * @brief Envoie au panneau les zones du framebuffer modifiées
+ */
+void ssd1306_refresh(void);
+
 /* -------------------------------------------------------------------------- */
 /*                           Fonctions graphiques                             */
 /* -------------------------------------------------------------------------- */
@@ -102,16 +295,37 @@ void ssd1306_draw_pixel(int x, int y, bool color);
  */
 void ssd1306_draw_rect(int x, int y, int w, int h, bool color);
 
+/**
+ * @brief Remplit un rectangle, découpé au bord de l’écran
+ * @param mode SSD1306_MODE_SET / COPY (blanc), CLEAR (noir), XOR (inversion)
+ */
+void ssd1306_fill_rect(int x, int y, int w, int h, ssd1306_mode_t mode);
+
+/**
+ * @brief Dessine le contour (1 pixel) d’un rectangle
+ * @param mode Voir ssd1306_fill_rect
+ */
+void ssd1306_draw_frame(int x, int y, int w, int h, ssd1306_mode_t mode);
+
 /**
  * @brief Dessine une image bitmap 1bpp dans le framebuffer
  * @param x Position X
  * @param y Position Y
  * @param w Largeur (en pixels)
  * @param h Hauteur (en pixels)
- * @param data Tableau contenant l’image (1 bit/pixel)
+ * @param data Tableau contenant l’image (1 bit/pixel, ligne par ligne,
+ *             bit de poids fort en premier)
  */
 void ssd1306_draw_bitmap(int x, int y, int w, int h, const uint8_t* data);
 
+/**
+ * @brief Dessine une image au format page du SSD1306 (chemin le plus rapide)
+ * @param data (h + 7) / 8 bandes de w octets, bit 0 = pixel du haut
+ * @param mode SET / CLEAR / XOR n’agissent que sur les pixels à 1,
+ *             COPY recopie aussi les pixels à 0
+ */
+void ssd1306_draw_bitmap_pages(int x, int y, int w, int h, const uint8_t* data, ssd1306_mode_t mode);
+
 /* -------------------------------------------------------------------------- */
 /*                         Fonctions sur le framebuffer                       */
 /* -------------------------------------------------------------------------- */
@@ -122,10 +336,45 @@ void ssd1306_draw_bitmap(int x, int y, int w, int h, const uint8_t* data);
 void ssd1306_fb_clear(void);
 
 /**
- * @brief Transmet le contenu du framebuffer à l’écran OLED
+ * @brief Transmet à l’écran OLED les plages de colonnes du framebuffer qui
+ *        diffèrent de ce que le panneau affiche déjà
+ *        (ssd1306_fb_commit() suivi de ssd1306_fb_send())
  */
 void ssd1306_fb_flush(void);
 
+/**
+ * @brief Recopie les pages modifiées du tampon arrière dans le tampon avant
+ *        (mémoire uniquement, aucun accès I2C)
+ * @return true si au moins une page a changé depuis le dernier appel
+ * @note Ne doit pas être appelée pendant un ssd1306_fb_send()
+ */
+bool ssd1306_fb_commit(void);
+
+/**
+ * @brief Transmet à l’écran le tampon avant validé par ssd1306_fb_commit()
+ * @note Ne lit pas le tampon arrière : le dessin peut continuer en parallèle
+ */
+void ssd1306_fb_send(void);
+
+/* -------------------------------------------------------------------------- */
+/*                              Diagnostic du bus                             */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Trafic I2C produit par le dernier appel ayant accédé au bus
+ *        (init, clear, contrast, power, refresh / flush)
+ * @param transactions Nombre de transactions I2C (peut être NULL)
+ * @param bytes Nombre d’octets émis, hors adresse (peut être NULL)
+ */
+void ssd1306_bus_last_call(uint32_t* transactions, uint32_t* bytes);
+
+/**
+ * @brief Image que le pilote considère affichée par le panneau (1024 octets,
+ *        format page), mise à jour à chaque envoi
+ * @note Diagnostic et tests : doit être identique à la GDDRAM du panneau
+ */
+const uint8_t* ssd1306_fb_displayed(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,348 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ssd1306_gfx.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Primitives graphiques par octets de page pour le framebuffer SSD1306.
+   Un octet de page porte 8 pixels verticaux : remplir ou copier une zone
+   revient à combiner des octets entiers sous un masque de lignes, au lieu
+   de traiter chaque pixel séparément.
+
+-- ========================================================================== */
+
+/** -------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include <string.h>
+#include "ssd1306_gfx.h"
+#include "font6x8.h"
+#include "font_scaled.h"
+#include "font_digits.h"
+
+/** -------------------------------------------------------------------------- --
+   Macro definitions
+-- -------------------------------------------------------------------------- */
+#define W   SSD1306_GFX_WIDTH
+#define H   SSD1306_GFX_HEIGHT
+
+#define FONT_WIDTH      6   /* Largeur d’un caractère font6x8 */
+#define FONT_MAX_SCALE  4
+
+/** -------------------------------------------------------------------------- --
+   Division par 8 arrondie vers le bas, y compris pour y < 0
+-- -------------------------------------------------------------------------- */
+static inline int page_of(int y)
+{
+    return (y >= 0) ? (y >> 3) : -((7 - y) >> 3);
+}
+
+/** -------------------------------------------------------------------------- --
+   Masque des lignes [lo, hi[ d’une page (0 <= lo < hi <= 8)
+-- -------------------------------------------------------------------------- */
+static inline uint8_t rows_mask(int lo, int hi)
+{
+    return (uint8_t)((0xFFu << lo) & (0xFFu >> (8 - hi)));
+}
+
+/** -------------------------------------------------------------------------- --
+   Combine bits dans *dst ; mask = lignes couvertes (utilisé par COPY)
+-- -------------------------------------------------------------------------- */
+static inline void apply_byte(uint8_t* dst, uint8_t bits, uint8_t mask, ssd1306_mode_t mode)
+{
+    switch (mode) {
+    case SSD1306_MODE_SET:   *dst |= bits; break;
+    case SSD1306_MODE_CLEAR: *dst &= (uint8_t)~bits; break;
+    case SSD1306_MODE_XOR:   *dst ^= bits; break;
+    case SSD1306_MODE_COPY:  *dst = (uint8_t)((*dst & ~mask) | (bits & mask)); break;
+    }
+}
+
+/** -------------------------------------------------------------------------- --
+   Découpe le rectangle à l’écran ; false s’il est entièrement dehors
+-- -------------------------------------------------------------------------- */
+static bool clip_rect(int* x, int* y, int* w, int* h)
+{
+    if (*x < 0) { *w += *x; *x = 0; }
+    if (*y < 0) { *h += *y; *y = 0; }
+    if (*x + *w > W) *w = W - *x;
+    if (*y + *h > H) *h = H - *y;
+    return *w > 0 && *h > 0;
+}
+
+/** -------------------------------------------------------------------------- --
+   Rectangle plein : pages complètes par memset, pages de bord sous masque
+-- -------------------------------------------------------------------------- */
+uint8_t ssd1306_gfx_fill_rect(uint8_t* fb, int x, int y, int w, int h, ssd1306_mode_t mode)
+{
+    if (!clip_rect(&x, &y, &w, &h)) return 0;
+
+    uint8_t dirty = 0;
+    int first = y >> 3;
+    int last = (y + h - 1) >> 3;
+    for (int page = first; page <= last; page++) {
+        int lo = (page == first) ? (y & 7) : 0;
+        int hi = (page == last) ? ((y + h - 1) & 7) + 1 : 8;
+        uint8_t mask = rows_mask(lo, hi);
+        uint8_t* row = &fb[page * W + x];
+
+        if (mask == 0xFF && mode != SSD1306_MODE_XOR) {
+            memset(row, (mode == SSD1306_MODE_CLEAR) ? 0x00 : 0xFF, w);
+        } else {
+            for (int i = 0; i < w; i++) {
+                apply_byte(&row[i], mask, mask, mode);
+            }
+        }
+        dirty |= (uint8_t)(1u << page);
+    }
+    return dirty;
+}
+
+/** -------------------------------------------------------------------------- --
+   Contour : deux lignes horizontales et deux colonnes sans recouvrement
+   (important en XOR : aucun pixel n’est inversé deux fois)
+-- -------------------------------------------------------------------------- */
+uint8_t ssd1306_gfx_draw_frame(uint8_t* fb, int x, int y, int w, int h, ssd1306_mode_t mode)
+{
+    if (w <= 0 || h <= 0) return 0;
+
+    uint8_t dirty = ssd1306_gfx_fill_rect(fb, x, y, w, 1, mode);
+    if (h > 1) {
+        dirty |= ssd1306_gfx_fill_rect(fb, x, y + h - 1, w, 1, mode);
+    }
+    if (h > 2) {
+        dirty |= ssd1306_gfx_fill_rect(fb, x, y + 1, 1, h - 2, mode);
+        if (w > 1) {
+            dirty |= ssd1306_gfx_fill_rect(fb, x + w - 1, y + 1, 1, h - 2, mode);
+        }
+    }
+    return dirty;
+}
+
+/** -------------------------------------------------------------------------- --
+   Bitmap au format page : chaque octet source est décalé de (y mod 8) et
+   réparti sur au plus deux pages de destination
+-- -------------------------------------------------------------------------- */
+uint8_t ssd1306_gfx_blit(uint8_t* fb, int x, int y, int w, int h, const uint8_t* data, ssd1306_mode_t mode)
+{
+    if (w <= 0 || h <= 0) return 0;
+
+    int col0 = (x < 0) ? -x : 0;
+    int col1 = (x + w > W) ? W - x : w;
+    if (col0 >= col1) return 0;
+
+    uint8_t dirty = 0;
+    int src_pages = (h + 7) >> 3;
+    for (int sp = 0; sp < src_pages; sp++) {
+        int rows = h - sp * 8;
+        uint8_t src_mask = (rows >= 8) ? 0xFF : rows_mask(0, rows);
+        int y0 = y + sp * 8;
+        int dp = page_of(y0);
+        int shift = y0 - dp * 8;
+        const uint8_t* src = data + sp * w;
+
+        if (dp >= 0 && dp < SSD1306_GFX_PAGES) {
+            uint8_t* dst = &fb[dp * W + x];
+            uint8_t mask = (uint8_t)(src_mask << shift);
+            if (shift == 0 && src_mask == 0xFF && mode == SSD1306_MODE_COPY) {
+                memcpy(dst + col0, src + col0, col1 - col0);
+            } else {
+                for (int c = col0; c < col1; c++) {
+                    apply_byte(&dst[c], (uint8_t)((src[c] & src_mask) << shift), mask, mode);
+                }
+            }
+            dirty |= (uint8_t)(1u << dp);
+        }
+        if (shift != 0 && dp + 1 >= 0 && dp + 1 < SSD1306_GFX_PAGES) {
+            uint8_t* dst = &fb[(dp + 1) * W + x];
+            uint8_t mask = (uint8_t)(src_mask >> (8 - shift));
+            for (int c = col0; c < col1; c++) {
+                apply_byte(&dst[c], (uint8_t)((src[c] & src_mask) >> (8 - shift)), mask, mode);
+            }
+            dirty |= (uint8_t)(1u << (dp + 1));
+        }
+    }
+    return dirty;
+}
+
+/** -------------------------------------------------------------------------- --
+   Transposition d’un bloc de 8 x 8 bits : l’octet k (ligne k, colonne j au
+   bit 7 - j) devient l’octet 7 - j (colonne j, ligne k au bit k)
+-- -------------------------------------------------------------------------- */
+static inline uint64_t transpose8(uint64_t m)
+{
+    uint64_t t;
+    t = (m ^ (m >> 7)) & 0x00AA00AA00AA00AAULL;   m ^= t ^ (t << 7);
+    t = (m ^ (m >> 14)) & 0x0000CCCC0000CCCCULL;  m ^= t ^ (t << 14);
+    t = (m ^ (m >> 28)) & 0x00000000F0F0F0F0ULL;  m ^= t ^ (t << 28);
+    return m;
+}
+
+/** -------------------------------------------------------------------------- --
+   Bitmap ligne par ligne : les lignes couvertes par une page de destination
+   sont regroupées en octets de page, puis écrites en une seule passe.
+   Si chaque ligne source commence sur un octet (w multiple de 8), les
+   octets source sont transposés par blocs de 8 x 8, sinon bit à bit.
+-- -------------------------------------------------------------------------- */
+uint8_t ssd1306_gfx_blit_rows(uint8_t* fb, int x, int y, int w, int h, const uint8_t* data, ssd1306_mode_t mode)
+{
+    int cx = x, cy = y, cw = w, ch = h;
+    if (!clip_rect(&cx, &cy, &cw, &ch)) return 0;
+
+    uint8_t dirty = 0;
+    int first = cy >> 3;
+    int last = (cy + ch - 1) >> 3;
+    for (int page = first; page <= last; page++) {
+        int y_lo = (page == first) ? cy : page * 8;
+        int y_hi = (page == last) ? cy + ch : page * 8 + 8;
+        uint8_t mask = rows_mask(y_lo & 7, ((y_hi - 1) & 7) + 1);
+        uint8_t* row = &fb[page * W + cx];
+        uint8_t acc[W];
+
+        if ((w & 7) == 0) {
+            int stride = w >> 3;
+            for (int gx = (cx - x) >> 3; gx <= (cx + cw - 1 - x) >> 3; gx++) {
+                uint64_t m = 0;
+                for (int yy = y_lo; yy < y_hi; yy++) {
+                    m |= (uint64_t)data[(yy - y) * stride + gx] << (8 * (yy & 7));
+                }
+                m = transpose8(m);
+                for (int j = 0; j < 8; j++) {
+                    int i = x + gx * 8 + j - cx;
+                    if (i >= 0 && i < cw) acc[i] = (uint8_t)(m >> (8 * (7 - j)));
+                }
+            }
+        } else {
+            memset(acc, 0, cw);
+            for (int yy = y_lo; yy < y_hi; yy++) {
+                unsigned idx = (unsigned)((yy - y) * w + (cx - x));
+                int shift = yy & 7;
+                for (int i = 0; i < cw; i++, idx++) {
+                    acc[i] |= (uint8_t)(((data[idx >> 3] >> (~idx & 7)) & 1u) << shift);
+                }
+            }
+        }
+        for (int i = 0; i < cw; i++) {
+            apply_byte(&row[i], acc[i], mask, mode);
+        }
+        dirty |= (uint8_t)(1u << page);
+    }
+    return dirty;
+}
+
+/** -------------------------------------------------------------------------- --
+   Colonnes (page 0 en premier) d’un caractère agrandi ; NULL si non affichable
+-- -------------------------------------------------------------------------- */
+static const uint8_t* glyph_columns(char c, uint8_t scale)
+{
+    if (c < 32 || c > 126) return NULL;
+    switch (scale) {
+    case 1:  return font6x8[c - 32];
+    case 2:  return &font6x8_x2[c - 32][0][0];
+    case 3:  return &font6x8_x3[c - 32][0][0];
+    default: return &font6x8_x4[c - 32][0][0];
+    }
+}
+
+/** -------------------------------------------------------------------------- --
+   Texte agrandi : chaque colonne précalculée est recopiée scale fois par
+   memset, page par page (aucun calcul par pixel)
+-- -------------------------------------------------------------------------- */
+uint8_t ssd1306_gfx_draw_string(uint8_t* fb, int x, uint8_t page, const char* str, uint8_t scale, bool invert)
+{
+    if (page >= SSD1306_GFX_PAGES) return 0;
+    if (scale < 1) scale = 1;
+    if (scale > FONT_MAX_SCALE) scale = FONT_MAX_SCALE;
+
+    int pages = scale;
+    if (page + pages > SSD1306_GFX_PAGES) pages = SSD1306_GFX_PAGES - page;
+
+    uint8_t dirty = 0;
+    for (; *str && x < W; str++) {
+        const uint8_t* glyph = glyph_columns(*str, scale);
+        if (!glyph) continue;
+
+        for (int p = 0; p < pages; p++) {
+            uint8_t* row = &fb[(page + p) * W];
+            const uint8_t* cols = glyph + p * FONT_WIDTH;
+            for (int col = 0; col < FONT_WIDTH; col++) {
+                int cx = x + col * scale;
+                int n = scale;
+                if (cx < 0) { n += cx; cx = 0; }
+                if (cx + n > W) n = W - cx;
+                if (n > 0) memset(row + cx, invert ? (uint8_t)~cols[col] : cols[col], n);
+            }
+            dirty |= (uint8_t)(1u << (page + p));
+        }
+        x += FONT_WIDTH * scale;
+    }
+    return dirty;
+}
+
+int ssd1306_gfx_text_width(const char* str, uint8_t scale)
+{
+    if (scale < 1) scale = 1;
+    if (scale > FONT_MAX_SCALE) scale = FONT_MAX_SCALE;
+
+    int w = 0;
+    for (; *str; str++) {
+        if (*str >= 32 && *str <= 126) w += FONT_WIDTH * scale;
+    }
+    return w;
+}
+
+/** -------------------------------------------------------------------------- --
+   Grands chiffres : recherche du glyphe et largeur de cellule
+-- -------------------------------------------------------------------------- */
+static int big_digit_index(char c)
+{
+    const char* p = strchr(font_digits_chars, c);
+    return (c && p) ? (int)(p - font_digits_chars) : -1;
+}
+
+static int big_digit_width(char c)
+{
+    return (c == ':') ? FONT_DIGITS_COLON_W : FONT_DIGITS_ADVANCE;
+}
+
+/** -------------------------------------------------------------------------- --
+   Grands chiffres : une recopie d’octets par page et par caractère
+-- -------------------------------------------------------------------------- */
+uint8_t ssd1306_gfx_draw_big_digits(uint8_t* fb, int x, uint8_t page, const char* str)
+{
+    if (page >= SSD1306_GFX_PAGES) return 0;
+
+    int pages = FONT_DIGITS_PAGES;
+    if (page + pages > SSD1306_GFX_PAGES) pages = SSD1306_GFX_PAGES - page;
+
+    uint8_t dirty = 0;
+    for (; *str && x < W; str++) {
+        int idx = big_digit_index(*str);
+        if (idx < 0) continue;
+
+        int w = big_digit_width(*str);
+        int skip = (x < 0) ? -x : 0;
+        int n = w - skip;
+        if (x + w > W) n = W - x - skip;
+        if (n > 0) {
+            for (int p = 0; p < pages; p++) {
+                memcpy(&fb[(page + p) * W + x + skip], &font_digits[idx][p][skip], n);
+                dirty |= (uint8_t)(1u << (page + p));
+            }
+        }
+        x += w;
+    }
+    return dirty;
+}
+
+int ssd1306_gfx_big_digits_width(const char* str)
+{
+    int w = 0;
+    for (; *str; str++) {
+        if (big_digit_index(*str) >= 0) w += big_digit_width(*str);
+    }
+    return w;
+}
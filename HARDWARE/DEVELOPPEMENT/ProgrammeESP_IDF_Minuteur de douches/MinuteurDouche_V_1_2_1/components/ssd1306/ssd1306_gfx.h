@@ -0,0 +1,113 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ssd1306_gfx.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Primitives graphiques travaillant directement sur les octets de page
+   d’un framebuffer SSD1306 (128 x 64, 8 pages de 128 octets, bit 0 = ligne
+   du haut de la page) :
+   - Remplissage de rectangle par octets entiers avec masques de bord
+   - Contour de rectangle
+   - Copie de bitmap, source au format page ou ligne par ligne
+   - Texte font6x8 à l’échelle 1 à 4 et grands chiffres du compte à
+     rebours, à partir de tables précalculées (tools/gen_fonts.py)
+   Toutes les primitives découpent au bord de l’écran et retournent le
+   masque des pages modifiées (bit n = page n).
+   Indépendant du matériel : compilable sur PC (voir host/).
+
+-- ========================================================================== */
+
+#ifndef SSD1306_GFX_H
+#define SSD1306_GFX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SSD1306_GFX_WIDTH   128
+#define SSD1306_GFX_HEIGHT  64
+#define SSD1306_GFX_PAGES   8
+
+/**
+ * @brief Mode de combinaison des pixels source avec le framebuffer
+ */
+typedef enum {
+    SSD1306_MODE_SET,      /* Allume les pixels à 1 de la source */
+    SSD1306_MODE_CLEAR,    /* Éteint les pixels à 1 de la source */
+    SSD1306_MODE_XOR,      /* Inverse les pixels à 1 de la source */
+    SSD1306_MODE_COPY      /* Recopie la source (0 et 1) dans la zone */
+} ssd1306_mode_t;
+
+/**
+ * @brief Remplit un rectangle (SET/COPY allument, CLEAR éteint, XOR inverse)
+ * @param fb Framebuffer de 1024 octets
+ * @return Masque des pages modifiées
+ */
+uint8_t ssd1306_gfx_fill_rect(uint8_t* fb, int x, int y, int w, int h, ssd1306_mode_t mode);
+
+/**
+ * @brief Dessine le contour (1 pixel) d’un rectangle
+ * @param fb Framebuffer de 1024 octets
+ * @return Masque des pages modifiées
+ */
+uint8_t ssd1306_gfx_draw_frame(uint8_t* fb, int x, int y, int w, int h, ssd1306_mode_t mode);
+
+/**
+ * @brief Copie un bitmap au format page : (h + 7) / 8 bandes de w octets,
+ *        chaque octet = 8 pixels verticaux, bit 0 en haut
+ * @param fb Framebuffer de 1024 octets
+ * @return Masque des pages modifiées
+ */
+uint8_t ssd1306_gfx_blit(uint8_t* fb, int x, int y, int w, int h, const uint8_t* data, ssd1306_mode_t mode);
+
+/**
+ * @brief Copie un bitmap ligne par ligne : flux de w * h bits, bit de poids
+ *        fort en premier (format historique de ssd1306_draw_bitmap)
+ * @param fb Framebuffer de 1024 octets
+ * @return Masque des pages modifiées
+ */
+uint8_t ssd1306_gfx_blit_rows(uint8_t* fb, int x, int y, int w, int h, const uint8_t* data, ssd1306_mode_t mode);
+
+/**
+ * @brief Écrit une chaîne font6x8 agrandie, alignée sur une page
+ * @param fb Framebuffer de 1024 octets
+ * @param x Colonne de départ
+ * @param page Page du haut ; le texte occupe scale pages (tronqué en bas)
+ * @param scale Facteur d’agrandissement 1 à 4 (borné)
+ * @param invert Texte noir sur fond blanc
+ * @return Masque des pages modifiées
+ */
+uint8_t ssd1306_gfx_draw_string(uint8_t* fb, int x, uint8_t page, const char* str, uint8_t scale, bool invert);
+
+/**
+ * @brief Largeur en pixels d’une chaîne font6x8 à l’échelle donnée
+ */
+int ssd1306_gfx_text_width(const char* str, uint8_t scale);
+
+/**
+ * @brief Écrit une chaîne en grands chiffres (caractères "0123456789: -"),
+ *        4 pages de haut
+ * @param fb Framebuffer de 1024 octets
+ * @param x Colonne de départ
+ * @param page Page du haut
+ * @return Masque des pages modifiées
+ */
+uint8_t ssd1306_gfx_draw_big_digits(uint8_t* fb, int x, uint8_t page, const char* str);
+
+/**
+ * @brief Largeur en pixels d’une chaîne en grands chiffres
+ */
+int ssd1306_gfx_big_digits_width(const char* str);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SSD1306_GFX_H
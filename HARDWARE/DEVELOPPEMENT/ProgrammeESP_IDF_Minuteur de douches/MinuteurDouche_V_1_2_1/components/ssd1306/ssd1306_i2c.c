@@ -0,0 +1,125 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ssd1306_i2c.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Transport I2C du SSD1306 :
+   - Configuration des ports I2C maîtres
+   - Encodage d’une séquence de commandes, ou d’un en-tête de commandes
+     suivi d’un bloc de données (jusqu’à la GDDRAM entière), dans un
+     tampon statique et envoi en une transaction
+   - Comptage des transactions et des octets émis, panneau par panneau
+
+-- ========================================================================== */
+
+/** -------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include <string.h>
+#include "driver/i2c.h"
+#include "esp_log.h"
+#include "ssd1306.h"
+#include "ssd1306_i2c.h"
+
+/** -------------------------------------------------------------------------- --
+   Macro definitions
+-- -------------------------------------------------------------------------- */
+#define I2C_TIMEOUT_MS  1000
+
+/* Plus grande écriture : en-tête (contrôle + commande par octet), octet de
+   contrôle des données, puis l’image complète */
+#define TX_BUF_SIZE     (2 * SSD1306_I2C_MAX_HDR_CMDS + 1 + SSD1306_I2C_MAX_DATA)
+
+static const char *TAG = "SSD1306_I2C";
+
+/** -------------------------------------------------------------------------- --
+   Static variables
+   Le pilote n’est appelé que depuis une seule tâche à la fois, tous
+   panneaux confondus : un tampon d’émission unique suffit.
+-- -------------------------------------------------------------------------- */
+static uint8_t tx_buf[TX_BUF_SIZE];
+
+/** -------------------------------------------------------------------------- --
+   Initialisation d’un port I2C
+-- -------------------------------------------------------------------------- */
+void ssd1306_setup_i2c_port(i2c_port_t port, gpio_num_t sda, gpio_num_t scl)
+{
+    i2c_config_t conf = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = sda,
+        .scl_io_num = scl,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = 400000,
+    };
+    i2c_param_config(port, &conf);
+    i2c_driver_install(port, conf.mode, 0, 0, 0);
+}
+
+/** -------------------------------------------------------------------------- --
+   Initialisation du port I2C 0 (panneau unique)
+-- -------------------------------------------------------------------------- */
+void ssd1306_setup_i2c(gpio_num_t sda, gpio_num_t scl)
+{
+    ssd1306_setup_i2c_port(I2C_NUM_0, sda, scl);
+}
+
+/** -------------------------------------------------------------------------- --
+   Émission des len premiers octets du tampon
+-- -------------------------------------------------------------------------- */
+static esp_err_t transmit(ssd1306_link_t *link, size_t len)
+{
+    link->stats.transactions++;
+    link->stats.bytes += len;
+
+    esp_err_t err = i2c_master_write_to_device(link->port, link->addr, tx_buf, len,
+                                               I2C_TIMEOUT_MS / portTICK_PERIOD_MS);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Erreur I2C 0x%02X (%u octets) : %s", link->addr, (unsigned)len,
+                 esp_err_to_name(err));
+    }
+    return err;
+}
+
+/** -------------------------------------------------------------------------- --
+   Séquence de commandes : 0x00 puis les commandes
+-- -------------------------------------------------------------------------- */
+esp_err_t ssd1306_i2c_write_cmds(ssd1306_link_t *link, const uint8_t *cmds, size_t len)
+{
+    if (len + 1 > TX_BUF_SIZE) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    tx_buf[0] = SSD1306_CTRL_CMD_STREAM;
+    memcpy(tx_buf + 1, cmds, len);
+    return transmit(link, len + 1);
+}
+
+/** -------------------------------------------------------------------------- --
+   En-tête + données : (0x80, commande) pour chaque commande, 0x40 puis les
+   lignes du bloc mises bout à bout. Le contrôleur revient en mode commande
+   à la transaction suivante.
+-- -------------------------------------------------------------------------- */
+esp_err_t ssd1306_i2c_write_data(ssd1306_link_t *link, const uint8_t *cmds, size_t cmd_len,
+                                 const uint8_t *data, size_t width, size_t rows, size_t stride)
+{
+    if (cmd_len > SSD1306_I2C_MAX_HDR_CMDS || width * rows > SSD1306_I2C_MAX_DATA) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < cmd_len; i++) {
+        tx_buf[pos++] = SSD1306_CTRL_CMD_SINGLE;
+        tx_buf[pos++] = cmds[i];
+    }
+    tx_buf[pos++] = SSD1306_CTRL_DATA_STREAM;
+    for (size_t r = 0; r < rows; r++) {
+        memcpy(tx_buf + pos, data + r * stride, width);
+        pos += width;
+    }
+    return transmit(link, pos);
+}
@@ -0,0 +1,95 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ssd1306_i2c.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Couche de transport I2C du pilote SSD1306.
+   Chaque appel produit une seule transaction I2C vers le panneau décrit
+   par un lien (port I2C + adresse), encodée dans un tampon statique :
+   aucune allocation dynamique à l’exécution.
+
+-- ========================================================================== */
+
+#ifndef SSD1306_I2C_H
+#define SSD1306_I2C_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/i2c.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------------- */
+/*                     Octets de contrôle du protocole SSD1306                */
+/* -------------------------------------------------------------------------- */
+#define SSD1306_CTRL_CMD_STREAM   0x00    /* Tous les octets suivants sont des commandes */
+#define SSD1306_CTRL_CMD_SINGLE   0x80    /* Une commande, puis un nouvel octet de contrôle */
+#define SSD1306_CTRL_DATA_STREAM  0x40    /* Tous les octets suivants sont des données */
+
+/* Nombre maximal de commandes dans l’en-tête d’une écriture de données */
+#define SSD1306_I2C_MAX_HDR_CMDS  6
+
+/* Plus grande écriture de données : la GDDRAM complète (128 x 8 pages) */
+#define SSD1306_I2C_MAX_DATA      1024
+
+/**
+ * @brief Trafic généré sur le bus (octets comptés hors adresse I2C)
+ */
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;
+} ssd1306_bus_stats_t;
+
+/**
+ * @brief Panneau joint sur le bus et trafic cumulé vers ce panneau
+ */
+typedef struct {
+    i2c_port_t port;
+    uint8_t addr;
+    ssd1306_bus_stats_t stats;
+} ssd1306_link_t;
+
+/**
+ * @brief Envoie une séquence de commandes en une seule transaction
+ * @param link Panneau destinataire
+ * @param cmds Commandes (et leurs paramètres)
+ * @param len Nombre d’octets
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE ou l’erreur du driver I2C
+ */
+esp_err_t ssd1306_i2c_write_cmds(ssd1306_link_t *link, const uint8_t *cmds, size_t len);
+
+/**
+ * @brief Envoie des commandes d’adressage suivies d’un bloc de données, en
+ *        une seule transaction
+ *
+ * Le bloc est lu ligne par ligne : rows lignes de width octets, espacées de
+ * stride octets dans la source (stride = 0 répète la même ligne). En mode
+ * d’adressage horizontal, une fenêtre 0x21/0x22 de même taille reçoit ainsi
+ * une zone rectangulaire du framebuffer en un seul transfert. Sans
+ * commande d’en-tête (cmd_len = 0), les données prolongent l’écriture
+ * précédente là où le pointeur du contrôleur s’est arrêté.
+ *
+ * @param link Panneau destinataire
+ * @param cmds Commandes d’en-tête (au plus SSD1306_I2C_MAX_HDR_CMDS)
+ * @param cmd_len Nombre de commandes
+ * @param data Première ligne du bloc
+ * @param width Octets par ligne
+ * @param rows Nombre de lignes (width * rows <= SSD1306_I2C_MAX_DATA)
+ * @param stride Écart entre deux lignes dans la source
+ * @return ESP_OK, ESP_ERR_INVALID_SIZE ou l’erreur du driver I2C
+ */
+esp_err_t ssd1306_i2c_write_data(ssd1306_link_t *link, const uint8_t *cmds, size_t cmd_len,
+                                 const uint8_t *data, size_t width, size_t rows, size_t stride);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SSD1306_I2C_H
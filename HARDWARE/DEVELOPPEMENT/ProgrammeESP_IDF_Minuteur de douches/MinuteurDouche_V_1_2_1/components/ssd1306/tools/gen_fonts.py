@@ -0,0 +1,190 @@
+#!/usr/bin/env python3
+"""Génère les polices précalculées du driver SSD1306.
+
+  font_scaled.h  : font6x8 agrandie x2, x3 et x4 (colonnes étirées
+                   verticalement, la répétition horizontale se fait au blit)
+  font_digits.h  : chiffres 7 segments 18x32 pour le compte à rebours MM:SS
+
+Usage : python3 tools/gen_fonts.py   (depuis components/ssd1306)
+"""
+import os
+import re
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+
+SCALES = (2, 3, 4)
+
+DIGIT_W = 18            # largeur dessinée d'un chiffre
+DIGIT_ADVANCE = 20      # largeur d'une cellule (espacement compris)
+DIGIT_H = 32
+COLON_W = 8
+
+SEGMENTS = {
+    '0': 'abcdef', '1': 'bc', '2': 'abdeg', '3': 'abcdg', '4': 'bcfg',
+    '5': 'acdfg', '6': 'acdefg', '7': 'abc', '8': 'abcdefg', '9': 'abcdfg',
+    '-': 'g', ' ': '',
+}
+BIG_CHARS = '0123456789: -'
+
+
+def read_font6x8():
+    src = open(os.path.join(ROOT, 'font6x8.h'), encoding='utf-8').read()
+    glyphs = []
+    for row in re.findall(r'\{(0x[0-9A-Fa-f]{2}(?:\s*,\s*0x[0-9A-Fa-f]{2}){5})\}', src):
+        glyphs.append([int(v, 16) for v in row.split(',')])
+    assert len(glyphs) == 95, len(glyphs)
+    return glyphs
+
+
+def stretch_column(byte, scale):
+    """Étire une colonne de 8 pixels sur 8*scale pixels, découpée en pages."""
+    value = 0
+    for bit in range(8):
+        if byte & (1 << bit):
+            for k in range(scale):
+                value |= 1 << (bit * scale + k)
+    return [(value >> (8 * p)) & 0xFF for p in range(scale)]
+
+
+def segment_pixel(seg, x, y):
+    # Segments hexagonaux de 4 pixels d'épaisseur, extrémités biseautées
+    horiz = {'a': 1.5, 'g': 15.5, 'd': 29.5}
+    vert = {'f': (1.5, 2.5, 14.5), 'b': (15.5, 2.5, 14.5),
+            'e': (1.5, 16.5, 28.5), 'c': (15.5, 16.5, 28.5)}
+    if seg in horiz:
+        d = abs(y - horiz[seg])
+        return d <= 1.5 and 2.5 + d <= x <= 14.5 - d
+    xc, y0, y1 = vert[seg]
+    d = abs(x - xc)
+    return d <= 1.5 and y0 + d <= y <= y1 - d
+
+
+def big_glyph(ch):
+    if ch == ':':
+        width = COLON_W
+        on = lambda x, y: 2 <= x <= 5 and (9 <= y <= 12 or 19 <= y <= 22)
+    else:
+        width = DIGIT_ADVANCE
+        segs = SEGMENTS[ch]
+        on = lambda x, y: x < DIGIT_W and any(segment_pixel(s, x, y) for s in segs)
+    pages = []
+    for p in range(DIGIT_H // 8):
+        cols = []
+        for x in range(width):
+            byte = 0
+            for bit in range(8):
+                if on(x, p * 8 + bit):
+                    byte |= 1 << bit
+            cols.append(byte)
+        pages.append(cols)
+    return pages
+
+
+def banner(name, lines):
+    sep = '   ' + '=' * 74
+    sub = '   ' + '-' * 74
+    out = [
+        '/* ' + '=' * 74 + ' --',
+        '                  Projet : Smart Minuteur de Douche - ESP32',
+        '',
+        sep,
+        '   File: ' + name,
+        '',
+        sep,
+        '   Functional description:',
+        sub,
+    ]
+    out += ['   ' + l for l in lines]
+    out += [
+        '',
+        '   Fichier généré par tools/gen_fonts.py : ne pas modifier à la main.',
+        '-- ' + '=' * 74 + ' */',
+        '',
+    ]
+    return out
+
+
+def fmt_bytes(values):
+    return ','.join('0x%02X' % v for v in values)
+
+
+def char_comment(code):
+    c = chr(code)
+    return "0x%02X '%s'" % (code, c)
+
+
+def write_scaled(glyphs):
+    out = banner('font_scaled.h', [
+        'Police font6x8 agrandie x2, x3 et x4, précalculée à partir de',
+        'font6x8.h : chaque colonne est étirée verticalement et découpée en',
+        'pages, la répétition horizontale se fait à l’affichage.',
+    ]) + [
+        '#ifndef FONT_SCALED_H',
+        '#define FONT_SCALED_H',
+        '',
+        '#include <stdint.h>',
+        '',
+        '// Colonnes de font6x8 étirées verticalement : [caractère][page][colonne].',
+        '// Chaque colonne est répétée "scale" fois à l\'écran.',
+    ]
+    for scale in SCALES:
+        out.append('static const uint8_t font6x8_x%d[95][%d][6] = {' % (scale, scale))
+        for i, g in enumerate(glyphs):
+            cols = [stretch_column(b, scale) for b in g]
+            pages = ['{%s}' % fmt_bytes(cols[c][p] for c in range(6)) for p in range(scale)]
+            out.append('    {%s}, // %s' % (','.join(pages), char_comment(32 + i)))
+        out.append('};')
+        out.append('')
+    out.append('#endif // FONT_SCALED_H')
+    return '\n'.join(out) + '\n'
+
+
+def write_digits():
+    out = banner('font_digits.h', [
+        'Grands chiffres 7 segments (%dx%d) pour le compte à rebours MM:SS,' % (DIGIT_W, DIGIT_H),
+        'stockés au format page : l’affichage est une recopie d’octets.',
+    ]) + [
+        '#ifndef FONT_DIGITS_H',
+        '#define FONT_DIGITS_H',
+        '',
+        '#include <stdint.h>',
+        '',
+        '// Chiffres 7 segments de %d pixels de haut (%d pages) pour le compte à rebours.'
+        % (DIGIT_H, DIGIT_H // 8),
+        '#define FONT_DIGITS_PAGES   %d' % (DIGIT_H // 8),
+        '#define FONT_DIGITS_ADVANCE %d' % DIGIT_ADVANCE,
+        '#define FONT_DIGITS_COLON_W %d' % COLON_W,
+        '',
+        '// Caractères disponibles, dans l\'ordre de la table',
+        'static const char font_digits_chars[] = "%s";' % BIG_CHARS,
+        '',
+        '// [caractère][page][colonne] ; le ":" n\'utilise que les %d premières colonnes'
+        % COLON_W,
+        'static const uint8_t font_digits[%d][%d][%d] = {' % (len(BIG_CHARS), DIGIT_H // 8, DIGIT_ADVANCE),
+    ]
+    for ch in BIG_CHARS:
+        pages = big_glyph(ch)
+        rows = ['{%s}' % fmt_bytes(cols + [0] * (DIGIT_ADVANCE - len(cols))) for cols in pages]
+        out.append("    { // '%s'" % ch)
+        for r in rows:
+            out.append('        %s,' % r)
+        out.append('    },')
+    out.append('};')
+    out.append('')
+    out.append('#endif // FONT_DIGITS_H')
+    return '\n'.join(out) + '\n'
+
+
+def preview(ch):
+    pages = big_glyph(ch)
+    for y in range(DIGIT_H):
+        print(''.join('#' if pages[y // 8][x] & (1 << (y % 8)) else '.' for x in range(len(pages[0]))))
+
+
+if __name__ == '__main__':
+    glyphs = read_font6x8()
+    with open(os.path.join(ROOT, 'font_scaled.h'), 'w', encoding='utf-8') as f:
+        f.write(write_scaled(glyphs))
+    with open(os.path.join(ROOT, 'font_digits.h'), 'w', encoding='utf-8') as f:
+        f.write(write_digits())
@@ -0,0 +1,294 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: bench_gfx.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Micro-benchmark des primitives graphiques SSD1306 (exécuté sur PC).
+   Compare l’ancien chemin (un ssd1306_draw_pixel par pixel : bornes,
+   division, lecture-modification-écriture) aux primitives ssd1306_gfx_*
+   qui travaillent par octets de page.
+
+     bench_gfx           mesure les deux chemins
+     bench_gfx --check   vérifie que les deux chemins donnent la même image
+                         (primitives, texte agrandi, grands chiffres)
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ssd1306_gfx.h"
+#include "font6x8.h"
+
+#define W      SSD1306_GFX_WIDTH
+#define H      SSD1306_GFX_HEIGHT
+#define FB_LEN (W * SSD1306_GFX_PAGES)
+
+/** -------------------------------------------------------------------------- --
+   Ancien chemin : copie de l’ancien ssd1306_draw_pixel
+-- -------------------------------------------------------------------------- */
+static void draw_pixel(uint8_t* fb, int x, int y, bool color)
+{
+    if (x < 0 || x >= 128 || y < 0 || y >= 64) return;
+    uint16_t byte_idx = x + (y / 8) * 128;
+    uint8_t bit = 1 << (y % 8);
+    if (color)
+        fb[byte_idx] |= bit;
+    else
+        fb[byte_idx] &= ~bit;
+}
+
+static bool get_pixel(const uint8_t* fb, int x, int y)
+{
+    return (fb[(y / 8) * W + x] >> (y % 8)) & 1;
+}
+
+static void plot(uint8_t* fb, int x, int y, bool bit, ssd1306_mode_t mode)
+{
+    if (x < 0 || x >= W || y < 0 || y >= H) return;
+    switch (mode) {
+    case SSD1306_MODE_SET:   if (bit) draw_pixel(fb, x, y, true); break;
+    case SSD1306_MODE_CLEAR: if (bit) draw_pixel(fb, x, y, false); break;
+    case SSD1306_MODE_XOR:   if (bit) draw_pixel(fb, x, y, !get_pixel(fb, x, y)); break;
+    case SSD1306_MODE_COPY:  draw_pixel(fb, x, y, bit); break;
+    }
+}
+
+static void ref_fill_rect(uint8_t* fb, int x, int y, int w, int h, ssd1306_mode_t mode)
+{
+    for (int dx = 0; dx < w; dx++)
+        for (int dy = 0; dy < h; dy++)
+            plot(fb, x + dx, y + dy, true, mode);
+}
+
+static void ref_draw_frame(uint8_t* fb, int x, int y, int w, int h, ssd1306_mode_t mode)
+{
+    if (w <= 0 || h <= 0) return;
+    for (int i = 0; i < w; i++) {
+        plot(fb, x + i, y, true, mode);
+        if (h > 1) plot(fb, x + i, y + h - 1, true, mode);
+    }
+    for (int j = 1; j < h - 1; j++) {
+        plot(fb, x, y + j, true, mode);
+        if (w > 1) plot(fb, x + w - 1, y + j, true, mode);
+    }
+}
+
+static void ref_blit(uint8_t* fb, int x, int y, int w, int h, const uint8_t* data, ssd1306_mode_t mode)
+{
+    for (int j = 0; j < h; j++)
+        for (int i = 0; i < w; i++)
+            plot(fb, x + i, y + j, (data[(j / 8) * w + i] >> (j % 8)) & 1, mode);
+}
+
+/* Ancien ssd1306_draw_bitmap */
+static void ref_blit_rows(uint8_t* fb, int x, int y, int w, int h, const uint8_t* data, ssd1306_mode_t mode)
+{
+    for (int j = 0; j < h; j++) {
+        for (int i = 0; i < w; i++) {
+            int byte = (j * w + i) / 8;
+            int bit = 7 - ((j * w + i) % 8);
+            plot(fb, x + i, y + j, (data[byte] >> bit) & 1, mode);
+        }
+    }
+}
+
+/* Texte agrandi calculé pixel par pixel depuis font6x8 */
+static void ref_draw_string(uint8_t* fb, int x, int page, const char* str, int scale, bool invert)
+{
+    for (; *str; str++) {
+        if (*str < 32 || *str > 126) continue;
+        const uint8_t* chr = font6x8[*str - 32];
+        for (int col = 0; col < 6 * scale; col++) {
+            for (int row = 0; row < 8 * scale; row++) {
+                bool on = (chr[col / scale] >> (row / scale)) & 1;
+                plot(fb, x + col, page * 8 + row, on != invert, SSD1306_MODE_COPY);
+            }
+        }
+        x += 6 * scale;
+    }
+}
+
+/** -------------------------------------------------------------------------- --
+   Outils
+-- -------------------------------------------------------------------------- */
+static uint8_t bitmap_full[FB_LEN];
+
+static void random_fill(uint8_t* p, size_t n)
+{
+    for (size_t i = 0; i < n; i++) p[i] = (uint8_t)rand();
+}
+
+static double now_s(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static volatile uint8_t sink;
+
+/** -------------------------------------------------------------------------- --
+   Vérification : opérations aléatoires, clipping compris
+-- -------------------------------------------------------------------------- */
+static int check(void)
+{
+    static uint8_t a[FB_LEN], b[FB_LEN];
+    static uint8_t bmp[48 * 48];
+    static const char* names[] = { "fill_rect", "draw_frame", "blit", "blit_rows" };
+    int failures = 0;
+
+    srand(1234);
+    for (int iter = 0; iter < 20000; iter++) {
+        random_fill(a, sizeof(a));
+        memcpy(b, a, sizeof(a));
+        random_fill(bmp, sizeof(bmp));
+
+        int x = rand() % 176 - 24;
+        int y = rand() % 112 - 24;
+        int w = rand() % 48 + 1;
+        int h = rand() % 48 + 1;
+        ssd1306_mode_t mode = (ssd1306_mode_t)(rand() % 4);
+        int op = rand() % 4;
+        uint8_t dirty = 0;
+
+        switch (op) {
+        case 0: dirty = ssd1306_gfx_fill_rect(a, x, y, w, h, mode);       ref_fill_rect(b, x, y, w, h, mode); break;
+        case 1: dirty = ssd1306_gfx_draw_frame(a, x, y, w, h, mode);      ref_draw_frame(b, x, y, w, h, mode); break;
+        case 2: dirty = ssd1306_gfx_blit(a, x, y, w, h, bmp, mode);       ref_blit(b, x, y, w, h, bmp, mode); break;
+        default: dirty = ssd1306_gfx_blit_rows(a, x, y, w, h, bmp, mode); ref_blit_rows(b, x, y, w, h, bmp, mode); break;
+        }
+
+        bool ok = memcmp(a, b, sizeof(a)) == 0;
+        /* Toute page modifiée doit figurer dans le masque retourné */
+        for (int p = 0; ok && p < SSD1306_GFX_PAGES; p++) {
+            if (!(dirty & (1u << p)) && memcmp(&a[p * W], &b[p * W], W) != 0) ok = false;
+        }
+        if (!ok && failures++ < 10) {
+            printf("ECHEC %s mode=%d x=%d y=%d w=%d h=%d\n", names[op], mode, x, y, w, h);
+        }
+    }
+
+    printf("%s (%d ecart(s) sur 20000 operations)\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
+
+static int check_text(void)
+{
+    static uint8_t a[FB_LEN], b[FB_LEN];
+    static const char* samples[] = { "12:34", "Douche", "05:00 +9s", "~!Az", "Nom tres long depasse" };
+    int failures = 0;
+
+    for (int scale = 1; scale <= 4; scale++) {
+        for (size_t s = 0; s < sizeof(samples) / sizeof(samples[0]); s++) {
+            for (int x = -13; x < 128; x += 29) {
+                for (int page = 0; page < SSD1306_GFX_PAGES; page += 3) {
+                    bool invert = (x + page) & 1;
+                    random_fill(a, sizeof(a));
+                    memcpy(b, a, sizeof(a));
+                    ssd1306_gfx_draw_string(a, x, page, samples[s], scale, invert);
+                    ref_draw_string(b, x, page, samples[s], scale, invert);
+                    if (memcmp(a, b, sizeof(a)) != 0 && failures++ < 10) {
+                        printf("ECHEC texte x%d \"%s\" x=%d page=%d\n", scale, samples[s], x, page);
+                    }
+                }
+            }
+        }
+    }
+
+    /* Grands chiffres : 4 pages exactement, clippés, sans déborder */
+    memset(a, 0, sizeof(a));
+    uint8_t dirty = ssd1306_gfx_draw_big_digits(a, 20, 1, "88:88");
+    if (dirty != 0x1E || ssd1306_gfx_big_digits_width("88:88") != 88) {
+        printf("ECHEC grands chiffres : pages 0x%02X\n", dirty);
+        failures++;
+    }
+    for (int i = 0; i < W; i++) {
+        if (a[i] || a[5 * W + i] || ((i < 20 || i >= 108) && (a[W + i] | a[2 * W + i] | a[3 * W + i] | a[4 * W + i]))) {
+            printf("ECHEC grands chiffres : colonne %d hors zone\n", i);
+            failures++;
+            break;
+        }
+    }
+    /* Débordement à gauche, à droite et en bas : ne doit rien écrire hors du tampon */
+    memset(a, 0, sizeof(a));
+    ssd1306_gfx_draw_big_digits(a, -30, 6, "12:34");
+    ssd1306_gfx_draw_big_digits(a, 100, 0, "99");
+
+    printf("%s texte (%d ecart(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
+
+/** -------------------------------------------------------------------------- --
+   Mesure
+-- -------------------------------------------------------------------------- */
+typedef void (*draw_fn)(uint8_t* fb);
+
+static void new_fill_screen(uint8_t* fb)   { ssd1306_gfx_fill_rect(fb, 0, 0, 128, 64, SSD1306_MODE_SET); }
+static void old_fill_screen(uint8_t* fb)   { ref_fill_rect(fb, 0, 0, 128, 64, SSD1306_MODE_SET); }
+static void new_invert_screen(uint8_t* fb) { ssd1306_gfx_fill_rect(fb, 0, 0, 128, 64, SSD1306_MODE_XOR); }
+static void old_invert_screen(uint8_t* fb) { ref_fill_rect(fb, 0, 0, 128, 64, SSD1306_MODE_XOR); }
+static void new_gauge(uint8_t* fb)         { ssd1306_gfx_fill_rect(fb, 101, 23, 18, 36, SSD1306_MODE_SET); }
+static void old_gauge(uint8_t* fb)         { ref_fill_rect(fb, 101, 23, 18, 36, SSD1306_MODE_SET); }
+static void new_frame(uint8_t* fb)         { ssd1306_gfx_draw_frame(fb, 100, 10, 20, 50, SSD1306_MODE_SET); }
+static void old_frame(uint8_t* fb)         { ref_draw_frame(fb, 100, 10, 20, 50, SSD1306_MODE_SET); }
+static void new_blit_aligned(uint8_t* fb)  { ssd1306_gfx_blit(fb, 0, 0, 128, 64, bitmap_full, SSD1306_MODE_COPY); }
+static void old_blit_aligned(uint8_t* fb)  { ref_blit(fb, 0, 0, 128, 64, bitmap_full, SSD1306_MODE_COPY); }
+static void new_blit_shifted(uint8_t* fb)  { ssd1306_gfx_blit(fb, 0, 3, 128, 61, bitmap_full, SSD1306_MODE_XOR); }
+static void old_blit_shifted(uint8_t* fb)  { ref_blit(fb, 0, 3, 128, 61, bitmap_full, SSD1306_MODE_XOR); }
+static void new_countdown(uint8_t* fb)     { ssd1306_gfx_draw_big_digits(fb, 20, 1, "04:59"); }
+static void old_countdown(uint8_t* fb)     { ref_draw_string(fb, 4, 1, "04:59", 4, false); }
+static void new_blit_rows(uint8_t* fb)     { ssd1306_gfx_blit_rows(fb, 0, 0, 128, 64, bitmap_full, SSD1306_MODE_COPY); }
+static void old_blit_rows(uint8_t* fb)     { ref_blit_rows(fb, 0, 0, 128, 64, bitmap_full, SSD1306_MODE_COPY); }
+
+static double time_us(draw_fn fn, int iterations)
+{
+    static uint8_t fb[FB_LEN];
+    double t0 = now_s();
+    for (int i = 0; i < iterations; i++) {
+        fn(fb);
+        sink ^= fb[i & (FB_LEN - 1)];
+    }
+    return (now_s() - t0) * 1e6 / iterations;
+}
+
+static void bench(void)
+{
+    static const struct {
+        const char* name;
+        draw_fn old_fn;
+        draw_fn new_fn;
+    } cases[] = {
+        { "remplissage plein ecran",     old_fill_screen,   new_fill_screen },
+        { "inversion plein ecran (XOR)", old_invert_screen, new_invert_screen },
+        { "jauge 18x36 non alignee",     old_gauge,         new_gauge },
+        { "cadre 20x50",                 old_frame,         new_frame },
+        { "bitmap page 128x64 aligne",   old_blit_aligned,  new_blit_aligned },
+        { "bitmap page 128x61 (XOR)",    old_blit_shifted,  new_blit_shifted },
+        { "bitmap lignes 128x64",        old_blit_rows,     new_blit_rows },
+        { "compte a rebours (x4 / 7seg)", old_countdown,    new_countdown },
+    };
+    const int iterations = 2000;
+
+    random_fill(bitmap_full, sizeof(bitmap_full));
+    printf("%-30s %12s %12s %8s\n", "operation", "pixel (us)", "octet (us)", "gain");
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        double t_old = time_us(cases[i].old_fn, iterations);
+        double t_new = time_us(cases[i].new_fn, iterations);
+        printf("%-30s %12.3f %12.3f %7.1fx\n", cases[i].name, t_old, t_new, t_old / t_new);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strcmp(argv[1], "--check") == 0) {
+        return check() | check_text();
+    }
+    bench();
+    return 0;
+}
@@ -0,0 +1,297 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: bench_jitter.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Retard des réveils de la tâche minuteur pendant que l’écran se
+   remplit (exécuté sur PC, threads POSIX épinglés sur un seul cœur,
+   priorités temps réel des tâches FreeRTOS si le système le permet).
+
+   Un thread « minuteur » se réveille sur des échéances irrégulières
+   (5 à 40 ms, suite fixe) et, à chacune, dessine comme timer_manager.c
+   avec les vraies fonctions oled_* : par cycles de quatre échéances,
+   écran « Debut douche ! », écran du minuteur, puis deux secondes de
+   compte à rebours. Le bus I2C est simulé
+   par l’émulateur : chaque tranche envoyée bloque l’appelant le temps
+   qu’elle prendrait à 400 kHz. Trois variantes de display_begin /
+   display_commit :
+     repos    aucun dessin (référence)
+     direct   envoi I2C dans le thread minuteur (avant la tâche d’affichage)
+     tache    copie sous verrou puis envoi par un thread d’affichage, comme
+              main/display_task.c
+   Le retard d’un réveil est l’écart entre l’échéance et le réveil
+   effectif du thread minuteur ; on compte aussi les réveils en retard de
+   plus de LATE_US (sur PC, quelques-uns viennent du système lui-même).
+
+     bench_jitter            tableau des retards (400 échéances par variante)
+     bench_jitter --check    vérifie que le retard reste plat avec la tâche
+                             d’affichage (100 échéances par variante)
+
+-- ========================================================================== */
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ssd1306.h"
+#include "ssd1306_emu.h"
+#include "oled_display.h"
+#include "display_task.h"
+
+#define OLED_ADDR       0x3C
+#define I2C_PORT        I2C_NUM_0
+
+#define DEADLINES       400
+#define CHECK_DEADLINES 100
+#define LATE_US         5000          // Réveil nettement en retard
+
+#define TIMER_PRIO      6             // Comme timer_manager_task
+#define DISPLAY_PRIO    4             // Comme display_task (DISPLAY_TASK_PRIO)
+
+typedef enum { MODE_IDLE, MODE_DIRECT, MODE_TASK } mode_t_;
+
+static const char* mode_names[] = { "repos", "direct", "tache" };
+
+typedef struct {
+    int64_t p50_us;
+    int64_t p99_us;
+    int64_t max_us;
+    int late;                         // Réveils en retard de plus de LATE_US
+    uint32_t frames;
+    double bus_ms;
+} result_t;
+
+static mode_t_ mode;
+static ssd1306_t* dev;
+static uint32_t frames;
+
+/* Thread d’affichage (MODE_TASK) */
+static pthread_mutex_t draw_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t notify_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t notify_cond = PTHREAD_COND_INITIALIZER;
+static bool notified;
+static bool stopping;
+
+static int64_t now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void sleep_until_us(int64_t t)
+{
+    struct timespec ts = { .tv_sec = t / 1000000, .tv_nsec = (t % 1000000) * 1000 };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0) {
+    }
+}
+
+/* Une tranche d’envoi ; l’appelant reste bloqué le temps du transfert
+   sur le bus, comme avec le pilote I2C de l’ESP32 */
+static bool send_round_blocking(void)
+{
+    ssd1306_emu_t* emu = ssd1306_emu_get(I2C_PORT, OLED_ADDR);
+    double before = emu->traffic.bus_us;
+    bool pending = ssd1306_send_round(&dev, 1);
+    sleep_until_us(now_us() + (int64_t)(emu->traffic.bus_us - before));
+    return pending;
+}
+
+/** -------------------------------------------------------------------------- --
+   display_task.h pour le banc
+-- -------------------------------------------------------------------------- */
+void display_init(void)
+{
+}
+
+void display_attach(ssd1306_t* d)
+{
+}
+
+void display_begin(void)
+{
+    if (mode == MODE_TASK) pthread_mutex_lock(&draw_lock);
+}
+
+void display_commit(void)
+{
+    if (mode == MODE_DIRECT) {
+        if (ssd1306_dev_commit(dev)) {
+            while (send_round_blocking()) {
+            }
+            frames++;
+        }
+    } else if (mode == MODE_TASK) {
+        pthread_mutex_unlock(&draw_lock);
+        pthread_mutex_lock(&notify_lock);
+        notified = true;
+        pthread_cond_signal(&notify_cond);
+        pthread_mutex_unlock(&notify_lock);
+    }
+}
+
+void display_get_stats(display_stats_t* out)
+{
+    memset(out, 0, sizeof(*out));
+    out->frames = frames;
+}
+
+/* Boucle de main/display_task.c : validation sous verrou, envoi sans */
+static bool take_notification(bool wait)
+{
+    pthread_mutex_lock(&notify_lock);
+    while (wait && !notified && !stopping) {
+        pthread_cond_wait(&notify_cond, &notify_lock);
+    }
+    bool got = notified;
+    notified = false;
+    pthread_mutex_unlock(&notify_lock);
+    return got;
+}
+
+static void* display_thread(void* arg)
+{
+    struct sched_param prio = { .sched_priority = DISPLAY_PRIO };
+    bool busy = false;
+
+    pthread_setschedparam(pthread_self(), SCHED_FIFO, &prio);
+
+    while (take_notification(true)) {
+        bool pending;
+        do {
+            pthread_mutex_lock(&draw_lock);
+            if (!busy && ssd1306_dev_commit(dev)) busy = true;
+            pthread_mutex_unlock(&draw_lock);
+
+            pending = send_round_blocking();
+
+            if (busy && !ssd1306_dev_busy(dev)) {
+                busy = false;
+                frames++;
+            }
+        } while (pending || take_notification(false));
+    }
+    return NULL;
+}
+
+/** -------------------------------------------------------------------------- --
+   Thread minuteur
+-- -------------------------------------------------------------------------- */
+static int cmp_i64(const void* a, const void* b)
+{
+    int64_t x = *(const int64_t*)a, y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static result_t run(mode_t_ m, int count)
+{
+    static const char* names[] = { "alice", "bob" };
+    int64_t late[DEADLINES];
+    oled_timer_screen_t screen;
+    pthread_t display;
+    uint32_t seed = 12345;
+    result_t r;
+
+    ssd1306_emu_reset_all();
+    oled_init();
+    dev = ssd1306_default();
+    memset(&screen, 0, sizeof(screen));
+    mode = m;
+    frames = 0;
+    notified = stopping = false;
+    if (m == MODE_TASK) pthread_create(&display, NULL, display_thread, NULL);
+    ssd1306_emu_clear_traffic(ssd1306_emu_get(I2C_PORT, OLED_ADDR));
+
+    int64_t due = now_us() + 10000;
+    for (int i = 0; i < count; i++) {
+        seed = seed * 1103515245u + 12345u;
+        due += 5000 + (int64_t)((seed >> 16) % 35001);
+        sleep_until_us(due);
+        late[i] = now_us() - due;
+
+        if (m == MODE_IDLE) continue;
+        uint32_t remain = 300 - (uint32_t)i % 300;
+        switch (i % 4) {
+        case 0:
+            display_begin();
+            oled_dev_clear(dev);
+            oled_dev_display_centered(dev, "Debut douche !", 3);
+            display_commit();
+            memset(&screen, 0, sizeof(screen));
+            break;
+        case 1:
+            oled_dev_timer_screen_show(&screen, dev, names[(i / 4) % 2], remain);
+            break;
+        default:
+            oled_dev_timer_screen_update(&screen, remain, (uint8_t)(i % 100));
+            break;
+        }
+    }
+
+    if (m == MODE_TASK) {
+        pthread_mutex_lock(&notify_lock);
+        stopping = true;
+        pthread_cond_signal(&notify_cond);
+        pthread_mutex_unlock(&notify_lock);
+        pthread_join(display, NULL);
+    }
+
+    qsort(late, (size_t)count, sizeof(late[0]), cmp_i64);
+    r.p50_us = late[count / 2];
+    r.p99_us = late[(count * 99) / 100];
+    r.max_us = late[count - 1];
+    r.late = 0;
+    for (int i = 0; i < count; i++) {
+        if (late[i] > LATE_US) r.late++;
+    }
+    r.frames = frames;
+    r.bus_ms = ssd1306_emu_get(I2C_PORT, OLED_ADDR)->traffic.bus_us / 1000.0;
+    return r;
+}
+
+int main(int argc, char** argv)
+{
+    bool check = argc > 1 && strcmp(argv[1], "--check") == 0;
+    int count = check ? CHECK_DEADLINES : DEADLINES;
+    result_t r[3];
+    cpu_set_t cpus;
+
+    // Un seul cœur, comme les tâches minuteur et affichage sur l’ESP32
+    CPU_ZERO(&cpus);
+    CPU_SET(0, &cpus);
+    sched_setaffinity(0, sizeof(cpus), &cpus);
+    struct sched_param prio = { .sched_priority = TIMER_PRIO };
+    bool rt = sched_setscheduler(0, SCHED_FIFO, &prio) == 0;
+    printf("Ordonnancement %s\n", rt ? "temps reel (priorites FreeRTOS)" : "par defaut (droits insuffisants)");
+
+    printf("%-8s %8s %7s %9s %9s %9s %9s %7s\n", "variante", "echeanc.", "images",
+           "bus (ms)", "p50 (us)", "p99 (us)", "max (us)", "> 5 ms");
+    for (int m = MODE_IDLE; m <= MODE_TASK; m++) {
+        r[m] = run((mode_t_)m, count);
+        printf("%-8s %8d %7lu %9.1f %9lld %9lld %9lld %7d\n", mode_names[m], count,
+               (unsigned long)r[m].frames, r[m].bus_ms, (long long)r[m].p50_us,
+               (long long)r[m].p99_us, (long long)r[m].max_us, r[m].late);
+    }
+
+    if (!check) return 0;
+
+    // Avec la tâche d’affichage, le retard ne suit plus la durée des envois
+    int failures = 0;
+    if (r[MODE_DIRECT].frames == 0 || r[MODE_TASK].frames == 0) {
+        printf("ECHEC : aucune image envoyee\n");
+        failures++;
+    }
+    if (r[MODE_TASK].late * 2 > r[MODE_DIRECT].late) {
+        printf("ECHEC : retards avec la tache d'affichage comparables a l'envoi direct\n");
+        failures++;
+    }
+    printf("%s (%d echec(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
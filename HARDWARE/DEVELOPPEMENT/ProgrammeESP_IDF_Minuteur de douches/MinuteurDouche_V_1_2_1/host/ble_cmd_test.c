@@ -0,0 +1,207 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ble_cmd_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test des commandes binaires (main/ble_cmd.c) : écriture de référence
+   enchaînant plusieurs commandes (mêmes octets que test_commandes.py
+   côté pont), réponses groupées au MTU par défaut et au MTU négocié,
+   longueurs refusées, opcode inconnu, écriture tronquée.
+
+     ble_cmd_test           code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "ble_cmd.h"
+
+static int failures;
+
+static void check(const char* what, int ok)
+{
+    if (!ok) {
+        printf("ECHEC : %s\n", what);
+        failures++;
+    }
+}
+
+/* Octets de référence : à modifier des deux côtés (test_commandes.py) */
+static const char GOLDEN_REQ_HEX[] =
+    "01010601616c696365"            // SELECT_USER  #1 cabine 1 "alice"
+    "02020300f000"                  // SET_BUDGET   #2 cabine 0, 240 s
+    "030301" "00"                   // START        #3 cabine 0
+    "040401" "09"                   // STOP         #4 cabine 9 (refusée)
+    "050501" "00"                   // STATUS       #5 cabine 0
+    "0606042a000000"                // HISTORY      #6 après 42
+    "7f0700"                        // opcode inconnu #7
+    "080801" "00";                  // REBOOT       #8 avec argument (refusé)
+static const char GOLDEN_RESP_HEX[] =
+    "81010000"
+    "82020000"
+    "83030000"
+    "84040300"
+    "8505000e" "00017d0000002c01f00003000000"
+    "86060000"
+    "ff070100"
+    "88080200";
+
+/* Minuteur simulé */
+typedef struct {
+    char user[32];
+    uint8_t user_stall;
+    uint16_t budget_s;
+    int started, stopped, reboot;
+    uint32_t history;
+} fake_t;
+
+static ble_cmd_status_t on_select(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    fake_t* f = ctx;
+    f->user_stall = arg[0];
+    memcpy(f->user, arg + 1, len - 1);
+    f->user[len - 1] = '\0';
+    return BLE_CMD_OK;
+}
+
+static ble_cmd_status_t on_budget(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    ((fake_t*)ctx)->budget_s = ble_cmd_get_u16(arg + 1);
+    return BLE_CMD_OK;
+}
+
+static ble_cmd_status_t on_start(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    ((fake_t*)ctx)->started++;
+    return BLE_CMD_OK;
+}
+
+static ble_cmd_status_t on_stop(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    if (arg[0] != 0) return BLE_CMD_E_ARG;
+    ((fake_t*)ctx)->stopped++;
+    return BLE_CMD_OK;
+}
+
+static ble_cmd_status_t on_status(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    ble_cmd_stall_status_t st = { .stall = arg[0], .state = 1, .elapsed_s = 125,
+                                  .duration_s = 300, .budget_s = 240, .sessions = 3 };
+    *out_len = ble_cmd_put_stall_status(out, &st);
+    return BLE_CMD_OK;
+}
+
+static ble_cmd_status_t on_history(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    ((fake_t*)ctx)->history = ble_cmd_get_u32(arg);
+    return BLE_CMD_OK;
+}
+
+static ble_cmd_status_t on_reboot(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    ((fake_t*)ctx)->reboot = 1;
+    return BLE_CMD_OK;
+}
+
+static const ble_cmd_def_t table[BLE_CMD_OPCODES] = {
+    [BLE_CMD_SELECT_USER] = { on_select,  2, 32 },
+    [BLE_CMD_SET_BUDGET]  = { on_budget,  3, 34 },
+    [BLE_CMD_START]       = { on_start,   1, 32 },
+    [BLE_CMD_STOP]        = { on_stop,    1, 1 },
+    [BLE_CMD_STATUS]      = { on_status,  1, 1 },
+    [BLE_CMD_HISTORY]     = { on_history, 4, 4 },
+    [BLE_CMD_REBOOT]      = { on_reboot,  0, 0 },
+};
+
+/* Notifications émises */
+typedef struct {
+    uint8_t bytes[2048];
+    size_t len;
+    int notifications;
+    size_t largest;
+} sink_t;
+
+static void emit(void* ctx, const uint8_t* data, size_t len)
+{
+    sink_t* s = ctx;
+    memcpy(s->bytes + s->len, data, len);
+    s->len += len;
+    s->notifications++;
+    if (len > s->largest) s->largest = len;
+}
+
+static size_t unhex(const char* hex, uint8_t* out)
+{
+    size_t n = strlen(hex) / 2;
+    for (size_t i = 0; i < n; i++) {
+        unsigned v;
+        sscanf(hex + 2 * i, "%2x", &v);
+        out[i] = (uint8_t)v;
+    }
+    return n;
+}
+
+static size_t run(const uint8_t* in, size_t len, size_t out_max, fake_t* f, sink_t* s)
+{
+    uint8_t out[512];
+    memset(f, 0, sizeof(*f));
+    memset(s, 0, sizeof(*s));
+    return ble_cmd_process(table, BLE_CMD_OPCODES, f, in, len, out, out_max, emit, s);
+}
+
+int main(void)
+{
+    uint8_t req[256], resp[256];
+    size_t req_len = unhex(GOLDEN_REQ_HEX, req);
+    size_t resp_len = unhex(GOLDEN_RESP_HEX, resp);
+    fake_t f;
+    sink_t s;
+
+    // Écriture de référence, MTU négocié : toutes les réponses en une notification
+    check("8 commandes", run(req, req_len, 185 - 3, &f, &s) == 8);
+    check("reponses de reference", s.len == resp_len && memcmp(s.bytes, resp, resp_len) == 0);
+    check("une notification", s.notifications == 1);
+    check("effets", strcmp(f.user, "alice") == 0 && f.user_stall == 1 && f.budget_s == 240 &&
+                    f.started == 1 && f.stopped == 0 && f.history == 42 && f.reboot == 0);
+
+    // MTU par défaut : mêmes octets, jamais une réponse coupée
+    check("MTU 23", run(req, req_len, 23 - 3, &f, &s) == 8 && s.len == resp_len &&
+                    memcmp(s.bytes, resp, resp_len) == 0 && s.largest <= 20 && s.notifications >= 4);
+
+    // Commande seule, sans argument
+    uint8_t reboot[] = { BLE_CMD_REBOOT, 0x2a, 0 };
+    check("reboot", run(reboot, sizeof(reboot), 20, &f, &s) == 1 && f.reboot == 1 &&
+                    s.len == 4 && s.bytes[0] == (BLE_CMD_REBOOT | BLE_CMD_RESP) && s.bytes[1] == 0x2a &&
+                    s.bytes[2] == BLE_CMD_OK);
+
+    // Écriture tronquée : les commandes complètes passent, la dernière est signalée
+    check("tronquee", run(req, 18, 182, &f, &s) == 3 && strcmp(f.user, "alice") == 0 &&
+                      s.len == 12 && s.bytes[8] == (BLE_CMD_START | BLE_CMD_RESP) &&
+                      s.bytes[9] == 3 && s.bytes[10] == BLE_CMD_E_TRUNCATED && f.started == 0);
+    check("un octet", run(req, 1, 182, &f, &s) == 1 && s.bytes[1] == 0 && s.bytes[2] == BLE_CMD_E_TRUNCATED);
+    check("vide", run(req, 0, 182, &f, &s) == 0 && s.notifications == 0);
+
+    // Opcode de réponse ou hors table : inconnu, sans lecture hors de la table
+    uint8_t unknown[] = { 0xff, 1, 0, BLE_CMD_OPCODES, 2, 0 };
+    check("inconnus", run(unknown, sizeof(unknown), 182, &f, &s) == 2 &&
+                      s.bytes[2] == BLE_CMD_E_UNKNOWN && s.bytes[6] == BLE_CMD_E_UNKNOWN);
+
+    // Enchaînement long : 60 STATUS en une écriture
+    uint8_t many[60 * 4];
+    for (int i = 0; i < 60; i++) {
+        many[4 * i] = BLE_CMD_STATUS;
+        many[4 * i + 1] = (uint8_t)i;
+        many[4 * i + 2] = 1;
+        many[4 * i + 3] = 0;
+    }
+    check("60 commandes", run(many, sizeof(many), 182, &f, &s) == 60 && s.len == 60 * 18 &&
+                          s.notifications == 6 && s.bytes[59 * 18 + 1] == 59);
+    printf("60 STATUS : %d notification(s) au MTU 185\n", s.notifications);
+
+    printf("%s (%d ecart(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,297 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ble_tx_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test du moteur d’envoi des notifications (main/ble_tx.c) sur une
+   liaison simulée : file de la pile BLE limitée (refus quand elle est
+   pleine), confirmations aléatoires, congestions, échec de la pile,
+   déconnexion. Un récepteur rassemble les fragments comme le pont.
+   Vérifie : blocs reçus intacts pour plusieurs MTU, fenêtre respectée,
+   rien d’envoyé pendant une congestion, plus de 255 fragments (et
+   numéro qui repasse par 0), un seul compte rendu par bloc, échecs
+   tardifs d’un bloc abandonné sans effet sur le suivant, refus différé
+   de la pile, débit
+   mesuré juste. Affiche la durée d’un bloc comparée à l’ancien envoi
+   (20 ms entre fragments), liaison simulée.
+
+     ble_tx_test            code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ble_tx.h"
+
+#define WINDOW          6
+#define STACK_DEPTH     4                    // File de la pile : refus au-delà
+#define STEP_US         250                  // Pas de la liaison simulée
+#define MAX_BLOCK       (1200 * 1024)
+
+static int failures;
+
+static void check(const char* what, int ok)
+{
+    if (!ok) {
+        printf("ECHEC : %s\n", what);
+        failures++;
+    }
+}
+
+/* Récepteur : même règles que fragments.py dans le pont */
+typedef struct {
+    uint8_t* buf;
+    size_t len;
+    bool open;
+    uint16_t next;
+    unsigned blocks;                         // Blocs complets reçus
+    unsigned dropped;                        // Blocs incomplets rejetés
+} receiver_t;
+
+static void rx_notification(receiver_t* rx, const uint8_t* p, uint16_t len)
+{
+    if (len >= BLE_TX_FRAG_HEADER && p[0] == BLE_TX_FRAG_MAGIC) {
+        uint8_t flags = p[1];
+        uint16_t index = (uint16_t)(p[2] | p[3] << 8);
+        if (flags & BLE_TX_FRAG_FIRST) {
+            if (rx->open) rx->dropped++;
+            rx->open = index == 0;
+            rx->len = 0;
+        } else if (!rx->open || index != rx->next) {
+            if (rx->open) rx->dropped++;
+            rx->open = false;
+            return;
+        }
+        memcpy(rx->buf + rx->len, p + BLE_TX_FRAG_HEADER, len - BLE_TX_FRAG_HEADER);
+        rx->len += len - BLE_TX_FRAG_HEADER;
+        rx->next = (uint16_t)(index + 1);
+        if (flags & BLE_TX_FRAG_LAST) {
+            rx->open = false;
+            rx->blocks++;
+        }
+        return;
+    }
+    if (rx->open) rx->dropped++;
+    rx->open = false;
+    memcpy(rx->buf, p, len);
+    rx->len = len;
+    rx->blocks++;
+}
+
+/* Liaison simulée : notifications confiées à la pile, livrées dans l’ordre */
+typedef struct {
+    uint8_t data[STACK_DEPTH + WINDOW][BLE_TX_NTF_MAX];
+    uint16_t len[STACK_DEPTH + WINDOW];
+    unsigned head, count;
+    unsigned mtu;
+    bool congested;
+    bool refuse;                             // Pile indisponible
+    unsigned sent_while_congested;
+    unsigned too_long;
+    unsigned max_in_flight;
+    receiver_t* rx;
+} link_t;
+
+static bool link_send(void* ctx, const uint8_t* data, uint16_t len)
+{
+    link_t* l = ctx;
+    if (l->refuse || l->count >= STACK_DEPTH) return false;
+    if (l->congested) l->sent_while_congested++;
+    if (len > l->mtu - 3) l->too_long++;
+    unsigned slot = (l->head + l->count) % (STACK_DEPTH + WINDOW);
+    memcpy(l->data[slot], data, len);
+    l->len[slot] = len;
+    l->count++;
+    if (l->count > l->max_in_flight) l->max_in_flight = l->count;
+    return true;
+}
+
+/* Livre la plus ancienne notification et la confirme au moteur */
+static ble_tx_status_t link_deliver(link_t* l, ble_tx_t* tx, bool ok, int64_t now)
+{
+    unsigned slot = l->head;
+    l->head = (l->head + 1) % (STACK_DEPTH + WINDOW);
+    l->count--;
+    if (ok) rx_notification(l->rx, l->data[slot], l->len[slot]);
+    return ble_tx_on_sent(tx, ok, now);
+}
+
+static uint32_t rnd(void)
+{
+    static uint32_t s = 0x1234567u;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+/* Envoie un bloc sur la liaison aléatoire ; retourne le nombre de comptes rendus */
+static unsigned run_block(ble_tx_t* tx, link_t* l, const uint8_t* data, size_t len,
+                          bool congestion, int64_t* now, ble_tx_status_t* last)
+{
+    unsigned reports = 0;
+    ble_tx_status_t st = ble_tx_submit(tx, data, len, *now);
+    if (st != BLE_TX_PENDING) {
+        *last = st;
+        return 1;
+    }
+    while (ble_tx_busy(tx) || l->count) {
+        *now += STEP_US;
+        if (congestion && rnd() % 97 == 0) {
+            l->congested = !l->congested;
+            st = ble_tx_on_congest(tx, l->congested, *now);
+            if (st == BLE_TX_DONE || st == BLE_TX_FAILED) { reports++; *last = st; }
+        }
+        if (l->count && rnd() % 3 == 0) {
+            st = link_deliver(l, tx, true, *now);
+            if (st == BLE_TX_DONE || st == BLE_TX_FAILED) { reports++; *last = st; }
+        }
+    }
+    if (l->congested) {
+        l->congested = false;
+        ble_tx_on_congest(tx, false, *now);
+    }
+    return reports;
+}
+
+int main(void)
+{
+    static uint8_t block[MAX_BLOCK];
+    static receiver_t rx;
+    static link_t link;
+    static ble_tx_t tx;
+    int64_t now = 0;
+    ble_tx_status_t last;
+    char what[96];
+
+    rx.buf = malloc(MAX_BLOCK);
+    for (size_t i = 0; i < MAX_BLOCK; i++) block[i] = (uint8_t)(rnd() >> 7);
+    block[0] = 0xD5;                           // Trame du journal
+    link.rx = &rx;
+
+    // Blocs de toutes tailles sur plusieurs MTU (517 : notification bornée à 512),
+    // confirmations et congestions aléatoires
+    const unsigned mtus[] = { 23, 100, 185, 247, 517 };
+    for (unsigned m = 0; m < sizeof(mtus) / sizeof(mtus[0]); m++) {
+        unsigned payload = mtus[m] - 3 > BLE_TX_NTF_MAX ? BLE_TX_NTF_MAX : mtus[m] - 3;
+        const size_t sizes[] = { 1, payload, payload + 1, 72, 5000, 300 * (payload - 4) + 7 };
+        ble_tx_init(&tx, link_send, &link, WINDOW);
+        ble_tx_set_mtu(&tx, (uint16_t)mtus[m]);
+        link.mtu = payload + 3;
+        for (unsigned s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            size_t len = sizes[s];
+            size_t chunk = len > payload ? payload - 4 : payload;
+            unsigned want_ntf = (unsigned)((len + chunk - 1) / chunk);
+            unsigned blocks = rx.blocks;
+            memset(rx.buf, 0, len);
+            unsigned reports = run_block(&tx, &link, block, len, true, &now, &last);
+            snprintf(what, sizeof(what), "MTU %u, bloc de %zu octets", mtus[m], len);
+            check(what, reports == 1 && last == BLE_TX_DONE);
+            check(what, rx.blocks == blocks + 1 && rx.len == len && memcmp(rx.buf, block, len) == 0);
+            check(what, tx.stats.last_notifications == want_ntf && tx.stats.last_bytes == len);
+        }
+        snprintf(what, sizeof(what), "MTU %u : fenetre et congestion", mtus[m]);
+        check(what, link.max_in_flight <= WINDOW && link.sent_while_congested == 0 &&
+                    link.too_long == 0 && tx.stats.failures == 0 && rx.dropped == 0);
+    }
+    check("congestions vues", tx.stats.congestions > 0);
+
+    // Numéro de fragment qui repasse par 0 (plus de 65535 fragments)
+    ble_tx_init(&tx, link_send, &link, WINDOW);
+    link.mtu = BLE_TX_MTU_DEFAULT;
+    size_t huge = 66000u * 16u;
+    run_block(&tx, &link, block, huge, false, &now, &last);
+    check("66000 fragments", last == BLE_TX_DONE && rx.len == huge &&
+                             memcmp(rx.buf, block, huge) == 0 && tx.stats.last_notifications == 66000);
+
+    // Bloc court commençant par '#' : un seul fragment, pas pris pour un fragment
+    block[MAX_BLOCK - 10] = BLE_TX_FRAG_MAGIC;
+    run_block(&tx, &link, block + MAX_BLOCK - 10, 10, false, &now, &last);
+    check("bloc commencant par #", last == BLE_TX_DONE && rx.len == 10 &&
+                                   memcmp(rx.buf, block + MAX_BLOCK - 10, 10) == 0);
+
+    // Second bloc refusé pendant un envoi, pile indisponible
+    check("envoi en cours", ble_tx_submit(&tx, block, 4000, now) == BLE_TX_PENDING);
+    check("second bloc refuse", ble_tx_submit(&tx, block, 10, now) == BLE_TX_REJECTED);
+    while (link.count) link_deliver(&link, &tx, true, now);
+    link.refuse = true;
+    check("pile indisponible : echec immediat", ble_tx_submit(&tx, block, 10, now) == BLE_TX_FAILED &&
+                                                !ble_tx_busy(&tx));
+    link.refuse = false;
+
+    // Échec signalé par la pile au milieu d’un bloc : abandon, bloc incomplet rejeté
+    unsigned dropped = rx.dropped, blocks = rx.blocks;
+    check("echec : envoi", ble_tx_submit(&tx, block, 2000, now) == BLE_TX_PENDING);
+    link_deliver(&link, &tx, true, now);
+    check("echec : compte rendu", link_deliver(&link, &tx, false, now) == BLE_TX_FAILED);
+    while (link.count) check("echec : reste", link_deliver(&link, &tx, true, now) == BLE_TX_PENDING);
+    run_block(&tx, &link, block, 2000, false, &now, &last);
+    check("echec : bloc suivant", last == BLE_TX_DONE && rx.blocks == blocks + 1 &&
+                                  rx.dropped == dropped + 1 && memcmp(rx.buf, block, 2000) == 0);
+
+    // Échecs tardifs du bloc abandonné, reçus pendant le bloc suivant : ignorés
+    blocks = rx.blocks;
+    check("echec tardif : envoi", ble_tx_submit(&tx, block, 2000, now) == BLE_TX_PENDING);
+    check("echec tardif : abandon", link_deliver(&link, &tx, false, now) == BLE_TX_FAILED);
+    unsigned late = link.count;
+    check("echec tardif : bloc suivant", ble_tx_submit(&tx, block, 2000, now) == BLE_TX_PENDING);
+    for (unsigned i = 0; i < late; i++) {
+        check("echec tardif : ignore", link_deliver(&link, &tx, false, now) == BLE_TX_PENDING);
+    }
+    last = BLE_TX_PENDING;
+    while (last == BLE_TX_PENDING && link.count) last = link_deliver(&link, &tx, true, now);
+    check("echec tardif : bloc suivant recu", last == BLE_TX_DONE && rx.blocks == blocks + 1 &&
+                                              memcmp(rx.buf, block, 2000) == 0);
+
+    // Notifications acceptées puis refusées après coup : bloc abandonné, fenêtre rendue
+    link.count = 0;
+    link.head = 0;
+    check("refus differe : envoi", ble_tx_submit(&tx, block, 2000, now) == BLE_TX_PENDING);
+    unsigned queued = link.count;
+    link.count = 0;
+    check("refus differe : abandon", ble_tx_on_refused(&tx, now) == BLE_TX_FAILED);
+    for (unsigned i = 1; i < queued; i++) {
+        check("refus differe : reste", ble_tx_on_refused(&tx, now) == BLE_TX_PENDING);
+    }
+    check("refus differe : fenetre rendue", tx.in_flight == 0 && tx.stale == 0);
+    run_block(&tx, &link, block, 2000, false, &now, &last);
+    check("refus differe : bloc suivant", last == BLE_TX_DONE && memcmp(rx.buf, block, 2000) == 0);
+
+    // Déconnexion pendant un envoi : compte rendu d’échec, MTU par défaut
+    ble_tx_set_mtu(&tx, 247);
+    check("deconnexion : envoi", ble_tx_submit(&tx, block, 3000, now) == BLE_TX_PENDING);
+    check("deconnexion", ble_tx_reset(&tx) == BLE_TX_FAILED && !ble_tx_busy(&tx) &&
+                         tx.mtu == BLE_TX_MTU_DEFAULT && tx.in_flight == 0);
+    link.count = 0;
+    check("deconnexion sans envoi", ble_tx_reset(&tx) == BLE_TX_PENDING);
+
+    // Débit : une notification confirmée toutes les 1,25 ms (liaison simulée)
+    ble_tx_init(&tx, link_send, &link, WINDOW);
+    ble_tx_set_mtu(&tx, 185);
+    link.mtu = 185;
+    size_t len = 10 + 62 * 100;                // Journal de 100 douches
+    int64_t t0 = now;
+    check("debit : envoi", ble_tx_submit(&tx, block, len, now) == BLE_TX_PENDING);
+    last = BLE_TX_PENDING;
+    while (last == BLE_TX_PENDING) {
+        now += 1250;
+        last = link_deliver(&link, &tx, true, now);
+    }
+    uint32_t us = (uint32_t)(now - t0);
+    check("debit mesure", last == BLE_TX_DONE && tx.stats.last_us == us &&
+                          tx.stats.last_bytes_per_s == (uint32_t)((uint64_t)len * 1000000u / us));
+    unsigned old_frags = (unsigned)((len + 185 - 7 - 1) / (185 - 7));
+    printf("Bloc de %zu octets, MTU 185 : %u notifications en %.1f ms (%u o/s) ; "
+           "ancien envoi : %u x 20 ms = %u ms\n",
+           len, tx.stats.last_notifications, us / 1000.0, tx.stats.last_bytes_per_s,
+           old_frags, old_frags * 20);
+
+    free(rx.buf);
+    printf("%s (%d ecart(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
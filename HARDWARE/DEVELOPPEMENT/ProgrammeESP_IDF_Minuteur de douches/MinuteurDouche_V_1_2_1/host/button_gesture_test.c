@@ -0,0 +1,167 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: button_gesture_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test de la reconnaissance des gestes du bouton (main/button_gesture.c)
+   sur des séquences de transitions horodatées, rejouées comme le ferait
+   la tâche du bouton : transitions dans l’ordre, button_gesture_poll à
+   chaque échéance atteinte.
+
+   Scénarios : appui court, rebonds, impulsion parasite, appui long,
+   double appui, second appui trop lent, bouton tenu au démarrage.
+
+     button_gesture_test    code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "button_gesture.h"
+
+#define MS          1000LL
+#define MAX_EVENTS  8
+#define POLL_LAG_US 300              // Retard du réveil de la tâche sur l’échéance
+
+/* Transition brute : instant (ms) et niveau ; pressed = -1 termine */
+typedef struct {
+    int64_t t_ms;
+    int pressed;
+} edge_t;
+
+static int failures;
+
+/* Rejoue les transitions jusqu’à end_ms ; gestes reconnus dans out */
+static int replay(const edge_t* edges, bool held_at_boot, int64_t end_ms,
+                  button_gesture_t* out, int64_t* at_us)
+{
+    button_gesture_sm_t sm;
+    int count = 0;
+    bool level = held_at_boot;
+    int64_t end_us = end_ms * MS;
+
+    button_gesture_init(&sm, held_at_boot, 0);
+
+    for (size_t i = 0; ; i++) {
+        int64_t next_us = (edges[i].pressed < 0) ? end_us : edges[i].t_ms * MS;
+
+        // Échéances atteintes avant la transition suivante
+        int64_t deadline;
+        while ((deadline = button_gesture_deadline(&sm)) != BUTTON_NO_DEADLINE &&
+               deadline + POLL_LAG_US <= next_us) {
+            button_gesture_t g = button_gesture_poll(&sm, level, deadline + POLL_LAG_US);
+            if (g != BUTTON_GESTURE_NONE && count < MAX_EVENTS) {
+                at_us[count] = deadline + POLL_LAG_US;
+                out[count++] = g;
+            }
+        }
+        if (edges[i].pressed < 0) break;
+
+        level = edges[i].pressed;
+        button_gesture_t g = button_gesture_edge(&sm, level, next_us);
+        if (g != BUTTON_GESTURE_NONE && count < MAX_EVENTS) {
+            at_us[count] = next_us;
+            out[count++] = g;
+        }
+    }
+    return count;
+}
+
+/* Compare les gestes obtenus à la liste attendue (terminée par NONE) */
+static void expect(const char* scenario, const edge_t* edges, bool held_at_boot,
+                   int64_t end_ms, const button_gesture_t* want)
+{
+    button_gesture_t got[MAX_EVENTS];
+    int64_t at_us[MAX_EVENTS];
+    int n = replay(edges, held_at_boot, end_ms, got, at_us);
+    int w = 0;
+
+    while (want[w] != BUTTON_GESTURE_NONE) w++;
+    bool ok = (n == w);
+    for (int i = 0; ok && i < n; i++) ok = (got[i] == want[i]);
+
+    if (!ok) {
+        printf("ECHEC %s : obtenu", scenario);
+        for (int i = 0; i < n; i++) {
+            printf(" %s@%lldms", button_gesture_name(got[i]), (long long)(at_us[i] / MS));
+        }
+        printf(", attendu");
+        for (int i = 0; i < w; i++) printf(" %s", button_gesture_name(want[i]));
+        printf("\n");
+        failures++;
+    }
+}
+
+/* Le geste doit tomber à l’instant de la transition qui le déclenche */
+static void expect_at(const char* scenario, const edge_t* edges, int64_t end_ms,
+                      int index, int64_t t_ms)
+{
+    button_gesture_t got[MAX_EVENTS];
+    int64_t at_us[MAX_EVENTS];
+    int n = replay(edges, false, end_ms, got, at_us);
+
+    if (index >= n || at_us[index] > t_ms * MS + POLL_LAG_US) {
+        printf("ECHEC %s : geste %d trop tardif ou absent\n", scenario, index);
+        failures++;
+    }
+}
+
+int main(void)
+{
+    const button_gesture_t none[] = { BUTTON_GESTURE_NONE };
+    const button_gesture_t shrt[] = { BUTTON_GESTURE_SHORT, BUTTON_GESTURE_NONE };
+    const button_gesture_t two_short[] = { BUTTON_GESTURE_SHORT, BUTTON_GESTURE_SHORT, BUTTON_GESTURE_NONE };
+    const button_gesture_t lng[] = { BUTTON_GESTURE_LONG, BUTTON_GESTURE_NONE };
+    const button_gesture_t dbl[] = { BUTTON_GESTURE_SHORT, BUTTON_GESTURE_DOUBLE, BUTTON_GESTURE_SHORT,
+                                     BUTTON_GESTURE_NONE };
+
+    const edge_t tap[] = { {100, 1}, {250, 0}, {0, -1} };
+    expect("court", tap, false, 2000, shrt);
+    expect_at("court", tap, 2000, 0, 250);
+
+    // Rebonds à l’appui et au relâchement (< 20 ms)
+    const edge_t bouncy[] = { {100, 1}, {101, 0}, {103, 1}, {104, 0}, {106, 1},
+                              {400, 0}, {402, 1}, {405, 0}, {0, -1} };
+    expect("rebonds", bouncy, false, 2000, shrt);
+
+    // Rebond qui se termine sur l’autre niveau : relu en fin de fenêtre
+    const edge_t late[] = { {100, 1}, {300, 0}, {305, 1}, {0, -1} };
+    const button_gesture_t late_want[] = { BUTTON_GESTURE_SHORT, BUTTON_GESTURE_DOUBLE, BUTTON_GESTURE_NONE };
+    expect("fin de rebond", late, false, 1000, late_want);
+
+    // Impulsion parasite de 5 ms : aucun geste
+    const edge_t glitch[] = { {100, 1}, {105, 0}, {0, -1} };
+    expect("parasite", glitch, false, 2000, none);
+
+    // Appui long : signalé pendant l’appui, rien au relâchement
+    const edge_t hold[] = { {100, 1}, {3000, 0}, {0, -1} };
+    expect("long", hold, false, 4000, lng);
+    expect_at("long", hold, 4000, 0, 100 + BUTTON_LONG_US / MS);
+
+    // Double appui signalé au second appui, puis un appui court normal
+    const edge_t twice[] = { {100, 1}, {200, 0}, {400, 1}, {500, 0},
+                             {1500, 1}, {1600, 0}, {0, -1} };
+    expect("double", twice, false, 3000, dbl);
+    expect_at("double", twice, 3000, 1, 400);
+
+    // Second appui hors délai : deux appuis courts
+    const edge_t slow[] = { {100, 1}, {200, 0}, {200 + BUTTON_DOUBLE_US / MS + 50, 1},
+                            {800, 0}, {0, -1} };
+    expect("trop lent", slow, false, 2000, two_short);
+
+    // Second appui d’un double tenu longtemps : pas d’appui long
+    const edge_t dbl_hold[] = { {100, 1}, {200, 0}, {400, 1}, {3000, 0}, {0, -1} };
+    const button_gesture_t dbl_hold_want[] = { BUTTON_GESTURE_SHORT, BUTTON_GESTURE_DOUBLE, BUTTON_GESTURE_NONE };
+    expect("double tenu", dbl_hold, false, 4000, dbl_hold_want);
+
+    // Bouton tenu au démarrage : ni long ni court avant un vrai appui
+    const edge_t boot[] = { {500, 0}, {1000, 1}, {1100, 0}, {0, -1} };
+    expect("tenu au demarrage", boot, true, 3000, shrt);
+
+    printf("%s (%d ecart(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,159 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: conn_policy_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test des paramètres de connexion selon l’activité (main/conn_policy.c)
+   sur horloge simulée, avec un central qui accorde, refuse ou ignore les
+   demandes.
+
+   Vérifie : profil rapide à la connexion et pendant un envoi, retour au
+   profil repos après le maintien, une seule demande en attente, demande
+   refaite après un central muet, refus non relancé, profil déjà en
+   vigueur non demandé, rien après la déconnexion.
+
+     conn_policy_test    code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include "conn_policy.h"
+
+#define MS  1000LL
+
+static int failures;
+
+static void check(const char* scenario, const char* what, int ok)
+{
+    if (!ok) {
+        printf("ECHEC %s : %s\n", scenario, what);
+        failures++;
+    }
+}
+
+/* Le central accorde le milieu de la plage demandée */
+static void grant(conn_policy_t* p, conn_profile_t profile)
+{
+    const conn_params_t* c = conn_policy_params(profile);
+    conn_policy_updated(p, true, (uint16_t)((c->min_int + c->max_int) / 2), c->latency, c->timeout);
+}
+
+/* Connexion, envoi du journal, puis repos (douche en cours) */
+static void sync_then_idle(void)
+{
+    const char* s = "synchro";
+    conn_policy_t p;
+    int64_t t = 0;
+
+    conn_policy_init(&p);
+    check(s, "rien avant connexion", conn_policy_poll(&p, t) == CONN_PROFILE_NONE);
+
+    conn_policy_connected(&p, 40, 0, 500, t);        // 50 ms choisis par le central
+    check(s, "rapide à la connexion", conn_policy_poll(&p, t) == CONN_PROFILE_FAST);
+    check(s, "une seule demande en attente", conn_policy_poll(&p, t + 10 * MS) == CONN_PROFILE_NONE);
+    grant(&p, CONN_PROFILE_FAST);
+    check(s, "paramètres accordés enregistrés", p.interval == 15 && p.latency == 0 && p.updates == 1);
+
+    // Envoi soutenu plus long que le maintien : reste rapide
+    conn_policy_busy(&p, true, t += 100 * MS);
+    check(s, "pas d’échéance pendant l’envoi", conn_policy_next_us(&p, t) == 0);
+    check(s, "rapide pendant l’envoi", conn_policy_poll(&p, t + 5000 * MS) == CONN_PROFILE_NONE);
+    conn_policy_busy(&p, false, t += 5000 * MS);
+    check(s, "échéance à la fin du maintien", conn_policy_next_us(&p, t) == t + CONN_POLICY_HOLD_US);
+    check(s, "rapide pendant le maintien", conn_policy_poll(&p, t + CONN_POLICY_HOLD_US - 1) == CONN_PROFILE_NONE);
+
+    // Acquittement du pont : maintien prolongé
+    conn_policy_activity(&p, t += 1500 * MS);
+    check(s, "maintien prolongé", conn_policy_poll(&p, t + 1000 * MS) == CONN_PROFILE_NONE);
+
+    t += CONN_POLICY_HOLD_US;
+    check(s, "repos après le maintien", conn_policy_poll(&p, t) == CONN_PROFILE_IDLE);
+    grant(&p, CONN_PROFILE_IDLE);
+    check(s, "latence accordée", p.latency == 4 && p.interval == 144);
+    check(s, "plus d’échéance au repos", conn_policy_next_us(&p, t) == 0);
+    check(s, "rien à redemander", conn_policy_poll(&p, t + 60000 * MS) == CONN_PROFILE_NONE);
+    check(s, "deux demandes", p.requests == 2 && p.rejected == 0);
+
+    // Rafale de commandes pendant la douche
+    conn_policy_activity(&p, t += 60000 * MS);
+    check(s, "rapide pour une rafale", conn_policy_poll(&p, t) == CONN_PROFILE_FAST);
+
+    conn_policy_disconnected(&p);
+    check(s, "rien après déconnexion", conn_policy_poll(&p, t + CONN_POLICY_PENDING_US) == CONN_PROFILE_NONE);
+    check(s, "aucune échéance déconnecté", conn_policy_next_us(&p, t) == 0);
+}
+
+/* Central muet, puis refus */
+static void silent_and_reject(void)
+{
+    const char* s = "central";
+    conn_policy_t p;
+    int64_t t = 0;
+
+    conn_policy_init(&p);
+    conn_policy_connected(&p, 40, 0, 500, t);
+    check(s, "première demande", conn_policy_poll(&p, t) == CONN_PROFILE_FAST);
+
+    // Pas de réponse : échéance de l’attente, puis demande refaite
+    check(s, "échéance du maintien d’abord", conn_policy_next_us(&p, t) == CONN_POLICY_HOLD_US);
+    t = CONN_POLICY_PENDING_US;
+    check(s, "échéance de l’attente", conn_policy_next_us(&p, t - 1) == CONN_POLICY_PENDING_US);
+    check(s, "demande refaite (repos désormais)", conn_policy_poll(&p, t) == CONN_PROFILE_IDLE);
+
+    // Refus : non relancé tant que l’activité ne change pas
+    conn_policy_updated(&p, false, 0, 0, 0);
+    check(s, "refus compté", p.rejected == 1 && p.interval == 40);
+    check(s, "refus non relancé", conn_policy_poll(&p, t + 30000 * MS) == CONN_PROFILE_NONE);
+    conn_policy_activity(&p, t += 30000 * MS);
+    check(s, "nouvelle activité demandée", conn_policy_poll(&p, t) == CONN_PROFILE_FAST);
+    check(s, "trois demandes", p.requests == 3);
+}
+
+/* Paramètres du central déjà adaptés : aucune demande */
+static void already_granted(void)
+{
+    const char* s = "en vigueur";
+    conn_policy_t p;
+
+    conn_policy_init(&p);
+    conn_policy_connected(&p, 12, 0, 400, 0);        // 15 ms : dans la plage rapide
+    check(s, "rapide non demandé", conn_policy_poll(&p, 0) == CONN_PROFILE_NONE);
+    check(s, "repos demandé ensuite", conn_policy_poll(&p, CONN_POLICY_HOLD_US) == CONN_PROFILE_IDLE);
+    check(s, "une seule demande", p.requests == 1);
+
+    // Changement imposé par le central, sans demande
+    conn_policy_updated(&p, true, 200, 0, 600);
+    check(s, "changement imposé enregistré", p.interval == 200 && !p.pending);
+}
+
+/* Profils dans les limites usuelles des centraux */
+static void profiles(void)
+{
+    const char* s = "profils";
+    const conn_params_t* all[] = { &conn_policy_fast, &conn_policy_idle };
+
+    for (unsigned i = 0; i < sizeof(all) / sizeof(all[0]); i++) {
+        const conn_params_t* c = all[i];
+        check(s, "intervalle 7,5 ms à 4 s", c->min_int >= 6 && c->max_int <= 3200 && c->min_int <= c->max_int);
+        check(s, "plage d’au moins 15 ms", c->max_int - c->min_int >= 12);
+        // Supervision (10 ms) > 2 × intervalle max (1,25 ms) × (latence + 1)
+        check(s, "supervision suffisante", c->timeout * 4 > c->max_int * (c->latency + 1));
+    }
+    check(s, "NONE sans paramètres", conn_policy_params(CONN_PROFILE_NONE) == NULL);
+}
+
+int main(void)
+{
+    sync_then_idle();
+    silent_and_reject();
+    already_granted();
+    profiles();
+
+    if (failures) return 1;
+    printf("conn_policy : OK\n");
+    return 0;
+}
@@ -0,0 +1,120 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: diag_record_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test du relevé de diagnostic (main/diag_record.c) : charges calculées
+   entre deux relevés (compteurs 32 bits qui repassent par zéro, tâche
+   créée pendant la période, charge des cœurs), rangement par marge de
+   pile, format binaire relu à l’identique, troncature au MTU.
+
+     diag_record_test       code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "diag_record.h"
+
+static int failures;
+
+static void check(const char* what, int ok)
+{
+    if (!ok) {
+        printf("ECHEC : %s\n", what);
+        failures++;
+    }
+}
+
+static void add_task(diag_sample_t* s, const char* name, uint32_t number, uint32_t runtime,
+                     uint16_t stack_free, uint8_t core, uint8_t flags)
+{
+    diag_task_t* t = &s->tasks[s->task_count++];
+    memset(t, 0, sizeof(*t));
+    strncpy(t->name, name, DIAG_NAME_LEN);
+    t->number = number;
+    t->runtime = runtime;
+    t->stack_free = stack_free;
+    t->priority = 5;
+    t->core = core;
+    t->flags = flags;
+    s->task_total = s->task_count;
+}
+
+static const diag_task_t* by_number(const diag_sample_t* s, uint32_t number)
+{
+    for (uint8_t i = 0; i < s->task_count; i++) {
+        if (s->tasks[i].number == number) return &s->tasks[i];
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    static diag_sample_t prev, cur, back;
+    static uint8_t buf[DIAG_RECORD_MAX_LEN];
+
+    // Relevé précédent juste avant le passage par zéro des compteurs
+    memset(&prev, 0, sizeof(prev));
+    prev.total_runtime = 0xFFFF0000u;
+    add_task(&prev, "IDLE0", 1, 0xFFF00000u, 900, 0, DIAG_TASK_IDLE);
+    add_task(&prev, "IDLE1", 2, 0xFFF80000u, 900, 1, DIAG_TASK_IDLE);
+    add_task(&prev, "timer_manager_task", 7, 0xFFFFFF00u, 1800, DIAG_CORE_ANY, 0);
+    diag_sample_finish(NULL, &prev, 0);
+    check("premier releve sans charge", prev.period_ms == 0 && prev.tasks[0].load_permille == 0 &&
+          prev.core_load_permille[0] == 0);
+
+    // Une seconde plus tard : IDLE0 75 %, IDLE1 95 %, timer 25 %, tâche créée 5 %
+    memset(&cur, 0, sizeof(cur));
+    cur.total_runtime = prev.total_runtime + 1000000u;
+    cur.uptime_s = 42;
+    cur.free_heap = 150000;
+    cur.min_free_heap = 120000;
+    cur.largest_block = 110000;
+    add_task(&cur, "IDLE0", 1, 0xFFF00000u + 750000u, 900, 0, DIAG_TASK_IDLE);
+    add_task(&cur, "IDLE1", 2, 0xFFF80000u + 950000u, 880, 1, DIAG_TASK_IDLE);
+    add_task(&cur, "timer_manager_task", 7, 0xFFFFFF00u + 250000u, 1700, DIAG_CORE_ANY, 0);
+    add_task(&cur, "diag_task", 12, 50000u, 120, DIAG_CORE_ANY, 0);
+    diag_sample_finish(&prev, &cur, 1000);
+
+    check("periode", cur.period_ms == 1000);
+    check("charge IDLE0", by_number(&cur, 1)->load_permille == 750);
+    check("charge timer (compteurs repasses par zero)", by_number(&cur, 7)->load_permille == 250);
+    check("charge tache creee pendant la periode", by_number(&cur, 12)->load_permille == 50);
+    check("charge des coeurs", cur.core_load_permille[0] == 250 && cur.core_load_permille[1] == 50);
+    check("rangement par marge de pile",
+          cur.tasks[0].number == 12 && cur.tasks[1].number == 2 &&
+          cur.tasks[2].number == 1 && cur.tasks[3].number == 7);
+
+    // Relevé complet relu à l’identique (nom tronqué à DIAG_NAME_LEN)
+    size_t len = diag_record_pack(&cur, buf, sizeof(buf));
+    check("longueur", len == sizeof(diag_record_header_t) + 4 * sizeof(diag_record_task_t));
+    check("relecture", diag_record_unpack(buf, len, &back));
+    check("tas", back.free_heap == 150000 && back.min_free_heap == 120000 && back.largest_block == 110000);
+    check("en-tete", back.uptime_s == 42 && back.period_ms == 1000 && back.task_total == 4 &&
+          back.task_count == 4 && back.core_load_permille[0] == 250);
+    check("nom tronque", strcmp(back.tasks[3].name, "timer_manage") == 0);
+    for (uint8_t i = 0; i < 4; i++) {
+        check("tache relue", back.tasks[i].stack_free == cur.tasks[i].stack_free &&
+              back.tasks[i].load_permille == cur.tasks[i].load_permille &&
+              back.tasks[i].core == cur.tasks[i].core && back.tasks[i].flags == cur.tasks[i].flags);
+    }
+
+    // Notification : MTU par défaut (20 octets utiles) trop petit, puis deux tâches
+    check("MTU 23 : rien", diag_record_pack(&cur, buf, 20) == 0);
+    len = diag_record_pack(&cur, buf, sizeof(diag_record_header_t) + 2 * sizeof(diag_record_task_t) + 5);
+    check("releve tronque", diag_record_unpack(buf, len, &back) &&
+          back.task_count == 2 && back.task_total == 4 && back.tasks[0].stack_free == 120);
+
+    // Relevés invalides
+    check("longueur insuffisante refusee", !diag_record_unpack(buf, len - 1, &back));
+    buf[0] = DIAG_RECORD_VERSION + 1;
+    check("version inconnue refusee", !diag_record_unpack(buf, len, &back));
+
+    printf("%s (%d ecart(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: display_task_host.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Tâche d’affichage pour la compilation sur PC : même interface que
+   main/display_task.c, mais display_commit() envoie l’image immédiatement,
+   ce qui rend chaque appel de oled_display.c mesurable isolément.
+   display_attach() initialise le panneau comme la tâche d’affichage.
+
+-- ========================================================================== */
+
+#include <string.h>
+#include "display_task.h"
+#include "ssd1306.h"
+
+static display_stats_t stats;
+static ssd1306_t *panels[SSD1306_MAX_PANELS];
+static size_t panel_count;
+
+void display_init(void)
+{
+    memset(&stats, 0, sizeof(stats));
+    panels[0] = ssd1306_default();
+    panel_count = 1;
+}
+
+void display_attach(ssd1306_t *dev)
+{
+    for (size_t i = 0; i < panel_count; i++) {
+        if (panels[i] == dev) return;
+    }
+    if (panel_count < SSD1306_MAX_PANELS) {
+        ssd1306_dev_init(dev);
+        ssd1306_dev_contrast(dev, 0xFF);
+        panels[panel_count++] = dev;
+    }
+}
+
+void display_begin(void)
+{
+}
+
+void display_commit(void)
+{
+    bool changed[SSD1306_MAX_PANELS];
+    for (size_t i = 0; i < panel_count; i++) {
+        changed[i] = ssd1306_dev_commit(panels[i]);
+    }
+
+    while (ssd1306_send_round(panels, panel_count)) {
+    }
+
+    for (size_t i = 0; i < panel_count; i++) {
+        if (!changed[i]) continue;
+        uint32_t bytes;
+        ssd1306_dev_bus_last_call(panels[i], NULL, &bytes);
+        stats.frames++;
+        stats.last_bytes = bytes;
+    }
+}
+
+void display_get_stats(display_stats_t *out)
+{
+    *out = stats;
+}
@@ -0,0 +1,152 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: flow_accum_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test du cumul du débitmètre (main/flow_accum.c) sans matériel :
+   - Source d’impulsions simulée : un profil de débit (L/min en fonction
+     du temps) est intégré au pas de 1 ms, une impulsion par 1/450 L
+   - Compteur PCNT simulé : il compte les impulsions et repasse à 0 en
+     atteignant FLOW_PCNT_LIMIT, comme le compteur matériel
+   - Lectures comme dans timer_manager : au départ, à chaque seconde
+     (réveil en retard de quelques ms), à l’arrêt
+   Vérifie : aucune impulsion perdue malgré les tours du compteur, volume
+   égal au volume écoulé à une impulsion près, débit de pointe juste, pas
+   de pic faux sur une dernière lecture rapprochée.
+
+     flow_accum_test        code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "flow_accum.h"
+
+#define PPL             FLOW_PPL_YF_S201
+#define STEP_US         1000                 // Pas de la source simulée
+#define WAKE_LAG_US     3000                 // Retard des lectures de la seconde
+
+/* Segment de profil : débit passant linéairement de q0 à q1 (L/min) */
+typedef struct {
+    int64_t duration_us;
+    double q0;
+    double q1;
+} segment_t;
+
+/* Source d’impulsions et compteur matériel simulés */
+typedef struct {
+    double phase;                       // Fraction d’impulsion en cours
+    double litres;                      // Volume réellement écoulé
+    uint32_t pulses;                    // Impulsions émises
+    int32_t pcnt;                       // Compteur PCNT (0 .. FLOW_PCNT_LIMIT - 1)
+} source_t;
+
+static int failures;
+
+static void check(const char* scenario, const char* what, int ok)
+{
+    if (!ok) {
+        printf("ECHEC %s : %s\n", scenario, what);
+        failures++;
+    }
+}
+
+/* Fait couler l’eau pendant STEP_US au débit q (L/min) */
+static void source_step(source_t* src, double q)
+{
+    double litres = q * STEP_US / 60e6;
+    src->litres += litres;
+    src->phase += litres * PPL;
+    while (src->phase >= 1.0) {
+        src->phase -= 1.0;
+        src->pulses++;
+        src->pcnt++;
+        if (src->pcnt == FLOW_PCNT_LIMIT) src->pcnt = 0;
+    }
+}
+
+/* Rejoue un profil ; stop_extra_us : arrêt après la dernière seconde */
+static void replay(const char* scenario, const segment_t* seg, int count, int32_t pcnt0,
+                   int64_t stop_extra_us, double want_peak_l_min)
+{
+    source_t src = { .pcnt = pcnt0 };
+    flow_accum_t acc;
+    int64_t now = 0;
+    int64_t next_read = 1000000 + WAKE_LAG_US;
+
+    flow_accum_start(&acc, PPL, src.pcnt, now);
+    for (int i = 0; i < count; i++) {
+        for (int64_t t = 0; t < seg[i].duration_us; t += STEP_US) {
+            double q = seg[i].q0 + (seg[i].q1 - seg[i].q0) * (double)t / (double)seg[i].duration_us;
+            source_step(&src, q);
+            now += STEP_US;
+            if (now >= next_read) {
+                flow_accum_sample(&acc, src.pcnt, now);
+                next_read += 1000000;
+            }
+        }
+    }
+    for (int64_t t = 0; t < stop_extra_us; t += STEP_US) {
+        source_step(&src, seg[count - 1].q1);
+        now += STEP_US;
+    }
+    flow_accum_sample(&acc, src.pcnt, now);
+
+    flow_result_t r = flow_accum_result(&acc);
+    long want_ml = (long)((uint64_t)src.pulses * 1000u / PPL);
+    long true_ml = (long)(src.litres * 1000.0);
+
+    check(scenario, "impulsions perdues", acc.pulses == src.pulses);
+    check(scenario, "volume (impulsions)", (long)r.volume_ml == want_ml);
+    check(scenario, "volume (ecoule)", labs((long)r.volume_ml - true_ml) <= 1000 / PPL + 1);
+    if (want_peak_l_min > 0) {
+        double got = r.peak_ml_min / 1000.0;
+        check(scenario, "debit de pointe", got > want_peak_l_min * 0.97 && got < want_peak_l_min * 1.03);
+    } else {
+        check(scenario, "debit de pointe nul", r.peak_ml_min == 0);
+    }
+    printf("%-22s %7.2f L coules, %7.2f L mesures, pointe %5.2f L/min (%u impulsions)\n", scenario,
+           src.litres, r.volume_ml / 1000.0, r.peak_ml_min / 1000.0, (unsigned)src.pulses);
+}
+
+int main(void)
+{
+    const int64_t S = 1000000;
+
+    // Longue douche à débit constant : le compteur fait plusieurs tours
+    const segment_t longue[] = { { 600 * S, 18.0, 18.0 } };
+    replay("longue (tours PCNT)", longue, 1, 0, 0, 18.0);
+
+    // Départ compteur presque plein, profil réaliste, arrêt 200 ms après une seconde
+    const segment_t profil[] = {
+        { 10 * S, 0.0, 8.0 },           // Ouverture du robinet
+        { 60 * S, 8.0, 8.0 },
+        { 5 * S, 14.0, 14.0 },          // Plein débit
+        { 30 * S, 0.0, 0.0 },           // Savonnage, robinet fermé
+        { 20 * S, 8.0, 8.0 },
+    };
+    replay("profil", profil, 5, FLOW_PCNT_LIMIT - 40, 200000, 14.0);
+
+    // Arrêt très rapproché d’une lecture pendant le plein débit
+    const segment_t court[] = { { 20 * S, 9.0, 9.0 }, { 3 * S, 16.0, 16.0 } };
+    replay("arret rapproche", court, 2, 12345, 20000, 16.0);
+
+    // Lecture rapprochée : une impulsion en 10 ms ne compte pas pour 13 L/min
+    flow_accum_t acc;
+    flow_accum_start(&acc, PPL, 0, 0);
+    flow_accum_sample(&acc, 15, 1 * S);             // 15 impulsions/s : 2 L/min
+    flow_accum_sample(&acc, 16, 1 * S + 10000);
+    flow_accum_sample(&acc, 30, 2 * S);
+    check("lecture rapprochee", "pas de pic faux", flow_accum_result(&acc).peak_ml_min == 2000);
+
+    // Capteur sans eau
+    const segment_t sec[] = { { 30 * S, 0.0, 0.0 } };
+    replay("sans eau", sec, 1, 77, 0, 0.0);
+
+    printf("%s (%d ecart(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,8 @@
+// Substitut minimal de driver/gpio.h pour la compilation sur PC
+#pragma once
+
+typedef int gpio_num_t;
+
+#define GPIO_NUM_21         21
+#define GPIO_NUM_22         22
+#define GPIO_PULLUP_ENABLE  1
@@ -0,0 +1,7 @@
+// Substitut minimal de esp_timer.h pour la compilation sur PC : l’horloge
+// est fournie par le programme de test (horloge simulée).
+#pragma once
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
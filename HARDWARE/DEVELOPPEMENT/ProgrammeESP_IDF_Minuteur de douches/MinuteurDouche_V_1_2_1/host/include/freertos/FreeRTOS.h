@@ -0,0 +1,8 @@
+// Substitut minimal de FreeRTOS.h pour la compilation sur PC
+#pragma once
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#define portTICK_PERIOD_MS  1
@@ -0,0 +1,189 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: journal_ring_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test du journal circulaire (main/journal_ring.c) sur une flash NOR
+   simulée en mémoire : une écriture ne fait que passer des bits à 0,
+   un effacement remet le secteur à 0xFF. Petite géométrie (4 secteurs
+   de 4 enregistrements) pour faire plusieurs tours.
+
+   Scénarios : journal vide, redémarrage, plusieurs tours du journal,
+   écriture interrompue par une coupure, parcours après acquittement.
+
+     journal_ring_test      code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "journal_ring.h"
+
+#define SECTOR_SIZE     (4 * JOURNAL_RECORD_SIZE)
+#define FLASH_SIZE      (4 * SECTOR_SIZE)
+#define SLOTS           (FLASH_SIZE / JOURNAL_RECORD_SIZE)
+#define PER_SECTOR      (SECTOR_SIZE / JOURNAL_RECORD_SIZE)
+
+static uint8_t flash_mem[FLASH_SIZE];
+static int overwrites;                   // Écritures sur des bits déjà à 0
+static int failures;
+
+static int sim_read(void* ctx, uint32_t offset, void* dst, size_t len)
+{
+    memcpy(dst, flash_mem + offset, len);
+    return 0;
+}
+
+static int sim_write(void* ctx, uint32_t offset, const void* src, size_t len)
+{
+    const uint8_t* p = src;
+    for (size_t i = 0; i < len; i++) {
+        if ((uint8_t)~flash_mem[offset + i] & p[i]) overwrites++;
+        flash_mem[offset + i] &= p[i];
+    }
+    return 0;
+}
+
+static int sim_erase(void* ctx, uint32_t offset, size_t len)
+{
+    if (offset % SECTOR_SIZE || len % SECTOR_SIZE) return -1;
+    memset(flash_mem + offset, 0xFF, len);
+    return 0;
+}
+
+static const journal_flash_t sim_flash = {
+    .read = sim_read, .write = sim_write, .erase = sim_erase,
+    .ctx = NULL, .size = FLASH_SIZE, .sector_size = SECTOR_SIZE,
+};
+
+static void check(const char* scenario, const char* what, int ok)
+{
+    if (!ok) {
+        printf("ECHEC %s : %s\n", scenario, what);
+        failures++;
+    }
+}
+
+/* Redémarrage : nouvel état RAM relu depuis la flash */
+static void reopen(journal_ring_t* ring)
+{
+    if (!journal_ring_open(ring, &sim_flash)) {
+        printf("ECHEC ouverture du journal\n");
+        failures++;
+    }
+}
+
+static uint32_t append(journal_ring_t* ring, uint32_t n)
+{
+    journal_record_t rec;
+    memset(&rec, 0, sizeof(rec));
+    rec.boot = 1;
+    rec.start_s = n * 600;
+    rec.duration_ms = 240 + n;
+    rec.overtime_ms = n % 60;
+    snprintf(rec.user, sizeof(rec.user), "user%lu", (unsigned long)n);
+    return journal_ring_append(ring, &rec);
+}
+
+/* Parcours complet : numéros consécutifs après after_seq, jusqu’à last ;
+   retourne le nombre d’enregistrements lus */
+static uint32_t walk(const char* scenario, const journal_ring_t* ring, uint32_t after_seq, uint32_t last)
+{
+    journal_cursor_t cur;
+    journal_record_t rec;
+    uint32_t count = 0, prev = 0;
+    char user[JOURNAL_USER_MAX];
+
+    journal_ring_cursor(ring, &cur);
+    while (journal_ring_next(ring, &cur, after_seq, &rec)) {
+        check(scenario, "ordre des numeros", prev == 0 || rec.seq == prev + 1);
+        snprintf(user, sizeof(user), "user%lu", (unsigned long)rec.seq);
+        check(scenario, "contenu", strcmp(rec.user, user) == 0 && rec.duration_ms == 240 + rec.seq);
+        prev = rec.seq;
+        count++;
+    }
+    check(scenario, "dernier numero", count == 0 ? last == after_seq : prev == last);
+    return count;
+}
+
+static void scenario_empty(void)
+{
+    journal_ring_t ring;
+
+    memset(flash_mem, 0xFF, sizeof(flash_mem));
+    reopen(&ring);
+    check("vide", "aucun enregistrement", ring.last_seq == JOURNAL_SEQ_NONE && walk("vide", &ring, 0, 0) == 0);
+
+    for (uint32_t n = 1; n <= 5; n++) check("vide", "numero attribue", append(&ring, n) == n);
+    reopen(&ring);
+    check("redemarrage", "dernier numero relu", ring.last_seq == 5);
+    check("redemarrage", "5 enregistrements", walk("redemarrage", &ring, 0, 5) == 5);
+    check("redemarrage", "suite de la numerotation", append(&ring, 6) == 6);
+}
+
+static void scenario_wrap(void)
+{
+    journal_ring_t ring;
+
+    memset(flash_mem, 0xFF, sizeof(flash_mem));
+    reopen(&ring);
+    for (uint32_t n = 1; n <= 50; n++) {
+        append(&ring, n);
+        if (n % 7 == 0) reopen(&ring);       // Redémarrages en cours de tour
+    }
+    reopen(&ring);
+
+    uint32_t kept = walk("tours", &ring, 0, 50);
+    check("tours", "capacite conservee", kept >= SLOTS - PER_SECTOR && kept <= SLOTS);
+    check("tours", "parcours apres acquittement", walk("acquittement", &ring, 45, 50) == 5);
+    check("tours", "tout acquitte", walk("acquittement", &ring, 50, 50) == 0);
+}
+
+static void scenario_torn_write(void)
+{
+    journal_ring_t ring;
+
+    memset(flash_mem, 0xFF, sizeof(flash_mem));
+    reopen(&ring);
+    for (uint32_t n = 1; n <= 6; n++) append(&ring, n);
+
+    // Coupure pendant l’écriture suivante : seuls 20 octets programmés
+    uint8_t partial[20];
+    memset(partial, 0x00, sizeof(partial));
+    sim_write(NULL, ring.head * JOURNAL_RECORD_SIZE, partial, sizeof(partial));
+
+    reopen(&ring);
+    check("coupure", "enregistrement interrompu ignore", ring.last_seq == 6);
+    for (uint32_t n = 7; n <= 30; n++) append(&ring, n);
+    reopen(&ring);
+    check("coupure", "numerotation continue", ring.last_seq == 30);
+    walk("coupure", &ring, 20, 30);
+}
+
+static void scenario_geometry(void)
+{
+    journal_ring_t ring;
+    journal_flash_t bad = sim_flash;
+
+    bad.size = SECTOR_SIZE;                   // Un seul secteur
+    check("geometrie", "un secteur refuse", !journal_ring_open(&ring, &bad));
+    bad = sim_flash;
+    bad.sector_size = 100;                    // Pas un multiple de 64
+    check("geometrie", "secteur invalide refuse", !journal_ring_open(&ring, &bad));
+}
+
+int main(void)
+{
+    scenario_empty();
+    scenario_wrap();
+    scenario_torn_write();
+    scenario_geometry();
+    check("flash", "aucune reecriture sans effacement", overwrites == 0);
+
+    printf("%s (%d ecart(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
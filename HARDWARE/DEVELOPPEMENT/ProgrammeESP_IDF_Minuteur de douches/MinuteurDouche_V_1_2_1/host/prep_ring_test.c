@@ -0,0 +1,163 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: prep_ring_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test du réassemblage des écritures longues (main/prep_ring.c) : une
+   écriture de 512 octets en fragments de MTU 23, exécution, annulation,
+   fragments refusés (hors ordre, autre attribut, sans place), messages
+   gardés par le consommateur pendant les écritures suivantes (retour au
+   début de l’anneau), puis charge aléatoire comparée à un modèle.
+
+     prep_ring_test         code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "prep_ring.h"
+
+#define RING_CAP        2048                 // SPP_DATA_BUFF_MAX_LEN
+#define H_DATA          42
+#define H_OTHER         45
+
+static int failures;
+
+static void check(const char* what, int ok)
+{
+    if (!ok) {
+        printf("ECHEC : %s\n", what);
+        failures++;
+    }
+}
+
+static uint32_t rnd(void)
+{
+    static uint32_t s = 0xC0FFEEu;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    return s;
+}
+
+/* Écriture longue d’un client : fragments de (mtu - 5) octets */
+static bool long_write(prep_ring_t* r, uint16_t handle, const uint8_t* data, size_t len, unsigned mtu)
+{
+    bool ok = true;
+    for (size_t off = 0; off < len; off += mtu - 5) {
+        size_t n = len - off < mtu - 5 ? len - off : mtu - 5;
+        ok = prep_ring_prepare(r, handle, (uint16_t)off, data + off, n) && ok;
+    }
+    return ok;
+}
+
+int main(void)
+{
+    static uint8_t storage[RING_CAP], value[1024];
+    prep_ring_t ring;
+    prep_msg_t msg, kept[PREP_RING_MSGS];
+
+    for (size_t i = 0; i < sizeof(value); i++) value[i] = (uint8_t)rnd();
+    prep_ring_init(&ring, storage, sizeof(storage));
+
+    // Écriture longue de 512 octets (MTU 23 : 18 octets par fragment)
+    check("fragments acceptes", long_write(&ring, H_DATA, value, 512, 23));
+    check("execution", prep_ring_execute(&ring, &msg));
+    check("message contigu", msg.handle == H_DATA && msg.len == 512 && memcmp(msg.data, value, 512) == 0);
+    prep_ring_release(&ring);
+    check("rien a executer", !prep_ring_execute(&ring, &msg));
+
+    // Annulation : rien n’est remis, l’écriture suivante repart de zéro
+    long_write(&ring, H_DATA, value, 100, 23);
+    prep_ring_cancel(&ring);
+    check("annulee", !prep_ring_execute(&ring, &msg) && ring.cancelled == 1);
+    long_write(&ring, H_DATA, value + 7, 40, 23);
+    check("apres annulation", prep_ring_execute(&ring, &msg) && msg.len == 40 &&
+                              memcmp(msg.data, value + 7, 40) == 0);
+    prep_ring_release(&ring);
+
+    // Fragments refusés : tout le message est rejeté, le suivant passe
+    prep_ring_prepare(&ring, H_DATA, 0, value, 18);
+    check("hors ordre", !prep_ring_prepare(&ring, H_DATA, 36, value + 36, 18));
+    check("suite ignoree", !prep_ring_prepare(&ring, H_DATA, 18, value + 18, 18));
+    check("rejete", !prep_ring_execute(&ring, &msg) && ring.rejected == 1);
+    prep_ring_prepare(&ring, H_DATA, 0, value, 18);
+    check("autre attribut", !prep_ring_prepare(&ring, H_OTHER, 0, value, 18));
+    check("rejete 2", !prep_ring_execute(&ring, &msg) && ring.rejected == 2);
+    uint8_t big[RING_CAP + 1] = {0};
+    check("trop long", !prep_ring_prepare(&ring, H_DATA, 0, big, sizeof(big)));
+    check("rejete 3", !prep_ring_execute(&ring, &msg) && ring.rejected == 3);
+
+    // Messages gardés par le consommateur : l’écriture suivante repart au
+    // début de l’anneau quand la fin est occupée
+    for (int i = 0; i < 3; i++) {
+        check("garde", long_write(&ring, H_DATA, value, 650, 185) && prep_ring_execute(&ring, &kept[i]));
+    }
+    prep_ring_release(&ring);                    // Libère kept[0] : début libre
+    check("retour au debut", long_write(&ring, H_DATA, value + 12, 650, 185) &&
+                             prep_ring_execute(&ring, &kept[3]) && kept[3].data == storage);
+    check("messages intacts", memcmp(kept[1].data, value, 650) == 0 && memcmp(kept[2].data, value, 650) == 0 &&
+                              memcmp(kept[3].data, value + 12, 650) == 0);
+    check("anneau plein", !long_write(&ring, H_DATA, value, 200, 185) && !prep_ring_execute(&ring, &msg));
+    prep_ring_release(&ring);
+    prep_ring_release(&ring);
+    prep_ring_release(&ring);
+
+    // Charge aléatoire : le consommateur garde jusqu’à PREP_RING_MSGS messages,
+    // annulations et fragments refusés ; chaque message remis est comparé
+    // à ce qui a été écrit, et les messages gardés ne sont jamais abîmés
+    prep_ring_init(&ring, storage, sizeof(storage));
+    static uint8_t copies[PREP_RING_MSGS][512];
+    size_t held_len[PREP_RING_MSGS];
+    unsigned held = 0, first = 0, delivered = 0, refused = 0;
+    for (int iter = 0; iter < 200000; iter++) {
+        unsigned op = rnd() % 10;
+        if (op < 3 && held > 0) {
+            unsigned k = first;
+            check("garde intact", memcmp(kept[k].data, copies[k], held_len[k]) == 0);
+            prep_ring_release(&ring);
+            first = (first + 1) % PREP_RING_MSGS;
+            held--;
+            continue;
+        }
+        size_t len = 1 + rnd() % 512;
+        size_t off = rnd() % (512 - len + 1);
+        unsigned mtu = (rnd() % 2) ? 23 : 23 + rnd() % 490;
+        bool ok = long_write(&ring, H_DATA, value + off, len, mtu);
+        if (op == 9) {
+            prep_ring_cancel(&ring);
+            continue;
+        }
+        if (prep_ring_execute(&ring, &msg)) {
+            check("message remis intact", ok && msg.len == len && memcmp(msg.data, value + off, len) == 0);
+            check("dans l'anneau", msg.data >= storage && msg.data + msg.len <= storage + RING_CAP);
+            unsigned k = (first + held) % PREP_RING_MSGS;
+            kept[k] = msg;
+            memcpy(copies[k], msg.data, len);
+            held_len[k] = len;
+            held++;
+            delivered++;
+        } else {
+            check("refus justifie", !ok || held == PREP_RING_MSGS);
+            refused++;
+        }
+        for (unsigned i = 0; i < held; i++) {
+            unsigned k = (first + i) % PREP_RING_MSGS;
+            if (memcmp(kept[k].data, copies[k], held_len[k]) != 0) {
+                check("message garde ecrase", 0);
+                i = held;
+                iter = 200000;
+            }
+        }
+    }
+    printf("Charge : %u message(s) remis, %u refuse(s)\n", delivered, refused);
+    check("charge", delivered > 10000 && refused > 0);
+
+    printf("%s (%d ecart(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
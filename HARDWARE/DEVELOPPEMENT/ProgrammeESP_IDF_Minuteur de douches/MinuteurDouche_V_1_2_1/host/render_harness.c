@@ -0,0 +1,361 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: render_harness.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Banc de rendu : pilote SSD1306 et oled_display.c compilés sur PC, reliés
+   à l’émulateur de panneau (ssd1306_emu.c) à la place du bus I2C.
+
+   Chaque scénario part d’un panneau fraîchement alimenté et enchaîne des
+   appels d’API ; pour chaque appel on relève le trafic I2C vu par le
+   panneau (transactions, octets, durée estimée à 400 kHz).
+
+     render_harness                  tableau du trafic par appel
+     render_harness --check DIR      compare les images aux références DIR/<scénario>.pbm
+     render_harness --update DIR     réécrit les références
+     render_harness --dump DIR       écrit les images en PGM (agrandies x4)
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "ssd1306.h"
+#include "ssd1306_emu.h"
+#include "oled_display.h"
+#include "display_task.h"
+
+#define OLED_ADDR   0x3C
+#define I2C_PORT    I2C_NUM_0
+
+/* Une seconde de compte à rebours ne doit pas coûter plus d’une
+   transaction par page de grands chiffres */
+#define TICK_MAX_TRANSACTIONS   4
+
+typedef enum { RUN_BENCH, RUN_CHECK, RUN_UPDATE, RUN_DUMP } run_mode_t;
+
+static run_mode_t run_mode;
+static const char* out_dir;
+static int failures;
+static emu_traffic_t last_step;
+
+static ssd1306_emu_t* panel(void)
+{
+    return ssd1306_emu_get(I2C_PORT, OLED_ADDR);
+}
+
+static void fail(const char* scenario, const char* what)
+{
+    printf("ECHEC %s : %s\n", scenario, what);
+    failures++;
+}
+
+/* Trafic d’un appel : différence des compteurs du panneau avant / après */
+#define STEP(scenario, label, call)                                         \
+    do {                                                                    \
+        emu_traffic_t before_ = panel()->traffic;                           \
+        call;                                                               \
+        step_done(scenario, label, &before_);                               \
+    } while (0)
+
+static void step_done(const char* scenario, const char* label, const emu_traffic_t* before)
+{
+    const emu_traffic_t* now = &panel()->traffic;
+    last_step.transactions = now->transactions - before->transactions;
+    last_step.bytes = now->bytes - before->bytes;
+    last_step.bus_us = now->bus_us - before->bus_us;
+
+    if (run_mode == RUN_BENCH) {
+        printf("%-10s %-32s %6lu %7lu %10.1f\n", scenario, label,
+               (unsigned long)last_step.transactions, (unsigned long)last_step.bytes,
+               last_step.bus_us);
+    }
+}
+
+/* Le panneau doit afficher exactement ce que le pilote croit avoir envoyé */
+static void check_coherent(const char* scenario)
+{
+    if (panel()->errors != 0) {
+        fail(scenario, "commande ou trame invalide recue par le panneau");
+    }
+    if (memcmp(panel()->gddram, ssd1306_fb_displayed(), sizeof(panel()->gddram)) != 0) {
+        fail(scenario, "GDDRAM differente de l'image suivie par le pilote");
+    }
+}
+
+static void finish(const char* scenario)
+{
+    char path[512];
+    check_coherent(scenario);
+
+    switch (run_mode) {
+    case RUN_CHECK: {
+        snprintf(path, sizeof(path), "%s/%s.pbm", out_dir, scenario);
+        int diff = ssd1306_emu_compare_pbm(panel(), path);
+        if (diff < 0) {
+            fail(scenario, "reference absente ou illisible");
+        } else if (diff > 0) {
+            printf("ECHEC %s : %d pixel(s) different(s) de %s\n", scenario, diff, path);
+            failures++;
+        }
+        break;
+    }
+    case RUN_UPDATE:
+        snprintf(path, sizeof(path), "%s/%s.pbm", out_dir, scenario);
+        ssd1306_emu_write_pbm(panel(), path);
+        break;
+    case RUN_DUMP:
+        snprintf(path, sizeof(path), "%s/%s.pgm", out_dir, scenario);
+        ssd1306_emu_write_pgm(panel(), path, 4);
+        break;
+    case RUN_BENCH:
+        break;
+    }
+}
+
+/** -------------------------------------------------------------------------- --
+   Scénarios
+-- -------------------------------------------------------------------------- */
+static void boot(const char* name)
+{
+    ssd1306_emu_reset_all();
+    STEP(name, "oled_init", oled_init());
+    display_init();
+}
+
+static void scenario_boot(void)
+{
+    const char* name = "boot";
+    ssd1306_emu_reset_all();
+    STEP(name, "ssd1306_setup_i2c", ssd1306_setup_i2c(GPIO_NUM_21, GPIO_NUM_22));
+    STEP(name, "ssd1306_128x64_i2c_init", ssd1306_128x64_i2c_init());
+    STEP(name, "ssd1306_contrast", ssd1306_contrast(0xFF));
+    display_init();
+    STEP(name, "show_boot_screen", show_boot_screen());
+
+    if (!panel()->display_on || !panel()->charge_pump || panel()->contrast != 0xFF) {
+        fail(name, "panneau eteint ou contraste non applique");
+    }
+    if (panel()->mode != EMU_ADDR_HORIZONTAL) {
+        fail(name, "le pilote n'a pas programme l'adressage horizontal");
+    }
+
+    // Mise en veille après inactivité, puis réveil sur la même image
+    STEP(name, "ssd1306_power (veille)", ssd1306_power(false));
+    if (panel()->display_on || panel()->charge_pump || last_step.transactions != 1) {
+        fail(name, "veille : panneau ou pompe de charge encore actifs");
+    }
+    STEP(name, "ssd1306_power (reveil)", ssd1306_power(true));
+    if (!panel()->display_on || !panel()->charge_pump) {
+        fail(name, "reveil : panneau toujours eteint");
+    }
+    finish(name);
+}
+
+static void scenario_message(void)
+{
+    const char* name = "message";
+    boot(name);
+    STEP(name, "oled_display_message (1)", oled_display_message("Douche 1 libre"));
+    STEP(name, "oled_display_message (2)", oled_display_message("Douche 1 occupee"));
+    STEP(name, "oled_display_message (meme)", oled_display_message("Douche 1 occupee"));
+    if (last_step.transactions != 0) {
+        fail(name, "un message identique a genere du trafic");
+    }
+    finish(name);
+}
+
+/* Écran du minuteur tel que le pilote timer_manager_task */
+static void scenario_countdown(void)
+{
+    const char* name = "countdown";
+    boot(name);
+    STEP(name, "ecran minuteur 05:00", oled_timer_screen_show("Alice", 300));
+    STEP(name, "meme valeur", oled_timer_screen_update(300, 0));
+    if (last_step.transactions != 0) {
+        fail(name, "une mise a jour sans changement a genere du trafic");
+    }
+    STEP(name, "seconde 04:59", oled_timer_screen_update(299, 0));
+    STEP(name, "seconde 04:58", oled_timer_screen_update(298, 0));
+    if (last_step.transactions > TICK_MAX_TRANSACTIONS) {
+        fail(name, "une seconde envoie plus d'une transaction par page");
+    }
+    STEP(name, "minute 03:59 + jauge", oled_timer_screen_update(239, 20));
+    finish(name);
+}
+
+/* Dépassement : l’alerte clignote sans redessiner le reste de l’écran */
+static void scenario_overtime(void)
+{
+    const char* name = "overtime";
+    boot(name);
+    oled_timer_screen_show("Alice", 1);
+    STEP(name, "passage en depassement", oled_timer_screen_overtime(0));
+    STEP(name, "alerte eteinte", oled_timer_screen_blink(false));
+    if (last_step.transactions != 1) {
+        fail(name, "le clignotement redessine plus que l'alerte");
+    }
+    STEP(name, "alerte allumee + 1 s", {
+        oled_timer_screen_blink(true);
+        oled_timer_screen_overtime(1);
+    });
+    finish(name);
+}
+
+static void scenario_gfx(void)
+{
+    static const uint8_t drop[2][8] = {
+        { 0x00, 0xC0, 0xF0, 0xFE, 0xFF, 0xF0, 0xC0, 0x00 },
+        { 0x00, 0x07, 0x0F, 0x1F, 0x1F, 0x0F, 0x07, 0x00 },
+    };
+    const char* name = "gfx";
+    boot(name);
+
+    STEP(name, "texte x2 + jauge + goutte", {
+        display_begin();
+        ssd1306_clear_screen();
+        ssd1306_draw_string(0, 2, "12 L", 2, true);
+        ssd1306_draw_frame(100, 10, 20, 50, SSD1306_MODE_SET);
+        ssd1306_fill_rect(102, 30, 16, 28, SSD1306_MODE_SET);
+        ssd1306_draw_bitmap_pages(80, 21, 8, 16, &drop[0][0], SSD1306_MODE_SET);
+        display_commit();
+    });
+    STEP(name, "jauge -10 px", {
+        display_begin();
+        ssd1306_fill_rect(102, 30, 16, 10, SSD1306_MODE_CLEAR);
+        display_commit();
+    });
+    STEP(name, "inversion XOR plein ecran", {
+        display_begin();
+        ssd1306_fill_rect(0, 0, 128, 64, SSD1306_MODE_XOR);
+        display_commit();
+    });
+    if (last_step.transactions != 1) {
+        fail(name, "un redessin complet n'est pas parti en une seule rafale");
+    }
+    finish(name);
+}
+
+static void scenario_clear(void)
+{
+    const char* name = "clear";
+    boot(name);
+    STEP(name, "oled_display_message", oled_display_message("A effacer"));
+    STEP(name, "ssd1306_clear_line + commit", {
+        display_begin();
+        ssd1306_clear_line(3);
+        display_commit();
+    });
+    STEP(name, "ssd1306_clear", ssd1306_clear());
+    if (last_step.transactions != 1) {
+        fail(name, "l'effacement n'est pas parti en une seule rafale");
+    }
+    finish(name);
+}
+
+/* Deux panneaux sur le même port (0x3C et 0x3D) : le redessin complet de
+   l’un est découpé en tranches et n’empêche pas la seconde suivante de
+   l’autre de partir dès le premier tour d’envoi */
+static void scenario_dual(void)
+{
+    const char* name = "dual";
+    boot(name);
+
+    ssd1306_t* a = ssd1306_default();
+    ssd1306_t* b = ssd1306_open(I2C_PORT, SSD1306_ADDR_SECONDARY);
+    ssd1306_emu_t* emu_b = ssd1306_emu_get(I2C_PORT, SSD1306_ADDR_SECONDARY);
+    display_attach(b);
+    uint8_t x = (128 - ssd1306_gfx_big_digits_width("04:59")) / 2;
+
+    STEP(name, "deux ecrans minuteur", {
+        oled_timer_screen_show("Alice", 300);
+        display_begin();
+        ssd1306_dev_draw_big_digits(b, x, 1, "04:59");
+        display_commit();
+    });
+
+    ssd1306_t* both[] = { a, b };
+    int rounds = 0;
+    int b_done = 0;
+    bool a_busy_when_b_done = false;
+    STEP(name, "A plein ecran / B seconde", {
+        ssd1306_dev_fill_rect(a, 0, 0, 128, 64, SSD1306_MODE_XOR);
+        ssd1306_dev_draw_big_digits(b, x, 1, "04:58");
+        ssd1306_dev_commit(a);
+        ssd1306_dev_commit(b);
+        bool pending;
+        do {
+            pending = ssd1306_send_round(both, 2);
+            rounds++;
+            if (!b_done && !ssd1306_dev_busy(b)) {
+                b_done = rounds;
+                a_busy_when_b_done = ssd1306_dev_busy(a);
+            }
+        } while (pending);
+    });
+    if (b_done != 1 || !a_busy_when_b_done) {
+        fail(name, "le redessin complet de A a retarde la mise a jour de B");
+    }
+    if (emu_b->errors != 0 ||
+        memcmp(emu_b->gddram, ssd1306_dev_displayed(b), sizeof(emu_b->gddram)) != 0) {
+        fail(name, "GDDRAM du panneau B differente de l'image suivie par le pilote");
+    }
+    finish(name);
+}
+
+/* Écriture refusée par le bus au milieu d’un envoi : le pilote ne croit
+   pas l’avoir affichée et la renvoie à l’envoi suivant, sans nouveau
+   dessin de la même région */
+static void scenario_bus_error(void)
+{
+    const char* name = "bus_error";
+    boot(name);
+    STEP(name, "oled_display_message (1)", oled_display_message("Douche 1 libre"));
+    panel()->fail_writes = 1;
+    STEP(name, "oled_display_message (2) refuse", oled_display_message("Douche 1 occupee"));
+    check_coherent(name);
+    STEP(name, "envoi suivant sans dessin", {
+        display_begin();
+        display_commit();
+    });
+    if (last_step.transactions == 0) {
+        fail(name, "region refusee par le bus non renvoyee");
+    }
+    finish(name);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 2 && strcmp(argv[1], "--check") == 0) {
+        run_mode = RUN_CHECK;
+    } else if (argc > 2 && strcmp(argv[1], "--update") == 0) {
+        run_mode = RUN_UPDATE;
+    } else if (argc > 2 && strcmp(argv[1], "--dump") == 0) {
+        run_mode = RUN_DUMP;
+    } else if (argc > 1) {
+        fprintf(stderr, "usage : %s [--check|--update|--dump DIR]\n", argv[0]);
+        return 2;
+    }
+    out_dir = (argc > 2) ? argv[2] : ".";
+
+    if (run_mode == RUN_BENCH) {
+        printf("%-10s %-32s %6s %7s %10s\n", "scenario", "appel", "trans.", "octets", "bus (us)");
+    }
+
+    scenario_boot();
+    scenario_message();
+    scenario_countdown();
+    scenario_overtime();
+    scenario_gfx();
+    scenario_clear();
+    scenario_dual();
+    scenario_bus_error();
+
+    if (run_mode == RUN_CHECK) {
+        printf("%s (%d echec(s))\n", failures ? "ECHEC" : "OK", failures);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,144 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: session_clock_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test de la base de temps des sessions (main/session_clock.c) sur une
+   horloge simulée : on avance esp_timer_get_time() au-delà des
+   débordements des anciennes horloges 32 bits et l’on vérifie les durées.
+
+     session_clock_test      exécute les scénarios, code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "session_clock.h"
+
+/* Débordement de xTaskGetTickCount() * portTICK_PERIOD_MS en uint32_t
+   (2^32 ms, environ 49,7 jours) et d’un compteur de microsecondes 32 bits
+   (2^32 µs, environ 71,6 minutes) */
+#define WRAP_32_MS_US   (4294967296LL * SESSION_US_PER_MS)
+#define WRAP_32_US      4294967296LL
+
+#define DURATION_US     (5 * 60 * SESSION_US_PER_S)
+
+static int64_t fake_now_us;
+static int failures;
+
+int64_t esp_timer_get_time(void)
+{
+    return fake_now_us;
+}
+
+static void advance(int64_t us)
+{
+    fake_now_us += us;
+}
+
+#define EXPECT_EQ(scenario, what, got, want)                                \
+    do {                                                                    \
+        int64_t got_ = (got), want_ = (want);                               \
+        if (got_ != want_) {                                                \
+            printf("ECHEC %s : %s = %" PRId64 " (attendu %" PRId64 ")\n",   \
+                   scenario, what, got_, want_);                            \
+            failures++;                                                     \
+        }                                                                   \
+    } while (0)
+
+/* Ancien calcul de timer_manager_get_total_time() : millisecondes en
+   uint32_t, 0 dès que "now" paraît antérieur au démarrage */
+static uint32_t legacy_total_ms(uint32_t start_ms, uint32_t now_ms)
+{
+    return (now_ms > start_ms) ? now_ms - start_ms : 0;
+}
+
+/* Douche qui commence 2 s avant le débordement des millisecondes 32 bits
+   et se termine 7 min plus tard, en dépassement */
+static void scenario_wrap_ms(void)
+{
+    const char* s = "wrap_ms";
+    session_clock_t c;
+
+    fake_now_us = WRAP_32_MS_US - 2 * SESSION_US_PER_S;
+    session_clock_start(&c, DURATION_US, session_clock_now_us());
+    uint32_t legacy_start = (uint32_t)(session_clock_now_us() / SESSION_US_PER_MS);
+
+    // Ticks d’une seconde de part et d’autre du débordement
+    for (int i = 1; i <= 10; i++) {
+        advance(session_clock_next_tick_us(&c, session_clock_now_us()));
+        EXPECT_EQ(s, "ecoule", session_clock_elapsed_us(&c, session_clock_now_us()),
+                  i * SESSION_US_PER_S);
+    }
+    EXPECT_EQ(s, "restant", session_clock_remaining_us(&c, session_clock_now_us()),
+              DURATION_US - 10 * SESSION_US_PER_S);
+
+    // Le scénario franchit bien le débordement : l’ancien calcul rendait 0
+    uint32_t legacy_now = (uint32_t)(session_clock_now_us() / SESSION_US_PER_MS);
+    EXPECT_EQ(s, "ancien calcul", legacy_total_ms(legacy_start, legacy_now), 0);
+
+    advance(7 * 60 * SESSION_US_PER_S - 10 * SESSION_US_PER_S);
+    EXPECT_EQ(s, "restant a l'echeance", session_clock_remaining_us(&c, session_clock_now_us()), 0);
+    EXPECT_EQ(s, "depassement", session_clock_overtime_us(&c, session_clock_now_us()),
+              2 * 60 * SESSION_US_PER_S);
+
+    session_clock_stop(&c, session_clock_now_us());
+    advance(SESSION_US_PER_S);
+    EXPECT_EQ(s, "duree figee", session_clock_elapsed_us(&c, session_clock_now_us()),
+              7 * 60 * SESSION_US_PER_S);
+    EXPECT_EQ(s, "en cours", session_clock_running(&c), 0);
+}
+
+/* Débordement d’un compteur de microsecondes 32 bits en pleine douche */
+static void scenario_wrap_us(void)
+{
+    const char* s = "wrap_us";
+    session_clock_t c;
+
+    fake_now_us = WRAP_32_US - 500 * SESSION_US_PER_MS;
+    session_clock_start(&c, DURATION_US, session_clock_now_us());
+    advance(3 * SESSION_US_PER_S + 250);
+    EXPECT_EQ(s, "ecoule", session_clock_elapsed_us(&c, session_clock_now_us()),
+              3 * SESSION_US_PER_S + 250);
+    EXPECT_EQ(s, "prochain tick", session_clock_next_tick_us(&c, session_clock_now_us()),
+              SESSION_US_PER_S - 250);
+}
+
+/* Appareil jamais redémarré : 400 jours de fonctionnement, réveil en retard,
+   double arrêt et horloge lue avant le démarrage */
+static void scenario_long_uptime(void)
+{
+    const char* s = "long_uptime";
+    session_clock_t c;
+
+    fake_now_us = 400LL * 24 * 3600 * SESSION_US_PER_S;
+    session_clock_start(&c, DURATION_US, session_clock_now_us());
+    EXPECT_EQ(s, "premier tick", session_clock_next_tick_us(&c, session_clock_now_us()),
+              SESSION_US_PER_S);
+
+    advance(42 * SESSION_US_PER_S + 3 * SESSION_US_PER_MS);    // Réveil 3 ms en retard
+    EXPECT_EQ(s, "tick suivant", session_clock_next_tick_us(&c, session_clock_now_us()),
+              997 * SESSION_US_PER_MS);
+    EXPECT_EQ(s, "avant le demarrage", session_clock_elapsed_us(&c, c.start_us - 1), 0);
+
+    session_clock_stop(&c, session_clock_now_us());
+    advance(SESSION_US_PER_S);
+    session_clock_stop(&c, session_clock_now_us());            // Sans effet
+    EXPECT_EQ(s, "duree", session_clock_elapsed_us(&c, session_clock_now_us()),
+              42 * SESSION_US_PER_S + 3 * SESSION_US_PER_MS);
+    EXPECT_EQ(s, "depassement", session_clock_overtime_us(&c, session_clock_now_us()), 0);
+}
+
+int main(void)
+{
+    scenario_wrap_ms();
+    scenario_wrap_us();
+    scenario_long_uptime();
+
+    printf("%s (%d ecart(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
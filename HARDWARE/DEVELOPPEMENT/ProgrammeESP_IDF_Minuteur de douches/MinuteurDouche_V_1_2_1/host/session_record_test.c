@@ -0,0 +1,155 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: session_record_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test du format binaire des douches (main/session_record.c) : trame de
+   référence octet par octet (la même que dans le test du décodeur
+   Python du pont), aller-retour codage / décodage, nombre de douches
+   par trame selon le MTU, rejet des trames abîmées.
+
+     session_record_test    code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "session_record.h"
+
+/* Trame de référence : en-tête (démarrage 7, 3600 s) et deux douches.
+   Recopiée dans test_session_record.py : à modifier des deux côtés. */
+static const char* GOLDEN_HEX =
+    "d501023e0700100e0000"
+    "2a00000007000101c4090000c89304008c3c0000227f00004826"
+    "616c696365000000000000000000000000000000000000000000000000000000a4d6b1c3"
+    "2b000000060000005802000090d0030000000000000000000000"
+    "626f620000000000000000000000000000000000000000000000000000000000bbc46fb4";
+
+static int failures;
+
+static void check(const char* what, int ok)
+{
+    if (!ok) {
+        printf("ECHEC : %s\n", what);
+        failures++;
+    }
+}
+
+static size_t from_hex(const char* hex, uint8_t* out)
+{
+    size_t n = 0;
+    unsigned v;
+    while (hex[0] && hex[1] && sscanf(hex, "%2x", &v) == 1) {
+        out[n++] = (uint8_t)v;
+        hex += 2;
+    }
+    return n;
+}
+
+static void make_records(session_record_t* r)
+{
+    memset(r, 0, 2 * sizeof(*r));
+    r[0].seq = 42;
+    r[0].boot = 7;
+    r[0].stall = 1;
+    r[0].flags = SESSION_RECORD_FLOW;
+    r[0].start_s = 2500;
+    r[0].duration_ms = 299976;
+    r[0].overtime_ms = 15500;
+    r[0].volume_ml = 32546;
+    r[0].peak_ml_min = 9800;
+    strcpy(r[0].user, "alice");
+
+    // Démarrage précédent, douche d’un ancien firmware (secondes × 1000)
+    r[1].seq = 43;
+    r[1].boot = 6;
+    r[1].start_s = 600;
+    r[1].duration_ms = 250000;
+    strcpy(r[1].user, "bob");
+}
+
+static int same(const session_record_t* a, const session_record_t* b)
+{
+    return a->seq == b->seq && a->boot == b->boot && a->stall == b->stall &&
+           a->flags == b->flags && a->start_s == b->start_s &&
+           a->duration_ms == b->duration_ms && a->overtime_ms == b->overtime_ms &&
+           a->volume_ml == b->volume_ml && a->peak_ml_min == b->peak_ml_min &&
+           strcmp(a->user, b->user) == 0;
+}
+
+int main(void)
+{
+    static uint8_t buf[512], golden[512];
+    session_record_t rec[2], back[8];
+    session_frame_info_t info;
+    session_frame_t f;
+
+    make_records(rec);
+
+    // Trame de référence (le CRC de chaque douche est celui de zlib.crc32)
+    size_t golden_len = from_hex(GOLDEN_HEX, golden);
+    session_frame_begin(&f, buf, sizeof(buf), 7, 3600);
+    check("ajout 1", session_frame_add(&f, &rec[0]));
+    check("ajout 2", session_frame_add(&f, &rec[1]));
+    size_t len = session_frame_end(&f);
+    check("longueur de reference", len == golden_len && len == SESSION_FRAME_MIN_LEN + 62);
+    check("octets de reference", len == golden_len && memcmp(buf, golden, len) == 0);
+    if (len == golden_len && memcmp(buf, golden, len) != 0) {
+        for (size_t i = 0; i < len; i++) printf("%02x", buf[i]);
+        printf("\n");
+    }
+
+    // Aller-retour
+    int n = session_frame_decode(buf, len, &info, back, 8);
+    check("relecture", n == 2);
+    check("en-tete relu", info.version == SESSION_RECORD_VERSION && info.count == 2 &&
+                          info.boot == 7 && info.uptime_s == 3600);
+    check("douche 1 relue", n == 2 && same(&rec[0], &back[0]));
+    check("douche 2 relue", n == 2 && same(&rec[1], &back[1]));
+    check("place limitee", session_frame_decode(buf, len, &info, back, 1) == 1 && same(&rec[0], &back[0]));
+
+    // Nom de 31 caractères (le plus long) et nom trop long tronqué
+    session_record_t longue = rec[0];
+    memset(longue.user, 'x', sizeof(longue.user));
+    session_frame_begin(&f, buf, sizeof(buf), 7, 3600);
+    session_frame_add(&f, &longue);
+    len = session_frame_end(&f);
+    check("nom tronque", session_frame_decode(buf, len, &info, back, 8) == 1 &&
+                         strlen(back[0].user) == SESSION_RECORD_USER_MAX - 1);
+
+    // Douches par trame selon le MTU : la trame ne dépasse jamais la notification
+    const unsigned mtus[] = { 23, 75, 100, 185, 247, 500, 515 };
+    for (unsigned m = 0; m < sizeof(mtus) / sizeof(mtus[0]); m++) {
+        size_t max = mtus[m] - 3;
+        if (max > sizeof(buf)) max = sizeof(buf);
+        unsigned count = 0;
+        session_frame_begin(&f, buf, max, 7, 3600);
+        while (count < 20 && session_frame_add(&f, &rec[count % 2])) count++;
+        len = session_frame_end(&f);
+        unsigned want = max >= 10 ? (unsigned)((max - 10) / 62) : 0;
+        char what[64];
+        snprintf(what, sizeof(what), "MTU %u : %u douche(s)", mtus[m], want);
+        check(what, count == want && len <= max && (count == 0 ? len == 0 : len == 10 + 62 * count));
+        if (count) check(what, session_frame_decode(buf, len, &info, back, 8) == (int)count);
+    }
+
+    // Trames abîmées : rejetées en entier
+    memcpy(buf, golden, golden_len);
+    buf[10 + 20] ^= 0x01;
+    check("CRC faux", session_frame_decode(buf, golden_len, &info, back, 8) == -1);
+    check("trame tronquee", session_frame_decode(golden, golden_len - 1, &info, back, 8) == -1);
+    check("en-tete seul", session_frame_decode(golden, 10, &info, back, 8) == -1);
+    memcpy(buf, golden, golden_len);
+    buf[0] = 'J';
+    check("ligne texte", session_frame_decode(buf, golden_len, &info, back, 8) == -1);
+    memcpy(buf, golden, golden_len);
+    buf[1] = SESSION_RECORD_VERSION + 1;
+    check("version inconnue", session_frame_decode(buf, golden_len, &info, back, 8) == -1);
+
+    printf("%s (%d ecart(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
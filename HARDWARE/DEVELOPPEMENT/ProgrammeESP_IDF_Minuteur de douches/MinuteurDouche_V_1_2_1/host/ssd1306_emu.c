@@ -0,0 +1,327 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ssd1306_emu.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Décodage du flux I2C du SSD1306 vers une GDDRAM en mémoire, comptage
+   du trafic et export des images (PGM, PBM).
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <string.h>
+#include "driver/i2c.h"
+#include "ssd1306_emu.h"
+
+#define EMU_MAX_PANELS  4
+
+// Un transfert coûte : START, 9 bits par octet (adresse comprise), STOP
+#define BUS_BITS(len)   (((len) + 1) * 9 + 2)
+
+static ssd1306_emu_t panels[EMU_MAX_PANELS];
+static int panel_count;
+
+static void power_on(ssd1306_emu_t *emu)
+{
+    int port = emu->port;
+    uint8_t addr = emu->addr;
+
+    // La GDDRAM n'est pas effacée à la mise sous tension : on la remplit
+    // d'un motif pour qu'un oubli d'effacement se voie dans les images.
+    memset(emu, 0, sizeof(*emu));
+    memset(emu->gddram, 0xA5, sizeof(emu->gddram));
+    emu->port = port;
+    emu->addr = addr;
+    emu->mode = EMU_ADDR_PAGE;
+    emu->col_end = EMU_WIDTH - 1;
+    emu->page_end = EMU_PAGES - 1;
+    emu->contrast = 0x7F;
+}
+
+ssd1306_emu_t *ssd1306_emu_get(int port, uint8_t addr)
+{
+    for (int i = 0; i < panel_count; i++) {
+        if (panels[i].port == port && panels[i].addr == addr) {
+            return &panels[i];
+        }
+    }
+    if (panel_count == EMU_MAX_PANELS) {
+        return NULL;
+    }
+    ssd1306_emu_t *emu = &panels[panel_count++];
+    emu->port = port;
+    emu->addr = addr;
+    power_on(emu);
+    return emu;
+}
+
+void ssd1306_emu_reset_all(void)
+{
+    for (int i = 0; i < panel_count; i++) {
+        power_on(&panels[i]);
+    }
+}
+
+void ssd1306_emu_clear_traffic(ssd1306_emu_t *emu)
+{
+    memset(&emu->traffic, 0, sizeof(emu->traffic));
+}
+
+// --- Décodage des commandes --------------------------------------------------
+
+// Nombre d'octets de paramètres attendus après une commande
+static int cmd_arg_count(uint8_t cmd)
+{
+    switch (cmd) {
+    case 0x21: case 0x22:
+        return 2;
+    case 0x20: case 0x81: case 0x8D: case 0xA8:
+    case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void exec_cmd(ssd1306_emu_t *emu)
+{
+    uint8_t cmd = emu->cmd;
+    const uint8_t *a = emu->args;
+
+    // 0x00-0x1F et 0xB0-0xB7 n'agissent qu'en adressage par page
+    // (datasheet SSD1306 §10.1.1 à 10.1.3) : ignorés dans les autres modes.
+    if (cmd <= 0x0F) {                          // colonne basse
+        if (emu->mode == EMU_ADDR_PAGE) {
+            emu->col = (uint8_t)((emu->col & 0xF0) | cmd);
+        }
+    } else if (cmd <= 0x1F) {                   // colonne haute
+        if (emu->mode == EMU_ADDR_PAGE) {
+            emu->col = (uint8_t)((emu->col & 0x0F) | ((cmd & 0x07) << 4));
+        }
+    } else if (cmd >= 0xB0 && cmd <= 0xB7) {    // page de départ
+        if (emu->mode == EMU_ADDR_PAGE) {
+            emu->page = cmd & 0x07;
+        }
+    } else if (cmd >= 0x40 && cmd <= 0x7F) {
+        // ligne de départ : sans effet sur l'image décodée
+    } else {
+        switch (cmd) {
+        case 0x20:
+            if ((a[0] & 0x03) == 0x03) {
+                emu->errors++;
+            } else {
+                emu->mode = (emu_addr_mode_t)(a[0] & 0x03);
+            }
+            break;
+        case 0x21:
+            emu->col_start = a[0] & 0x7F;
+            emu->col_end = a[1] & 0x7F;
+            emu->col = emu->col_start;
+            break;
+        case 0x22:
+            emu->page_start = a[0] & 0x07;
+            emu->page_end = a[1] & 0x07;
+            emu->page = emu->page_start;
+            break;
+        case 0x81: emu->contrast = a[0]; break;
+        case 0x8D: emu->charge_pump = (a[0] & 0x04) != 0; break;
+        case 0xA6: emu->inverted = false; break;
+        case 0xA7: emu->inverted = true; break;
+        case 0xAE: emu->display_on = false; break;
+        case 0xAF: emu->display_on = true; break;
+        // Réglages électriques et d'orientation : acceptés, non modélisés.
+        // L'image décodée correspond à l'orientation A1 / C8 du montage.
+        case 0xA0: case 0xA1: case 0xA4: case 0xA5:
+        case 0xC0: case 0xC8: case 0xE3:
+        case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            break;
+        default:
+            emu->errors++;
+            break;
+        }
+    }
+}
+
+static void feed_cmd(ssd1306_emu_t *emu, uint8_t byte)
+{
+    if (emu->want == 0) {
+        emu->cmd = byte;
+        emu->nargs = 0;
+        emu->want = (uint8_t)cmd_arg_count(byte);
+    } else {
+        emu->args[emu->nargs++] = byte;
+        emu->want--;
+    }
+    if (emu->want == 0) {
+        exec_cmd(emu);
+    }
+}
+
+// Écriture d'un octet en GDDRAM puis avancée du pointeur selon le mode
+static void feed_data(ssd1306_emu_t *emu, uint8_t byte)
+{
+    if (emu->want != 0) {
+        emu->errors++;                  // données au milieu d'une commande
+        emu->want = 0;
+    }
+    emu->gddram[emu->page & 0x07][emu->col & 0x7F] = byte;
+
+    switch (emu->mode) {
+    case EMU_ADDR_PAGE:
+        emu->col = (emu->col >= EMU_WIDTH - 1) ? 0 : emu->col + 1;
+        break;
+    case EMU_ADDR_HORIZONTAL:
+        if (emu->col >= emu->col_end) {
+            emu->col = emu->col_start;
+            emu->page = (emu->page >= emu->page_end) ? emu->page_start : emu->page + 1;
+        } else {
+            emu->col++;
+        }
+        break;
+    case EMU_ADDR_VERTICAL:
+        if (emu->page >= emu->page_end) {
+            emu->page = emu->page_start;
+            emu->col = (emu->col >= emu->col_end) ? emu->col_start : emu->col + 1;
+        } else {
+            emu->page++;
+        }
+        break;
+    }
+}
+
+// --- Faux driver I2C ---------------------------------------------------------
+
+esp_err_t i2c_param_config(i2c_port_t port, const i2c_config_t *conf)
+{
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t port, i2c_mode_t mode, size_t rx_len, size_t tx_len, int flags)
+{
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_write_to_device(i2c_port_t port, uint8_t addr, const uint8_t *buf, size_t len, TickType_t timeout)
+{
+    ssd1306_emu_t *emu = ssd1306_emu_get(port, addr);
+    if (emu == NULL || len == 0) {
+        return ESP_FAIL;
+    }
+    if (emu->fail_writes > 0) {
+        emu->fail_writes--;
+        return ESP_FAIL;
+    }
+
+    emu->traffic.transactions++;
+    emu->traffic.bytes += (uint32_t)len + 1;
+    emu->traffic.bus_us += BUS_BITS(len) * 1e6 / EMU_I2C_HZ;
+
+    // Octet de contrôle : Co (bit 7) = un seul octet suit, D/C (bit 6) = données
+    size_t i = 0;
+    while (i < len) {
+        uint8_t ctrl = buf[i++];
+        bool data = (ctrl & 0x40) != 0;
+        if (ctrl & 0x3F) {
+            emu->errors++;
+        }
+        if (ctrl & 0x80) {
+            if (i == len) {
+                emu->errors++;
+                break;
+            }
+            data ? feed_data(emu, buf[i]) : feed_cmd(emu, buf[i]);
+            i++;
+        } else {
+            for (; i < len; i++) {
+                data ? feed_data(emu, buf[i]) : feed_cmd(emu, buf[i]);
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+// --- Images ------------------------------------------------------------------
+
+bool ssd1306_emu_pixel(const ssd1306_emu_t *emu, int x, int y)
+{
+    if (!emu->display_on) {
+        return false;
+    }
+    bool on = (emu->gddram[y / 8][x] >> (y % 8)) & 1;
+    return on != emu->inverted;
+}
+
+int ssd1306_emu_write_pgm(const ssd1306_emu_t *emu, const char *path, int zoom)
+{
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        return -1;
+    }
+    if (zoom < 1) {
+        zoom = 1;
+    }
+
+    // Pixels allumés de gris moyen (contraste 0) à blanc (contraste 255)
+    uint8_t lit = (uint8_t)(80 + emu->contrast * 175 / 255);
+    fprintf(f, "P5\n%d %d\n255\n", EMU_WIDTH * zoom, EMU_PAGES * 8 * zoom);
+    for (int y = 0; y < EMU_PAGES * 8 * zoom; y++) {
+        for (int x = 0; x < EMU_WIDTH * zoom; x++) {
+            fputc(ssd1306_emu_pixel(emu, x / zoom, y / zoom) ? lit : 0, f);
+        }
+    }
+    return fclose(f);
+}
+
+int ssd1306_emu_write_pbm(const ssd1306_emu_t *emu, const char *path)
+{
+    FILE *f = fopen(path, "w");
+    if (f == NULL) {
+        return -1;
+    }
+    fprintf(f, "P1\n%d %d\n", EMU_WIDTH, EMU_PAGES * 8);
+    for (int y = 0; y < EMU_PAGES * 8; y++) {
+        for (int x = 0; x < EMU_WIDTH; x++) {
+            fputc(ssd1306_emu_pixel(emu, x, y) ? '1' : '0', f);
+        }
+        fputc('\n', f);
+    }
+    return fclose(f);
+}
+
+// Retourne le nombre de pixels différents, ou -1 si la référence est illisible
+int ssd1306_emu_compare_pbm(const ssd1306_emu_t *emu, const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return -1;
+    }
+
+    int w = 0, h = 0;
+    if (fscanf(f, "P1 %d %d", &w, &h) != 2 || w != EMU_WIDTH || h != EMU_PAGES * 8) {
+        fclose(f);
+        return -1;
+    }
+
+    int diff = 0;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            int c;
+            do {
+                c = fgetc(f);
+            } while (c == ' ' || c == '\n' || c == '\r' || c == '\t');
+            if (c != '0' && c != '1') {
+                fclose(f);
+                return -1;
+            }
+            if ((c == '1') != ssd1306_emu_pixel(emu, x, y)) {
+                diff++;
+            }
+        }
+    }
+    fclose(f);
+    return diff;
+}
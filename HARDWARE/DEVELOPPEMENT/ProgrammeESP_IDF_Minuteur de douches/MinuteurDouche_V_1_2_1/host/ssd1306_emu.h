@@ -0,0 +1,84 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ssd1306_emu.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Émulateur SSD1306 branché derrière un faux driver I2C (compilation PC).
+   Chaque écriture i2c_master_write_to_device() est décodée comme le ferait
+   le contrôleur : octets de contrôle, commandes (adressage page /
+   horizontal / vertical, fenêtres 0x21 / 0x22, contraste, allumage...) et
+   données écrites dans une GDDRAM de 128x64. Le trafic est compté par
+   panneau.
+
+-- ========================================================================== */
+
+#ifndef SSD1306_EMU_H
+#define SSD1306_EMU_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define EMU_WIDTH           128
+#define EMU_PAGES           8
+#define EMU_I2C_HZ          400000
+
+typedef enum {
+    EMU_ADDR_HORIZONTAL = 0,
+    EMU_ADDR_VERTICAL = 1,
+    EMU_ADDR_PAGE = 2,
+} emu_addr_mode_t;
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;             // octets écrits, adresse I2C comprise
+    double   bus_us;            // durée estimée sur le bus à EMU_I2C_HZ
+} emu_traffic_t;
+
+typedef struct {
+    int      port;
+    uint8_t  addr;
+
+    uint8_t  gddram[EMU_PAGES][EMU_WIDTH];
+    emu_addr_mode_t mode;
+    uint8_t  col, page;                 // pointeurs d'écriture
+    uint8_t  col_start, col_end;        // fenêtre 0x21
+    uint8_t  page_start, page_end;      // fenêtre 0x22
+    uint8_t  contrast;
+    bool     display_on;
+    bool     inverted;
+    bool     charge_pump;
+
+    // Décodage d'une commande à paramètres en cours
+    uint8_t  cmd;
+    uint8_t  args[2];
+    uint8_t  nargs, want;
+
+    emu_traffic_t traffic;
+    uint32_t errors;                    // commandes inconnues, trames invalides
+    uint32_t fail_writes;               // écritures suivantes refusées (erreur de bus simulée)
+} ssd1306_emu_t;
+
+// Panneau à l'adresse donnée (créé à la première écriture)
+ssd1306_emu_t *ssd1306_emu_get(int port, uint8_t addr);
+
+// Remet tous les panneaux dans l'état de mise sous tension
+void ssd1306_emu_reset_all(void);
+
+void ssd1306_emu_clear_traffic(ssd1306_emu_t *emu);
+
+// Pixel tel qu'affiché (tient compte de l'extinction et de l'inversion)
+bool ssd1306_emu_pixel(const ssd1306_emu_t *emu, int x, int y);
+
+// Image en niveaux de gris (PGM binaire), agrandie "zoom" fois, la
+// luminosité suit le contraste programmé.
+int ssd1306_emu_write_pgm(const ssd1306_emu_t *emu, const char *path, int zoom);
+
+// Image de référence noir et blanc (PBM ASCII) : écriture et comparaison.
+int ssd1306_emu_write_pbm(const ssd1306_emu_t *emu, const char *path);
+int ssd1306_emu_compare_pbm(const ssd1306_emu_t *emu, const char *path);
+
+#endif // SSD1306_EMU_H
@@ -0,0 +1,171 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: stall_schedule_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test des échéances multi-cabines (main/stall_schedule.c) sur horloge
+   simulée, rejouées comme le fait timer_manager_task : réveil sur
+   stall_schedule_next (avec un retard), traitement de toutes les
+   échéances atteintes, programmation des suivantes.
+
+   Vérifie pour chaque cabine : un tick par seconde de session, aucun
+   tick ni clignotement perdu ou traité deux fois, aucun traité avant son
+   échéance ni plus tard que le retard du réveil ; une cabine arrêtée ne
+   réveille plus la tâche ; des échéances simultanées ne coûtent qu’un
+   réveil.
+
+     stall_schedule_test    code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include "stall_schedule.h"
+#include "session_clock.h"
+
+#define BLINK_US        (400 * SESSION_US_PER_MS)    // Comme OVERTIME_BLINK_US
+#define WAKE_LAG_US     700                          // Retard du réveil de la tâche
+
+/* Douche simulée d’une cabine (instants relatifs au début du scénario) */
+typedef struct {
+    int64_t start_us;
+    int64_t budget_us;
+    int64_t stop_us;
+} shower_t;
+
+static int64_t fake_now_us;
+static int failures;
+
+int64_t esp_timer_get_time(void)
+{
+    return fake_now_us;
+}
+
+static void check(const char* scenario, const char* what, int ok)
+{
+    if (!ok) {
+        printf("ECHEC %s : %s\n", scenario, what);
+        failures++;
+    }
+}
+
+/* Rejoue les douches ; retourne le nombre de réveils de la tâche */
+static int replay(const char* scenario, const shower_t* showers, uint8_t count)
+{
+    stall_schedule_t s;
+    session_clock_t clock[STALL_MAX];
+    bool running[STALL_MAX] = { false };
+    int64_t ticks[STALL_MAX] = { 0 };
+    int64_t blinks[STALL_MAX] = { 0 };
+    int64_t end_us = 0;
+    int wakeups = 0;
+
+    stall_schedule_init(&s, count);
+    for (uint8_t i = 0; i < count; i++) {
+        if (showers[i].stop_us > end_us) end_us = showers[i].stop_us;
+    }
+
+    fake_now_us = 0;
+    while (fake_now_us <= end_us) {
+        // Prochain événement : échéance (+ retard du réveil), début ou fin de douche
+        int64_t wake = stall_schedule_next(&s);
+        if (wake != STALL_NO_DEADLINE) wake += WAKE_LAG_US;
+        for (uint8_t i = 0; i < count; i++) {
+            if (!running[i] && showers[i].start_us >= fake_now_us && showers[i].start_us < wake)
+                wake = showers[i].start_us;
+            if (running[i] && showers[i].stop_us < wake) wake = showers[i].stop_us;
+        }
+        if (wake == STALL_NO_DEADLINE) break;
+        fake_now_us = wake;
+
+        // Commandes d’abord (comme process_commands), puis échéances
+        for (uint8_t i = 0; i < count; i++) {
+            if (!running[i] && showers[i].start_us == fake_now_us) {
+                session_clock_start(&clock[i], showers[i].budget_us, fake_now_us);
+                s.tick_us[i] = fake_now_us + session_clock_next_tick_us(&clock[i], fake_now_us);
+                running[i] = true;
+            }
+            else if (running[i] && showers[i].stop_us == fake_now_us) {
+                session_clock_stop(&clock[i], fake_now_us);
+                stall_schedule_clear(&s, i);
+                running[i] = false;
+            }
+        }
+
+        uint32_t blink_mask;
+        uint32_t tick_mask = stall_schedule_due(&s, fake_now_us, &blink_mask);
+        if (tick_mask | blink_mask) wakeups++;
+
+        for (uint8_t i = 0; i < count; i++) {
+            if (tick_mask & (1u << i)) {
+                int64_t late = fake_now_us - s.tick_us[i];
+                check(scenario, "tick en retard", late >= 0 && late <= WAKE_LAG_US);
+                check(scenario, "tick d'une cabine arretee", running[i]);
+                ticks[i]++;
+                if (s.blink_us[i] == STALL_NO_DEADLINE &&
+                    session_clock_remaining_us(&clock[i], fake_now_us) == 0) {
+                    s.blink_us[i] = fake_now_us + BLINK_US;
+                }
+                s.tick_us[i] = fake_now_us + session_clock_next_tick_us(&clock[i], fake_now_us);
+            }
+            if (blink_mask & (1u << i)) {
+                int64_t late = fake_now_us - s.blink_us[i];
+                check(scenario, "clignotement en retard", late >= 0 && late <= WAKE_LAG_US);
+                blinks[i]++;
+                s.blink_us[i] += BLINK_US;
+            }
+        }
+    }
+
+    check(scenario, "plus aucune echeance", stall_schedule_next(&s) == STALL_NO_DEADLINE);
+    for (uint8_t i = 0; i < count; i++) {
+        int64_t length = showers[i].stop_us - showers[i].start_us;
+        int64_t over = length - showers[i].budget_us;
+        int64_t want_ticks = (length - 1) / SESSION_US_PER_S;
+        int64_t want_blinks = over > 0 ? (over - 1) / BLINK_US : 0;
+
+        if (ticks[i] != want_ticks || blinks[i] != want_blinks) {
+            printf("ECHEC %s : cabine %u, %" PRId64 " ticks / %" PRId64 " clignotements"
+                   " (attendu %" PRId64 " / %" PRId64 ")\n", scenario, (unsigned)i,
+                   ticks[i], blinks[i], want_ticks, want_blinks);
+            failures++;
+        }
+    }
+    return wakeups;
+}
+
+int main(void)
+{
+    const int64_t S = SESSION_US_PER_S;
+
+    // Huit cabines décalées : durées, dépassements et arrêts différents
+    shower_t staggered[STALL_MAX];
+    for (uint8_t i = 0; i < STALL_MAX; i++) {
+        staggered[i].start_us = i * 137 * SESSION_US_PER_MS + i * 41 * S;
+        staggered[i].budget_us = (180 + 30 * i) * S;
+        staggered[i].stop_us = staggered[i].start_us + staggered[i].budget_us
+                               + (i % 3 == 0 ? -20 * S : (int64_t)i * 7 * S + 250 * SESSION_US_PER_MS);
+    }
+    replay("decalees", staggered, STALL_MAX);
+
+    // Départs simultanés : un seul réveil par seconde pour toutes les cabines
+    shower_t together[STALL_MAX];
+    for (uint8_t i = 0; i < STALL_MAX; i++) {
+        together[i].start_us = 5 * S;
+        together[i].budget_us = 60 * S;
+        together[i].stop_us = 5 * S + 30 * S + 500 * SESSION_US_PER_MS;
+    }
+    int wakeups = replay("simultanees", together, STALL_MAX);
+    check("simultanees", "un reveil par seconde", wakeups == 30);
+
+    // Une seule cabine (carte d’origine)
+    shower_t single[1] = { { 0, 300 * S, 330 * S } };
+    replay("une cabine", single, 1);
+
+    printf("%s (%d ecart(s))\n", failures ? "ECHEC" : "OK", failures);
+    return failures ? 1 : 0;
+}
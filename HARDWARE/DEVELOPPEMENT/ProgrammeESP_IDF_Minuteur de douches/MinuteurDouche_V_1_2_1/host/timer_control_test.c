@@ -0,0 +1,216 @@
+/* ========================================================================== --
+                  Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: timer_control_test.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Test de charge de main/timer_control.c sur PC, avec des threads POSIX à
+   la place des tâches FreeRTOS :
+   - plusieurs producteurs (bouton, BLE...) martèlent start / stop /
+     utilisateur / durée allouée dans la file sans verrou
+   - un consommateur unique applique les commandes et publie l’instantané,
+     comme timer_manager_task
+   - des lecteurs relisent l’instantané en continu et vérifient qu’aucune
+     copie n’est déchirée
+
+   Vérifications : aucune commande perdue ni dupliquée, transitions
+   start / stop cohérentes, instantanés toujours cohérents.
+
+     timer_control_test      code de sortie 1 en cas d’écart
+
+-- ========================================================================== */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include "timer_control.h"
+
+#define PRODUCERS        4
+#define READERS          2
+#define CMDS_PER_THREAD  50000
+
+static timer_cmd_queue_t queue;
+static timer_snapshot_cell_t cell;
+static timer_sm_t sm;
+
+static atomic_int producers_done;
+static atomic_bool consumer_done;
+static atomic_long pushed[4];               // Par type de commande
+static atomic_long full_retries;
+static long popped[4];
+static long started, stopped, rejected;
+static atomic_int failures;
+
+/* Horloge simulée : un pas par commande traitée */
+static atomic_llong fake_now_us;
+
+int64_t esp_timer_get_time(void)
+{
+    return atomic_load(&fake_now_us);
+}
+
+static void fail(const char* what)
+{
+    if (atomic_fetch_add(&failures, 1) < 10) {
+        printf("ECHEC %s\n", what);
+    }
+}
+
+/* Nom d’utilisateur uniforme : une copie déchirée mélangerait les lettres */
+static void make_user(char* user, char letter)
+{
+    memset(user, letter, TIMER_USER_MAX - 1);
+    user[TIMER_USER_MAX - 1] = '\0';
+}
+
+static bool user_uniform(const char* user)
+{
+    size_t len = strlen(user);
+    if (len == 0) return true;
+    if (len != TIMER_USER_MAX - 1) return false;
+    for (size_t i = 1; i < len; i++) {
+        if (user[i] != user[0]) return false;
+    }
+    return true;
+}
+
+/* Générateur pseudo-aléatoire propre à chaque thread */
+static unsigned next_rand(unsigned* s)
+{
+    *s = *s * 1103515245u + 12345u;
+    return *s >> 16;
+}
+
+static void* producer(void* arg)
+{
+    int id = (int)(intptr_t)arg;
+    unsigned seed = 1234u + (unsigned)id;
+
+    for (int i = 0; i < CMDS_PER_THREAD; i++) {
+        timer_cmd_t cmd;
+        memset(&cmd, 0, sizeof(cmd));
+        cmd.type = (timer_cmd_type_t)(next_rand(&seed) % 4);
+
+        switch (cmd.type) {
+        case TIMER_CMD_START:
+            if (next_rand(&seed) & 1) make_user(cmd.user, (char)('A' + id));
+            break;
+        case TIMER_CMD_SET_USER:
+            make_user(cmd.user, (char)('a' + id));
+            break;
+        case TIMER_CMD_SET_BUDGET:
+            cmd.budget_us = 1 + (int64_t)(next_rand(&seed) % 600) * SESSION_US_PER_S;
+            break;
+        default:
+            break;
+        }
+
+        while (!timer_cmd_push(&queue, &cmd)) {
+            atomic_fetch_add(&full_retries, 1);
+            sched_yield();
+        }
+        atomic_fetch_add(&pushed[cmd.type], 1);
+    }
+
+    atomic_fetch_add(&producers_done, 1);
+    return NULL;
+}
+
+static void* consumer(void* arg)
+{
+    timer_cmd_t cmd;
+
+    for (;;) {
+        bool done = atomic_load(&producers_done) == PRODUCERS;
+
+        while (timer_cmd_pop(&queue, &cmd)) {
+            popped[cmd.type]++;
+            atomic_fetch_add(&fake_now_us, 1);
+            timer_state_t before = sm.state;
+
+            switch (timer_sm_apply(&sm, &cmd, esp_timer_get_time())) {
+            case TIMER_SM_STARTED:
+                if (before != TIMER_STOPPED) fail("demarrage d'une session en cours");
+                started++;
+                break;
+            case TIMER_SM_STOPPED:
+                if (before == TIMER_STOPPED) fail("arret d'une session arretee");
+                stopped++;
+                break;
+            case TIMER_SM_NO_USER:
+                rejected++;
+                break;
+            default:
+                break;
+            }
+            if (!user_uniform(sm.user)) fail("nom d'utilisateur melange");
+            timer_snapshot_publish(&cell, &sm);
+        }
+        if (done) break;                    // File vide après la fin des producteurs
+        sched_yield();
+    }
+
+    atomic_store(&consumer_done, true);
+    return NULL;
+}
+
+static void* reader(void* arg)
+{
+    uint32_t last_sessions = 0;
+    int64_t last_start = 0;
+    timer_snapshot_t snap;
+
+    while (!atomic_load(&consumer_done)) {
+        timer_snapshot_read(&cell, &snap);
+
+        if (!user_uniform(snap.user)) fail("instantane : nom dechire");
+        if (snap.state == TIMER_STOPPED && snap.sessions > 0 && snap.stop_us == 0)
+            fail("instantane : arrete sans instant d'arret");
+        if (snap.state != TIMER_STOPPED && snap.stop_us != 0)
+            fail("instantane : en cours avec instant d'arret");
+        if (snap.sessions < last_sessions || snap.start_us < last_start)
+            fail("instantane : retour en arriere");
+        last_sessions = snap.sessions;
+        last_start = snap.start_us;
+        sched_yield();
+    }
+    return NULL;
+}
+
+int main(void)
+{
+    pthread_t prod[PRODUCERS], rd[READERS], cons;
+
+    timer_cmd_queue_init(&queue);
+    timer_sm_init(&sm, 5 * 60 * SESSION_US_PER_S);
+    timer_snapshot_publish(&cell, &sm);
+
+    pthread_create(&cons, NULL, consumer, NULL);
+    for (int i = 0; i < READERS; i++) pthread_create(&rd[i], NULL, reader, NULL);
+    for (int i = 0; i < PRODUCERS; i++) pthread_create(&prod[i], NULL, producer, (void*)(intptr_t)i);
+
+    for (int i = 0; i < PRODUCERS; i++) pthread_join(prod[i], NULL);
+    pthread_join(cons, NULL);
+    for (int i = 0; i < READERS; i++) pthread_join(rd[i], NULL);
+
+    for (int t = 0; t < 4; t++) {
+        if (popped[t] != atomic_load(&pushed[t])) fail("commandes perdues ou dupliquees");
+    }
+    if (started - stopped != (sm.state != TIMER_STOPPED ? 1 : 0)) fail("bilan start / stop");
+    if (sm.sessions != (uint32_t)started) fail("compteur de sessions");
+
+    timer_snapshot_t snap;
+    timer_snapshot_read(&cell, &snap);
+    if (snap.state != sm.state || snap.sessions != sm.sessions || strcmp(snap.user, sm.user) != 0)
+        fail("instantane final");
+
+    printf("%d commandes, %ld demarrages, %ld arrets, %ld refus, %ld file pleine\n",
+           PRODUCERS * CMDS_PER_THREAD, started, stopped, rejected, atomic_load(&full_retries));
+    printf("%s (%d ecart(s))\n", failures ? "ECHEC" : "OK", atomic_load(&failures));
+    return failures ? 1 : 0;
+}
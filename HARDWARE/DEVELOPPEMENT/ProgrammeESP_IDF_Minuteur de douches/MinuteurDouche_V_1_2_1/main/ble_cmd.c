@@ -0,0 +1,164 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ble_cmd.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Commandes binaires du pont (voir ble_cmd.h).
+
+   Une écriture est lue commande par commande ; une commande coupée
+   (écriture tronquée) reçoit le statut BLE_CMD_E_TRUNCATED et termine
+   le traitement. Les réponses s’accumulent dans le tampon de sortie,
+   émis dès que la suivante n’y tiendrait plus, puis à la fin.
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "ble_cmd.h"
+#include <string.h>
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: put_u16
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Entier 16 bits little-endian
+
+-- -------------------------------------------------------------------------- */
+static void put_u16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_cmd_process
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Exécute les commandes d’une écriture
+
+   --------------------------------------------------------------------------
+   Description:
+   L’opcode indexe la table : pas de recherche, quel que soit le nombre
+   de commandes. La longueur de l’argument est vérifiée avant l’appel du
+   traitement, qui ne voit que des arguments de la bonne taille.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     table, count : traitements, indexés par l’opcode
+     ctx          : argument des traitements
+     in, len      : écriture reçue
+     out, out_max : tampon d’une notification (MTU - 3)
+     emit         : envoi d’une notification de réponses
+     emit_ctx     : argument de emit
+
+   --------------------------------------------------------------------------
+   Return value:
+     Nombre de commandes traitées
+
+-- -------------------------------------------------------------------------- */
+size_t ble_cmd_process(const ble_cmd_def_t* table, size_t count, void* ctx,
+                       const uint8_t* in, size_t len,
+                       uint8_t* out, size_t out_max, ble_cmd_emit_fn emit, void* emit_ctx) {
+    size_t pos = 0, used = 0, done = 0;
+
+    while (pos < len) {
+        // Réponse construite directement à sa place dans la notification
+        if (used + BLE_CMD_RESP_MAX > out_max) {
+            emit(emit_ctx, out, used);
+            used = 0;
+        }
+        uint8_t* resp = out + used;
+        uint8_t opcode = in[pos];
+        uint8_t id = pos + 1 < len ? in[pos + 1] : 0;
+        uint8_t data_len = 0;
+        ble_cmd_status_t status;
+
+        if (len - pos < BLE_CMD_HEADER || len - pos - BLE_CMD_HEADER < in[pos + 2]) {
+            status = BLE_CMD_E_TRUNCATED;
+            pos = len;
+        } else {
+            uint8_t arg_len = in[pos + 2];
+            const uint8_t* arg = in + pos + BLE_CMD_HEADER;
+            const ble_cmd_def_t* def = opcode < count ? &table[opcode] : NULL;
+
+            pos += BLE_CMD_HEADER + arg_len;
+            if (def == NULL || def->handler == NULL) {
+                status = BLE_CMD_E_UNKNOWN;
+            } else if (arg_len < def->min_len || arg_len > def->max_len) {
+                status = BLE_CMD_E_LENGTH;
+            } else {
+                status = def->handler(ctx, arg, arg_len, resp + BLE_CMD_RESP_HEADER, &data_len);
+                if (data_len > BLE_CMD_RESP_DATA_MAX) data_len = BLE_CMD_RESP_DATA_MAX;
+            }
+        }
+
+        resp[0] = opcode | BLE_CMD_RESP;
+        resp[1] = id;
+        resp[2] = (uint8_t)status;
+        resp[3] = data_len;
+        used += BLE_CMD_RESP_HEADER + data_len;
+        done++;
+    }
+    if (used > 0) emit(emit_ctx, out, used);
+    return done;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_cmd_put_stall_status
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Données de la réponse à STATUS
+
+   --------------------------------------------------------------------------
+   Return value:
+     Longueur écrite (BLE_CMD_STALL_STATUS_LEN)
+
+-- -------------------------------------------------------------------------- */
+uint8_t ble_cmd_put_stall_status(uint8_t* out, const ble_cmd_stall_status_t* st) {
+    out[0] = st->stall;
+    out[1] = st->state;
+    ble_cmd_put_u32(out + 2, st->elapsed_s);
+    put_u16(out + 6, st->duration_s);
+    put_u16(out + 8, st->budget_s);
+    ble_cmd_put_u32(out + 10, st->sessions);
+    return BLE_CMD_STALL_STATUS_LEN;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_cmd_get_u16 / ble_cmd_get_u32 / ble_cmd_put_u32
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Entiers little-endian (arguments non alignés)
+
+-- -------------------------------------------------------------------------- */
+uint16_t ble_cmd_get_u16(const uint8_t* p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+uint32_t ble_cmd_get_u32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+void ble_cmd_put_u32(uint8_t* p, uint32_t v) {
+    put_u16(p, (uint16_t)v);
+    put_u16(p + 2, (uint16_t)(v >> 16));
+}
@@ -0,0 +1,156 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ble_cmd.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Commandes binaires écrites sur la caractéristique COMMAND (0xABF3) et
+   réponses notifiées sur STATUS (0xABF4) :
+   - Une commande : opcode, identifiant choisi par le client, longueur
+     de l’argument, argument (BLE_CMD_HEADER + 0 à 255 octets)
+   - Une écriture peut enchaîner plusieurs commandes : le pont en envoie
+     autant qu’il veut en une fois, sans attendre les réponses
+   - Une réponse par commande, dans l’ordre : opcode | BLE_CMD_RESP,
+     identifiant de la commande, statut (ble_cmd_status_t), longueur,
+     données (BLE_CMD_RESP_DATA_MAX au plus). Les réponses sont groupées
+     dans des notifications d’au plus MTU - 3 octets ; une réponse n’est
+     jamais coupée (au MTU par défaut, une notification en tient une)
+   - Traitement choisi par l’opcode dans une table (ble_cmd_def_t,
+     indexée par l’opcode) qui borne aussi la longueur de l’argument
+   Entiers en little-endian. Le codeur Python du pont (commandes.py)
+   suit la même description ; les deux sont vérifiés sur les mêmes
+   octets de référence. Aucune dépendance ESP-IDF : module testé sur PC.
+
+   Opcodes et arguments (réponse : données après le statut) :
+     0x01 SELECT_USER  cabine u8, nom (1 à 31 octets)
+     0x02 SET_BUDGET   cabine u8, secondes u16, nom (0 à 31 octets ;
+                       avec un nom, durée mémorisée de cet utilisateur)
+     0x03 START        cabine u8, nom (0 à 31 octets : utilisateur courant)
+     0x04 STOP         cabine u8
+     0x05 STATUS       cabine u8 -> ble_cmd_stall_status_t (14 octets)
+     0x06 HISTORY      numéro u32 : journal renvoyé sur DATA après ce numéro
+     0x07 SET_CLOCK    secondes depuis 1970 u32 -> secondes depuis le
+                       démarrage u32 au moment du réglage
+     0x08 REBOOT       (aucun) : redémarrage après l’envoi des réponses,
+                       refusé pendant une douche (BLE_CMD_E_BUSY)
+
+-- ========================================================================== */
+
+#ifndef BLE_CMD_H
+#define BLE_CMD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define BLE_CMD_HEADER          3           // Opcode, identifiant, longueur
+#define BLE_CMD_RESP_HEADER     4           // Opcode | BLE_CMD_RESP, identifiant, statut, longueur
+#define BLE_CMD_RESP_DATA_MAX   16          // Une réponse tient dans une notification au MTU 23
+#define BLE_CMD_RESP_MAX        (BLE_CMD_RESP_HEADER + BLE_CMD_RESP_DATA_MAX)
+#define BLE_CMD_RESP            0x80        // Bit des opcodes de réponse
+
+#define BLE_CMD_SELECT_USER     0x01
+#define BLE_CMD_SET_BUDGET      0x02
+#define BLE_CMD_START           0x03
+#define BLE_CMD_STOP            0x04
+#define BLE_CMD_STATUS          0x05
+#define BLE_CMD_HISTORY         0x06
+#define BLE_CMD_SET_CLOCK       0x07
+#define BLE_CMD_REBOOT          0x08
+#define BLE_CMD_OPCODES         0x09        // Taille d’une table indexée par l’opcode
+
+#define BLE_CMD_STALL_STATUS_LEN 14
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   ENUM: ble_cmd_status_t
+   Statut d’une réponse
+-- -------------------------------------------------------------------------- */
+typedef enum {
+    BLE_CMD_OK,
+    BLE_CMD_E_UNKNOWN,                 // Opcode sans traitement
+    BLE_CMD_E_LENGTH,                  // Argument trop court ou trop long
+    BLE_CMD_E_ARG,                     // Argument refusé (cabine inconnue, durée nulle...)
+    BLE_CMD_E_BUSY,                    // Refusée pour l’instant (file du minuteur pleine...) : à refaire
+    BLE_CMD_E_TRUNCATED                // Écriture coupée au milieu d’une commande
+} ble_cmd_status_t;
+
+/* -------------------------------------------------------------------------- --
+   TYPE: ble_cmd_handler_fn
+   Traitement d’une commande ; les données de la réponse vont dans out
+   (BLE_CMD_RESP_DATA_MAX octets), leur longueur dans *out_len (0 par
+   défaut)
+-- -------------------------------------------------------------------------- */
+typedef ble_cmd_status_t (*ble_cmd_handler_fn)(void* ctx, const uint8_t* arg, uint8_t len,
+                                               uint8_t* out, uint8_t* out_len);
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: ble_cmd_def_t
+   Entrée de la table des commandes (indexée par l’opcode)
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    ble_cmd_handler_fn handler;        // NULL : opcode inconnu
+    uint8_t min_len;                   // Longueurs d’argument acceptées
+    uint8_t max_len;
+} ble_cmd_def_t;
+
+/* -------------------------------------------------------------------------- --
+   TYPE: ble_cmd_emit_fn
+   Envoie une notification de réponses (len <= out_max de ble_cmd_process)
+-- -------------------------------------------------------------------------- */
+typedef void (*ble_cmd_emit_fn)(void* ctx, const uint8_t* data, size_t len);
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: ble_cmd_stall_status_t
+   Réponse à STATUS (BLE_CMD_STALL_STATUS_LEN octets, dans cet ordre)
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint8_t stall;
+    uint8_t state;                     // timer_state_t
+    uint32_t elapsed_s;                // Session en cours (0 à l’arrêt)
+    uint16_t duration_s;               // Durée allouée à cette session
+    uint16_t budget_s;                 // Durée allouée aux prochaines
+    uint32_t sessions;                 // Sessions démarrées depuis le démarrage
+} ble_cmd_stall_status_t;
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_cmd_process
+   Exécute les commandes d’une écriture, dans l’ordre, et émet leurs
+   réponses groupées en notifications d’au plus out_max octets
+   (out_max >= BLE_CMD_RESP_MAX)
+   Retour : nombre de commandes traitées (réponses émises)
+-- -------------------------------------------------------------------------- */
+size_t ble_cmd_process(const ble_cmd_def_t* table, size_t count, void* ctx,
+                       const uint8_t* in, size_t len,
+                       uint8_t* out, size_t out_max, ble_cmd_emit_fn emit, void* emit_ctx);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_cmd_put_stall_status
+   Écrit une réponse à STATUS dans out
+   Retour : BLE_CMD_STALL_STATUS_LEN
+-- -------------------------------------------------------------------------- */
+uint8_t ble_cmd_put_stall_status(uint8_t* out, const ble_cmd_stall_status_t* st);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_cmd_get_u16 / ble_cmd_get_u32 / ble_cmd_put_u32
+   Entiers little-endian des arguments et des réponses
+-- -------------------------------------------------------------------------- */
+uint16_t ble_cmd_get_u16(const uint8_t* p);
+uint32_t ble_cmd_get_u32(const uint8_t* p);
+void ble_cmd_put_u32(uint8_t* p, uint32_t v);
+
+#endif // BLE_CMD_H
@@ -8,12 +8,16 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "freertos/semphr.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "esp_bt.h"
 #include "driver/uart.h"
 #include "string.h"
+#include <stdlib.h>
+#include <sys/time.h>
 
 #include "esp_gap_ble_api.h"
 #include "esp_gatts_api.h"
@@ -26,6 +30,14 @@
 #include "oled_display.h"
 #include "nvs_flash.h"
 #include "user_context.h"
+#include "timer_manager.h"
+#include "diag_service.h"
+#include "ble_tx.h"
+#include "prep_ring.h"
+#include "ble_cmd.h"
+#include "session_clock.h"
+#include "stall_config.h"
+#include "conn_policy.h"
 
 
 
@@ -38,6 +50,18 @@
 #define SAMPLE_DEVICE_NAME          "MinuteurESP32"    //The Device Name Characteristics in GAP
 #define SPP_SVC_INST_ID	            0
 
+/// Message du backend sur DATA_RECEIVE : "BUDGET:<nom>=<secondes>" (sinon : nom d'utilisateur)
+#define BUDGET_MSG_PREFIX           "BUDGET:"
+#define BUDGET_MSG_MAX_LEN          (sizeof(BUDGET_MSG_PREFIX) + 31 + 1 + 5)
+
+/// Utilisateur d'une cabine : "STALL:<cabine>=<nom>" (un nom seul vise la cabine 0)
+#define STALL_MSG_PREFIX            "STALL:"
+#define STALL_MSG_MAX_LEN           (sizeof(STALL_MSG_PREFIX) + 3 + 1 + 31)
+
+/// Journal des douches : "ACK:<seq>" (enregistré jusqu'à seq), "SYNC" (tout renvoyer)
+#define JOURNAL_ACK_PREFIX          "ACK:"
+#define JOURNAL_SYNC_MSG            "SYNC"
+
 /// SPP Service
 static const uint16_t spp_service_uuid = 0xABF0;
 /// Characteristic UUID
@@ -45,6 +69,7 @@ static const uint16_t spp_service_uuid = 0xABF0;
 #define ESP_GATT_UUID_SPP_DATA_NOTIFY       0xABF2
 #define ESP_GATT_UUID_SPP_COMMAND_RECEIVE   0xABF3
 #define ESP_GATT_UUID_SPP_COMMAND_NOTIFY    0xABF4
+#define ESP_GATT_UUID_SPP_DIAG              0xABF6
 
 #ifdef SUPPORT_HEARTBEAT
 #define ESP_GATT_UUID_SPP_HEARTBEAT         0xABF5
@@ -65,6 +90,7 @@ uint16_t spp_conn_id = 0xffff;
 esp_gatt_if_t spp_gatts_if = 0xff;
 QueueHandle_t spp_uart_queue = NULL;
 static QueueHandle_t cmd_cmd_queue = NULL;
+static QueueHandle_t cmd_free_queue = NULL;
 
 #ifdef SUPPORT_HEARTBEAT
 static QueueHandle_t cmd_heartbeat_queue = NULL;
@@ -74,14 +100,70 @@ static uint8_t heartbeat_count_num = 0;
 #endif
 
 bool enable_data_ntf = false;
+static bool enable_diag_ntf = false;
+static bool enable_status_ntf = false;
 bool is_connected = false;
 static esp_bd_addr_t spp_remote_bda = {0x0,};
 
 uint16_t spp_handle_table[SPP_IDX_NB];
-
+static bool spp_handles_contiguous = false;     // spp_handle_table[i] == handle du service + i
+
+/* Blocs notifiés sur DATA_NOTIFY (journal, pont série) : fragments à la
+   taille du MTU, rythmés par les confirmations et congestions de la pile.
+   Fenêtre courte devant la file de la tâche Bluedroid. La pile n’est
+   jamais appelée sous data_tx_lock : data_tx prépare les notifications
+   dans data_tx_stage, confiées à la pile après avoir rendu le verrou par
+   un seul contexte à la fois (data_tx_drain) */
+#define DATA_TX_WINDOW              8
+static ble_tx_t data_tx;
+static SemaphoreHandle_t data_tx_lock;
+static ble_spp_tx_done_fn data_tx_done;
+static void* data_tx_ctx;
+static bool data_tx_busy;                       // Dernier état reporté à conn_policy
+
+typedef struct {
+    uint16_t len;
+    uint8_t data[BLE_TX_NTF_MAX];
+} data_tx_ntf_t;
+static data_tx_ntf_t data_tx_stage[DATA_TX_WINDOW];     // Au plus une par notification non confirmée
+static uint8_t data_tx_stage_head;
+static uint8_t data_tx_stage_count;
+static uint8_t data_tx_gen;                     // Change à chaque abandon de bloc
+static uint32_t data_tx_block;                  // Change à chaque bloc soumis
+static bool data_tx_draining;
+static SemaphoreHandle_t uart_tx_sem;
+
+/* Réponses aux commandes binaires (STATUS) : au plus STATUS_TX_WINDOW
+   notifications non confirmées ; spp_cmd_task attend un jeton libéré par
+   ESP_GATTS_CONF_EVT avant la suivante */
+#define STATUS_TX_WINDOW            4
+#define STATUS_TX_WAIT_MS           1000
+static SemaphoreHandle_t status_tx_sem;
+static uint32_t status_tx_dropped;              // Notifications abandonnées faute de jeton
+
+/* Paramètres de connexion selon l’activité (conn_policy) : réévalués à
+   chaque changement d’activité et à l’échéance de conn_timer, le tout
+   sous conn_lock (tâche Bluedroid, tâches du journal et des commandes) */
+static conn_policy_t conn_policy;
+static SemaphoreHandle_t conn_lock;
+static esp_timer_handle_t conn_timer;
+
+/* Écriture reçue sur COMMAND, remise à spp_cmd_task. Emplacements
+   statiques : cmd_free_queue donne les libres au rappel BLE,
+   spp_cmd_task les y rend après traitement */
+#define SPP_CMD_SLOTS               4
+typedef struct {
+    size_t len;
+    uint8_t data[SPP_CMD_MAX_LEN];
+} spp_cmd_msg_t;
+static spp_cmd_msg_t spp_cmd_slots[SPP_CMD_SLOTS];
+
+/* Intervalle d’annonce 500 ms - 1 s (unités de 0,625 ms) : la radio reste
+   en modem sleep entre deux annonces ; le pont met au plus une seconde
+   de plus à retrouver le minuteur */
 static esp_ble_adv_params_t spp_adv_params = {
-    .adv_int_min        = 0x20,
-    .adv_int_max        = 0x40,
+    .adv_int_min        = 0x320,
+    .adv_int_max        = 0x640,
     .adv_type           = ADV_TYPE_IND,
     .own_addr_type      = BLE_ADDR_TYPE_PUBLIC,
     .channel_map        = ADV_CHNL_ALL,
@@ -103,26 +185,10 @@ struct gatts_profile_inst {
     esp_bt_uuid_t descr_uuid;
 };
 
-typedef struct spp_receive_data_node{
-    int32_t len;
-    uint8_t * node_buff;
-    struct spp_receive_data_node * next_node;
-}spp_receive_data_node_t;
-
-static spp_receive_data_node_t * temp_spp_recv_data_node_p1 = NULL;
-static spp_receive_data_node_t * temp_spp_recv_data_node_p2 = NULL;
-
-typedef struct spp_receive_data_buff{
-    int32_t node_num;
-    int32_t buff_size;
-    spp_receive_data_node_t * first_node;
-}spp_receive_data_buff_t;
-
-static spp_receive_data_buff_t SppRecvDataBuff = {
-    .node_num   = 0,
-    .buff_size  = 0,
-    .first_node = NULL
-};
+/* Écritures longues (Prepare / Execute Write) sur DATA_RECEIVE : fragments
+   réassemblés dans un anneau statique, aucune allocation dans les rappels BLE */
+static uint8_t prep_storage[SPP_DATA_BUFF_MAX_LEN];
+static prep_ring_t prep_writes;
 
 static void gatts_profile_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param);
 
@@ -145,7 +211,8 @@ static const uint16_t character_declaration_uuid = ESP_GATT_UUID_CHAR_DECLARE;
 static const uint16_t character_client_config_uuid = ESP_GATT_UUID_CHAR_CLIENT_CONFIG;
 
 static const uint8_t char_prop_read_notify = ESP_GATT_CHAR_PROP_BIT_READ|ESP_GATT_CHAR_PROP_BIT_NOTIFY;
-static const uint8_t char_prop_read_write = ESP_GATT_CHAR_PROP_BIT_WRITE_NR|ESP_GATT_CHAR_PROP_BIT_READ;
+// DATA_RECEIVE, COMMAND : écriture avec réponse en plus, pour les écritures longues (au-delà de MTU - 3)
+static const uint8_t char_prop_read_write_long = ESP_GATT_CHAR_PROP_BIT_WRITE|ESP_GATT_CHAR_PROP_BIT_WRITE_NR|ESP_GATT_CHAR_PROP_BIT_READ;
 
 #ifdef SUPPORT_HEARTBEAT
 static const uint8_t char_prop_read_write_notify = ESP_GATT_CHAR_PROP_BIT_READ|ESP_GATT_CHAR_PROP_BIT_WRITE_NR|ESP_GATT_CHAR_PROP_BIT_NOTIFY;
@@ -160,15 +227,20 @@ static const uint16_t spp_data_notify_uuid = ESP_GATT_UUID_SPP_DATA_NOTIFY;
 static const uint8_t  spp_data_notify_val[20] = {0x00};
 static const uint8_t  spp_data_notify_ccc[2] = {0x00, 0x00};
 
-///SPP Service - command characteristic, read&write without response
+///SPP Service - command characteristic, write (binary commands, ble_cmd.h)
 static const uint16_t spp_command_uuid = ESP_GATT_UUID_SPP_COMMAND_RECEIVE;
 static const uint8_t  spp_command_val[10] = {0x00};
 
-///SPP Service - status characteristic, notify&read
+///SPP Service - status characteristic, notify&read (command responses)
 static const uint16_t spp_status_uuid = ESP_GATT_UUID_SPP_COMMAND_NOTIFY;
 static const uint8_t  spp_status_val[10] = {0x00};
 static const uint8_t  spp_status_ccc[2] = {0x00, 0x00};
 
+///SPP Service - diagnostic characteristic, notify&read (relevé diag_record)
+static const uint16_t spp_diag_uuid = ESP_GATT_UUID_SPP_DIAG;
+static const uint8_t  spp_diag_val[1] = {0x00};
+static const uint8_t  spp_diag_ccc[2] = {0x00, 0x00};
+
 #ifdef SUPPORT_HEARTBEAT
 ///SPP Server - Heart beat characteristic, notify&write&read
 static const uint16_t spp_heart_beat_uuid = ESP_GATT_UUID_SPP_HEARTBEAT;
@@ -187,7 +259,7 @@ static const esp_gatts_attr_db_t spp_gatt_db[SPP_IDX_NB] =
     //SPP -  data receive characteristic Declaration
     [SPP_IDX_SPP_DATA_RECV_CHAR]            =
     {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_declaration_uuid, ESP_GATT_PERM_READ,
-    CHAR_DECLARATION_SIZE,CHAR_DECLARATION_SIZE, (uint8_t *)&char_prop_read_write}},
+    CHAR_DECLARATION_SIZE,CHAR_DECLARATION_SIZE, (uint8_t *)&char_prop_read_write_long}},
 
     //SPP -  data receive characteristic Value
     [SPP_IDX_SPP_DATA_RECV_VAL]             	=
@@ -212,7 +284,7 @@ static const esp_gatts_attr_db_t spp_gatt_db[SPP_IDX_NB] =
     //SPP -  command characteristic Declaration
     [SPP_IDX_SPP_COMMAND_CHAR]            =
     {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_declaration_uuid, ESP_GATT_PERM_READ,
-    CHAR_DECLARATION_SIZE,CHAR_DECLARATION_SIZE, (uint8_t *)&char_prop_read_write}},
+    CHAR_DECLARATION_SIZE,CHAR_DECLARATION_SIZE, (uint8_t *)&char_prop_read_write_long}},
 
     //SPP -  command characteristic Value
     [SPP_IDX_SPP_COMMAND_VAL]                 =
@@ -234,6 +306,21 @@ static const esp_gatts_attr_db_t spp_gatt_db[SPP_IDX_NB] =
     {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_client_config_uuid, ESP_GATT_PERM_READ|ESP_GATT_PERM_WRITE,
     sizeof(uint16_t),sizeof(spp_status_ccc), (uint8_t *)spp_status_ccc}},
 
+    //SPP -  diagnostic characteristic Declaration
+    [SPP_IDX_DIAG_CHAR]            =
+    {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_declaration_uuid, ESP_GATT_PERM_READ,
+    CHAR_DECLARATION_SIZE,CHAR_DECLARATION_SIZE, (uint8_t *)&char_prop_read_notify}},
+
+    //SPP -  diagnostic characteristic Value
+    [SPP_IDX_DIAG_VAL]                 =
+    {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&spp_diag_uuid, ESP_GATT_PERM_READ,
+    SPP_DIAG_MAX_LEN,sizeof(spp_diag_val), (uint8_t *)spp_diag_val}},
+
+    //SPP -  diagnostic characteristic - Client Characteristic Configuration Descriptor
+    [SPP_IDX_DIAG_CFG]         =
+    {{ESP_GATT_AUTO_RSP}, {ESP_UUID_LEN_16, (uint8_t *)&character_client_config_uuid, ESP_GATT_PERM_READ|ESP_GATT_PERM_WRITE,
+    sizeof(uint16_t),sizeof(spp_diag_ccc), (uint8_t *)spp_diag_ccc}},
+
 #ifdef SUPPORT_HEARTBEAT
     //SPP -  Heart beat characteristic Declaration
     [SPP_IDX_SPP_HEARTBEAT_CHAR]  =
@@ -252,85 +339,279 @@ static const esp_gatts_attr_db_t spp_gatt_db[SPP_IDX_NB] =
 #endif
 };
 
-static uint8_t find_char_and_desr_index(uint16_t handle)
-{
-    uint8_t error = 0xff;
+/* -------------------------------------------------------------------------- --
+   FUNCTION: spp_attr_index
 
-    for(int i = 0; i < SPP_IDX_NB ; i++){
-        if(handle == spp_handle_table[i]){
-            return i;
-        }
-    }
+   --------------------------------------------------------------------------
+   Purpose:
+   Index SPP_IDX_* d’un handle d’attribut du service
 
-    return error;
-}
+   --------------------------------------------------------------------------
+   Description:
+   La pile crée la table d’attributs sur des handles consécutifs (vérifié
+   à ESP_GATTS_CREAT_ATTR_TAB_EVT) : l’index est l’écart au handle du
+   service. Sinon, recherche dans spp_handle_table.
 
-static bool store_wr_buffer(esp_ble_gatts_cb_param_t *p_data)
-{
-    temp_spp_recv_data_node_p1 = (spp_receive_data_node_t *)malloc(sizeof(spp_receive_data_node_t));
+   --------------------------------------------------------------------------
+   Return value:
+     Index, SPP_IDX_NB si le handle n’est pas dans le service
 
-    if(temp_spp_recv_data_node_p1 == NULL){
-        ESP_LOGI(GATTS_TABLE_TAG, "malloc error %s %d", __func__, __LINE__);
-        return false;
-    }
-    if(temp_spp_recv_data_node_p2 != NULL){
-        temp_spp_recv_data_node_p2->next_node = temp_spp_recv_data_node_p1;
+-- -------------------------------------------------------------------------- */
+static uint8_t spp_attr_index(uint16_t handle)
+{
+    if (spp_handles_contiguous) {
+        uint16_t i = (uint16_t)(handle - spp_handle_table[SPP_IDX_SVC]);
+        return i < SPP_IDX_NB ? (uint8_t)i : SPP_IDX_NB;
     }
-    temp_spp_recv_data_node_p1->len = p_data->write.len;
-    SppRecvDataBuff.buff_size += p_data->write.len;
-    temp_spp_recv_data_node_p1->next_node = NULL;
-    temp_spp_recv_data_node_p1->node_buff = (uint8_t *)malloc(p_data->write.len);
-    temp_spp_recv_data_node_p2 = temp_spp_recv_data_node_p1;
-    if (temp_spp_recv_data_node_p1->node_buff == NULL) {
-        ESP_LOGI(GATTS_TABLE_TAG, "malloc error %s %d\n", __func__, __LINE__);
-        temp_spp_recv_data_node_p1->len = 0;
-    } else {
-        memcpy(temp_spp_recv_data_node_p1->node_buff,p_data->write.value,p_data->write.len);
+    for (int i = 0; i < SPP_IDX_NB; i++) {
+        if (handle == spp_handle_table[i]) {
+            return (uint8_t)i;
+        }
     }
+    return SPP_IDX_NB;
+}
 
-    if(SppRecvDataBuff.node_num == 0){
-        SppRecvDataBuff.first_node = temp_spp_recv_data_node_p1;
-        SppRecvDataBuff.node_num++;
-    }else{
-        SppRecvDataBuff.node_num++;
-    }
+/* -------------------------------------------------------------------------- --
+   FUNCTION: data_tx_send
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Prépare une notification de DATA_NOTIFY (fonction d’envoi de data_tx,
+   appelée sous data_tx_lock)
 
+   --------------------------------------------------------------------------
+   Description:
+   La notification est copiée : en mode fragmenté, data_tx réutilise son
+   tampon pour le fragment suivant. data_tx_drain la confie à la pile.
+
+   --------------------------------------------------------------------------
+   Return value:
+     false si aucune place (fenêtre dépassée, ne devrait pas arriver)
+
+-- -------------------------------------------------------------------------- */
+static bool data_tx_send(void* ctx, const uint8_t* data, uint16_t len)
+{
+    if (data_tx_stage_count == DATA_TX_WINDOW) return false;
+
+    data_tx_ntf_t* ntf = &data_tx_stage[(data_tx_stage_head + data_tx_stage_count) % DATA_TX_WINDOW];
+    memcpy(ntf->data, data, len);
+    ntf->len = len;
+    data_tx_stage_count++;
     return true;
 }
 
-static void free_write_buffer(void)
+/* -------------------------------------------------------------------------- --
+   FUNCTION: data_tx_discard
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Oublie les notifications préparées d’un bloc abandonné (sous
+   data_tx_lock)
+
+   --------------------------------------------------------------------------
+   Description:
+   Elles ne seront jamais confirmées : retirées de la fenêtre de data_tx.
+   Une notification en cours d’envoi par data_tx_drain appartient
+   désormais à une autre génération : son refus éventuel est ignoré.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void data_tx_discard(void)
 {
-    temp_spp_recv_data_node_p1 = SppRecvDataBuff.first_node;
+    while (data_tx_stage_count > 0) {
+        ble_tx_on_refused(&data_tx, 0);         // Bloc déjà terminé : fenêtre seule
+        data_tx_stage_count--;
+    }
+    data_tx_stage_head = 0;
+    data_tx_gen++;
+}
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: data_tx_drain
 
-    while(temp_spp_recv_data_node_p1 != NULL){
-        temp_spp_recv_data_node_p2 = temp_spp_recv_data_node_p1->next_node;
-        if (temp_spp_recv_data_node_p1->node_buff) {
-            free(temp_spp_recv_data_node_p1->node_buff);
+   --------------------------------------------------------------------------
+   Purpose:
+   Confie à la pile les notifications préparées, data_tx_lock rendu
+   pendant chaque appel
+
+   --------------------------------------------------------------------------
+   Description:
+   Appelée et terminée sous data_tx_lock. Un seul contexte vide la file
+   (ordre des fragments conservé) : s’il est déjà occupé, il enverra
+   aussi ce qui vient d’être préparé. Un refus de la pile abandonne le
+   bloc, sauf s’il a déjà été abandonné entre-temps.
+
+   --------------------------------------------------------------------------
+   Return value:
+     BLE_TX_FAILED si la pile a refusé une notification, sinon
+     BLE_TX_PENDING
+
+-- -------------------------------------------------------------------------- */
+static ble_tx_status_t data_tx_drain(void)
+{
+    static uint8_t ntf[BLE_TX_NTF_MAX];        // Réservé au contexte qui vide la file
+
+    if (data_tx_draining) return BLE_TX_PENDING;
+    data_tx_draining = true;
+
+    while (data_tx_stage_count > 0) {
+        uint16_t len = data_tx_stage[data_tx_stage_head].len;
+        uint8_t gen = data_tx_gen;
+
+        memcpy(ntf, data_tx_stage[data_tx_stage_head].data, len);
+        data_tx_stage_head = (data_tx_stage_head + 1) % DATA_TX_WINDOW;
+        data_tx_stage_count--;
+
+        xSemaphoreGive(data_tx_lock);
+        bool ok = esp_ble_gatts_send_indicate(spp_gatts_if, spp_conn_id, spp_handle_table[SPP_IDX_SPP_DATA_NTY_VAL],
+                                              len, ntf, false) == ESP_OK;
+        xSemaphoreTake(data_tx_lock, portMAX_DELAY);
+
+        if (!ok && gen == data_tx_gen) {
+            ble_tx_status_t st = ble_tx_on_refused(&data_tx, session_clock_now_us());
+            data_tx_discard();
+            data_tx_draining = false;
+            return st;
         }
-        free(temp_spp_recv_data_node_p1);
-        temp_spp_recv_data_node_p1 = temp_spp_recv_data_node_p2;
     }
+    data_tx_draining = false;
+    return BLE_TX_PENDING;
+}
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_apply
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Demande au central les paramètres voulus par conn_policy
+
+   --------------------------------------------------------------------------
+   Description:
+   Appelée après chaque changement d’activité et par conn_timer, réarmé
+   sur la prochaine échéance de la politique. Une demande que la pile
+   n’accepte pas compte comme refusée.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void conn_apply(void)
+{
+    int64_t now = session_clock_now_us();
+    esp_ble_conn_update_params_t req = {0};
+
+    xSemaphoreTake(conn_lock, portMAX_DELAY);
+    conn_profile_t profile = conn_policy_poll(&conn_policy, now);
+    int64_t next = conn_policy_next_us(&conn_policy, now);
+    esp_timer_stop(conn_timer);     // Sans effet s’il n’est pas armé
+    if (next > 0) {
+        esp_timer_start_once(conn_timer, next > now ? (uint64_t)(next - now) : 0);
+    }
+    xSemaphoreGive(conn_lock);
+
+    const conn_params_t* c = conn_policy_params(profile);
+    if (c == NULL) return;
+
+    memcpy(req.bda, spp_remote_bda, sizeof(esp_bd_addr_t));
+    req.min_int = c->min_int;
+    req.max_int = c->max_int;
+    req.latency = c->latency;
+    req.timeout = c->timeout;
+    if (esp_ble_gap_update_conn_params(&req) != ESP_OK) {
+        xSemaphoreTake(conn_lock, portMAX_DELAY);
+        conn_policy_updated(&conn_policy, false, 0, 0, 0);
+        xSemaphoreGive(conn_lock);
+        ESP_LOGW(GATTS_TABLE_TAG, "Demande de parametres de connexion refusee par la pile");
+        return;
+    }
+    ESP_LOGI(GATTS_TABLE_TAG, "Demande de parametres %s : %u-%u ms, latence %u",
+             profile == CONN_PROFILE_FAST ? "rapides" : "repos",
+             (unsigned)(c->min_int * 5 / 4), (unsigned)(c->max_int * 5 / 4), (unsigned)c->latency);
+}
 
-    SppRecvDataBuff.node_num = 0;
-    SppRecvDataBuff.buff_size = 0;
-    SppRecvDataBuff.first_node = NULL;
+static void conn_timer_cb(void* arg)
+{
+    conn_apply();
 }
 
-static void print_write_buffer(void)
+// Envoi d’un bloc sur DATA_NOTIFY commencé ou terminé (sous data_tx_lock,
+// conn_apply ensuite hors verrou)
+static void conn_busy(bool busy)
 {
-    temp_spp_recv_data_node_p1 = SppRecvDataBuff.first_node;
+    xSemaphoreTake(conn_lock, portMAX_DELAY);
+    conn_policy_busy(&conn_policy, busy, session_clock_now_us());
+    xSemaphoreGive(conn_lock);
+}
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: data_tx_unlock
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Envoie les notifications préparées, rend data_tx_lock puis, si le bloc
+   est terminé, en rend compte
+
+   --------------------------------------------------------------------------
+   Description:
+   Les appels à la pile (notifications, paramètres de connexion) et le
+   rappel de fin sont faits hors verrou : le rappel peut soumettre le bloc
+   suivant. Débit obtenu journalisé à chaque bloc.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     st : compte rendu de la fonction ble_tx appelée sous verrou
 
-    while(temp_spp_recv_data_node_p1 != NULL){
-        uart_write_bytes(UART_NUM_0, (char *)(temp_spp_recv_data_node_p1->node_buff), temp_spp_recv_data_node_p1->len);
-        temp_spp_recv_data_node_p1 = temp_spp_recv_data_node_p1->next_node;
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void data_tx_unlock(ble_tx_status_t st)
+{
+    if (st == BLE_TX_FAILED) {
+        data_tx_discard();
+    } else if (st == BLE_TX_PENDING) {
+        st = data_tx_drain();
+    }
+
+    bool finished = st == BLE_TX_DONE || st == BLE_TX_FAILED;
+    ble_spp_tx_done_fn done = finished ? data_tx_done : NULL;
+    void* ctx = data_tx_ctx;
+    ble_tx_stats_t stats = data_tx.stats;
+    bool busy = ble_tx_busy(&data_tx);
+    bool busy_changed = busy != data_tx_busy;
+
+    if (finished) data_tx_done = NULL;
+    if (busy_changed) {
+        data_tx_busy = busy;
+        conn_busy(busy);
     }
+    xSemaphoreGive(data_tx_lock);
+    if (busy_changed) conn_apply();
+
+    if (st == BLE_TX_DONE) {
+        ESP_LOGI(GATTS_TABLE_TAG, "Bloc de %lu octets : %lu notification(s) en %lu ms, %lu o/s",
+                 (unsigned long)stats.last_bytes, (unsigned long)stats.last_notifications,
+                 (unsigned long)(stats.last_us / 1000), (unsigned long)stats.last_bytes_per_s);
+    } else if (st == BLE_TX_FAILED) {
+        ESP_LOGW(GATTS_TABLE_TAG, "Bloc abandonne (%lu echec(s) depuis le demarrage)",
+                 (unsigned long)stats.failures);
+    }
+    if (done) done(ctx, st == BLE_TX_DONE);
+}
+
+static void uart_tx_done(void* ctx, bool ok)
+{
+    xSemaphoreGive(uart_tx_sem);
 }
 
 void uart_task(void *pvParameters)
 {
     uart_event_t event;
-    uint8_t total_num = 0;
-    uint8_t current_num = 0;
 
     for (;;) {
         //Waiting for UART event.
@@ -340,7 +621,6 @@ void uart_task(void *pvParameters)
             case UART_DATA:
                 if ((event.size)&&(is_connected)) {
                     uint8_t * temp = NULL;
-                    uint8_t * ntf_value_p = NULL;
 #ifdef SUPPORT_HEARTBEAT
                     if(!enable_heart_ntf){
                         ESP_LOGE(GATTS_TABLE_TAG, "%s do not enable heartbeat Notify", __func__);
@@ -358,41 +638,11 @@ void uart_task(void *pvParameters)
                     }
                     memset(temp,0x0,event.size);
                     uart_read_bytes(UART_NUM_0,temp,event.size,portMAX_DELAY);
-                    if(event.size <= (spp_mtu_size - 3)){
-                        esp_ble_gatts_send_indicate(spp_gatts_if, spp_conn_id, spp_handle_table[SPP_IDX_SPP_DATA_NTY_VAL],event.size, temp, false);
-                    }else if(event.size > (spp_mtu_size - 3)){
-                        if((event.size%(spp_mtu_size - 7)) == 0){
-                            total_num = event.size/(spp_mtu_size - 7);
-                        }else{
-                            total_num = event.size/(spp_mtu_size - 7) + 1;
-                        }
-                        current_num = 1;
-                        ntf_value_p = (uint8_t *)malloc((spp_mtu_size-3)*sizeof(uint8_t));
-                        if(ntf_value_p == NULL){
-                            ESP_LOGE(GATTS_TABLE_TAG, "%s malloc.2 failed", __func__);
-                            free(temp);
-                            break;
-                        }
-                        while(current_num <= total_num){
-                            if(current_num < total_num){
-                                ntf_value_p[0] = '#';
-                                ntf_value_p[1] = '#';
-                                ntf_value_p[2] = total_num;
-                                ntf_value_p[3] = current_num;
-                                memcpy(ntf_value_p + 4,temp + (current_num - 1)*(spp_mtu_size-7),(spp_mtu_size-7));
-                                esp_ble_gatts_send_indicate(spp_gatts_if, spp_conn_id, spp_handle_table[SPP_IDX_SPP_DATA_NTY_VAL],(spp_mtu_size-3), ntf_value_p, false);
-                            }else if(current_num == total_num){
-                                ntf_value_p[0] = '#';
-                                ntf_value_p[1] = '#';
-                                ntf_value_p[2] = total_num;
-                                ntf_value_p[3] = current_num;
-                                memcpy(ntf_value_p + 4,temp + (current_num - 1)*(spp_mtu_size-7),(event.size - (current_num - 1)*(spp_mtu_size - 7)));
-                                esp_ble_gatts_send_indicate(spp_gatts_if, spp_conn_id, spp_handle_table[SPP_IDX_SPP_DATA_NTY_VAL],(event.size - (current_num - 1)*(spp_mtu_size - 7) + 4), ntf_value_p, false);
-                            }
-                            vTaskDelay(20 / portTICK_PERIOD_MS);
-                            current_num++;
-                        }
-                        free(ntf_value_p);
+                    // Découpage et rythme : data_tx ; le bloc reste alloué jusqu’au compte rendu
+                    if (ble_spp_data_send(temp, event.size, uart_tx_done, NULL)) {
+                        xSemaphoreTake(uart_tx_sem, portMAX_DELAY);
+                    } else {
+                        ESP_LOGW(GATTS_TABLE_TAG, "%s envoi refuse (bloc en cours)", __func__);
                     }
                     free(temp);
                 }
@@ -423,6 +673,7 @@ static void spp_uart_init(void)
     uart_param_config(UART_NUM_0, &uart_config);
     //Set UART pins
     uart_set_pin(UART_NUM_0, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    uart_tx_sem = xSemaphoreCreateBinary();
     xTaskCreate(uart_task, "uTask", 2048, (void*)UART_NUM_0, 8, NULL);
 }
 
@@ -452,15 +703,205 @@ void spp_heartbeat_task(void * arg)
 }
 #endif
 
+/* -------------------------------------------------------------------------- --
+   Commandes binaires du pont sur COMMAND (voir ble_cmd.h)
+-- -------------------------------------------------------------------------- */
+
+// État d’un traitement d’écriture (spp_cmd_task)
+typedef struct {
+    bool reboot;                       // REBOOT accepté : après l’envoi des réponses
+} spp_cmd_ctx_t;
+
+// Nom d’utilisateur d’un argument (non terminé par '\0')
+static void cmd_user(char* dst, const uint8_t* src, size_t len)
+{
+    if (len > TIMER_USER_MAX - 1) len = TIMER_USER_MAX - 1;
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+// Commande déposée pour le minuteur ; refusée si sa file est pleine
+static ble_cmd_status_t cmd_posted(bool ok)
+{
+    return ok ? BLE_CMD_OK : BLE_CMD_E_BUSY;
+}
+
+static ble_cmd_status_t cmd_select_user(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    char user[TIMER_USER_MAX];
+    if (arg[0] >= stall_count) return BLE_CMD_E_ARG;
+    cmd_user(user, arg + 1, len - 1);
+    return cmd_posted(timer_manager_set_user(arg[0], user));
+}
+
+// Avec un nom : durée mémorisée de l’utilisateur (toutes cabines) ; sans : cabine
+static ble_cmd_status_t cmd_set_budget(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    uint16_t budget_s = ble_cmd_get_u16(arg + 1);
+    if (budget_s == 0) return BLE_CMD_E_ARG;
+    if (len > 3) {
+        char user[TIMER_USER_MAX];
+        cmd_user(user, arg + 3, len - 3);
+        return cmd_posted(timer_manager_set_user_budget(user, budget_s));
+    }
+    if (arg[0] >= stall_count) return BLE_CMD_E_ARG;
+    return cmd_posted(timer_manager_set_budget(arg[0], (int64_t)budget_s * SESSION_US_PER_S));
+}
+
+static ble_cmd_status_t cmd_start(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    char user[TIMER_USER_MAX];
+    if (arg[0] >= stall_count) return BLE_CMD_E_ARG;
+    cmd_user(user, arg + 1, len - 1);
+    return cmd_posted(timer_manager_start(arg[0], user));
+}
+
+static ble_cmd_status_t cmd_stop(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    if (arg[0] >= stall_count) return BLE_CMD_E_ARG;
+    return cmd_posted(timer_manager_stop(arg[0]));
+}
+
+// Instantané de la cabine : répond sans passer par la file du minuteur
+static ble_cmd_status_t cmd_status(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    timer_snapshot_t snap;
+    if (arg[0] >= stall_count) return BLE_CMD_E_ARG;
+    timer_manager_get_snapshot(arg[0], &snap);
+
+    ble_cmd_stall_status_t st = {
+        .stall = arg[0],
+        .state = (uint8_t)snap.state,
+        .elapsed_s = (uint32_t)(timer_manager_snapshot_elapsed_us(&snap) / SESSION_US_PER_S),
+        .duration_s = (uint16_t)(snap.duration_us / SESSION_US_PER_S),
+        .budget_s = (uint16_t)(snap.budget_us / SESSION_US_PER_S),
+        .sessions = snap.sessions,
+    };
+    *out_len = ble_cmd_put_stall_status(out, &st);
+    return BLE_CMD_OK;
+}
+
+// Les douches suivant le numéro repartent sur DATA (trames session_record)
+static ble_cmd_status_t cmd_history(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    return cmd_posted(timer_manager_replay_journal(ble_cmd_get_u32(arg)));
+}
+
+// Heure calendaire donnée par le pont ; la réponse situe ce démarrage
+static ble_cmd_status_t cmd_set_clock(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    struct timeval tv = { .tv_sec = ble_cmd_get_u32(arg), .tv_usec = 0 };
+    if (tv.tv_sec == 0 || settimeofday(&tv, NULL) != 0) return BLE_CMD_E_ARG;
+    ble_cmd_put_u32(out, (uint32_t)(session_clock_now_us() / SESSION_US_PER_S));
+    *out_len = 4;
+    return BLE_CMD_OK;
+}
+
+// Refusé pendant une douche : elle serait perdue
+static ble_cmd_status_t cmd_reboot(void* ctx, const uint8_t* arg, uint8_t len, uint8_t* out, uint8_t* out_len)
+{
+    for (uint8_t i = 0; i < stall_count; i++) {
+        if (timer_manager_get_state(i) != TIMER_STOPPED) return BLE_CMD_E_BUSY;
+    }
+    ((spp_cmd_ctx_t*)ctx)->reboot = true;
+    return BLE_CMD_OK;
+}
+
+/* Table des commandes, indexée par l’opcode : longueurs d’argument acceptées */
+static const ble_cmd_def_t spp_cmd_table[BLE_CMD_OPCODES] = {
+    [BLE_CMD_SELECT_USER] = { cmd_select_user, 2, TIMER_USER_MAX },
+    [BLE_CMD_SET_BUDGET]  = { cmd_set_budget,  3, 3 + TIMER_USER_MAX - 1 },
+    [BLE_CMD_START]       = { cmd_start,       1, TIMER_USER_MAX },
+    [BLE_CMD_STOP]        = { cmd_stop,        1, 1 },
+    [BLE_CMD_STATUS]      = { cmd_status,      1, 1 },
+    [BLE_CMD_HISTORY]     = { cmd_history,     4, 4 },
+    [BLE_CMD_SET_CLOCK]   = { cmd_set_clock,   4, 4 },
+    [BLE_CMD_REBOOT]      = { cmd_reboot,      0, 0 },
+};
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: status_emit
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Publie une notification de réponses sur STATUS (fonction d’émission de
+   ble_cmd_process)
+
+   --------------------------------------------------------------------------
+   Description:
+   La valeur lue de la caractéristique est la dernière notification. Un
+   jeton de status_tx_sem par notification en vol : au-delà de la
+   fenêtre, attente de la confirmation de la pile (au plus
+   STATUS_TX_WAIT_MS). Sans jeton, la notification n’est pas envoyée
+   (comptée) : le pont relit la caractéristique ou renvoie la commande.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void status_emit(void* ctx, const uint8_t* data, size_t len)
+{
+    uint16_t handle = spp_handle_table[SPP_IDX_SPP_STATUS_VAL];
+
+    esp_ble_gatts_set_attr_value(handle, len, data);
+    if (!is_connected || !enable_status_ntf) {
+        return;
+    }
+    if (xSemaphoreTake(status_tx_sem, pdMS_TO_TICKS(STATUS_TX_WAIT_MS)) != pdTRUE) {
+        status_tx_dropped++;
+        ESP_LOGW(GATTS_TABLE_TAG, "Reponses non notifiees, pas de confirmation de la pile (%lu depuis le demarrage)",
+                 (unsigned long)status_tx_dropped);
+        return;
+    }
+    if (esp_ble_gatts_send_indicate(spp_gatts_if, spp_conn_id, handle, len, (uint8_t *)data, false) != ESP_OK) {
+        xSemaphoreGive(status_tx_sem);
+        ESP_LOGW(GATTS_TABLE_TAG, "Reponses perdues (%u octets)", (unsigned)len);
+    }
+}
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: spp_cmd_task
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Exécute les écritures reçues sur COMMAND, hors de la tâche Bluedroid
+
+   --------------------------------------------------------------------------
+   Description:
+   Une écriture peut enchaîner plusieurs commandes ; leurs réponses
+   partent groupées au MTU du moment. Un redémarrage accepté a lieu
+   après l’envoi des réponses.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
 void spp_cmd_task(void * arg)
 {
-    uint8_t * cmd_id;
+    static uint8_t resp[BLE_TX_NTF_MAX];
+    spp_cmd_msg_t * msg;
 
     for(;;){
-        vTaskDelay(50 / portTICK_PERIOD_MS);
-        if(xQueueReceive(cmd_cmd_queue, &cmd_id, portMAX_DELAY)) {
-            ESP_LOG_BUFFER_CHAR(GATTS_TABLE_TAG,(char *)(cmd_id),strlen((char *)cmd_id));
-            free(cmd_id);
+        if(xQueueReceive(cmd_cmd_queue, &msg, portMAX_DELAY)) {
+            spp_cmd_ctx_t ctx = { .reboot = false };
+            size_t resp_max = spp_mtu_size - 3;
+            if (resp_max > sizeof(resp)) resp_max = sizeof(resp);
+
+            size_t n = ble_cmd_process(spp_cmd_table, BLE_CMD_OPCODES, &ctx, msg->data, msg->len,
+                                       resp, resp_max, status_emit, NULL);
+            ESP_LOGI(GATTS_TABLE_TAG, "Commandes : %u traitee(s) (%u octets)", (unsigned)n, (unsigned)msg->len);
+            xQueueSend(cmd_free_queue, &msg, 0);
+
+            if (ctx.reboot) {
+                ESP_LOGW(GATTS_TABLE_TAG, "Redemarrage demande par le pont");
+                // Dernière réponse confirmée par la pile (ou délai dépassé)
+                for (int i = 0; i < STATUS_TX_WINDOW; i++) {
+                    xSemaphoreTake(status_tx_sem, pdMS_TO_TICKS(STATUS_TX_WAIT_MS));
+                }
+                esp_restart();
+            }
         }
     }
     vTaskDelete(NULL);
@@ -475,8 +916,14 @@ static void spp_task_init(void)
     xTaskCreate(spp_heartbeat_task, "spp_heartbeat_task", 2048, NULL, 10, NULL);
 #endif
 
-    cmd_cmd_queue = xQueueCreate(10, sizeof(uint32_t));
-    xTaskCreate(spp_cmd_task, "spp_cmd_task", 2048, NULL, 10, NULL);
+    cmd_cmd_queue = xQueueCreate(SPP_CMD_SLOTS, sizeof(spp_cmd_msg_t *));
+    cmd_free_queue = xQueueCreate(SPP_CMD_SLOTS, sizeof(spp_cmd_msg_t *));
+    for (int i = 0; i < SPP_CMD_SLOTS; i++) {
+        spp_cmd_msg_t * slot = &spp_cmd_slots[i];
+        xQueueSend(cmd_free_queue, &slot, 0);
+    }
+    status_tx_sem = xSemaphoreCreateCounting(STATUS_TX_WINDOW, STATUS_TX_WINDOW);
+    xTaskCreate(spp_cmd_task, "spp_cmd_task", 3072, NULL, 10, NULL);
 }
 
 static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param)
@@ -494,20 +941,232 @@ static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param
             ESP_LOGE(GATTS_TABLE_TAG, "Advertising start failed: %s", esp_err_to_name(err));
         }
         break;
+    // Réponse du central à une demande, ou changement qu’il impose
+    case ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT: {
+        bool ok = param->update_conn_params.status == ESP_BT_STATUS_SUCCESS;
+        xSemaphoreTake(conn_lock, portMAX_DELAY);
+        conn_policy_updated(&conn_policy, ok, param->update_conn_params.conn_int,
+                            param->update_conn_params.latency, param->update_conn_params.timeout);
+        conn_policy_t cp = conn_policy;
+        xSemaphoreGive(conn_lock);
+        if (ok) {
+            ESP_LOGI(GATTS_TABLE_TAG, "Parametres de connexion : intervalle %u.%02u ms, latence %u, supervision %u ms",
+                     (unsigned)(cp.interval * 125 / 100), (unsigned)(cp.interval * 125 % 100),
+                     (unsigned)cp.latency, (unsigned)cp.timeout * 10);
+        } else {
+            ESP_LOGW(GATTS_TABLE_TAG, "Parametres de connexion refuses (statut %d, %lu refus / %lu demandes)",
+                     param->update_conn_params.status, (unsigned long)cp.rejected, (unsigned long)cp.requests);
+        }
+        conn_apply();
+        break;
+    }
     default:
         break;
     }
 }
 
 
-extern char user_name[32]; // À placer dans la portée globale si besoin
+/* -------------------------------------------------------------------------- --
+   FUNCTION: data_recv_dispatch
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Traite un message du pont écrit sur DATA_RECEIVE
+
+   --------------------------------------------------------------------------
+   Description:
+   Même traitement pour une écriture simple et pour une écriture longue
+   réassemblée (prep_ring) : durée allouée, utilisateur d’une cabine,
+   acquittement ou synchronisation du journal, sinon nom d’utilisateur.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     value : message (non terminé par '\0')
+     size  : sa longueur
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void data_recv_dispatch(const uint8_t* value, size_t size)
+{
+    if (size > strlen(BUDGET_MSG_PREFIX) &&
+        memcmp(value, BUDGET_MSG_PREFIX, strlen(BUDGET_MSG_PREFIX)) == 0) {
+        // Durée allouée à un utilisateur, calculée par le backend
+        char msg[BUDGET_MSG_MAX_LEN];
+        int len = size >= sizeof(msg) ? sizeof(msg) - 1 : size;
+        memcpy(msg, value, len);
+        msg[len] = '\0';
+
+        char *nom = msg + strlen(BUDGET_MSG_PREFIX);
+        char *sep = strrchr(nom, '=');
+        long secondes = sep ? strtol(sep + 1, NULL, 10) : 0;
+        if (sep) *sep = '\0';
+
+        ESP_LOGI(GATTS_TABLE_TAG, "Duree reçue par BLE: %s = %ld s", nom, secondes);
+        if (secondes <= 0 || secondes > UINT16_MAX ||
+            !timer_manager_set_user_budget(nom, (uint16_t)secondes)) {
+            ESP_LOGW(GATTS_TABLE_TAG, "Duree refusee : %s", msg);
+        }
+    }
+    else if (size > strlen(STALL_MSG_PREFIX) &&
+             memcmp(value, STALL_MSG_PREFIX, strlen(STALL_MSG_PREFIX)) == 0) {
+        // Utilisateur choisi pour une cabine de la carte
+        char msg[STALL_MSG_MAX_LEN];
+        int len = size >= sizeof(msg) ? sizeof(msg) - 1 : size;
+        memcpy(msg, value, len);
+        msg[len] = '\0';
+
+        char *fin;
+        long cabine = strtol(msg + strlen(STALL_MSG_PREFIX), &fin, 10);
+        if (*fin != '=' || cabine < 0 || cabine > UINT8_MAX ||
+            !timer_manager_set_user((uint8_t)cabine, fin + 1)) {
+            ESP_LOGW(GATTS_TABLE_TAG, "Cabine refusee : %s", msg);
+        } else {
+            ESP_LOGI(GATTS_TABLE_TAG, "Nom reçu par BLE pour la cabine %ld: %s", cabine, fin + 1);
+        }
+    }
+    else if (size > strlen(JOURNAL_ACK_PREFIX) && size < 16 &&
+             memcmp(value, JOURNAL_ACK_PREFIX, strlen(JOURNAL_ACK_PREFIX)) == 0) {
+        // Acquittement du journal par le pont
+        char msg[16];
+        memcpy(msg, value, size);
+        msg[size] = '\0';
+        timer_manager_ack_journal((uint32_t)strtoul(msg + strlen(JOURNAL_ACK_PREFIX), NULL, 10));
+    }
+    else if (size == strlen(JOURNAL_SYNC_MSG) &&
+             memcmp(value, JOURNAL_SYNC_MSG, strlen(JOURNAL_SYNC_MSG)) == 0) {
+        timer_manager_sync_journal();
+    }
+    else {
+        // On reçoit un "nom d'utilisateur" depuis le backend/frontend via BLE
+        char nom_recu[32];
+        int len = size > 31 ? 31 : size;
+        memcpy(nom_recu, value, len);
+        nom_recu[len] = '\0';
+
+        ESP_LOGI(GATTS_TABLE_TAG, "Nom reçu par BLE: %s", nom_recu);
+
+        // Le minuteur mémorise le nom et affiche la bienvenue dans sa tâche :
+        // le callback BLE ne bloque jamais sur l’écran
+        timer_manager_set_user(0, nom_recu);
+    }
+}
+
+/* -------------------------------------------------------------------------- --
+   Traitement des écritures et lectures, par attribut
+-- -------------------------------------------------------------------------- */
+
+// Commandes binaires : copiées pour spp_cmd_task (le rappel BLE n’attend pas le minuteur)
+static void on_command_write(const uint8_t* value, size_t len)
+{
+    spp_cmd_msg_t * msg;
+
+    if (len > SPP_CMD_MAX_LEN) {
+        ESP_LOGW(GATTS_TABLE_TAG, "Commandes ignorees (%u octets)", (unsigned)len);
+        return;
+    }
+    // Tous les emplacements attendent spp_cmd_task : file pleine
+    if (xQueueReceive(cmd_free_queue, &msg, 0) != pdTRUE) {
+        ESP_LOGW(GATTS_TABLE_TAG, "Commandes ignorees (file pleine)");
+        return;
+    }
+    msg->len = len;
+    memcpy(msg->data, value, len);
+    xQueueSend(cmd_cmd_queue, &msg, 0);     // Place assurée : autant de places que d’emplacements
+
+    // Rafale de commandes : intervalle court le temps des réponses
+    xSemaphoreTake(conn_lock, portMAX_DELAY);
+    conn_policy_activity(&conn_policy, session_clock_now_us());
+    xSemaphoreGive(conn_lock);
+    conn_apply();
+}
+
+// Abonnement du pont aux réponses des commandes
+static void on_status_cfg_write(const uint8_t* value, size_t len)
+{
+    if (len != 2) return;
+    enable_status_ntf = (value[0] & 0x01) != 0;
+}
+
+// Abonnement du pont aux notifications de données
+static void on_data_ntf_cfg_write(const uint8_t* value, size_t len)
+{
+    if ((len == 2) && (value[0] == 0x01) && (value[1] == 0x00)) {
+        enable_data_ntf = true;
+        ESP_LOGI(GATTS_TABLE_TAG, "enable_data_ntf activé !");
+        // Le pont écoute : envoi des douches prises pendant son absence
+        timer_manager_sync_journal();
+    } else if ((len == 2) && (value[0] == 0x00) && (value[1] == 0x00)) {
+        enable_data_ntf = false;
+        ESP_LOGI(GATTS_TABLE_TAG, "enable_data_ntf désactivé !");
+    }
+}
+
+// Abonnement au diagnostic : relevé immédiat plutôt qu’à la prochaine période
+static void on_diag_cfg_write(const uint8_t* value, size_t len)
+{
+    if (len != 2) return;
+    enable_diag_ntf = (value[0] & 0x01) != 0;
+    if (enable_diag_ntf) diag_service_request();
+}
+
+// Lecture du diagnostic (réponse automatique de la pile) : un client qui
+// interroge sans s’abonner lit un relevé rafraîchi à chaque lecture suivante
+static void on_diag_read(void)
+{
+    diag_service_request();
+}
+
+#ifdef SUPPORT_HEARTBEAT
+static void on_heartbeat_cfg_write(const uint8_t* value, size_t len)
+{
+    if((len == 2)&&(value[0] == 0x01)&&(value[1] == 0x00)){
+        enable_heart_ntf = true;
+    }else if((len == 2)&&(value[0] == 0x00)&&(value[1] == 0x00)){
+        enable_heart_ntf = false;
+    }
+}
+
+static void on_heartbeat_write(const uint8_t* value, size_t len)
+{
+    if((len == sizeof(heartbeat_s))&&(memcmp(heartbeat_s,value,sizeof(heartbeat_s)) == 0)){
+        heartbeat_count_num = 0;
+    }
+}
+#endif
+
+/* Traitements par index d’attribut (SPP_IDX_*) : une nouvelle
+   caractéristique déclare les siens ici, sans toucher au gestionnaire
+   d’événements. long_write : écritures longues acceptées (prep_ring) */
+typedef struct {
+    void (*write)(const uint8_t* value, size_t len);
+    void (*read)(void);
+    bool long_write;
+} spp_attr_ops_t;
+
+static const spp_attr_ops_t spp_attr_ops[SPP_IDX_NB] = {
+    [SPP_IDX_SPP_DATA_RECV_VAL]  = { .write = data_recv_dispatch, .long_write = true },
+    [SPP_IDX_SPP_DATA_NTF_CFG]   = { .write = on_data_ntf_cfg_write },
+    [SPP_IDX_SPP_COMMAND_VAL]    = { .write = on_command_write, .long_write = true },
+    [SPP_IDX_SPP_STATUS_CFG]     = { .write = on_status_cfg_write },
+    [SPP_IDX_DIAG_VAL]           = { .read = on_diag_read },
+    [SPP_IDX_DIAG_CFG]           = { .write = on_diag_cfg_write },
+#ifdef SUPPORT_HEARTBEAT
+    [SPP_IDX_SPP_HEARTBEAT_VAL]  = { .write = on_heartbeat_write },
+    [SPP_IDX_SPP_HEARTBEAT_CFG]  = { .write = on_heartbeat_cfg_write },
+#endif
+};
 
 static void gatts_profile_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param)
 {
     esp_ble_gatts_cb_param_t *p_data = (esp_ble_gatts_cb_param_t *) param;
     uint8_t res = 0xff;
 
-    ESP_LOGI(GATTS_TABLE_TAG, "event = %x",event);
+    if (event != ESP_GATTS_CONF_EVT) {
+        ESP_LOGI(GATTS_TABLE_TAG, "event = %x",event);
+    }
     switch (event) {
         case ESP_GATTS_REG_EVT:
             ESP_LOGI(GATTS_TABLE_TAG, "%s %d", __func__, __LINE__);
@@ -521,83 +1180,77 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_
             break;
 
         case ESP_GATTS_WRITE_EVT: {
-            res = find_char_and_desr_index(p_data->write.handle);
-            ESP_LOGI(GATTS_TABLE_TAG, "WRITE_EVT real_handle=0x%04x, res=%d", p_data->write.handle, res);
-
-            if (p_data->write.is_prep == false) {
-                ESP_LOGI(GATTS_TABLE_TAG, "ESP_GATTS_WRITE_EVT : handle = %d", res);
-
-                // Bloc COMMANDE
-                if (res == SPP_IDX_SPP_COMMAND_VAL) {
-                    uint8_t * spp_cmd_buff = NULL;
-                    spp_cmd_buff = (uint8_t *)malloc((spp_mtu_size - 3) * sizeof(uint8_t));
-                    if(spp_cmd_buff == NULL){
-                        ESP_LOGE(GATTS_TABLE_TAG, "%s malloc failed", __func__);
-                        break;
-                    }
-                    memset(spp_cmd_buff,0x0,(spp_mtu_size - 3));
-                    memcpy(spp_cmd_buff,p_data->write.value,p_data->write.len);
-                    xQueueSend(cmd_cmd_queue,&spp_cmd_buff,10/portTICK_PERIOD_MS);
-                }
-                // Bloc NOTIF BLE
-                else if (res == SPP_IDX_SPP_DATA_NTF_CFG) {
-                    ESP_LOGI(GATTS_TABLE_TAG, "Dans SPP_IDX_SPP_DATA_NTF_CFG !");
-                    ESP_LOGI(GATTS_TABLE_TAG, "Data: len=%d val[0]=0x%02x val[1]=0x%02x",
-                        p_data->write.len, p_data->write.value[0], p_data->write.value[1]);
-                    if ((p_data->write.len == 2) &&
-                        (p_data->write.value[0] == 0x01) && (p_data->write.value[1] == 0x00)) {
-                        enable_data_ntf = true;
-                        ESP_LOGI(GATTS_TABLE_TAG, "enable_data_ntf activé !");
-                    } else if ((p_data->write.len == 2) &&
-                               (p_data->write.value[0] == 0x00) && (p_data->write.value[1] == 0x00)) {
-                        enable_data_ntf = false;
-                        ESP_LOGI(GATTS_TABLE_TAG, "enable_data_ntf désactivé !");
-                    }
-                }
-                // --- NOUVEAU : Bloc DATA_RECEIVE (écriture d'un nom depuis le backend/frontend via le pont Python) ---
-                else if (res == SPP_IDX_SPP_DATA_RECV_VAL) {
-                    // On reçoit un "nom d'utilisateur" depuis le backend/frontend via BLE
-                    char nom_recu[32];
-                    int len = p_data->write.len > 31 ? 31 : p_data->write.len;
-                    memcpy(nom_recu, p_data->write.value, len);
-                    nom_recu[len] = '\0';
-
-                    ESP_LOGI(GATTS_TABLE_TAG, "Nom reçu par BLE: %s", nom_recu);
-                    oled_display_message(nom_recu);
-
-                    // On mémorise le nom pour la prochaine douche (pour le minuteur)
-                    strncpy(user_name, nom_recu, sizeof(user_name)-1);
-                    user_name[sizeof(user_name)-1] = '\0';
-                }
-#ifdef SUPPORT_HEARTBEAT
-                else if(res == SPP_IDX_SPP_HEARTBEAT_CFG){
-                    if((p_data->write.len == 2)&&(p_data->write.value[0] == 0x01)&&(p_data->write.value[1] == 0x00)){
-                        enable_heart_ntf = true;
-                    }else if((p_data->write.len == 2)&&(p_data->write.value[0] == 0x00)&&(p_data->write.value[1] == 0x00)){
-                        enable_heart_ntf = false;
-                    }
-                }else if(res == SPP_IDX_SPP_HEARTBEAT_VAL){
-                    if((p_data->write.len == sizeof(heartbeat_s))&&(memcmp(heartbeat_s,p_data->write.value,sizeof(heartbeat_s)) == 0)){
-                        heartbeat_count_num = 0;
-                    }
-                }
-#endif
-                else {
-                    ESP_LOGI(GATTS_TABLE_TAG, "WRITE_EVT: res ne correspond à aucun bloc connu (res=%d)", res);
+            res = spp_attr_index(p_data->write.handle);
+            const spp_attr_ops_t *ops = res < SPP_IDX_NB ? &spp_attr_ops[res] : NULL;
+            ESP_LOGI(GATTS_TABLE_TAG, "WRITE_EVT handle=0x%04x, index=%d, len=%d",
+                     p_data->write.handle, res, p_data->write.len);
+
+            if (ops == NULL || ops->write == NULL) {
+                ESP_LOGI(GATTS_TABLE_TAG, "WRITE_EVT: aucun traitement pour l'index %d", res);
+            } else if (p_data->write.is_prep == false) {
+                ops->write(p_data->write.value, p_data->write.len);
+            }
+            // Fragment d’une écriture longue : remis à l’exécution (ESP_GATTS_EXEC_WRITE_EVT)
+            else if (ops->long_write) {
+                if (!prep_ring_prepare(&prep_writes, p_data->write.handle, p_data->write.offset,
+                                       p_data->write.value, p_data->write.len)) {
+                    ESP_LOGW(GATTS_TABLE_TAG, "Ecriture longue refusee (offset %u)", p_data->write.offset);
                 }
             }
-            // Gestion PREP_WRITE éventuelle
-            else if((p_data->write.is_prep == true)&&(res == SPP_IDX_SPP_DATA_RECV_VAL)){
-                ESP_LOGI(GATTS_TABLE_TAG, "ESP_GATTS_PREP_WRITE_EVT : handle = %d", res);
-                store_wr_buffer(p_data);
+            break;
+        }
+        case ESP_GATTS_READ_EVT:
+            res = spp_attr_index(p_data->read.handle);
+            if (res < SPP_IDX_NB && spp_attr_ops[res].read) {
+                spp_attr_ops[res].read();
+            }
+            break;
+        case ESP_GATTS_EXEC_WRITE_EVT: {
+            prep_msg_t msg;
+            if (p_data->exec_write.exec_write_flag != ESP_GATT_PREP_WRITE_EXEC) {
+                prep_ring_cancel(&prep_writes);
+            } else if (prep_ring_execute(&prep_writes, &msg)) {
+                res = spp_attr_index(msg.handle);
+                ESP_LOGI(GATTS_TABLE_TAG, "Ecriture longue : %u octets, index %d", (unsigned)msg.len, res);
+                if (res < SPP_IDX_NB && spp_attr_ops[res].write) {
+                    spp_attr_ops[res].write(msg.data, msg.len);
+                }
+                prep_ring_release(&prep_writes);
             }
             break;
         }
+        case ESP_GATTS_MTU_EVT:
+            spp_mtu_size = p_data->mtu.mtu;
+            ESP_LOGI(GATTS_TABLE_TAG, "MTU negocie : %d", spp_mtu_size);
+            xSemaphoreTake(data_tx_lock, portMAX_DELAY);
+            ble_tx_set_mtu(&data_tx, spp_mtu_size);
+            xSemaphoreGive(data_tx_lock);
+            break;
+        // Notification traitée par la pile : la suivante peut partir
+        case ESP_GATTS_CONF_EVT:
+            if (p_data->conf.handle == spp_handle_table[SPP_IDX_SPP_DATA_NTY_VAL]) {
+                xSemaphoreTake(data_tx_lock, portMAX_DELAY);
+                data_tx_unlock(ble_tx_on_sent(&data_tx, p_data->conf.status == ESP_GATT_OK, session_clock_now_us()));
+            } else if (p_data->conf.handle == spp_handle_table[SPP_IDX_SPP_STATUS_VAL]) {
+                xSemaphoreGive(status_tx_sem);
+            }
+            break;
+        case ESP_GATTS_CONGEST_EVT:
+            xSemaphoreTake(data_tx_lock, portMAX_DELAY);
+            data_tx_unlock(ble_tx_on_congest(&data_tx, p_data->congest.congested, session_clock_now_us()));
+            break;
         case ESP_GATTS_CONNECT_EVT:
             spp_conn_id = p_data->connect.conn_id;
             spp_gatts_if = gatts_if;
             is_connected = true;
             memcpy(&spp_remote_bda,&p_data->connect.remote_bda,sizeof(esp_bd_addr_t));
+            // Le pont synchronise le journal aussitôt connecté : profil rapide d’emblée
+            xSemaphoreTake(conn_lock, portMAX_DELAY);
+            conn_policy_connected(&conn_policy, p_data->connect.conn_params.interval,
+                                  p_data->connect.conn_params.latency,
+                                  p_data->connect.conn_params.timeout, session_clock_now_us());
+            xSemaphoreGive(conn_lock);
+            conn_apply();
 #ifdef SUPPORT_HEARTBEAT
             uint16_t cmd = 0;
             xQueueSend(cmd_heartbeat_queue,&cmd,10/portTICK_PERIOD_MS);
@@ -607,6 +1260,19 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_
             spp_mtu_size = 23;
             is_connected = false;
             enable_data_ntf = false;
+            enable_diag_ntf = false;
+            enable_status_ntf = false;
+            // Confirmations perdues avec la connexion : fenêtre des réponses rendue
+            while (uxSemaphoreGetCount(status_tx_sem) < STATUS_TX_WINDOW) {
+                xSemaphoreGive(status_tx_sem);
+            }
+            xSemaphoreTake(conn_lock, portMAX_DELAY);
+            conn_policy_disconnected(&conn_policy);
+            esp_timer_stop(conn_timer);
+            xSemaphoreGive(conn_lock);
+            prep_ring_cancel(&prep_writes);
+            xSemaphoreTake(data_tx_lock, portMAX_DELAY);
+            data_tx_unlock(ble_tx_reset(&data_tx));
 #ifdef SUPPORT_HEARTBEAT
             enable_heart_ntf = false;
             heartbeat_count_num = 0;
@@ -623,6 +1289,14 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_
             }
             else {
                 memcpy(spp_handle_table, param->add_attr_tab.handles, sizeof(spp_handle_table));
+                spp_handles_contiguous = true;
+                for (int i = 1; i < SPP_IDX_NB; i++) {
+                    if (spp_handle_table[i] != spp_handle_table[SPP_IDX_SVC] + i) {
+                        spp_handles_contiguous = false;
+                        ESP_LOGW(GATTS_TABLE_TAG, "Handles non consecutifs : recherche dans la table");
+                        break;
+                    }
+                }
                 esp_ble_gatts_start_service(spp_handle_table[SPP_IDX_SVC]);
                 ESP_LOGI(GATTS_TABLE_TAG, "Handles GATT DB:");
                 for (int i = 0; i < SPP_IDX_NB; i++) {
@@ -639,7 +1313,9 @@ static void gatts_profile_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_
 
 static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_if, esp_ble_gatts_cb_param_t *param)
 {
-    ESP_LOGI(GATTS_TABLE_TAG, "EVT %d, gatts if %d", event, gatts_if);
+    if (event != ESP_GATTS_CONF_EVT) {      // Une par notification : journal illisible et envoi ralenti
+        ESP_LOGI(GATTS_TABLE_TAG, "EVT %d, gatts if %d", event, gatts_if);
+    }
 
     /* If event is register event, store the gatts_if for each profile */
     if (event == ESP_GATTS_REG_EVT) {
@@ -664,6 +1340,133 @@ static void gatts_event_handler(esp_gatts_cb_event_t event, esp_gatt_if_t gatts_
     } while (0);
 }
 
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_spp_get_mtu
+
+   --------------------------------------------------------------------------
+   Purpose:
+   MTU de la connexion en cours (23 tant qu’il n’a pas été négocié)
+
+   --------------------------------------------------------------------------
+   Return value:
+     MTU ATT en octets (charge utile d’une notification : MTU - 3)
+
+-- -------------------------------------------------------------------------- */
+uint16_t ble_spp_get_mtu(void)
+{
+    return spp_mtu_size;
+}
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_spp_data_send
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Envoie un bloc au pont par notifications sur DATA_NOTIFY
+
+   --------------------------------------------------------------------------
+   Description:
+   Bloc fragmenté à la taille du MTU négocié (voir ble_tx.h), envoyé au
+   rythme des confirmations de la pile. Le bloc n’est pas copié : il doit
+   rester intact jusqu’à l’appel de done, fait depuis la tâche Bluedroid.
+   Un seul compte rendu par bloc : si la pile refuse d’emblée une
+   notification, seul le retour en rend compte.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     data : bloc
+     len  : sa longueur
+     done : rappel de fin (ok : dernière notification confirmée), ou NULL
+     ctx  : argument de done
+
+   --------------------------------------------------------------------------
+   Return value:
+     false si le bloc n’est pas parti (pont absent ou non abonné, bloc
+     précédent en cours, pile indisponible ou refus d’emblée) : done
+     n’est pas appelé
+
+-- -------------------------------------------------------------------------- */
+bool ble_spp_data_send(const uint8_t* data, size_t len, ble_spp_tx_done_fn done, void* ctx)
+{
+    if (!is_connected || !enable_data_ntf || len == 0) {
+        return false;
+    }
+    xSemaphoreTake(data_tx_lock, portMAX_DELAY);
+    if (ble_tx_busy(&data_tx)) {
+        xSemaphoreGive(data_tx_lock);
+        return false;
+    }
+    data_tx_done = NULL;
+    ble_tx_status_t st = ble_tx_submit(&data_tx, data, len, session_clock_now_us());
+    if (st != BLE_TX_PENDING) {
+        data_tx_unlock(st);
+        return false;
+    }
+    uint32_t block = ++data_tx_block;
+    data_tx_done = done;
+    data_tx_ctx = ctx;
+
+    // Premières notifications confiées ici : un refus de la pile pour ce
+    // bloc n’est rendu que par le retour (un bloc soumis entre-temps par
+    // un autre contexte garde son rappel)
+    st = data_tx_drain();
+    bool sent = !(st == BLE_TX_FAILED && block == data_tx_block);
+    if (!sent) data_tx_done = NULL;
+    data_tx_unlock(st);
+    return sent;
+}
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_spp_data_busy
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Indique si un bloc de DATA_NOTIFY est en cours d’envoi
+
+   --------------------------------------------------------------------------
+   Return value:
+     true jusqu’au compte rendu du bloc
+
+-- -------------------------------------------------------------------------- */
+bool ble_spp_data_busy(void)
+{
+    xSemaphoreTake(data_tx_lock, portMAX_DELAY);
+    bool busy = ble_tx_busy(&data_tx);
+    xSemaphoreGive(data_tx_lock);
+    return busy;
+}
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_spp_diag_publish
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Met à jour la caractéristique de diagnostic (appelé par diag_service)
+
+   --------------------------------------------------------------------------
+   Description:
+   La valeur est copiée par la pile BLE : une lecture longue (read blob)
+   rend le relevé complet même au-delà du MTU. La notification n’est
+   envoyée qu’à un client abonné, avec le relevé tronqué.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void ble_spp_diag_publish(const uint8_t* value, uint16_t len, const uint8_t* ntf, uint16_t ntf_len)
+{
+    uint16_t handle = spp_handle_table[SPP_IDX_DIAG_VAL];
+
+    if (handle == 0 || len == 0) {
+        return;     // Table d’attributs pas encore créée
+    }
+    esp_ble_gatts_set_attr_value(handle, len, value);
+    if (is_connected && enable_diag_ntf && ntf_len > 0) {
+        esp_ble_gatts_send_indicate(spp_gatts_if, spp_conn_id, handle, ntf_len, (uint8_t *)ntf, false);
+    }
+}
+
 void ble_server_init(void)
 {
     esp_err_t ret;
@@ -703,6 +1506,18 @@ void ble_server_init(void)
         return;
     }
 
+    prep_ring_init(&prep_writes, prep_storage, sizeof(prep_storage));
+    data_tx_lock = xSemaphoreCreateMutex();
+    ble_tx_init(&data_tx, data_tx_send, NULL, DATA_TX_WINDOW);
+    conn_lock = xSemaphoreCreateMutex();
+    conn_policy_init(&conn_policy);
+    const esp_timer_create_args_t conn_args = {
+        .callback = conn_timer_cb,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "conn_policy",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&conn_args, &conn_timer));
+
     esp_ble_gatts_register_callback(gatts_event_handler);
     esp_ble_gap_register_callback(gap_event_handler);
     esp_ble_gatts_app_register(ESP_SPP_APP_ID);
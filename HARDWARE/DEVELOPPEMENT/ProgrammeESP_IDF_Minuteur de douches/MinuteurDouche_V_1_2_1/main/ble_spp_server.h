@@ -22,6 +22,9 @@
 /**-------------------------------------------------------------------------- --
    Include header files
 -- -------------------------------------------------------------------------- */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -31,9 +34,10 @@
 -- -------------------------------------------------------------------------- */
 #define spp_sprintf(s,...)           sprintf((char*)(s), ##__VA_ARGS__)  // Wrapper simplifié
 #define SPP_DATA_MAX_LEN             (512)    // Taille max d’un paquet de données
-#define SPP_CMD_MAX_LEN              (20)     // Taille max d’une commande reçue
-#define SPP_STATUS_MAX_LEN           (20)     // Taille max d’un message de statut
+#define SPP_CMD_MAX_LEN              (512)    // Commandes binaires enchaînées d’une écriture (ble_cmd.h)
+#define SPP_STATUS_MAX_LEN           (512)    // Réponses groupées d’une notification (MTU - 3)
 #define SPP_DATA_BUFF_MAX_LEN        (2*1024) // Buffer interne global (circulaire ou tampon)
+#define SPP_DIAG_MAX_LEN             (512)    // Relevé de diagnostic (longueur max d’un attribut)
 
 /**-------------------------------------------------------------------------- --
    Enumération de la machine d'état GATT (index des caractéristiques/valeurs)
@@ -48,13 +52,17 @@ enum {
     SPP_IDX_SPP_DATA_NTY_VAL,       // Valeur à notifier
     SPP_IDX_SPP_DATA_NTF_CFG,       // Configuration des notifications (Client Characteristic Configuration Descriptor)
 
-    SPP_IDX_SPP_COMMAND_CHAR,       // Caractéristique pour les commandes (type texte)
+    SPP_IDX_SPP_COMMAND_CHAR,       // Caractéristique des commandes binaires (ble_cmd.h)
     SPP_IDX_SPP_COMMAND_VAL,        // Valeur des commandes
 
-    SPP_IDX_SPP_STATUS_CHAR,        // Caractéristique de retour d’état
+    SPP_IDX_SPP_STATUS_CHAR,        // Caractéristique des réponses aux commandes
     SPP_IDX_SPP_STATUS_VAL,         // Valeur de statut
     SPP_IDX_SPP_STATUS_CFG,         // Configuration des notifications sur statut
 
+    SPP_IDX_DIAG_CHAR,              // Caractéristique de diagnostic (diag_record)
+    SPP_IDX_DIAG_VAL,               // Dernier relevé
+    SPP_IDX_DIAG_CFG,               // Configuration des notifications de diagnostic
+
 #ifdef SUPPORT_HEARTBEAT
     SPP_IDX_SPP_HEARTBEAT_CHAR,     // Caractéristique de heartbeat
     SPP_IDX_SPP_HEARTBEAT_VAL,      // Valeur heartbeat
@@ -64,6 +72,9 @@ enum {
     SPP_IDX_NB                      // Nombre total d’éléments dans le GATT
 };
 
+/* Compte rendu d’un envoi de ble_spp_data_send (ok : bloc entièrement notifié) */
+typedef void (*ble_spp_tx_done_fn)(void* ctx, bool ok);
+
 /**-------------------------------------------------------------------------- --
    Public function prototypes
 -- -------------------------------------------------------------------------- */
@@ -81,3 +92,73 @@ enum {
 
 -- -------------------------------------------------------------------------- */
 void ble_server_init(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_spp_get_mtu
+
+   --------------------------------------------------------------------------
+   Purpose:
+   MTU négocié avec le pont (23 par défaut)
+
+   --------------------------------------------------------------------------
+   Return value:
+     MTU en octets
+
+-- -------------------------------------------------------------------------- */
+uint16_t ble_spp_get_mtu(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_spp_diag_publish
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Publie un relevé de diagnostic sur la caractéristique 0xABF6
+
+   --------------------------------------------------------------------------
+   Parameters:
+     value   : relevé complet, valeur lue par les clients
+     len     : sa longueur (SPP_DIAG_MAX_LEN au plus)
+     ntf     : relevé tronqué au MTU, notifié si le client est abonné
+     ntf_len : sa longueur (0 : pas de notification)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void ble_spp_diag_publish(const uint8_t* value, uint16_t len, const uint8_t* ntf, uint16_t ntf_len);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_spp_data_send
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Envoie un bloc au pont sur DATA_NOTIFY, fragmenté à la taille du MTU
+
+   --------------------------------------------------------------------------
+   Parameters:
+     data : bloc, intact jusqu’à l’appel de done
+     len  : sa longueur
+     done : rappel de fin (tâche Bluedroid), ou NULL
+     ctx  : argument de done
+
+   --------------------------------------------------------------------------
+   Return value:
+     false si le bloc n’est pas parti (done n’est alors pas appelé)
+
+-- -------------------------------------------------------------------------- */
+bool ble_spp_data_send(const uint8_t* data, size_t len, ble_spp_tx_done_fn done, void* ctx);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_spp_data_busy
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Indique si un bloc de ble_spp_data_send est en cours d’envoi
+
+   --------------------------------------------------------------------------
+   Return value:
+     true jusqu’au compte rendu du bloc
+
+-- -------------------------------------------------------------------------- */
+bool ble_spp_data_busy(void);
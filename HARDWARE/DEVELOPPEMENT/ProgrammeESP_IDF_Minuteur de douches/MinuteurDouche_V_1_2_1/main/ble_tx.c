@@ -0,0 +1,319 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ble_tx.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Fragmentation et rythme des notifications (voir ble_tx.h).
+
+   Les confirmations arrivent dans l’ordre des envois. Un échec signalé
+   par la pile abandonne le bloc : les fragments suivants ne sont plus
+   envoyés, le destinataire voit un bloc incomplet et le rejette. Les
+   confirmations encore attendues sont décomptées normalement ; arrivées
+   pendant le bloc suivant, leurs échecs ne concernent pas celui-ci.
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "ble_tx.h"
+#include <string.h>
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: finish
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Termine le bloc en cours
+
+   --------------------------------------------------------------------------
+   Parameters:
+     tx     : moteur
+     ok     : true si toutes ses notifications sont confirmées
+     now_us : instant de la dernière confirmation
+
+   --------------------------------------------------------------------------
+   Return value:
+     BLE_TX_DONE ou BLE_TX_FAILED
+
+-- -------------------------------------------------------------------------- */
+static ble_tx_status_t finish(ble_tx_t* tx, bool ok, int64_t now_us) {
+    if (ok) {
+        uint32_t us = (uint32_t)(now_us - tx->start_us);
+        tx->stats.blocks++;
+        tx->stats.last_bytes = (uint32_t)tx->len;
+        tx->stats.last_notifications = tx->sent;
+        tx->stats.last_us = us;
+        tx->stats.last_bytes_per_s = us ? (uint32_t)((uint64_t)tx->len * 1000000u / us) : 0;
+    } else {
+        tx->stats.failures++;
+        tx->stale = tx->in_flight;     // Confirmations dues, avant celles du bloc suivant
+    }
+    tx->data = NULL;
+    return ok ? BLE_TX_DONE : BLE_TX_FAILED;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: pump
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Confie à la pile autant de notifications que la fenêtre le permet
+
+   --------------------------------------------------------------------------
+   Description:
+   Un refus de la pile laisse la notification à refaire à la prochaine
+   confirmation ; sans confirmation attendue, rien ne la relancerait :
+   le bloc est abandonné.
+
+   --------------------------------------------------------------------------
+   Return value:
+     BLE_TX_PENDING ou BLE_TX_FAILED
+
+-- -------------------------------------------------------------------------- */
+static ble_tx_status_t pump(ble_tx_t* tx, int64_t now_us) {
+    while (tx->data && tx->offset < tx->len && tx->in_flight < tx->window && !tx->congested) {
+        size_t n = tx->len - tx->offset;
+        if (n > tx->chunk) n = tx->chunk;
+
+        const uint8_t* ntf = tx->data + tx->offset;
+        uint16_t ntf_len = (uint16_t)n;
+        if (tx->fragmented) {
+            tx->frag[0] = BLE_TX_FRAG_MAGIC;
+            tx->frag[1] = (tx->offset == 0 ? BLE_TX_FRAG_FIRST : 0) |
+                          (tx->offset + n == tx->len ? BLE_TX_FRAG_LAST : 0);
+            tx->frag[2] = (uint8_t)(tx->index & 0xFF);
+            tx->frag[3] = (uint8_t)(tx->index >> 8);
+            memcpy(tx->frag + BLE_TX_FRAG_HEADER, ntf, n);
+            ntf = tx->frag;
+            ntf_len = (uint16_t)(n + BLE_TX_FRAG_HEADER);
+        }
+
+        if (!tx->send(tx->ctx, ntf, ntf_len)) {
+            if (tx->in_flight == 0) return finish(tx, false, now_us);
+            break;
+        }
+        tx->offset += n;
+        tx->index++;
+        tx->sent++;
+        tx->in_flight++;
+        tx->stats.notifications++;
+    }
+    return BLE_TX_PENDING;
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Moteur au repos, MTU par défaut
+
+   --------------------------------------------------------------------------
+   Parameters:
+     tx     : moteur
+     send   : envoi d’une notification
+     ctx    : argument de send
+     window : notifications non confirmées au plus
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void ble_tx_init(ble_tx_t* tx, ble_tx_send_fn send, void* ctx, uint8_t window) {
+    memset(tx, 0, sizeof(*tx));
+    tx->send = send;
+    tx->ctx = ctx;
+    tx->window = window ? window : 1;
+    tx->mtu = BLE_TX_MTU_DEFAULT;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_set_mtu
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Enregistre le MTU négocié
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void ble_tx_set_mtu(ble_tx_t* tx, uint16_t mtu) {
+    if (mtu < BLE_TX_MTU_DEFAULT) mtu = BLE_TX_MTU_DEFAULT;
+    if (mtu > BLE_TX_NTF_MAX + 3) mtu = BLE_TX_NTF_MAX + 3;
+    tx->mtu = mtu;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_submit
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Commence l’envoi d’un bloc
+
+   --------------------------------------------------------------------------
+   Parameters:
+     tx     : moteur
+     data   : bloc (intact jusqu’au compte rendu)
+     len    : sa longueur
+     now_us : instant de l’appel
+
+   --------------------------------------------------------------------------
+   Return value:
+     BLE_TX_PENDING, BLE_TX_FAILED ou BLE_TX_REJECTED
+
+-- -------------------------------------------------------------------------- */
+ble_tx_status_t ble_tx_submit(ble_tx_t* tx, const uint8_t* data, size_t len, int64_t now_us) {
+    if (tx->data) return BLE_TX_REJECTED;
+    if (len == 0) return BLE_TX_FAILED;
+
+    uint16_t payload = tx->mtu - 3;
+    tx->data = data;
+    tx->len = len;
+    tx->offset = 0;
+    tx->fragmented = len > payload || data[0] == BLE_TX_FRAG_MAGIC;
+    tx->chunk = tx->fragmented ? payload - BLE_TX_FRAG_HEADER : payload;
+    tx->index = 0;
+    tx->sent = 0;
+    tx->start_us = now_us;
+    return pump(tx, now_us);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_on_sent
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Une notification a été traitée par la pile
+
+   --------------------------------------------------------------------------
+   Parameters:
+     tx     : moteur
+     ok     : false si la pile signale un échec
+     now_us : instant de la confirmation
+
+   --------------------------------------------------------------------------
+   Return value:
+     BLE_TX_DONE, BLE_TX_FAILED ou BLE_TX_PENDING
+
+-- -------------------------------------------------------------------------- */
+ble_tx_status_t ble_tx_on_sent(ble_tx_t* tx, bool ok, int64_t now_us) {
+    if (tx->in_flight > 0) tx->in_flight--;
+    if (tx->stale > 0) {
+        tx->stale--;                                    // Reste d’un bloc abandonné
+        return tx->data ? pump(tx, now_us) : BLE_TX_PENDING;
+    }
+    if (tx->data == NULL) return BLE_TX_PENDING;
+
+    if (!ok) return finish(tx, false, now_us);
+    if (tx->offset == tx->len && tx->in_flight == 0) return finish(tx, true, now_us);
+    return pump(tx, now_us);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_on_refused
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Une notification comptée en vol ne sera jamais confirmée
+
+   --------------------------------------------------------------------------
+   Description:
+   Pour un appelant dont la fonction d’envoi ne fait que préparer les
+   notifications : le refus de la pile arrive après coup. Ce n’est pas
+   une confirmation : les restes d’un bloc abandonné (stale) ne sont
+   décomptés que pour ses propres notifications jamais envoyées.
+
+   --------------------------------------------------------------------------
+   Return value:
+     BLE_TX_FAILED si un bloc était en cours, sinon BLE_TX_PENDING
+
+-- -------------------------------------------------------------------------- */
+ble_tx_status_t ble_tx_on_refused(ble_tx_t* tx, int64_t now_us) {
+    if (tx->in_flight > 0) tx->in_flight--;
+    if (tx->data == NULL) {
+        if (tx->stale > 0) tx->stale--;
+        return BLE_TX_PENDING;
+    }
+    return finish(tx, false, now_us);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_on_congest
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Suspend ou reprend les envois
+
+   --------------------------------------------------------------------------
+   Return value:
+     BLE_TX_PENDING ou BLE_TX_FAILED
+
+-- -------------------------------------------------------------------------- */
+ble_tx_status_t ble_tx_on_congest(ble_tx_t* tx, bool congested, int64_t now_us) {
+    if (congested && !tx->congested) tx->stats.congestions++;
+    tx->congested = congested;
+    return congested ? BLE_TX_PENDING : pump(tx, now_us);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_reset
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Oublie la connexion terminée
+
+   --------------------------------------------------------------------------
+   Return value:
+     BLE_TX_FAILED si un bloc était en cours, sinon BLE_TX_PENDING
+
+-- -------------------------------------------------------------------------- */
+ble_tx_status_t ble_tx_reset(ble_tx_t* tx) {
+    bool active = tx->data != NULL;
+
+    tx->in_flight = 0;
+    tx->stale = 0;
+    tx->congested = false;
+    tx->mtu = BLE_TX_MTU_DEFAULT;
+    return active ? finish(tx, false, 0) : BLE_TX_PENDING;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_busy
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Indique si un bloc est en cours
+
+   --------------------------------------------------------------------------
+   Return value:
+     true tant que le compte rendu du bloc n’est pas rendu
+
+-- -------------------------------------------------------------------------- */
+bool ble_tx_busy(const ble_tx_t* tx) {
+    return tx->data != NULL;
+}
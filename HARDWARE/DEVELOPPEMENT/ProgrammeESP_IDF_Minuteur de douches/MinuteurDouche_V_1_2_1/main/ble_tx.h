@@ -0,0 +1,171 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: ble_tx.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Envoi d’un bloc de données par notifications sur une caractéristique :
+   - Un bloc qui tient dans une notification (MTU - 3) part tel quel ;
+     au-delà, il est découpé en fragments de MTU - 3 octets, chacun
+     précédé d’un en-tête de BLE_TX_FRAG_HEADER octets :
+       '#', drapeaux (BLE_TX_FRAG_FIRST / LAST), numéro (16 bits LE)
+     Le numéro repasse par 0 après 65535 : pas de limite de taille.
+     Un bloc court qui commence par '#' est aussi fragmenté (un seul
+     fragment) pour rester sans ambiguïté
+   - Rythme réglé par la pile BLE, sans attente fixe : au plus "window"
+     notifications confiées à la pile et pas encore confirmées
+     (ESP_GATTS_CONF_EVT), aucune pendant une congestion
+     (ESP_GATTS_CONGEST_EVT)
+   - Débit obtenu mesuré sur chaque bloc (première notification ->
+     dernière confirmation)
+   Un bloc à la fois ; le bloc n’est pas copié et doit rester intact
+   jusqu’au compte rendu (BLE_TX_DONE ou BLE_TX_FAILED). L’appelant
+   sérialise les appels (verrou) ; aucune dépendance ESP-IDF : module
+   testé sur PC (liaison simulée).
+
+-- ========================================================================== */
+
+#ifndef BLE_TX_H
+#define BLE_TX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define BLE_TX_MTU_DEFAULT      23          // MTU ATT avant négociation
+#define BLE_TX_NTF_MAX          512         // Plus longue notification (attribut de 512 octets)
+#define BLE_TX_FRAG_MAGIC       '#'
+#define BLE_TX_FRAG_HEADER      4
+#define BLE_TX_FRAG_FIRST       0x01
+#define BLE_TX_FRAG_LAST        0x02
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   TYPE: ble_tx_send_fn
+   Confie une notification à la pile BLE (qui la copie)
+   Retour : false si la pile la refuse (file pleine)
+-- -------------------------------------------------------------------------- */
+typedef bool (*ble_tx_send_fn)(void* ctx, const uint8_t* data, uint16_t len);
+
+/* -------------------------------------------------------------------------- --
+   ENUM: ble_tx_status_t
+   Compte rendu des fonctions de ble_tx
+-- -------------------------------------------------------------------------- */
+typedef enum {
+    BLE_TX_PENDING,                    // Envoi en cours (ou aucun envoi)
+    BLE_TX_DONE,                       // Dernière notification du bloc confirmée
+    BLE_TX_FAILED,                     // Bloc abandonné (refus ou échec de la pile)
+    BLE_TX_REJECTED                    // ble_tx_submit : un bloc est déjà en cours
+} ble_tx_status_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: ble_tx_stats_t
+   Compteurs depuis ble_tx_init et mesure du dernier bloc envoyé
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint32_t blocks;                   // Blocs envoyés
+    uint32_t failures;                 // Blocs abandonnés
+    uint32_t notifications;
+    uint32_t congestions;              // Passages en congestion
+    uint32_t last_bytes;               // Dernier bloc : taille
+    uint32_t last_notifications;       // ... notifications
+    uint32_t last_us;                  // ... durée
+    uint32_t last_bytes_per_s;         // ... débit utile obtenu
+} ble_tx_stats_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: ble_tx_t
+   Moteur d’envoi d’une caractéristique
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    ble_tx_send_fn send;
+    void* ctx;
+    uint8_t window;                    // Notifications non confirmées au plus
+    uint16_t mtu;
+
+    const uint8_t* data;               // Bloc en cours (NULL : aucun)
+    size_t len;
+    size_t offset;                     // Premier octet pas encore confié à la pile
+    uint16_t chunk;                    // Octets du bloc par notification
+    bool fragmented;
+    uint16_t index;                    // Numéro du prochain fragment
+    uint32_t sent;                     // Notifications du bloc confiées à la pile
+    int64_t start_us;
+
+    uint8_t in_flight;                 // Notifications confiées, pas encore confirmées
+    uint8_t stale;                     // ... dont celles d’un bloc abandonné
+    bool congested;
+    ble_tx_stats_t stats;
+    uint8_t frag[BLE_TX_NTF_MAX];
+} ble_tx_t;
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_init
+   Prépare le moteur (MTU par défaut, window >= 1)
+-- -------------------------------------------------------------------------- */
+void ble_tx_init(ble_tx_t* tx, ble_tx_send_fn send, void* ctx, uint8_t window);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_set_mtu
+   MTU négocié ; vaut pour les blocs suivants
+-- -------------------------------------------------------------------------- */
+void ble_tx_set_mtu(ble_tx_t* tx, uint16_t mtu);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_submit
+   Commence l’envoi d’un bloc de len octets (len > 0)
+   Retour : BLE_TX_PENDING, BLE_TX_FAILED (pile indisponible) ou
+   BLE_TX_REJECTED (bloc précédent en cours)
+-- -------------------------------------------------------------------------- */
+ble_tx_status_t ble_tx_submit(ble_tx_t* tx, const uint8_t* data, size_t len, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_on_sent
+   Confirmation d’une notification par la pile (ESP_GATTS_CONF_EVT)
+   Retour : BLE_TX_DONE à la fin du bloc, BLE_TX_FAILED s’il est abandonné
+-- -------------------------------------------------------------------------- */
+ble_tx_status_t ble_tx_on_sent(ble_tx_t* tx, bool ok, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_on_refused
+   Notification acceptée par send mais finalement refusée par la pile
+   (envoi différé par l’appelant) : jamais confirmée. Abandonne le bloc
+   en cours ; sans bloc, la retire seulement de la fenêtre
+   Retour : BLE_TX_FAILED si un bloc était en cours
+-- -------------------------------------------------------------------------- */
+ble_tx_status_t ble_tx_on_refused(ble_tx_t* tx, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_on_congest
+   Début ou fin de congestion de la liaison (ESP_GATTS_CONGEST_EVT)
+-- -------------------------------------------------------------------------- */
+ble_tx_status_t ble_tx_on_congest(ble_tx_t* tx, bool congested, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_reset
+   Déconnexion : bloc abandonné, MTU par défaut
+   Retour : BLE_TX_FAILED si un bloc était en cours
+-- -------------------------------------------------------------------------- */
+ble_tx_status_t ble_tx_reset(ble_tx_t* tx);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: ble_tx_busy
+   Un bloc est en cours d’envoi
+-- -------------------------------------------------------------------------- */
+bool ble_tx_busy(const ble_tx_t* tx);
+
+#endif // BLE_TX_H
@@ -0,0 +1,219 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: button_gesture.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Reconnaissance des gestes du bouton (voir button_gesture.h).
+   Les instants viennent tous de la même horloge (esp_timer sur la cible,
+   horloge simulée sur PC) : les écarts sont calculés en int64_t sans
+   débordement possible.
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "button_gesture.h"
+#include <string.h>
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: apply
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Retient une transition (hors fenêtre d’anti-rebond) et en déduit le geste
+
+   --------------------------------------------------------------------------
+   Return value:
+     Geste reconnu par cette transition
+
+-- -------------------------------------------------------------------------- */
+static button_gesture_t apply(button_gesture_sm_t* sm, bool pressed, int64_t t_us) {
+    sm->pressed = pressed;
+    sm->edge_us = t_us;
+
+    if (pressed) {
+        sm->press_us = t_us;
+        sm->long_sent = false;
+        sm->second = sm->double_armed && (t_us - sm->release_us) <= BUTTON_DOUBLE_US;
+        sm->double_armed = false;
+        return sm->second ? BUTTON_GESTURE_DOUBLE : BUTTON_GESTURE_NONE;
+    }
+
+    // Relâchement : seul un appui simple et bref donne un appui court
+    if (sm->long_sent || sm->second) {
+        sm->double_armed = false;
+        return BUTTON_GESTURE_NONE;
+    }
+    sm->double_armed = true;
+    sm->release_us = t_us;
+    return BUTTON_GESTURE_SHORT;
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_gesture_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   État initial à partir du niveau lu
+
+   --------------------------------------------------------------------------
+   Description:
+   Un bouton tenu au démarrage est marqué comme déjà signalé : son
+   relâchement ne produit pas d’appui court.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void button_gesture_init(button_gesture_sm_t* sm, bool pressed, int64_t now_us) {
+    memset(sm, 0, sizeof(*sm));
+    sm->pressed = pressed;
+    sm->long_sent = pressed;
+    sm->edge_us = now_us - BUTTON_DEBOUNCE_US;
+    sm->press_us = now_us;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_gesture_edge
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Traite une transition horodatée
+
+   --------------------------------------------------------------------------
+   Description:
+   - Même niveau que le niveau retenu : ignorée (interruption en double)
+   - Moins de BUTTON_DEBOUNCE_US après la dernière transition retenue :
+     rebond ignoré, le niveau sera relu à la fin de la fenêtre
+   - Sinon retenue immédiatement : la réaction ne dépend que du délai
+     interruption -> tâche
+
+   --------------------------------------------------------------------------
+   Parameters:
+     sm      : état
+     pressed : nouveau niveau (true = bouton appuyé)
+     t_us    : instant de l’interruption
+
+   --------------------------------------------------------------------------
+   Return value:
+     Geste reconnu, BUTTON_GESTURE_NONE sinon
+
+-- -------------------------------------------------------------------------- */
+button_gesture_t button_gesture_edge(button_gesture_sm_t* sm, bool pressed, int64_t t_us) {
+    if (t_us - sm->edge_us < BUTTON_DEBOUNCE_US) {
+        sm->resync = true;
+        return BUTTON_GESTURE_NONE;
+    }
+    if (pressed == sm->pressed) return BUTTON_GESTURE_NONE;
+    return apply(sm, pressed, t_us);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_gesture_poll
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Traite l’échéance courante (button_gesture_deadline)
+
+   --------------------------------------------------------------------------
+   Description:
+   - Fin d’une fenêtre d’anti-rebond où des transitions ont été ignorées :
+     si le niveau réel diffère du niveau retenu, la transition manquée est
+     appliquée à now_us ; un appui déjà relâché à la fin de sa propre
+     fenêtre est une impulsion parasite, sans geste
+   - Bouton tenu depuis BUTTON_LONG_US : appui long, une seule fois
+   Sans effet avant l’échéance.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     sm      : état
+     pressed : niveau lu à now_us
+     now_us  : instant courant
+
+   --------------------------------------------------------------------------
+   Return value:
+     Geste reconnu, BUTTON_GESTURE_NONE sinon
+
+-- -------------------------------------------------------------------------- */
+button_gesture_t button_gesture_poll(button_gesture_sm_t* sm, bool pressed, int64_t now_us) {
+    if (sm->resync && now_us - sm->edge_us >= BUTTON_DEBOUNCE_US) {
+        sm->resync = false;
+        if (pressed != sm->pressed) {
+            if (pressed) return apply(sm, true, now_us);
+            // Relâché dans la fenêtre de l’appui : impulsion parasite
+            sm->pressed = false;
+            sm->edge_us = now_us;
+            sm->double_armed = false;
+            return BUTTON_GESTURE_NONE;
+        }
+    }
+
+    if (sm->pressed && !sm->long_sent && !sm->second &&
+        now_us - sm->press_us >= BUTTON_LONG_US) {
+        sm->long_sent = true;
+        return BUTTON_GESTURE_LONG;
+    }
+    return BUTTON_GESTURE_NONE;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_gesture_deadline
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Prochain instant où button_gesture_poll peut produire quelque chose
+
+   --------------------------------------------------------------------------
+   Return value:
+     Instant en µs, BUTTON_NO_DEADLINE si aucun
+
+-- -------------------------------------------------------------------------- */
+int64_t button_gesture_deadline(const button_gesture_sm_t* sm) {
+    int64_t deadline = BUTTON_NO_DEADLINE;
+
+    if (sm->resync) {
+        deadline = sm->edge_us + BUTTON_DEBOUNCE_US;
+    }
+    if (sm->pressed && !sm->long_sent && !sm->second &&
+        sm->press_us + BUTTON_LONG_US < deadline) {
+        deadline = sm->press_us + BUTTON_LONG_US;
+    }
+    return deadline;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_gesture_name
+
+   --------------------------------------------------------------------------
+   Return value:
+     Nom constant du geste
+
+-- -------------------------------------------------------------------------- */
+const char* button_gesture_name(button_gesture_t gesture) {
+    switch (gesture) {
+    case BUTTON_GESTURE_SHORT:  return "court";
+    case BUTTON_GESTURE_LONG:   return "long";
+    case BUTTON_GESTURE_DOUBLE: return "double";
+    case BUTTON_GESTURE_NONE:   break;
+    }
+    return "aucun";
+}
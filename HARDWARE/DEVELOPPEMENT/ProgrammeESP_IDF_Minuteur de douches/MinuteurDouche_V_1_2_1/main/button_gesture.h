@@ -0,0 +1,109 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: button_gesture.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Anti-rebond et reconnaissance des gestes du bouton, à partir des
+   transitions horodatées par l’interruption GPIO :
+   - Anti-rebond sur le premier front : une transition est prise en
+     compte aussitôt, les suivantes sont ignorées pendant
+     BUTTON_DEBOUNCE_US ; le niveau réel est relu à la fin de cette
+     fenêtre (button_gesture_poll)
+   - Appui court : relâché avant BUTTON_LONG_US, signalé au relâchement
+   - Appui long : signalé dès que le bouton est tenu BUTTON_LONG_US
+     (le « Reset » de la version Arduino)
+   - Double appui : second appui moins de BUTTON_DOUBLE_US après un appui
+     court, signalé dès ce second appui ; le premier appui a déjà été
+     signalé comme court
+   Aucune dépendance ESP-IDF : module testé sur PC.
+
+-- ========================================================================== */
+
+#ifndef BUTTON_GESTURE_H
+#define BUTTON_GESTURE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define BUTTON_DEBOUNCE_US      20000       // Rebonds ignorés après une transition
+#define BUTTON_LONG_US          1500000     // Appui long (reset)
+#define BUTTON_DOUBLE_US        400000      // Relâchement -> second appui
+#define BUTTON_NO_DEADLINE      INT64_MAX   // Aucune échéance en attente
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   ENUM: button_gesture_t
+   Geste reconnu
+-- -------------------------------------------------------------------------- */
+typedef enum {
+    BUTTON_GESTURE_NONE,
+    BUTTON_GESTURE_SHORT,
+    BUTTON_GESTURE_LONG,
+    BUTTON_GESTURE_DOUBLE
+} button_gesture_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: button_gesture_sm_t
+   État de la reconnaissance (une seule tâche l’utilise)
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    bool pressed;                      // Niveau retenu après anti-rebond
+    bool resync;                       // Transition ignorée : relire le niveau
+    bool long_sent;                    // Appui courant déjà signalé long
+    bool second;                       // Appui courant = second d’un double
+    bool double_armed;                 // Dernier appui court : double possible
+    int64_t edge_us;                   // Dernière transition retenue
+    int64_t press_us;                  // Début de l’appui courant
+    int64_t release_us;                // Fin du dernier appui court
+} button_gesture_sm_t;
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_gesture_init
+   Part du niveau lu au démarrage (un bouton déjà tenu ne donne aucun geste
+   avant d’avoir été relâché)
+-- -------------------------------------------------------------------------- */
+void button_gesture_init(button_gesture_sm_t* sm, bool pressed, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_gesture_edge
+   Transition brute vers "pressed", horodatée par l’interruption
+   Retour : geste reconnu par cette transition (ou BUTTON_GESTURE_NONE)
+-- -------------------------------------------------------------------------- */
+button_gesture_t button_gesture_edge(button_gesture_sm_t* sm, bool pressed, int64_t t_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_gesture_poll
+   Échéance atteinte : niveau relu "pressed" à l’instant now_us
+   Retour : geste reconnu (appui long, ou transition manquée)
+-- -------------------------------------------------------------------------- */
+button_gesture_t button_gesture_poll(button_gesture_sm_t* sm, bool pressed, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_gesture_deadline
+   Instant du prochain button_gesture_poll nécessaire
+   Retour : BUTTON_NO_DEADLINE si seule une transition peut changer l’état
+-- -------------------------------------------------------------------------- */
+int64_t button_gesture_deadline(const button_gesture_sm_t* sm);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_gesture_name
+   Nom du geste pour les logs
+-- -------------------------------------------------------------------------- */
+const char* button_gesture_name(button_gesture_t gesture);
+
+#endif // BUTTON_GESTURE_H
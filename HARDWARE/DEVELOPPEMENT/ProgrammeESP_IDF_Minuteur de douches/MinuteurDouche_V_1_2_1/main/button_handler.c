@@ -7,11 +7,16 @@
    ==========================================================================
    Functional description:
    --------------------------------------------------------------------------
-   Gestion du bouton poussoir (GPIO)
-   - Initialisation du GPIO
-   - Détection d’un appui (front descendant)
-   - Envoi d’une notification BLE ("BP") si connectée et notifications activées
-   - Optionnel : bascule de l’état d’une LED pour retour visuel
+   Service des boutons poussoirs (GPIO, un par cabine), sans aucune
+   scrutation :
+   - L’interruption horodate chaque transition et la dépose dans une file
+     commune, avec le numéro du bouton
+   - La tâche des boutons applique l’anti-rebond et reconnaît les gestes
+     de chaque bouton (button_gesture.c), puis les distribue aux files
+     des abonnés
+   - Interruption sur niveau dont la polarité est inversée à chaque
+     transition : elle sert aussi de source de réveil du light sleep (le
+     réveil GPIO ne connaît que les niveaux)
 
    ==========================================================================
    History:
@@ -25,27 +30,208 @@
    Include header files
 -- -------------------------------------------------------------------------- */
 #include "button_handler.h"
+#include "stall_config.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
 #include "driver/gpio.h"
+#include "esp_sleep.h"
+#include "session_clock.h"
 #include "esp_log.h"
-#include "esp_gatts_api.h"
-#include "led_control.h"
-#include <string.h>
 
 /**-------------------------------------------------------------------------- --
-   Extern variables (déclarées dans ble_spp_server.c)
+   Local macros and constants
 -- -------------------------------------------------------------------------- */
-extern bool is_connected;                      // BLE connecté ?
-extern bool enable_data_ntf;                   // Notifications activées ?
-extern uint16_t spp_conn_id;                   // ID de la connexion BLE
-extern esp_gatt_if_t spp_gatts_if;             // Interface GATT
-extern uint16_t spp_handle_table[];            // Table des handles GATT
+#define TAG "BUTTON"                           // Tag pour les logs
+#define BUTTON_EDGE_DEPTH 32                   // Transitions en attente, tous boutons (rebonds compris)
+#define BUTTON_TASK_STACK 2560
+#define BUTTON_TASK_PRIO 7                     // Au-dessus du minuteur (6) : horodatage des gestes
 
 /**-------------------------------------------------------------------------- --
-   Local macros and constants
+   Types
 -- -------------------------------------------------------------------------- */
-#define SPP_IDX_SPP_DATA_NTY_VAL 4             // Index de la caractéristique de notification (doit être identique au serveur BLE)
-#define BUTTON_GPIO GPIO_NUM_5                 // Broche GPIO utilisée pour le bouton poussoir
-#define TAG "BUTTON"                           // Tag pour les logs
+typedef struct {
+    int64_t t_us;                              // Instant de l’interruption
+    uint8_t button;                            // Cabine du bouton
+    bool pressed;                              // Niveau après la transition
+} button_edge_t;
+
+/**-------------------------------------------------------------------------- --
+   Static variables
+-- -------------------------------------------------------------------------- */
+static QueueHandle_t edge_queue = NULL;
+static volatile bool isr_pressed[STALL_MAX];   // Niveau connu de chaque interruption
+
+static QueueHandle_t subscribers[BUTTON_MAX_SUBSCRIBERS];
+static volatile size_t subscriber_count = 0;
+static portMUX_TYPE subscribers_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static button_stats_t stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: arm_level
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Attend le niveau opposé à "pressed" sur le bouton "button"
+   (interruption et réveil du light sleep) ; gpio_wakeup_enable règle
+   aussi le type d’interruption
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+static void arm_level(uint8_t button, bool pressed) {
+    isr_pressed[button] = pressed;
+    gpio_wakeup_enable(stall_table[button].button_gpio,
+                       pressed ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_isr
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Interruption d’un bouton (arg : numéro de cabine) : une transition
+   horodatée par déclenchement
+
+   --------------------------------------------------------------------------
+   Description:
+   Le niveau attendu vient d’être atteint : l’interruption attend
+   désormais le niveau inverse, elle ne se redéclenche donc qu’à la
+   transition suivante (rebond compris). File pleine : transition perdue,
+   comptée ; la suivante rétablit le bon niveau.
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+static void button_isr(void *arg) {
+    BaseType_t woken = pdFALSE;
+    uint8_t button = (uint8_t)(uintptr_t)arg;
+    button_edge_t edge = {
+        .t_us = session_clock_now_us(),
+        .button = button,
+        .pressed = !isr_pressed[button],
+    };
+
+    arm_level(button, edge.pressed);
+    if (xQueueSendFromISR(edge_queue, &edge, &woken) != pdTRUE) {
+        portENTER_CRITICAL_ISR(&stats_lock);
+        stats.edges_lost++;
+        portEXIT_CRITICAL_ISR(&stats_lock);
+    }
+    portYIELD_FROM_ISR(woken);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: dispatch
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Distribue un geste à tous les abonnés, sans attente
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall   : cabine du bouton
+     gesture : geste reconnu (BUTTON_GESTURE_NONE : rien à faire)
+     t_us    : instant du geste (transition ou échéance)
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+static void dispatch(uint8_t stall, button_gesture_t gesture, int64_t t_us) {
+    if (gesture == BUTTON_GESTURE_NONE) return;
+
+    button_event_t event = { .gesture = gesture, .stall = stall, .t_us = t_us };
+    uint32_t dropped = 0;
+    size_t count = subscriber_count;
+    for (size_t i = 0; i < count; i++) {
+        if (xQueueSend(subscribers[i], &event, 0) != pdTRUE) dropped++;
+    }
+
+    int64_t react_us = session_clock_now_us() - t_us;
+    portENTER_CRITICAL(&stats_lock);
+    stats.gestures[gesture]++;
+    stats.dropped += dropped;
+    stats.last_react_us = react_us;
+    if (react_us > stats.max_react_us) stats.max_react_us = react_us;
+    portEXIT_CRITICAL(&stats_lock);
+
+    ESP_LOGD(TAG, "Cabine %u : geste %s distribue %lld us apres la transition",
+             (unsigned)stall, button_gesture_name(gesture), (long long)react_us);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_task
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Traitement différé des transitions des boutons
+
+   --------------------------------------------------------------------------
+   Description:
+   - Une reconnaissance de gestes par bouton
+   - Bloquée sur la file des transitions ; le délai d’attente est la plus
+     proche échéance des reconnaissances (fin d’anti-rebond, appui long),
+     infini au repos : aucun réveil entre deux appuis
+   - Transition reçue : button_gesture_edge du bouton concerné ; échéance
+     atteinte : niveau relu puis button_gesture_poll, pour chaque bouton
+     dont l’échéance est passée
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun (boucle infinie)
+
+-- -------------------------------------------------------------------------- */
+static void button_task(void *arg) {
+    button_gesture_sm_t sm[STALL_MAX];
+    for (uint8_t i = 0; i < stall_count; i++) {
+        button_gesture_init(&sm[i], isr_pressed[i], session_clock_now_us());
+    }
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        int64_t deadline = BUTTON_NO_DEADLINE;
+        for (uint8_t i = 0; i < stall_count; i++) {
+            int64_t d = button_gesture_deadline(&sm[i]);
+            if (d < deadline) deadline = d;
+        }
+        if (deadline != BUTTON_NO_DEADLINE) {
+            int64_t left_us = deadline - session_clock_now_us();
+            wait = (left_us > 0) ? pdMS_TO_TICKS((left_us + 999) / 1000) + 1 : 0;
+        }
+
+        button_edge_t edge;
+        if (xQueueReceive(edge_queue, &edge, wait) == pdTRUE) {
+            portENTER_CRITICAL(&stats_lock);
+            stats.edges++;
+            portEXIT_CRITICAL(&stats_lock);
+            dispatch(edge.button, button_gesture_edge(&sm[edge.button], edge.pressed, edge.t_us),
+                     edge.t_us);
+        } else {
+            int64_t now_us = session_clock_now_us();
+            for (uint8_t i = 0; i < stall_count; i++) {
+                if (button_gesture_deadline(&sm[i]) > now_us) continue;
+                bool pressed = (gpio_get_level(stall_table[i].button_gpio) == 0);
+                dispatch(i, button_gesture_poll(&sm[i], pressed, now_us), now_us);
+            }
+        }
+    }
+}
+
 
 /**========================================================================== --
    Public functions
@@ -56,13 +242,15 @@ extern uint16_t spp_handle_table[];            // Table des handles GATT
 
    --------------------------------------------------------------------------
    Purpose:
-   Initialiser le GPIO du bouton poussoir
+   Initialiser les boutons poussoirs des cabines et lancer leur tâche
 
    --------------------------------------------------------------------------
    Description:
-   - Configure la broche GPIO comme entrée
-   - Active la résistance de pull-up interne
-   - Pas d’interruption configurée ici (lecture en polling)
+   - Configure les broches GPIO comme entrées avec pull-up interne
+   - Interruption de chaque bouton sur le niveau opposé au niveau lu (bas
+     si relâché), son numéro de cabine en argument
+   - Active le réveil du light sleep par GPIO
+   - Crée la file des transitions et la tâche des boutons
 
    --------------------------------------------------------------------------
    Return value:
@@ -70,68 +258,87 @@ extern uint16_t spp_handle_table[];            // Table des handles GATT
 
 -- -------------------------------------------------------------------------- */
 void button_init(void) {
+    uint64_t mask = 0;
+    for (uint8_t i = 0; i < stall_count; i++) {
+        mask |= (1ULL << stall_table[i].button_gpio);
+    }
+
     gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << BUTTON_GPIO),     // Masque pour la broche GPIO5
+        .pin_bit_mask = mask,                      // Boutons de toutes les cabines
         .mode = GPIO_MODE_INPUT,                   // Configuration en entrée
         .pull_up_en = GPIO_PULLUP_ENABLE,          // Activation du pull-up
         .pull_down_en = GPIO_PULLDOWN_DISABLE,     // Désactivation du pull-down
-        .intr_type = GPIO_INTR_DISABLE             // Pas d’interruption (polling manuel)
+        .intr_type = GPIO_INTR_DISABLE             // Type réglé par arm_level()
     };
     gpio_config(&io_conf);                         // Application de la configuration
+
+    edge_queue = xQueueCreate(BUTTON_EDGE_DEPTH, sizeof(button_edge_t));
+    gpio_install_isr_service(0);
+    for (uint8_t i = 0; i < stall_count; i++) {
+        arm_level(i, gpio_get_level(stall_table[i].button_gpio) == 0);
+        gpio_isr_handler_add(stall_table[i].button_gpio, button_isr, (void *)(uintptr_t)i);
+    }
+    esp_sleep_enable_gpio_wakeup();
+
+    xTaskCreate(button_task, "button_task", BUTTON_TASK_STACK, NULL, BUTTON_TASK_PRIO, NULL);
 }
 
 
 /* -------------------------------------------------------------------------- --
-   FUNCTION: button_check_and_log
+   FUNCTION: button_subscribe
 
    --------------------------------------------------------------------------
    Purpose:
-   Vérifie l'état du bouton et envoie une notification BLE si appuyé
+   Crée une file de gestes pour un nouvel abonné
 
    --------------------------------------------------------------------------
    Description:
-   - Fonction à appeler régulièrement (ex: dans une tâche ou boucle principale)
-   - Détecte un front descendant (relâché → appuyé)
-   - Si connecté au BLE et notifications activées → envoie le message "BP"
-   - Active un retour visuel via la LED
+   La liste des abonnés ne fait que croître ; la tâche du bouton lit
+   subscriber_count puis les entrées déjà publiées. Une file pleine perd
+   le geste (compté dans les statistiques) : la tâche du bouton ne
+   bloque jamais sur un abonné lent.
 
    --------------------------------------------------------------------------
    Return value:
-   Aucun
+     File de button_event_t, NULL si la liste est pleine
 
 -- -------------------------------------------------------------------------- */
-void button_check_and_log(void) {
-    static int last_state = 1;                    // État précédent (1 = relâché, 0 = appuyé)
-    int current_state = gpio_get_level(BUTTON_GPIO);  // Lecture de l'état actuel
-
-    // Affiche les états BLE pour debug
-    ESP_LOGI(TAG, "is_connected=%d, enable_data_ntf=%d", is_connected, enable_data_ntf);
-
-    // Détection du front descendant (bouton appuyé)
-    if (last_state == 1 && current_state == 0) {
-        ESP_LOGI(TAG, "Bouton appuyé !");
-        led_toggle();                             // Toggle LED pour feedback utilisateur
-
-        // Si la connexion BLE est active et les notifications autorisées
-        if (is_connected && enable_data_ntf) {
-            const char *msg = "BP";               // Message à envoyer
-            esp_err_t err = esp_ble_gatts_send_indicate(
-                spp_gatts_if,                             // Interface BLE active
-                spp_conn_id,                              // Connexion active
-                spp_handle_table[SPP_IDX_SPP_DATA_NTY_VAL], // Handle de la caractéristique de notification
-                strlen(msg),                              // Taille du message
-                (uint8_t *)msg,                           // Données envoyées
-                false                                     // false = notification (pas d'acquittement)
-            );
-
-            // Vérification de l'envoi
-            if (err != ESP_OK) {
-                ESP_LOGE(TAG, "Erreur d'envoi de la notification BLE : %s", esp_err_to_name(err));
-            } else {
-                ESP_LOGI(TAG, "Notification BLE envoyée : %s", msg);
-            }
-        }
+QueueHandle_t button_subscribe(void) {
+    QueueHandle_t queue = xQueueCreate(BUTTON_EVENT_DEPTH, sizeof(button_event_t));
+    if (queue == NULL) return NULL;
+
+    bool added = false;
+    portENTER_CRITICAL(&subscribers_lock);
+    if (subscriber_count < BUTTON_MAX_SUBSCRIBERS) {
+        subscribers[subscriber_count] = queue;
+        subscriber_count = subscriber_count + 1;
+        added = true;
     }
+    portEXIT_CRITICAL(&subscribers_lock);
 
-    last_state = current_state;  // Mise à jour de l'état pour la prochaine itération
+    if (!added) {
+        ESP_LOGE(TAG, "Abonne refuse (max %d)", BUTTON_MAX_SUBSCRIBERS);
+        vQueueDelete(queue);
+        return NULL;
+    }
+    return queue;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_get_stats
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Lecture cohérente des statistiques du bouton
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void button_get_stats(button_stats_t *out) {
+    portENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_lock);
 }
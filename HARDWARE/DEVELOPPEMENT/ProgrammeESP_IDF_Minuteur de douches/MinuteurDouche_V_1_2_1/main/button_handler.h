@@ -7,9 +7,13 @@
    ==========================================================================
    Functional description:
    --------------------------------------------------------------------------
-   Interface du module de gestion du bouton poussoir :
-   - Initialisation du GPIO du bouton
-   - Détection des appuis et déclenchement d'actions (logique + BLE)
+   Interface du service des boutons poussoirs, un par cabine
+   (stall_config.h) :
+   - Initialisation des GPIO des boutons (interruption et réveil du light
+     sleep)
+   - Gestes (court, long, double) distribués aux abonnés par des files
+     FreeRTOS, horodatés à la transition qui les a déclenchés et marqués
+     du numéro de cabine du bouton
 
    ==========================================================================
    History:
@@ -20,6 +24,44 @@
 
 #pragma once
 
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "button_gesture.h"
+
+/**-------------------------------------------------------------------------- --
+   Public constants
+-- -------------------------------------------------------------------------- */
+#define BUTTON_MAX_SUBSCRIBERS 4               // Files de gestes
+#define BUTTON_EVENT_DEPTH 4                   // Gestes en attente par abonné
+
+/**-------------------------------------------------------------------------- --
+   Public types
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: button_event_t
+   Geste reçu par un abonné
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    button_gesture_t gesture;
+    uint8_t stall;             // Cabine du bouton (ligne de stall_table)
+    int64_t t_us;              // Transition (ou échéance de l’appui long), esp_timer
+} button_event_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: button_stats_t
+   Activité des boutons (toutes cabines) et délai de réaction
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint32_t edges;            // Transitions reçues (rebonds compris)
+    uint32_t edges_lost;       // File des transitions pleine
+    uint32_t gestures[BUTTON_GESTURE_DOUBLE + 1];  // Par geste
+    uint32_t dropped;          // Gestes perdus (file d’un abonné pleine)
+    int64_t  last_react_us;    // Transition -> distribution, dernier geste
+    int64_t  max_react_us;     // Pire délai observé
+} button_stats_t;
+
 /**-------------------------------------------------------------------------- --
    Public function prototypes
 -- -------------------------------------------------------------------------- */
@@ -29,7 +71,9 @@
 
    --------------------------------------------------------------------------
    Purpose:
-   Initialise le GPIO associé au bouton en mode entrée avec pull-up activé
+   Initialise le GPIO du bouton de chaque cabine en mode entrée avec
+   pull-up activé, son interruption, le réveil du light sleep et la tâche
+   des boutons
 
    --------------------------------------------------------------------------
    Return value:
@@ -39,21 +83,35 @@
 void button_init(void);
 
 /* -------------------------------------------------------------------------- --
-   FUNCTION: button_check_and_log
+   FUNCTION: button_subscribe
 
    --------------------------------------------------------------------------
    Purpose:
-   Vérifie l'état du bouton et déclenche une action à l'appui :
-   - Toggle de la LED
-   - Envoi d'une notification BLE si connectée
+   Abonne l’appelant aux gestes des boutons
 
    --------------------------------------------------------------------------
    Description:
-   À appeler régulièrement dans une boucle ou une tâche FreeRTOS
+   Chaque abonné reçoit tous les gestes de toutes les cabines dans sa
+   propre file ; un double appui est précédé de l’appui court du premier
+   appui
+
+   --------------------------------------------------------------------------
+   Return value:
+     File de button_event_t (xQueueReceive), NULL si trop d’abonnés
+
+-- -------------------------------------------------------------------------- */
+QueueHandle_t button_subscribe(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: button_get_stats
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Copie les statistiques du bouton
 
    --------------------------------------------------------------------------
    Return value:
      Aucun
 
 -- -------------------------------------------------------------------------- */
-void button_check_and_log(void);
+void button_get_stats(button_stats_t *out);
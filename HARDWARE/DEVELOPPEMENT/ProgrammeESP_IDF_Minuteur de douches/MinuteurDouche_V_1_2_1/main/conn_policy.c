@@ -0,0 +1,275 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: conn_policy.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Paramètres de connexion selon l’activité (voir conn_policy.h).
+
+   Profils choisis dans les limites usuelles des centraux (intervalle
+   maximal au moins 15 ms au-dessus du minimal, supervision supérieure à
+   deux fois intervalle × (latence + 1)) :
+   - rapide : 7,5 à 30 ms, latence 0, supervision 4 s
+   - repos  : 160 à 200 ms, latence 4 (éveil toutes les 0,8 à 1 s au
+     plus), supervision 6 s
+   Un refus du central n’est pas relancé : le profil refusé reste le
+   dernier demandé jusqu’au changement d’activité suivant.
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "conn_policy.h"
+#include <string.h>
+
+/**-------------------------------------------------------------------------- --
+   Profils
+-- -------------------------------------------------------------------------- */
+const conn_params_t conn_policy_fast = { .min_int = 6,   .max_int = 24,  .latency = 0, .timeout = 400 };
+const conn_params_t conn_policy_idle = { .min_int = 128, .max_int = 160, .latency = 4, .timeout = 600 };
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: wanted
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Profil voulu pour l’activité en cours
+
+-- -------------------------------------------------------------------------- */
+static conn_profile_t wanted(const conn_policy_t* p, int64_t now_us) {
+    if (p->busy || now_us - p->last_activity_us < CONN_POLICY_HOLD_US) return CONN_PROFILE_FAST;
+    return CONN_PROFILE_IDLE;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: granted_match
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Indique si les paramètres en vigueur conviennent déjà au profil
+
+-- -------------------------------------------------------------------------- */
+static bool granted_match(const conn_policy_t* p, const conn_params_t* c) {
+    return p->interval >= c->min_int && p->interval <= c->max_int && p->latency == c->latency;
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Aucune connexion, compteurs à zéro
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void conn_policy_init(conn_policy_t* p) {
+    memset(p, 0, sizeof(*p));
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_connected
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Nouvelle connexion, avec les paramètres choisis par le central
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void conn_policy_connected(conn_policy_t* p, uint16_t interval, uint16_t latency,
+                           uint16_t timeout, int64_t now_us) {
+    p->connected = true;
+    p->busy = false;
+    p->last_activity_us = now_us;
+    p->requested = CONN_PROFILE_NONE;
+    p->pending = false;
+    p->interval = interval;
+    p->latency = latency;
+    p->timeout = timeout;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_disconnected
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Fin de connexion : plus aucune demande
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void conn_policy_disconnected(conn_policy_t* p) {
+    p->connected = false;
+    p->busy = false;
+    p->pending = false;
+    p->requested = CONN_PROFILE_NONE;
+    p->interval = p->latency = p->timeout = 0;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_activity
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Échange ponctuel : profil rapide pour CONN_POLICY_HOLD_US
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void conn_policy_activity(conn_policy_t* p, int64_t now_us) {
+    p->last_activity_us = now_us;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_busy
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Échange soutenu : profil rapide tant qu’il dure, puis CONN_POLICY_HOLD_US
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void conn_policy_busy(conn_policy_t* p, bool busy, int64_t now_us) {
+    p->busy = busy;
+    p->last_activity_us = now_us;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_poll
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Décide d’une demande de paramètres
+
+   --------------------------------------------------------------------------
+   Description:
+   Rien tant qu’une demande attend sa réponse. Sans réponse dans le
+   délai, le profil est considéré comme non demandé. Un profil déjà
+   satisfait par les paramètres en vigueur n’est pas demandé.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Profil à demander, CONN_PROFILE_NONE sinon
+
+-- -------------------------------------------------------------------------- */
+conn_profile_t conn_policy_poll(conn_policy_t* p, int64_t now_us) {
+    if (!p->connected) return CONN_PROFILE_NONE;
+    if (p->pending) {
+        if (now_us - p->request_us < CONN_POLICY_PENDING_US) return CONN_PROFILE_NONE;
+        p->pending = false;
+        p->requested = CONN_PROFILE_NONE;
+    }
+
+    conn_profile_t want = wanted(p, now_us);
+    if (want == p->requested) return CONN_PROFILE_NONE;
+    p->requested = want;
+    if (granted_match(p, conn_policy_params(want))) return CONN_PROFILE_NONE;
+
+    p->pending = true;
+    p->request_us = now_us;
+    p->requests++;
+    return want;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_next_us
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Prochaine échéance de la politique
+
+   --------------------------------------------------------------------------
+   Return value:
+     Instant (µs), 0 si aucune échéance
+
+-- -------------------------------------------------------------------------- */
+int64_t conn_policy_next_us(const conn_policy_t* p, int64_t now_us) {
+    int64_t next = 0;
+
+    if (!p->connected) return 0;
+    if (p->pending) next = p->request_us + CONN_POLICY_PENDING_US;
+    if (!p->busy && p->last_activity_us + CONN_POLICY_HOLD_US > now_us &&
+        (next == 0 || p->last_activity_us + CONN_POLICY_HOLD_US < next)) {
+        next = p->last_activity_us + CONN_POLICY_HOLD_US;
+    }
+    return next;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_updated
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Enregistre la réponse du central, ou un changement qu’il impose
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void conn_policy_updated(conn_policy_t* p, bool ok, uint16_t interval, uint16_t latency,
+                         uint16_t timeout) {
+    p->pending = false;
+    if (!ok) {
+        p->rejected++;
+        return;
+    }
+    p->interval = interval;
+    p->latency = latency;
+    p->timeout = timeout;
+    p->updates++;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_params
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Paramètres d’un profil
+
+   --------------------------------------------------------------------------
+   Return value:
+     Paramètres, NULL pour CONN_PROFILE_NONE
+
+-- -------------------------------------------------------------------------- */
+const conn_params_t* conn_policy_params(conn_profile_t profile) {
+    switch (profile) {
+    case CONN_PROFILE_FAST: return &conn_policy_fast;
+    case CONN_PROFILE_IDLE: return &conn_policy_idle;
+    default:                return NULL;
+    }
+}
@@ -0,0 +1,149 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: conn_policy.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Choix des paramètres de la connexion BLE avec le pont :
+   - Profil rapide (intervalle court, sans latence) pendant un échange
+     soutenu : envoi du journal, rafale de commandes ; il est gardé
+     CONN_POLICY_HOLD_US après la dernière activité, le temps que le pont
+     acquitte et que le lot suivant parte
+   - Profil repos (intervalle long, latence esclave) le reste du temps,
+     douche en cours comprise : la radio ne s’éveille qu’environ une fois
+     par seconde quand rien n’est à envoyer
+   - Une seule demande en attente de réponse du central ; sans réponse
+     après CONN_POLICY_PENDING_US, la demande est refaite si besoin
+   - Paramètres accordés (ou imposés) par le central enregistrés
+   Unités de la norme : intervalles en 1,25 ms, supervision en 10 ms.
+   L’appelant sérialise les appels ; aucune dépendance ESP-IDF : module
+   testé sur PC.
+
+-- ========================================================================== */
+
+#ifndef CONN_POLICY_H
+#define CONN_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define CONN_POLICY_HOLD_US     2000000LL   // Profil rapide gardé après la dernière activité
+#define CONN_POLICY_PENDING_US  5000000LL   // Attente maximale de la réponse du central
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   ENUM: conn_profile_t
+   Profil de paramètres
+-- -------------------------------------------------------------------------- */
+typedef enum {
+    CONN_PROFILE_NONE,                 // Choisi par le central (aucune demande)
+    CONN_PROFILE_IDLE,
+    CONN_PROFILE_FAST
+} conn_profile_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: conn_params_t
+   Paramètres demandés (unités de la norme)
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint16_t min_int;                  // × 1,25 ms
+    uint16_t max_int;
+    uint16_t latency;                  // Événements que l’esclave peut sauter
+    uint16_t timeout;                  // × 10 ms
+} conn_params_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: conn_policy_t
+   État de la connexion en cours et paramètres accordés
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    bool connected;
+    bool busy;                         // Échange soutenu en cours (bloc en envoi)
+    int64_t last_activity_us;
+    conn_profile_t requested;          // Dernier profil demandé
+    bool pending;                      // Réponse du central attendue
+    int64_t request_us;
+
+    uint16_t interval;                 // Accordés (× 1,25 ms), 0 : inconnus
+    uint16_t latency;
+    uint16_t timeout;                  // × 10 ms
+
+    uint32_t requests;                 // Depuis le démarrage
+    uint32_t updates;                  // Paramètres changés par le central
+    uint32_t rejected;                 // Demandes refusées
+} conn_policy_t;
+
+/* Paramètres de chaque profil */
+extern const conn_params_t conn_policy_fast;
+extern const conn_params_t conn_policy_idle;
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_init
+   Aucune connexion
+-- -------------------------------------------------------------------------- */
+void conn_policy_init(conn_policy_t* p);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_connected / conn_policy_disconnected
+   Début (le pont synchronise aussitôt : compte comme activité) et fin
+   de connexion ; interval, latency, timeout : paramètres initiaux
+-- -------------------------------------------------------------------------- */
+void conn_policy_connected(conn_policy_t* p, uint16_t interval, uint16_t latency,
+                           uint16_t timeout, int64_t now_us);
+void conn_policy_disconnected(conn_policy_t* p);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_activity
+   Échange ponctuel (écriture de commandes, acquittement...)
+-- -------------------------------------------------------------------------- */
+void conn_policy_activity(conn_policy_t* p, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_busy
+   Début ou fin d’un échange soutenu (envoi d’un bloc)
+-- -------------------------------------------------------------------------- */
+void conn_policy_busy(conn_policy_t* p, bool busy, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_poll
+   Profil à demander maintenant (la demande est alors comptée en attente)
+   Retour : CONN_PROFILE_NONE si aucune demande n’est à faire
+-- -------------------------------------------------------------------------- */
+conn_profile_t conn_policy_poll(conn_policy_t* p, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_next_us
+   Instant du prochain appel utile de conn_policy_poll (fin du maintien du
+   profil rapide, fin d’attente de réponse), 0 si aucun
+-- -------------------------------------------------------------------------- */
+int64_t conn_policy_next_us(const conn_policy_t* p, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_updated
+   Réponse du central (ESP_GAP_BLE_UPDATE_CONN_PARAMS_EVT) : ok à false
+   si la demande est refusée ; paramètres en vigueur
+-- -------------------------------------------------------------------------- */
+void conn_policy_updated(conn_policy_t* p, bool ok, uint16_t interval, uint16_t latency,
+                         uint16_t timeout);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: conn_policy_params
+   Paramètres d’un profil (NULL pour CONN_PROFILE_NONE)
+-- -------------------------------------------------------------------------- */
+const conn_params_t* conn_policy_params(conn_profile_t profile);
+
+#endif // CONN_POLICY_H
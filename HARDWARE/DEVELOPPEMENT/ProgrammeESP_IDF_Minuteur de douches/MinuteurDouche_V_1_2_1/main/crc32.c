@@ -0,0 +1,46 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: crc32.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   CRC-32 du journal et des trames de douches (voir crc32.h).
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "crc32.h"
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: crc32_calc
+
+   --------------------------------------------------------------------------
+   Purpose:
+   CRC-32 (polynôme réfléchi 0xEDB88320), calcul bit à bit
+
+   --------------------------------------------------------------------------
+   Return value:
+     CRC des len octets
+
+-- -------------------------------------------------------------------------- */
+uint32_t crc32_calc(const void* data, size_t len) {
+    const uint8_t* p = data;
+    uint32_t crc = 0xFFFFFFFFu;
+
+    while (len--) {
+        crc ^= *p++;
+        for (int i = 0; i < 8; i++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1u));
+        }
+    }
+    return ~crc;
+}
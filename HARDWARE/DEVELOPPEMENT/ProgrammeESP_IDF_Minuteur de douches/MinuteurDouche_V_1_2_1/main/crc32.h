@@ -0,0 +1,29 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: crc32.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   CRC-32 (polynôme réfléchi 0xEDB88320, celui de zlib.crc32 côté pont),
+   commun au journal en flash (journal_ring) et aux trames envoyées au
+   pont (session_record). Calcul bit à bit : un appel par douche, pas de
+   table en RAM. Aucune dépendance ESP-IDF.
+
+-- ========================================================================== */
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: crc32_calc
+   CRC-32 des len octets de data
+-- -------------------------------------------------------------------------- */
+uint32_t crc32_calc(const void* data, size_t len);
+
+#endif // CRC32_H
@@ -0,0 +1,213 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: diag_record.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Relevé de diagnostic (voir diag_record.h) : calcul des charges par
+   différence entre deux relevés, rangement des tâches, format binaire.
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "diag_record.h"
+#include <string.h>
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: find_task
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Tâche de numéro "number" dans un relevé
+
+   --------------------------------------------------------------------------
+   Return value:
+     Tâche trouvée, NULL si elle n’existait pas encore
+
+-- -------------------------------------------------------------------------- */
+static const diag_task_t* find_task(const diag_sample_t* s, uint32_t number) {
+    for (uint8_t i = 0; i < s->task_count; i++) {
+        if (s->tasks[i].number == number) return &s->tasks[i];
+    }
+    return NULL;
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: diag_sample_finish
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Charges de la période écoulée depuis le relevé précédent
+
+   --------------------------------------------------------------------------
+   Description:
+   Les compteurs de temps d’exécution sont sur 32 bits (µs) : les
+   différences non signées restent justes tant que la période est plus
+   courte qu’un tour du compteur (71 minutes). Une tâche créée pendant
+   la période est comptée depuis sa création. La charge d’un cœur est le
+   complément de celle de sa tâche IDLE.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     prev      : relevé précédent (NULL : aucun)
+     cur       : relevé à compléter
+     period_ms : temps écoulé depuis prev
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void diag_sample_finish(const diag_sample_t* prev, diag_sample_t* cur, uint32_t period_ms) {
+    uint32_t total = prev ? cur->total_runtime - prev->total_runtime : 0;
+
+    cur->period_ms = total ? period_ms : 0;
+    for (uint8_t c = 0; c < DIAG_CORES; c++) cur->core_load_permille[c] = 0;
+
+    for (uint8_t i = 0; i < cur->task_count; i++) {
+        diag_task_t* t = &cur->tasks[i];
+        uint32_t ran = 0;
+
+        if (total) {
+            const diag_task_t* p = find_task(prev, t->number);
+            ran = p ? t->runtime - p->runtime : t->runtime;
+            if (ran > total) ran = total;
+        }
+        t->load_permille = total ? (uint16_t)(((uint64_t)ran * 1000u) / total) : 0;
+
+        if (total && (t->flags & DIAG_TASK_IDLE) && t->core < DIAG_CORES) {
+            cur->core_load_permille[t->core] = 1000 - t->load_permille;
+        }
+    }
+
+    // Marge de pile croissante (tri par insertion, stable)
+    for (uint8_t i = 1; i < cur->task_count; i++) {
+        diag_task_t t = cur->tasks[i];
+        uint8_t j = i;
+        while (j > 0 && cur->tasks[j - 1].stack_free > t.stack_free) {
+            cur->tasks[j] = cur->tasks[j - 1];
+            j--;
+        }
+        cur->tasks[j] = t;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: diag_record_pack
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Relevé au format binaire
+
+   --------------------------------------------------------------------------
+   Parameters:
+     s   : relevé
+     buf : destination
+     cap : place disponible (DIAG_RECORD_MAX_LEN : toutes les tâches)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Octets écrits (0 : en-tête trop grand pour cap)
+
+-- -------------------------------------------------------------------------- */
+size_t diag_record_pack(const diag_sample_t* s, uint8_t* buf, size_t cap) {
+    diag_record_header_t h;
+    size_t count;
+
+    if (cap < sizeof(h)) return 0;
+    count = (cap - sizeof(h)) / sizeof(diag_record_task_t);
+    if (count > s->task_count) count = s->task_count;
+
+    memset(&h, 0, sizeof(h));
+    h.version = DIAG_RECORD_VERSION;
+    h.task_total = s->task_total;
+    h.task_count = (uint8_t)count;
+    h.uptime_s = s->uptime_s;
+    h.period_ms = s->period_ms;
+    h.free_heap = s->free_heap;
+    h.min_free_heap = s->min_free_heap;
+    h.largest_block = s->largest_block;
+    for (uint8_t c = 0; c < DIAG_CORES; c++) h.core_load_permille[c] = s->core_load_permille[c];
+    memcpy(buf, &h, sizeof(h));
+
+    for (size_t i = 0; i < count; i++) {
+        const diag_task_t* t = &s->tasks[i];
+        diag_record_task_t r;
+
+        memset(&r, 0, sizeof(r));
+        strncpy(r.name, t->name, DIAG_NAME_LEN);
+        r.stack_free = t->stack_free;
+        r.load_permille = t->load_permille;
+        r.priority = t->priority;
+        r.state = t->state;
+        r.core = t->core;
+        r.flags = t->flags;
+        memcpy(buf + sizeof(h) + i * sizeof(r), &r, sizeof(r));
+    }
+    return sizeof(h) + count * sizeof(diag_record_task_t);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: diag_record_unpack
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Relevé binaire vers diag_sample_t
+
+   --------------------------------------------------------------------------
+   Return value:
+     false si la version ou la longueur ne correspondent pas
+
+-- -------------------------------------------------------------------------- */
+bool diag_record_unpack(const uint8_t* buf, size_t len, diag_sample_t* out) {
+    diag_record_header_t h;
+
+    if (len < sizeof(h)) return false;
+    memcpy(&h, buf, sizeof(h));
+    if (h.version != DIAG_RECORD_VERSION || h.task_count > DIAG_MAX_TASKS ||
+        len < sizeof(h) + h.task_count * sizeof(diag_record_task_t)) {
+        return false;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->task_total = h.task_total;
+    out->task_count = h.task_count;
+    out->uptime_s = h.uptime_s;
+    out->period_ms = h.period_ms;
+    out->free_heap = h.free_heap;
+    out->min_free_heap = h.min_free_heap;
+    out->largest_block = h.largest_block;
+    for (uint8_t c = 0; c < DIAG_CORES; c++) out->core_load_permille[c] = h.core_load_permille[c];
+
+    for (uint8_t i = 0; i < h.task_count; i++) {
+        diag_task_t* t = &out->tasks[i];
+        diag_record_task_t r;
+
+        memcpy(&r, buf + sizeof(h) + i * sizeof(r), sizeof(r));
+        memcpy(t->name, r.name, DIAG_NAME_LEN);
+        t->name[DIAG_NAME_LEN] = '\0';
+        t->stack_free = r.stack_free;
+        t->load_permille = r.load_permille;
+        t->priority = r.priority;
+        t->state = r.state;
+        t->core = r.core;
+        t->flags = r.flags;
+    }
+    return true;
+}
@@ -0,0 +1,142 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: diag_record.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Relevé de diagnostic de la carte (tâches et tas) et son format binaire,
+   lu en BLE par l’outil diag_minuteur.py :
+   - Par tâche : marge de pile minimale depuis le démarrage (high-water
+     mark, en octets), charge CPU sur la dernière période, priorité, état
+   - Tas : libre, minimum libre depuis le démarrage, plus grand bloc libre
+     (fragmentation = 1 - plus grand bloc / libre)
+   - Charge de chaque cœur, déduite du temps passé dans sa tâche IDLE
+   Les tâches sont rangées par marge de pile croissante : si le relevé
+   est tronqué (notification limitée par le MTU), ce sont les tâches les
+   plus à l’aise qui manquent.
+   Aucune dépendance ESP-IDF : module testé sur PC.
+
+   Format (little-endian, version DIAG_RECORD_VERSION) :
+     diag_record_header_t, puis task_count × diag_record_task_t
+
+-- ========================================================================== */
+
+#ifndef DIAG_RECORD_H
+#define DIAG_RECORD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define DIAG_RECORD_VERSION     1
+#define DIAG_MAX_TASKS          32          // Tâches relevées au plus
+#define DIAG_NAME_LEN           12          // Nom de tâche tronqué, sans '\0' final
+#define DIAG_CORES              2
+#define DIAG_CORE_ANY           0xFF        // Tâche non épinglée à un cœur
+
+#define DIAG_TASK_IDLE          0x01        // Tâche IDLE d’un cœur (flags)
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: diag_task_t
+   Une tâche au moment du relevé ; runtime est le compteur de temps
+   d’exécution FreeRTOS (µs, 32 bits, repasse par zéro)
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    char name[DIAG_NAME_LEN + 1];
+    uint32_t number;                   // Numéro unique de la tâche (xTaskNumber)
+    uint32_t runtime;
+    uint16_t stack_free;               // Marge de pile minimale (octets)
+    uint16_t load_permille;            // Charge sur la période (‰ d’un cœur)
+    uint8_t priority;
+    uint8_t state;                     // eTaskState
+    uint8_t core;                      // 0, 1 ou DIAG_CORE_ANY
+    uint8_t flags;                     // DIAG_TASK_*
+} diag_task_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: diag_sample_t
+   Relevé complet
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint32_t uptime_s;
+    uint32_t total_runtime;            // Compteur de temps total au relevé (µs)
+    uint32_t period_ms;                // Durée couverte par les charges (0 : premier relevé)
+    uint32_t free_heap;
+    uint32_t min_free_heap;
+    uint32_t largest_block;
+    uint16_t core_load_permille[DIAG_CORES];
+    uint8_t task_total;                // Tâches existantes (peut dépasser task_count)
+    uint8_t task_count;
+    diag_task_t tasks[DIAG_MAX_TASKS];
+} diag_sample_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: diag_record_header_t / diag_record_task_t
+   Format binaire transmis en BLE
+-- -------------------------------------------------------------------------- */
+typedef struct __attribute__((packed)) {
+    uint8_t version;
+    uint8_t task_total;
+    uint8_t task_count;                // Tâches présentes dans ce relevé
+    uint8_t reserved;
+    uint32_t uptime_s;
+    uint32_t period_ms;
+    uint32_t free_heap;
+    uint32_t min_free_heap;
+    uint32_t largest_block;
+    uint16_t core_load_permille[DIAG_CORES];
+} diag_record_header_t;
+
+typedef struct __attribute__((packed)) {
+    char name[DIAG_NAME_LEN];          // Complété par des '\0'
+    uint16_t stack_free;
+    uint16_t load_permille;
+    uint8_t priority;
+    uint8_t state;
+    uint8_t core;
+    uint8_t flags;
+} diag_record_task_t;
+
+_Static_assert(sizeof(diag_record_header_t) == 28, "taille d'en-tete");
+_Static_assert(sizeof(diag_record_task_t) == 20, "taille d'une tache");
+
+#define DIAG_RECORD_MAX_LEN     (sizeof(diag_record_header_t) + DIAG_MAX_TASKS * sizeof(diag_record_task_t))
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: diag_sample_finish
+   Calcule les charges de "cur" par rapport au relevé précédent "prev"
+   (NULL : premier relevé, charges nulles) et range les tâches par marge
+   de pile croissante
+-- -------------------------------------------------------------------------- */
+void diag_sample_finish(const diag_sample_t* prev, diag_sample_t* cur, uint32_t period_ms);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: diag_record_pack
+   Écrit le relevé dans buf, avec autant de tâches que "cap" le permet
+   Retour : octets écrits, 0 si l’en-tête ne tient pas
+-- -------------------------------------------------------------------------- */
+size_t diag_record_pack(const diag_sample_t* s, uint8_t* buf, size_t cap);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: diag_record_unpack
+   Relit un relevé (version et longueur vérifiées) ; runtime et number
+   ne sont pas transmis et valent 0
+-- -------------------------------------------------------------------------- */
+bool diag_record_unpack(const uint8_t* buf, size_t len, diag_sample_t* out);
+
+#endif // DIAG_RECORD_H
@@ -0,0 +1,243 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: diag_service.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Relevés de diagnostic (voir diag_service.h). Deux relevés alternent en
+   mémoire statique : le précédent sert au calcul des charges du suivant.
+   Aucune allocation, la tâche ne fait que dormir entre deux relevés
+   (réveil par notification sur demande d’un client BLE).
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "diag_service.h"
+#include "diag_record.h"
+#include "ble_spp_server.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_heap_caps.h"
+#include "session_clock.h"
+#include "esp_log.h"
+#include "sdkconfig.h"
+#include <string.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define DIAG_PERIOD_MS          10000       // Période des relevés (et des charges)
+#define DIAG_STACK_WARN_BYTES   256         // Marge de pile jugée dangereuse
+#define DIAG_TASK_STACK         3072
+#define DIAG_TASK_PRIO          1           // Sous toutes les tâches de l’application
+
+static const char* TAG = "DIAG";
+
+/**-------------------------------------------------------------------------- --
+   Static variables
+-- -------------------------------------------------------------------------- */
+static TaskHandle_t diag_task_handle = NULL;
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+static TaskStatus_t status[DIAG_MAX_TASKS];          // Sortie de uxTaskGetSystemState
+static diag_sample_t samples[2];                     // Relevé précédent / courant
+static uint8_t value[DIAG_RECORD_MAX_LEN];           // Relevé complet (lecture BLE)
+static uint8_t ntf[DIAG_RECORD_MAX_LEN];             // Relevé tronqué au MTU (notification)
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: take_sample
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Relève l’état des tâches et du tas
+
+   --------------------------------------------------------------------------
+   Description:
+   uxTaskGetSystemState ne remplit rien si le tableau est trop petit :
+   au-delà de DIAG_MAX_TASKS tâches, seul le tas est relevé. Sur ESP-IDF
+   la marge de pile est comptée en octets.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     s : relevé à remplir (charges calculées ensuite)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void take_sample(diag_sample_t* s) {
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t count = uxTaskGetSystemState(status, DIAG_MAX_TASKS, &total);
+
+    s->uptime_s = (uint32_t)(session_clock_now_us() / 1000000);
+    s->total_runtime = (uint32_t)total;
+    s->task_total = (uint8_t)uxTaskGetNumberOfTasks();
+    s->task_count = (uint8_t)count;
+    if (count == 0) {
+        ESP_LOGW(TAG, "%u taches : au-dela de DIAG_MAX_TASKS", (unsigned)s->task_total);
+    }
+
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t* st = &status[i];
+        diag_task_t* t = &s->tasks[i];
+        BaseType_t core = xTaskGetCoreID(st->xHandle);
+
+        strncpy(t->name, st->pcTaskName, DIAG_NAME_LEN);
+        t->name[DIAG_NAME_LEN] = '\0';
+        t->number = st->xTaskNumber;
+        t->runtime = (uint32_t)st->ulRunTimeCounter;
+        t->stack_free = st->usStackHighWaterMark > UINT16_MAX ? UINT16_MAX : (uint16_t)st->usStackHighWaterMark;
+        t->priority = (uint8_t)st->uxCurrentPriority;
+        t->state = (uint8_t)st->eCurrentState;
+        t->core = (core >= 0 && core < DIAG_CORES) ? (uint8_t)core : DIAG_CORE_ANY;
+        t->flags = 0;
+        for (BaseType_t c = 0; c < portNUM_PROCESSORS && c < DIAG_CORES; c++) {
+            if (st->xHandle == xTaskGetIdleTaskHandleForCore(c)) {
+                t->flags |= DIAG_TASK_IDLE;
+                t->core = (uint8_t)c;
+            }
+        }
+    }
+
+    s->free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    s->min_free_heap = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    s->largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: warn_low_stacks
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Avertit des tâches dont la marge de pile est sous le seuil
+
+   --------------------------------------------------------------------------
+   Description:
+   La marge relevée est un minimum depuis la création de la tâche : elle
+   ne fait que baisser. Une tâche n’est signalée qu’au premier relevé ou
+   quand sa marge a encore diminué, pas à chaque période.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void warn_low_stacks(const diag_sample_t* prev, const diag_sample_t* cur) {
+    for (uint8_t i = 0; i < cur->task_count && cur->tasks[i].stack_free < DIAG_STACK_WARN_BYTES; i++) {
+        const diag_task_t* t = &cur->tasks[i];
+        bool shrunk = true;
+
+        for (uint8_t j = 0; prev && j < prev->task_count; j++) {
+            if (prev->tasks[j].number == t->number) {
+                shrunk = t->stack_free < prev->tasks[j].stack_free;
+                break;
+            }
+        }
+        if (shrunk) {
+            ESP_LOGW(TAG, "Pile presque pleine : %s, %u octets libres", t->name, (unsigned)t->stack_free);
+        }
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: diag_task
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Relevé périodique et publication BLE
+
+   --------------------------------------------------------------------------
+   Description:
+   Le relevé complet devient la valeur lue de la caractéristique ; la
+   notification n’emporte que les tâches qui tiennent dans le MTU (les
+   plus justes en pile d’abord). Un relevé demandé entre deux périodes
+   couvre une période plus courte, indiquée dans period_ms.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun (boucle infinie)
+
+-- -------------------------------------------------------------------------- */
+static void diag_task(void* arg) {
+    const diag_sample_t* prev = NULL;
+    uint8_t idx = 0;
+    int64_t prev_us = 0;
+
+    while (1) {
+        diag_sample_t* cur = &samples[idx];
+        int64_t now_us = session_clock_now_us();
+
+        take_sample(cur);
+        diag_sample_finish(prev, cur, (uint32_t)((now_us - prev_us) / 1000));
+        warn_low_stacks(prev, cur);
+
+        ESP_LOGD(TAG, "Tas %lu libres (min %lu, bloc %lu), CPU %u/%u permil",
+                 (unsigned long)cur->free_heap, (unsigned long)cur->min_free_heap,
+                 (unsigned long)cur->largest_block,
+                 (unsigned)cur->core_load_permille[0], (unsigned)cur->core_load_permille[1]);
+
+        size_t len = diag_record_pack(cur, value, SPP_DIAG_MAX_LEN);
+        size_t ntf_len = diag_record_pack(cur, ntf, ble_spp_get_mtu() - 3);
+        ble_spp_diag_publish(value, (uint16_t)len, ntf, (uint16_t)ntf_len);
+
+        prev = cur;
+        prev_us = now_us;
+        idx ^= 1;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DIAG_PERIOD_MS));
+    }
+}
+#endif
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: diag_service_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Démarre les relevés de diagnostic
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void diag_service_init(void) {
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    xTaskCreate(diag_task, "diag_task", DIAG_TASK_STACK, NULL, DIAG_TASK_PRIO, &diag_task_handle);
+#else
+    ESP_LOGW(TAG, "Diagnostic desactive (CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)");
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: diag_service_request
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Réveille la tâche de diagnostic pour un relevé immédiat
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void diag_service_request(void) {
+    if (diag_task_handle) xTaskNotifyGive(diag_task_handle);
+}
@@ -0,0 +1,41 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: diag_service.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Diagnostic de la carte en service :
+   - Relevé périodique (DIAG_PERIOD_MS) des tâches FreeRTOS (temps
+     d’exécution, marge de pile) et du tas, au format diag_record
+   - Relevé publié sur la caractéristique BLE de diagnostic (0xABF6) :
+     lecture du relevé complet, notification du relevé tronqué au MTU
+   - Avertissement dans les logs quand la marge de pile d’une tâche passe
+     sous DIAG_STACK_WARN_BYTES
+   Demande CONFIG_FREERTOS_USE_TRACE_FACILITY et
+   CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS (sdkconfig.defaults).
+
+-- ========================================================================== */
+
+#ifndef DIAG_SERVICE_H
+#define DIAG_SERVICE_H
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: diag_service_init
+   Lance la tâche de diagnostic (après ble_server_init)
+-- -------------------------------------------------------------------------- */
+void diag_service_init(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: diag_service_request
+   Demande un relevé immédiat (abonnement d’un client aux notifications)
+-- -------------------------------------------------------------------------- */
+void diag_service_request(void);
+
+#endif // DIAG_SERVICE_H
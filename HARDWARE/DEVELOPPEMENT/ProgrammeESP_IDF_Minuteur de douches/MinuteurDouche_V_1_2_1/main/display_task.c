@@ -0,0 +1,339 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: display_task.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Tâche FreeRTOS propriétaire des écrans OLED :
+   - Les producteurs (minuteur, bouton, BLE) dessinent dans les tampons
+     arrière du pilote SSD1306 sous un mutex
+   - Sur notification, la tâche valide les images (copie mémoire sous le
+     mutex) puis les envoie en I2C sans le verrou
+   - Les producteurs ne bloquent donc jamais sur le bus I2C et une image
+     en cours de composition n’est jamais envoyée à moitié
+   - Avec plusieurs panneaux, les envois sont entrelacés tranche par
+     tranche : le redessin complet d’un panneau ne retarde pas le compte à
+     rebours de l’autre
+   - Sans nouvelle image pendant DISPLAY_BLANK_MS, les panneaux sont mis
+     en veille ; l’image suivante les rallume une fois envoyée
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "display_task.h"
+#include "ssd1306.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "session_clock.h"
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define DISPLAY_TASK_STACK   3072
+#define DISPLAY_TASK_PRIO    4       // Sous les tâches bouton (5) et minuteur (6)
+#define DISPLAY_BLANK_MS     60000   // Inactivité avant mise en veille des écrans
+#define DISPLAY_CONTRAST     0xFF    // Panneaux rattachés : comme oled_init()
+
+static const char* TAG = "DISPLAY";
+
+/**-------------------------------------------------------------------------- --
+   Static variables
+-- -------------------------------------------------------------------------- */
+static SemaphoreHandle_t draw_lock = NULL;        // Protège les tampons arrière
+static TaskHandle_t display_task_handle = NULL;
+
+static ssd1306_t* panels[SSD1306_MAX_PANELS];     // Panneaux servis
+static int64_t commit_us[SSD1306_MAX_PANELS];     // Validation de l’image en cours
+static volatile size_t panel_count = 0;
+
+static display_stats_t stats;
+static portMUX_TYPE stats_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Rattachement d’un panneau : l’initialisation passe par le bus I2C, dont
+   la tâche d’affichage est seule utilisatrice (tampon d’émission commun) */
+static SemaphoreHandle_t attach_lock = NULL;     // Un rattachement à la fois
+static SemaphoreHandle_t attach_done = NULL;     // Donné par la tâche, panneau servi
+static ssd1306_t* volatile attach_req = NULL;
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: frame_sent
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Met à jour les statistiques quand un panneau a fini d’envoyer son image
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+static void frame_sent(size_t i) {
+    int64_t elapsed = session_clock_now_us() - commit_us[i];
+    uint32_t bytes;
+    ssd1306_dev_bus_last_call(panels[i], NULL, &bytes);
+
+    portENTER_CRITICAL(&stats_lock);
+    stats.frames++;
+    stats.last_send_us = elapsed;
+    if (elapsed > stats.max_send_us) stats.max_send_us = elapsed;
+    stats.last_bytes = bytes;
+    portEXIT_CRITICAL(&stats_lock);
+
+    ESP_LOGD(TAG, "Panneau %u : %lu octets en %lld us", (unsigned)i,
+             (unsigned long)bytes, (long long)elapsed);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: set_power
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Allume ou met en veille tous les panneaux servis
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+static void set_power(bool on) {
+    size_t count = panel_count;
+    for (size_t i = 0; i < count; i++) {
+        ssd1306_dev_power(panels[i], on);
+    }
+    ESP_LOGD(TAG, "Ecrans %s", on ? "allumes" : "en veille");
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: attach_panel
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Initialise le panneau demandé par display_attach() et l’ajoute à la
+   liste servie
+
+   --------------------------------------------------------------------------
+   Description:
+   Appelée par la tâche d’affichage seule. La liste ne fait que croître :
+   la tâche lit panel_count puis les entrées déjà publiées sous le mutex.
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+static void attach_panel(void) {
+    ssd1306_t* dev = attach_req;
+    bool known = false;
+
+    for (size_t i = 0; i < panel_count; i++) {
+        if (panels[i] == dev) known = true;
+    }
+    if (!known && panel_count < SSD1306_MAX_PANELS) {
+        // Envoi direct : la tâche ne sert pas encore ce panneau
+        ssd1306_dev_init(dev);
+        ssd1306_dev_contrast(dev, DISPLAY_CONTRAST);
+        xSemaphoreTake(draw_lock, portMAX_DELAY);
+        panels[panel_count] = dev;
+        panel_count = panel_count + 1;
+        xSemaphoreGive(draw_lock);
+    } else if (!known) {
+        ESP_LOGE(TAG, "Panneau refuse (max %d)", SSD1306_MAX_PANELS);
+    }
+    attach_req = NULL;
+    xSemaphoreGive(attach_done);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: display_task
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Envoie aux écrans chaque image validée par display_commit()
+
+   --------------------------------------------------------------------------
+   Description:
+   - Attend une notification (les commits reçus pendant un envoi sont
+     fusionnés en une seule notification) ; un panneau à rattacher est
+     initialisé en début de tour
+   - À chaque tour : valide sous le mutex l’image des panneaux qui ont
+     fini leur envoi précédent, puis envoie une tranche par panneau en
+     attente, mutex relâché (ssd1306_send_round)
+   - Tourne tant qu’un envoi est en cours ou qu’un commit est arrivé
+     pendant le tour : une nouvelle image d’un panneau part dès le tour
+     suivant, sans attendre la fin d’un redessin d’un autre panneau
+   - Attente limitée à DISPLAY_BLANK_MS tant que les écrans sont allumés :
+     à l’échéance, ils sont mis en veille et la tâche reste bloquée
+     jusqu’à la prochaine image (aucun réveil périodique du CPU)
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun (boucle infinie)
+
+-- -------------------------------------------------------------------------- */
+static void display_task(void *arg) {
+    bool busy[SSD1306_MAX_PANELS] = { false };
+    bool powered = true;
+
+    while (1) {
+        TickType_t wait = powered ? pdMS_TO_TICKS(DISPLAY_BLANK_MS) : portMAX_DELAY;
+        if (ulTaskNotifyTake(pdTRUE, wait) == 0) {
+            set_power(false);
+            powered = false;
+            continue;
+        }
+
+        bool pending;
+        do {
+            if (attach_req) attach_panel();
+            size_t count = panel_count;
+
+            xSemaphoreTake(draw_lock, portMAX_DELAY);
+            for (size_t i = 0; i < count; i++) {
+                if (!busy[i] && ssd1306_dev_commit(panels[i])) {
+                    busy[i] = true;
+                    commit_us[i] = session_clock_now_us();
+                }
+            }
+            xSemaphoreGive(draw_lock);
+
+            pending = ssd1306_send_round(panels, count);
+
+            for (size_t i = 0; i < count; i++) {
+                if (busy[i] && !ssd1306_dev_busy(panels[i])) {
+                    busy[i] = false;
+                    frame_sent(i);
+                }
+            }
+        } while (pending || ulTaskNotifyTake(pdTRUE, 0));
+
+        // Réveil après l’envoi : la nouvelle image apparaît directement
+        if (!powered) {
+            set_power(true);
+            powered = true;
+        }
+    }
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: display_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Crée le mutex des tampons arrière et lance la tâche d’affichage sur le
+   panneau par défaut
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void display_init(void) {
+    draw_lock = xSemaphoreCreateMutex();
+    attach_lock = xSemaphoreCreateMutex();
+    attach_done = xSemaphoreCreateBinary();
+    panels[0] = ssd1306_default();
+    panel_count = 1;
+    xTaskCreate(display_task, "display_task", DISPLAY_TASK_STACK, NULL, DISPLAY_TASK_PRIO, &display_task_handle);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: display_attach
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Fait initialiser et servir un panneau par la tâche d’affichage
+
+   --------------------------------------------------------------------------
+   Description:
+   Le pilote I2C n’est appelé que depuis une tâche à la fois : la
+   tâche appelante attend que la tâche d’affichage ait initialisé le
+   panneau (voir attach_panel).
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void display_attach(ssd1306_t *dev) {
+    if (dev == NULL) return;
+
+    xSemaphoreTake(attach_lock, portMAX_DELAY);
+    attach_req = dev;
+    xTaskNotifyGive(display_task_handle);
+    xSemaphoreTake(attach_done, portMAX_DELAY);
+    xSemaphoreGive(attach_lock);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: display_begin
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Réserve les tampons arrière pour la tâche appelante
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void display_begin(void) {
+    xSemaphoreTake(draw_lock, portMAX_DELAY);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: display_commit
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Libère les tampons arrière et réveille la tâche d’affichage
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void display_commit(void) {
+    xSemaphoreGive(draw_lock);
+    xTaskNotifyGive(display_task_handle);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: display_get_stats
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Lecture cohérente des statistiques d’envoi
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void display_get_stats(display_stats_t *out) {
+    portENTER_CRITICAL(&stats_lock);
+    *out = stats;
+    portEXIT_CRITICAL(&stats_lock);
+}
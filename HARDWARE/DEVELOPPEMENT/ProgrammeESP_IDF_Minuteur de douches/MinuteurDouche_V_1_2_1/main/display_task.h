@@ -0,0 +1,88 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: display_task.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Interface de la tâche d’affichage, seule propriétaire du bus I2C des
+   écrans OLED :
+   - Les modules dessinent dans les tampons arrière entre display_begin()
+     et display_commit()
+   - La tâche d’affichage valide les images et les envoie de façon
+     asynchrone, en entrelaçant les panneaux
+   - Statistiques des envois (durée, trafic I2C)
+   - Mise en veille des écrans après une minute sans nouvelle image
+
+-- ========================================================================== */
+
+#ifndef DISPLAY_TASK_H
+#define DISPLAY_TASK_H
+
+#include <stdint.h>
+#include "ssd1306.h"
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: display_stats_t
+   Statistiques cumulées de la tâche d’affichage
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint32_t frames;           // Nombre d’images envoyées (tous panneaux)
+    int64_t  last_send_us;     // Validation -> fin d’envoi, dernière image
+    int64_t  max_send_us;      // Pire durée observée
+    uint32_t last_bytes;       // Octets I2C du dernier envoi
+} display_stats_t;
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions publiques
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: display_init
+   Crée le verrou des tampons arrière et lance la tâche d’affichage,
+   qui sert le panneau par défaut (ssd1306_default()).
+   À appeler dans app_main après oled_init(), avant tout display_begin()
+-- -------------------------------------------------------------------------- */
+void display_init(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: display_attach
+   Fait initialiser par la tâche d’affichage (ssd1306_dev_init, contraste
+   maximal comme oled_init()) un panneau ouvert par ssd1306_open, puis
+   l’ajoute à ceux qu’elle envoie ; retourne une fois le panneau servi.
+   Sans effet si le panneau est déjà servi
+-- -------------------------------------------------------------------------- */
+void display_attach(ssd1306_t *dev);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: display_begin
+   Réserve les tampons arrière pour composer une image (fonctions oled_*,
+   ssd1306_draw_* / ssd1306_display_text / ssd1306_clear_* et leurs
+   variantes ssd1306_dev_* sur un panneau attaché).
+   Le verrou ne protège que la mémoire : il n’est jamais tenu pendant un
+   transfert I2C. Ne pas imbriquer deux display_begin()
+-- -------------------------------------------------------------------------- */
+void display_begin(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: display_commit
+   Libère les tampons arrière et demande l’envoi des images (non bloquant).
+   Plusieurs commits rapprochés sont regroupés en un seul envoi ; rallume
+   les écrans s’ils étaient en veille
+-- -------------------------------------------------------------------------- */
+void display_commit(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: display_get_stats
+   Copie les statistiques de la tâche d’affichage
+-- -------------------------------------------------------------------------- */
+void display_get_stats(display_stats_t *out);
+
+#endif // DISPLAY_TASK_H
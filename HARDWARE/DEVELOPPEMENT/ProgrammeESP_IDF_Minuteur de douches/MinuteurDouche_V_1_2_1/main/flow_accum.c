@@ -0,0 +1,116 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: flow_accum.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Cumul des impulsions du débitmètre (voir flow_accum.h). Calculs en
+   entiers : volume et débit en mL, mL/min.
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "flow_accum.h"
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_accum_start
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Remet le cumul à zéro au départ d’une douche
+
+   --------------------------------------------------------------------------
+   Parameters:
+     f                : cumul
+     pulses_per_litre : constante du débitmètre (stall_config)
+     count            : lecture du compteur au départ
+     now_us           : instant de la lecture
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void flow_accum_start(flow_accum_t* f, uint16_t pulses_per_litre, int32_t count, int64_t now_us) {
+    f->pulses_per_litre = pulses_per_litre ? pulses_per_litre : FLOW_PPL_YF_S201;
+    f->last_count = count;
+    f->pulses = 0;
+    f->window_pulses = 0;
+    f->window_us = now_us;
+    f->peak_ml_min = 0;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_accum_sample
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Ajoute les impulsions comptées depuis la lecture précédente
+
+   --------------------------------------------------------------------------
+   Description:
+   Le compteur ne fait que monter, de 0 à FLOW_PCNT_LIMIT - 1 : une
+   lecture inférieure à la précédente signifie qu’il est repassé par 0.
+   Le débit de la fenêtre n’est calculé qu’une fois la fenêtre assez
+   longue ; ses impulsions sont comptées dans le volume dans tous les cas.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     f      : cumul
+     count  : lecture du compteur
+     now_us : instant de la lecture
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void flow_accum_sample(flow_accum_t* f, int32_t count, int64_t now_us) {
+    int32_t delta = count - f->last_count;
+    if (delta < 0) delta += FLOW_PCNT_LIMIT;
+
+    f->last_count = count;
+    f->pulses += (uint32_t)delta;
+    f->window_pulses += (uint32_t)delta;
+
+    int64_t window = now_us - f->window_us;
+    if (window >= FLOW_RATE_WINDOW_US) {
+        // mL/min = impulsions × 1000 / (impulsions par litre) × 60 s / fenêtre
+        uint64_t rate = ((uint64_t)f->window_pulses * 1000u * 60000000u)
+                        / ((uint64_t)f->pulses_per_litre * (uint64_t)window);
+        if (rate > f->peak_ml_min) f->peak_ml_min = (uint32_t)rate;
+        f->window_pulses = 0;
+        f->window_us = now_us;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_accum_result
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Mesure de la douche depuis son départ
+
+   --------------------------------------------------------------------------
+   Return value:
+     Volume (mL) et débit de pointe (mL/min)
+
+-- -------------------------------------------------------------------------- */
+flow_result_t flow_accum_result(const flow_accum_t* f) {
+    flow_result_t r = {
+        .volume_ml = (uint32_t)(((uint64_t)f->pulses * 1000u) / f->pulses_per_litre),
+        .peak_ml_min = f->peak_ml_min,
+    };
+    return r;
+}
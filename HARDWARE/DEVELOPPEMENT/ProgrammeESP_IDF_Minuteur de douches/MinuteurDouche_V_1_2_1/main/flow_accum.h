@@ -0,0 +1,86 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: flow_accum.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Volume et débit d’une douche à partir du compteur d’impulsions d’un
+   débitmètre à effet Hall (compteur PCNT de l’ESP32) :
+   - Le compteur matériel compte seul les impulsions ; il est lu une fois
+     par seconde (tick du minuteur), au départ et à l’arrêt de la douche
+   - Le compteur repasse à 0 en atteignant FLOW_PCNT_LIMIT : les écarts
+     entre deux lectures sont comptés modulo cette limite
+   - Débit de pointe : plus fort débit moyen sur une fenêtre d’au moins
+     FLOW_RATE_WINDOW_US (une lecture rapprochée, à l’arrêt par exemple,
+     est cumulée à la fenêtre suivante au lieu de donner un pic faux)
+   Aucune dépendance ESP-IDF : module testé sur PC (source d’impulsions
+   simulée).
+
+-- ========================================================================== */
+
+#ifndef FLOW_ACCUM_H
+#define FLOW_ACCUM_H
+
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define FLOW_PCNT_LIMIT         32767       // Limite haute du compteur (remise à 0)
+#define FLOW_RATE_WINDOW_US     500000      // Fenêtre minimale du débit de pointe
+#define FLOW_PPL_YF_S201        450         // Impulsions par litre (F = 7,5 × Q L/min)
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: flow_result_t
+   Mesure d’une douche terminée
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint32_t volume_ml;
+    uint32_t peak_ml_min;              // Débit de pointe (mL/min)
+} flow_result_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: flow_accum_t
+   Cumul d’une douche en cours
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint16_t pulses_per_litre;
+    int32_t last_count;                // Dernière lecture du compteur
+    uint32_t pulses;                   // Impulsions depuis le départ
+    uint32_t window_pulses;            // Impulsions de la fenêtre de débit en cours
+    int64_t window_us;                 // Début de cette fenêtre
+    uint32_t peak_ml_min;
+} flow_accum_t;
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_accum_start
+   Départ d’une douche : "count" est la lecture du compteur à cet instant
+-- -------------------------------------------------------------------------- */
+void flow_accum_start(flow_accum_t* f, uint16_t pulses_per_litre, int32_t count, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_accum_sample
+   Lecture du compteur (moins d’un tour de FLOW_PCNT_LIMIT impulsions
+   depuis la précédente)
+-- -------------------------------------------------------------------------- */
+void flow_accum_sample(flow_accum_t* f, int32_t count, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_accum_result
+   Volume et débit de pointe depuis le départ
+-- -------------------------------------------------------------------------- */
+flow_result_t flow_accum_result(const flow_accum_t* f);
+
+#endif // FLOW_ACCUM_H
@@ -0,0 +1,199 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: flow_meter.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Débitmètres sur le périphérique PCNT (voir flow_meter.h).
+
+   Le compteur matériel repasse à 0 en atteignant FLOW_PCNT_LIMIT ; à
+   150 impulsions/s au plus (20 L/min), il n’en fait jamais un tour entre
+   deux lectures. Le filtre anti-parasites du PCNT demande un verrou de
+   gestion d’énergie (APB maximal) : l’unité n’est activée que pendant
+   une douche, le light sleep reste permis entre deux douches.
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "flow_meter.h"
+#include "stall_config.h"
+#include "driver/pulse_cnt.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define FLOW_GLITCH_NS      10000       // Impulsions plus courtes ignorées (rebonds, parasites)
+
+static const char* TAG = "FLOW";
+
+/**-------------------------------------------------------------------------- --
+   Static variables
+-- -------------------------------------------------------------------------- */
+static pcnt_unit_handle_t unit[STALL_MAX];           // NULL : pas de débitmètre
+static flow_accum_t acc[STALL_MAX];
+static bool running[STALL_MAX];
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: read_count
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Lecture du compteur d’une cabine
+
+   --------------------------------------------------------------------------
+   Return value:
+     Valeur du compteur (0 .. FLOW_PCNT_LIMIT - 1)
+
+-- -------------------------------------------------------------------------- */
+static int32_t read_count(uint8_t stall) {
+    int count = 0;
+    pcnt_unit_get_count(unit[stall], &count);
+    return count;
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_meter_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Prépare une unité PCNT par débitmètre
+
+   --------------------------------------------------------------------------
+   Description:
+   Comptage sur front montant seulement, entrée avec pull-up interne. Une
+   cabine dont l’unité ne peut être créée fonctionne sans mesure.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void flow_meter_init(void) {
+    for (uint8_t i = 0; i < stall_count; i++) {
+        gpio_num_t gpio = stall_table[i].flow_gpio;
+        if (gpio == GPIO_NUM_NC) continue;
+
+        pcnt_unit_config_t unit_cfg = {
+            .low_limit = -1,
+            .high_limit = FLOW_PCNT_LIMIT,
+        };
+        pcnt_glitch_filter_config_t filter_cfg = {
+            .max_glitch_ns = FLOW_GLITCH_NS,
+        };
+        pcnt_chan_config_t chan_cfg = {
+            .edge_gpio_num = gpio,
+            .level_gpio_num = -1,
+        };
+        pcnt_channel_handle_t chan = NULL;
+
+        if (pcnt_new_unit(&unit_cfg, &unit[i]) != ESP_OK) {
+            ESP_LOGE(TAG, "Cabine %u : plus d'unite PCNT libre", (unsigned)i);
+            unit[i] = NULL;
+            continue;
+        }
+        if (pcnt_unit_set_glitch_filter(unit[i], &filter_cfg) != ESP_OK ||
+            pcnt_new_channel(unit[i], &chan_cfg, &chan) != ESP_OK ||
+            pcnt_channel_set_edge_action(chan, PCNT_CHANNEL_EDGE_ACTION_INCREASE,
+                                         PCNT_CHANNEL_EDGE_ACTION_HOLD) != ESP_OK) {
+            ESP_LOGE(TAG, "Cabine %u : configuration PCNT impossible (GPIO %d)", (unsigned)i, gpio);
+            if (chan) pcnt_del_channel(chan);
+            pcnt_del_unit(unit[i]);
+            unit[i] = NULL;
+            continue;
+        }
+        gpio_pullup_en(gpio);
+        ESP_LOGI(TAG, "Cabine %u : debitmetre sur GPIO %d (%u impulsions/L)", (unsigned)i, gpio,
+                 (unsigned)(stall_table[i].flow_ppl ? stall_table[i].flow_ppl : FLOW_PPL_YF_S201));
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_meter_start
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Lance le comptage d’une douche
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la cabine a un débitmètre
+
+-- -------------------------------------------------------------------------- */
+bool flow_meter_start(uint8_t stall, int64_t now_us) {
+    if (stall >= stall_count || unit[stall] == NULL) return false;
+
+    if (!running[stall]) {
+        pcnt_unit_enable(unit[stall]);
+        pcnt_unit_clear_count(unit[stall]);
+        pcnt_unit_start(unit[stall]);
+        running[stall] = true;
+    }
+    flow_accum_start(&acc[stall], stall_table[stall].flow_ppl, read_count(stall), now_us);
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_meter_sample
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Lecture périodique du compteur pendant une douche
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void flow_meter_sample(uint8_t stall, int64_t now_us) {
+    if (stall >= stall_count || !running[stall]) return;
+    flow_accum_sample(&acc[stall], read_count(stall), now_us);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_meter_stop
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Termine la mesure d’une douche
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall  : cabine
+     now_us : instant de l’arrêt
+     out    : mesure de la douche (NULL : douche abandonnée)
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si une mesure est rendue
+
+-- -------------------------------------------------------------------------- */
+bool flow_meter_stop(uint8_t stall, int64_t now_us, flow_result_t* out) {
+    if (stall >= stall_count || !running[stall]) return false;
+
+    flow_accum_sample(&acc[stall], read_count(stall), now_us);
+    pcnt_unit_stop(unit[stall]);
+    pcnt_unit_disable(unit[stall]);
+    running[stall] = false;
+
+    if (out) *out = flow_accum_result(&acc[stall]);
+    return out != NULL;
+}
@@ -0,0 +1,56 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: flow_meter.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Débitmètres des cabines (stall_config : flow_gpio, flow_ppl) :
+   - Une unité PCNT par cabine équipée compte les impulsions du capteur
+     à effet Hall, sans interruption ni travail du CPU par impulsion
+   - Le compteur ne tourne que pendant une douche ; il est lu au départ,
+     à chaque seconde (tick de timer_manager) et à l’arrêt (flow_accum)
+   Seule timer_manager_task appelle ce module (pas de verrou).
+
+-- ========================================================================== */
+
+#ifndef FLOW_METER_H
+#define FLOW_METER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "flow_accum.h"
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_meter_init
+   Crée les unités PCNT des cabines équipées d’un débitmètre
+-- -------------------------------------------------------------------------- */
+void flow_meter_init(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_meter_start
+   Départ d’une douche : compteur remis à zéro et lancé
+   Retour : false si la cabine n’a pas de débitmètre
+-- -------------------------------------------------------------------------- */
+bool flow_meter_start(uint8_t stall, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_meter_sample
+   Lecture de la seconde (sans effet hors douche ou sans débitmètre)
+-- -------------------------------------------------------------------------- */
+void flow_meter_sample(uint8_t stall, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: flow_meter_stop
+   Fin de la douche : dernière lecture, compteur arrêté
+   Retour : false si rien n’a été mesuré (out non modifié, peut être NULL)
+-- -------------------------------------------------------------------------- */
+bool flow_meter_stop(uint8_t stall, int64_t now_us, flow_result_t* out);
+
+#endif // FLOW_METER_H
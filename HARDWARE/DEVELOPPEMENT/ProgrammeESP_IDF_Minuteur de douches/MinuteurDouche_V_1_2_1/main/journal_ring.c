@@ -0,0 +1,259 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: journal_ring.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Journal circulaire en flash NOR (voir journal_ring.h) :
+   - Case libre : 64 octets à 0xFF ; une case écrite est valide si son
+     numéro n’est ni 0 ni 0xFFFFFFFF et si son CRC est juste
+   - Les numéros se suivent dans l’ordre des cases : la case qui suit le
+     plus grand numéro est la prochaine écrite, et aussi le début du
+     parcours (plus ancien enregistrement encore présent)
+   - Une case déjà programmée (écriture interrompue) n’est jamais
+     réécrite : elle est sautée jusqu’au prochain effacement de secteur
+   Aucune dépendance ESP-IDF : module testé sur PC.
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "journal_ring.h"
+#include "crc32.h"
+#include <stddef.h>
+#include <string.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define SEQ_ERASED      0xFFFFFFFFu
+#define CRC_LEN         offsetof(journal_record_t, crc)
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: read_slot
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Lit une case du journal
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la lecture flash a réussi
+
+-- -------------------------------------------------------------------------- */
+static bool read_slot(const journal_ring_t* ring, uint32_t slot, journal_record_t* rec) {
+    return ring->flash.read(ring->flash.ctx, slot * JOURNAL_RECORD_SIZE,
+                            rec, JOURNAL_RECORD_SIZE) == 0;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: record_valid
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Case écrite complètement (numéro plausible, CRC juste)
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si l’enregistrement est exploitable
+
+-- -------------------------------------------------------------------------- */
+static bool record_valid(const journal_record_t* rec) {
+    return rec->seq != JOURNAL_SEQ_NONE && rec->seq != SEQ_ERASED
+        && rec->crc == crc32_calc(rec, CRC_LEN);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: record_blank
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Case entièrement effacée (programmable sans effacement préalable)
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si les 64 octets valent 0xFF
+
+-- -------------------------------------------------------------------------- */
+static bool record_blank(const journal_record_t* rec) {
+    const uint8_t* p = (const uint8_t*)rec;
+    for (size_t i = 0; i < sizeof(*rec); i++) {
+        if (p[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: journal_ring_open
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Retrouve la position d’écriture après un démarrage
+
+   --------------------------------------------------------------------------
+   Description:
+   Toutes les cases sont lues une fois (1024 pour 64 Ko). Journal vide :
+   écriture en case 0 à partir du numéro 1.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     ring  : journal à initialiser
+     flash : accès à la zone de flash (copié)
+
+   --------------------------------------------------------------------------
+   Return value:
+     false si la géométrie est invalide (moins de deux secteurs, tailles
+     non multiples) ou si une lecture échoue
+
+-- -------------------------------------------------------------------------- */
+bool journal_ring_open(journal_ring_t* ring, const journal_flash_t* flash) {
+    memset(ring, 0, sizeof(*ring));
+    ring->flash = *flash;
+
+    if (flash->sector_size == 0 || flash->sector_size % JOURNAL_RECORD_SIZE != 0 ||
+        flash->size % flash->sector_size != 0 || flash->size < 2 * flash->sector_size) {
+        return false;
+    }
+    ring->slots = flash->size / JOURNAL_RECORD_SIZE;
+
+    uint32_t last_slot = 0;
+    for (uint32_t slot = 0; slot < ring->slots; slot++) {
+        journal_record_t rec;
+        if (!read_slot(ring, slot, &rec)) return false;
+        if (record_valid(&rec) && rec.seq > ring->last_seq) {
+            ring->last_seq = rec.seq;
+            last_slot = slot;
+        }
+    }
+
+    ring->head = (ring->last_seq == JOURNAL_SEQ_NONE) ? 0 : (last_slot + 1) % ring->slots;
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: journal_ring_append
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Écrit un enregistrement à la position courante
+
+   --------------------------------------------------------------------------
+   Description:
+   Au début d’un secteur, celui-ci est effacé (ses enregistrements, les
+   plus anciens du journal, sont perdus). Une case non vierge au milieu
+   d’un secteur (écriture interrompue) est sautée.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     ring : journal ouvert
+     rec  : données de la douche ; seq et crc sont remplis
+
+   --------------------------------------------------------------------------
+   Return value:
+     Numéro attribué, JOURNAL_SEQ_NONE en cas d’erreur flash
+
+-- -------------------------------------------------------------------------- */
+uint32_t journal_ring_append(journal_ring_t* ring, journal_record_t* rec) {
+    uint32_t per_sector = ring->flash.sector_size / JOURNAL_RECORD_SIZE;
+
+    rec->seq = ring->last_seq + 1;
+    rec->crc = crc32_calc(rec, CRC_LEN);
+
+    for (uint32_t tries = 0; tries <= per_sector; tries++) {
+        uint32_t offset = ring->head * JOURNAL_RECORD_SIZE;
+
+        if (ring->head % per_sector == 0) {
+            if (ring->flash.erase(ring->flash.ctx, offset, ring->flash.sector_size) != 0) {
+                return JOURNAL_SEQ_NONE;
+            }
+        } else {
+            journal_record_t cur;
+            if (!read_slot(ring, ring->head, &cur)) return JOURNAL_SEQ_NONE;
+            if (!record_blank(&cur)) {
+                ring->head = (ring->head + 1) % ring->slots;
+                continue;
+            }
+        }
+
+        int err = ring->flash.write(ring->flash.ctx, offset, rec, JOURNAL_RECORD_SIZE);
+        ring->head = (ring->head + 1) % ring->slots;
+        if (err != 0) return JOURNAL_SEQ_NONE;
+
+        ring->last_seq = rec->seq;
+        return rec->seq;
+    }
+    return JOURNAL_SEQ_NONE;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: journal_ring_cursor
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Début de parcours : la case d’écriture est suivie des plus anciens
+   enregistrements
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void journal_ring_cursor(const journal_ring_t* ring, journal_cursor_t* cur) {
+    cur->slot = ring->head;
+    cur->remaining = ring->slots;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: journal_ring_next
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Avance jusqu’au prochain enregistrement non encore transmis
+
+   --------------------------------------------------------------------------
+   Description:
+   Un parcours complet lit chaque case au plus une fois ; les cases
+   vierges, interrompues ou déjà acquittées sont passées.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     ring      : journal ouvert
+     cur       : curseur (journal_ring_cursor), avancé
+     after_seq : numéros inférieurs ou égaux ignorés
+     out       : enregistrement trouvé
+
+   --------------------------------------------------------------------------
+   Return value:
+     false si plus aucun enregistrement ne convient (ou erreur de lecture)
+
+-- -------------------------------------------------------------------------- */
+bool journal_ring_next(const journal_ring_t* ring, journal_cursor_t* cur,
+                       uint32_t after_seq, journal_record_t* out) {
+    while (cur->remaining > 0) {
+        uint32_t slot = cur->slot;
+        cur->slot = (cur->slot + 1) % ring->slots;
+        cur->remaining--;
+
+        if (!read_slot(ring, slot, out)) return false;
+        if (record_valid(out) && out->seq > after_seq) return true;
+    }
+    return false;
+}
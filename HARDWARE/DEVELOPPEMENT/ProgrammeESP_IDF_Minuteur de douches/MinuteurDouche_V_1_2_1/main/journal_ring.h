@@ -0,0 +1,134 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: journal_ring.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Journal circulaire des douches terminées, en flash NOR :
+   - Enregistrements de taille fixe (64 octets), ajoutés à la suite ;
+     un secteur n’est effacé qu’au moment d’y écrire le premier
+     enregistrement du tour suivant (les plus anciens sont alors perdus)
+   - Numéro de séquence croissant et CRC par enregistrement : la position
+     d’écriture est retrouvée au démarrage par lecture du journal, un
+     enregistrement interrompu par une coupure est ignoré
+   - Accès flash par fonctions fournies par l’appelant (partition ESP-IDF
+     sur la cible, mémoire simulée sur PC)
+
+-- ========================================================================== */
+
+#ifndef JOURNAL_RING_H
+#define JOURNAL_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define JOURNAL_RECORD_SIZE     64          // Divise la taille d’un secteur
+#define JOURNAL_USER_MAX        32          // Nom, '\0' compris
+#define JOURNAL_SEQ_NONE        0u          // Aucun enregistrement
+#define JOURNAL_FLAG_FLOW       0x01        // volume_ml et peak_ml_min mesurés
+#define JOURNAL_FLAG_MS         0x02        // Durées en ms (sinon en s : anciens firmwares)
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: journal_record_t
+   Douche terminée, telle qu’écrite en flash (little-endian)
+   start_s est compté depuis le démarrage numéro "boot" de l’ESP32 (pas
+   d’horloge calendaire sur la carte)
+-- -------------------------------------------------------------------------- */
+typedef struct __attribute__((packed)) {
+    uint32_t seq;                      // 1, 2, 3... (0xFFFFFFFF : case effacée)
+    uint16_t boot;                     // Numéro de démarrage
+    uint16_t stall;                    // Cabine (0 : carte à une cabine)
+    uint32_t start_s;                  // Début, en secondes depuis ce démarrage
+    uint32_t duration_ms;              // Durée totale de la douche
+    uint32_t overtime_ms;              // Dont dépassement de la durée allouée
+    char user[JOURNAL_USER_MAX];
+    uint32_t volume_ml;                // Eau mesurée (si JOURNAL_FLAG_FLOW)
+    uint16_t peak_ml_min;              // Débit de pointe (si JOURNAL_FLAG_FLOW)
+    uint8_t flags;                     // JOURNAL_FLAG_* (0 : anciens firmwares)
+    uint8_t pad[1];
+    uint32_t crc;                      // CRC-32 des 60 octets précédents
+} journal_record_t;
+
+_Static_assert(sizeof(journal_record_t) == JOURNAL_RECORD_SIZE, "taille d'enregistrement");
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: journal_flash_t
+   Accès à la zone de flash du journal (décalages relatifs à son début)
+   Fonctions : 0 en cas de succès ; write ne fait que passer des bits de
+   1 à 0, erase remet un secteur entier à 0xFF
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    int (*read)(void* ctx, uint32_t offset, void* dst, size_t len);
+    int (*write)(void* ctx, uint32_t offset, const void* src, size_t len);
+    int (*erase)(void* ctx, uint32_t offset, size_t len);
+    void* ctx;
+    uint32_t size;                     // Multiple de sector_size
+    uint32_t sector_size;              // Multiple de JOURNAL_RECORD_SIZE
+} journal_flash_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: journal_ring_t
+   Position d’écriture et bornes du journal
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    journal_flash_t flash;
+    uint32_t slots;                    // Nombre de cases
+    uint32_t head;                     // Prochaine case écrite
+    uint32_t last_seq;                 // Dernier enregistrement écrit
+} journal_ring_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: journal_cursor_t
+   Parcours des enregistrements dans l’ordre d’écriture
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint32_t slot;                     // Prochaine case lue
+    uint32_t remaining;                // Cases restant à lire
+} journal_cursor_t;
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: journal_ring_open
+   Lit tout le journal pour retrouver la position d’écriture et le dernier
+   numéro de séquence
+   Retour : false si la géométrie est invalide ou la lecture échoue
+-- -------------------------------------------------------------------------- */
+bool journal_ring_open(journal_ring_t* ring, const journal_flash_t* flash);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: journal_ring_append
+   Ajoute un enregistrement (seq et crc sont remplis ici)
+   Retour : numéro attribué, JOURNAL_SEQ_NONE en cas d’erreur flash
+-- -------------------------------------------------------------------------- */
+uint32_t journal_ring_append(journal_ring_t* ring, journal_record_t* rec);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: journal_ring_cursor
+   Place un curseur sur la plus ancienne case du journal
+-- -------------------------------------------------------------------------- */
+void journal_ring_cursor(const journal_ring_t* ring, journal_cursor_t* cur);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: journal_ring_next
+   Enregistrement valide suivant dont le numéro dépasse after_seq
+   Retour : false à la fin du journal
+-- -------------------------------------------------------------------------- */
+bool journal_ring_next(const journal_ring_t* ring, journal_cursor_t* cur,
+                       uint32_t after_seq, journal_record_t* out);
+
+#endif // JOURNAL_RING_H
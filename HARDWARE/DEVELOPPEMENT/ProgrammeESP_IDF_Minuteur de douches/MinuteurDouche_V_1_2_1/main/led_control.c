@@ -23,6 +23,7 @@
    Include header files
 -- -------------------------------------------------------------------------- */
 #include "led_control.h"
+#include "stall_config.h"
 #include "driver/gpio.h"
 
 /**-------------------------------------------------------------------------- --
@@ -39,11 +40,11 @@ static int led_state = 0;   // État interne de la LED : 0 = éteinte, 1 = allum
 
    --------------------------------------------------------------------------
    Purpose:
-   Initialiser le GPIO utilisé pour la LED
+   Initialiser les GPIO des LED (LED_GPIO et LED des cabines)
 
    --------------------------------------------------------------------------
    Description:
-   - Configure le GPIO comme sortie
+   - Configure les GPIO comme sorties
    - Désactive les pull-up/pull-down
    - Éteint la LED par défaut
 
@@ -53,14 +54,22 @@ static int led_state = 0;   // État interne de la LED : 0 = éteinte, 1 = allum
 
 -- -------------------------------------------------------------------------- */
 void led_init(void) {
+    uint64_t mask = (1ULL << LED_GPIO);
+    for (uint8_t i = 0; i < stall_count; i++) {
+        if (stall_table[i].led_gpio != GPIO_NUM_NC) mask |= (1ULL << stall_table[i].led_gpio);
+    }
+
     gpio_config_t io_conf = {
-        .pin_bit_mask = (1ULL << LED_GPIO),       // Sélection de la broche
+        .pin_bit_mask = mask,                     // Sélection des broches
         .mode = GPIO_MODE_OUTPUT,                 // Mode sortie
         .pull_up_en = GPIO_PULLUP_DISABLE,        // Pas de pull-up
         .pull_down_en = GPIO_PULLDOWN_DISABLE,    // Pas de pull-down
         .intr_type = GPIO_INTR_DISABLE            // Pas d’interruption
     };
     gpio_config(&io_conf);   // Applique la configuration GPIO
+    for (uint8_t i = 0; i < stall_count; i++) {
+        led_stall_set(i, false);
+    }
     led_off();               // État par défaut : LED éteinte
 }
 
@@ -137,6 +146,40 @@ void led_toggle(void) {
 }
 
 
+/* -------------------------------------------------------------------------- --
+   FUNCTION: led_stall_set
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Commander la LED d’une cabine
+
+   --------------------------------------------------------------------------
+   Description:
+   - La LED de LED_GPIO passe par led_on / led_off (état interne à jour)
+   - Cabine inconnue ou sans LED : rien
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : numéro de cabine
+     on    : true = allumée
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void led_stall_set(uint8_t stall, bool on) {
+    if (stall >= stall_count || stall_table[stall].led_gpio == GPIO_NUM_NC) return;
+
+    if (stall_table[stall].led_gpio == LED_GPIO) {
+        if (on) led_on();
+        else    led_off();
+    } else {
+        gpio_set_level(stall_table[stall].led_gpio, on ? 1 : 0);
+    }
+}
+
+
 /* -------------------------------------------------------------------------- --
    FUNCTION: led_get_state
 
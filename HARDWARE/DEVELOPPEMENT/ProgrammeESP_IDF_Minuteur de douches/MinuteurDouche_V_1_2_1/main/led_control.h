@@ -10,6 +10,7 @@
    Interface du module de gestion de la LED :
    - Initialisation du GPIO associé
    - Contrôle de l'état (on/off/toggle)
+   - LED de chaque cabine (stall_config.h)
    - Récupération de l'état actuel
 
    ==========================================================================
@@ -22,6 +23,8 @@
 #ifndef LED_CONTROL_H
 #define LED_CONTROL_H
 
+#include <stdbool.h>
+#include <stdint.h>
 #include "driver/gpio.h"
 
 /**-------------------------------------------------------------------------- --
@@ -57,6 +60,13 @@ void led_off(void);
 -- -------------------------------------------------------------------------- */
 void led_toggle(void);
 
+/* -------------------------------------------------------------------------- --
+   FUNCTION: led_stall_set
+   Allume ou éteint la LED de la cabine "stall" (sans effet si elle n’en
+   a pas)
+-- -------------------------------------------------------------------------- */
+void led_stall_set(uint8_t stall, bool on);
+
 /* -------------------------------------------------------------------------- --
    FUNCTION: led_get_state
    Retourne l’état actuel de la LED (0 = éteinte, 1 = allumée)
@@ -10,6 +10,8 @@
    Fichier principal de l'application ESP32.
    Initialise les modules (OLED, BLE, bouton, LED, minuteur) et
    lance les tâches FreeRTOS nécessaires au fonctionnement du système.
+   Les boutons, LED et écrans des cabines sont décrits dans
+   stall_config.c.
 
    ==========================================================================
    History:
@@ -30,6 +32,10 @@
 #include "button_handler.h"
 #include "led_control.h"
 #include "timer_manager.h"
+#include "display_task.h"
+#include "power_manager.h"
+#include "diag_service.h"
+#include "stall_config.h"
 
 #include "driver/gpio.h"
 #include "esp_log.h"
@@ -38,14 +44,8 @@
 /**-------------------------------------------------------------------------- --
    Local constants and macros
 -- -------------------------------------------------------------------------- */
-#define BUTTON_GPIO GPIO_NUM_5   // GPIO utilisé pour le bouton poussoir
 #define TAG "MAIN"               // Tag utilisé pour les logs
 
-/**-------------------------------------------------------------------------- --
-   External variables
--- -------------------------------------------------------------------------- */
-extern char user_name[32];       // Nom utilisateur reçu via BLE
-
 /**-------------------------------------------------------------------------- --
    Private functions
 -- -------------------------------------------------------------------------- */
@@ -55,12 +55,12 @@ extern char user_name[32];       // Nom utilisateur reçu via BLE
 
    --------------------------------------------------------------------------
    Purpose:
-   Tâche de DEBUG affichant l’état du bouton GPIO dans les logs
+   Tâche de DEBUG affichant l’état des boutons GPIO dans les logs
 
    --------------------------------------------------------------------------
    Description:
-   Affiche l'état (0 ou 1) du bouton toutes les 200 ms. Utilisable pour vérifier
-   le câblage et le rebond du bouton.
+   Affiche l'état (0 ou 1) du bouton de chaque cabine toutes les 200 ms.
+   Utilisable pour vérifier le câblage et le rebond des boutons.
 
    --------------------------------------------------------------------------
    Return value:
@@ -69,8 +69,10 @@ extern char user_name[32];       // Nom utilisateur reçu via BLE
 -- -------------------------------------------------------------------------- */
 void test_button_task(void *arg) {
     while (1) {
-        int state = gpio_get_level(BUTTON_GPIO);
-        ESP_LOGI("DEBUG", "Etat bouton: %d", state);
+        for (uint8_t i = 0; i < stall_count; i++) {
+            int state = gpio_get_level(stall_table[i].button_gpio);
+            ESP_LOGI("DEBUG", "Etat bouton cabine %u: %d", (unsigned)i, state);
+        }
         vTaskDelay(pdMS_TO_TICKS(200));
     }
 }
@@ -80,13 +82,18 @@ void test_button_task(void *arg) {
 
    --------------------------------------------------------------------------
    Purpose:
-   Tâche principale de gestion des appuis bouton et du minuteur
+   Abonné aux gestes des boutons qui pilote le minuteur de chaque cabine
 
    --------------------------------------------------------------------------
    Description:
-   - Sur appui bouton (front descendant), démarre ou arrête le minuteur
-   - Vérifie que le nom utilisateur est défini avant le démarrage
-   - Affiche un message d’erreur si aucun utilisateur sélectionné
+   - Bloquée sur sa file de gestes : aucun réveil entre deux appuis
+   - Chaque geste vise le minuteur de la cabine de son bouton
+   - Appui court : démarrage ou arrêt du minuteur selon son état publié
+     (la tâche du minuteur vérifie l’utilisateur et affiche l’invite si
+     aucun n’est sélectionné)
+   - Appui long : reset, la douche en cours est abandonnée
+   - Double appui : sans action sur le minuteur (le premier appui a déjà
+     été traité comme un appui court)
 
    --------------------------------------------------------------------------
    Return value:
@@ -94,33 +101,32 @@ void test_button_task(void *arg) {
 
 -- -------------------------------------------------------------------------- */
 void button_timer_task(void *arg) {
-    static int last_state = 1; // 1 = relâché, 0 = appuyé précédemment
+    QueueHandle_t gestures = (QueueHandle_t)arg;
+    button_event_t event;
+
     while (1) {
-        int current_state = gpio_get_level(BUTTON_GPIO);
-
-        // Détection de l'appui (front descendant)
-        if (last_state == 1 && current_state == 0) {
-            ESP_LOGI(TAG, "Appui bouton détecté !");
-
-            if (timer_manager_get_state() == TIMER_STOPPED) {
-                // Vérifie que l'utilisateur est bien sélectionné
-                if (user_name[0] == '\0' || strcmp(user_name, "User") == 0) {
-                    ssd1306_clear_screen();
-                    ssd1306_display_text(2, "Selectionnez un", strlen("Selectionnez un"), false);
-                    ssd1306_display_text(3, "utilisateur avant", strlen("utilisateur avant"), false);
-                    ssd1306_display_text(4, "la douche", strlen("la douche"), false);
-                } else {
-                    // Lancement du minuteur avec le nom utilisateur
-                    timer_manager_start(user_name);
-                }
+        xQueueReceive(gestures, &event, portMAX_DELAY);
+        ESP_LOGI(TAG, "Appui bouton détecté (cabine %u) : %s",
+                 (unsigned)event.stall, button_gesture_name(event.gesture));
+
+        switch (event.gesture) {
+        case BUTTON_GESTURE_SHORT:
+            if (timer_manager_get_state(event.stall) == TIMER_STOPPED) {
+                // Lancement du minuteur avec l’utilisateur courant
+                timer_manager_start(event.stall, NULL);
             } else {
                 // Arrêt du minuteur
-                timer_manager_stop();
+                timer_manager_stop(event.stall);
             }
-        }
+            break;
 
-        last_state = current_state;
-        vTaskDelay(pdMS_TO_TICKS(50));
+        case BUTTON_GESTURE_LONG:
+            timer_manager_reset(event.stall);
+            break;
+
+        default:
+            break;
+        }
     }
 }
 
@@ -134,8 +140,10 @@ void button_timer_task(void *arg) {
    --------------------------------------------------------------------------
    Description:
    - Initialise tous les composants logiciels et matériels
-   - Lance les tâches FreeRTOS (bouton + timer)
+   - Lance les tâches FreeRTOS (affichage + bouton + timer)
    - Affiche l’écran d’accueil à l'initialisation
+   - Active la gestion d’énergie puis rend la main (pas de boucle : la
+     tâche main est supprimée au retour)
 
    --------------------------------------------------------------------------
    Return value:
@@ -145,21 +153,19 @@ void button_timer_task(void *arg) {
 void app_main(void) {
     // Initialisation des périphériques
     oled_init();
+    display_init();       // Tâche propriétaire de l’écran OLED
     show_boot_screen();   // Affiche l'écran de bienvenue
 
     ble_server_init();    // Initialise le serveur BLE
-    button_init();        // Configure le GPIO bouton
-    led_init();           // Prépare la LED de signalisation
-    timer_manager_init(); // Lance la tâche de gestion du timer
+    button_init();        // GPIO, interruptions et tâche des boutons
+    led_init();           // Prépare les LED de signalisation
+    timer_manager_init(); // Écrans des cabines et tâche de gestion des timers
+    power_manager_init(); // Fréquence variable et light sleep automatique
+    diag_service_init();  // Relevés des tâches et du tas, publiés en BLE
 
     // Tâche de gestion des appuis et du minuteur
-    xTaskCreate(button_timer_task, "button_timer_task", 2048, NULL, 5, NULL);
+    xTaskCreate(button_timer_task, "button_timer_task", 2048, button_subscribe(), 5, NULL);
 
     // (Optionnel) : activer pour tester l’état du bouton
     // xTaskCreate(test_button_task, "test_button", 2048, NULL, 5, NULL);
-
-    // Boucle infinie principale (inactive ici)
-    while (1) {
-        vTaskDelay(pdMS_TO_TICKS(1000));
-    }
 }
@@ -9,8 +9,11 @@
    --------------------------------------------------------------------------
    Fonctions de gestion de l’écran OLED 128x64 via le pilote SSD1306 :
    - Initialisation de l’écran OLED via I2C (GPIO 21/22)
-   - Fonctions d’affichage de texte centré, de messages, de goutte animée,
-     d’écran d’explosion et d’écran de bienvenue
+   - Fonctions d’affichage de texte centré, de messages et d’écran de
+     bienvenue
+   - Écran du minuteur en scène retenue (oled_widgets.h) : nom, compte à
+     rebours, jauge de la goutte, alerte de dépassement clignotante
+   - Mêmes écrans sur le panneau de chaque cabine (fonctions oled_dev_*)
    - Réception du nom d’utilisateur via BLE et affichage
 
    ==========================================================================
@@ -25,7 +28,10 @@
    Include header files
 -- -------------------------------------------------------------------------- */
 #include "oled_display.h"
+#include "display_task.h"
+#include "oled_widgets.h"
 #include "ssd1306.h"
+#include "esp_log.h"
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -36,6 +42,18 @@
 -- -------------------------------------------------------------------------- */
 char user_name[32] = "";   // Nom d’utilisateur courant (reçu via BLE)
 
+static const char *TAG = "OLED";
+
+/**-------------------------------------------------------------------------- --
+   Écran du minuteur : scène et widgets
+-- -------------------------------------------------------------------------- */
+static const uint8_t icon_goutte[2][8] = {       // 8x16, format page
+    { 0x00, 0xC0, 0xF0, 0xFE, 0xFF, 0xF0, 0xC0, 0x00 },
+    { 0x00, 0x07, 0x0F, 0x1F, 0x1F, 0x0F, 0x07, 0x00 },
+};
+
+static oled_timer_screen_t default_screen;     // Panneau par défaut
+
 /**========================================================================== --
    Public functions
 -- ========================================================================== */
@@ -53,6 +71,7 @@ char user_name[32] = "";   // Nom d’utilisateur courant (reçu via BLE)
    - Initialise l’écran SSD1306 en 128x64
    - Efface l’écran et applique un contraste maximal
    - Affiche un message d’état centré
+   Appelée avant display_init() : l’envoi se fait dans la tâche appelante.
 
    --------------------------------------------------------------------------
    Return value:
@@ -60,11 +79,17 @@ char user_name[32] = "";   // Nom d’utilisateur courant (reçu via BLE)
 
 -- -------------------------------------------------------------------------- */
 void oled_init(void) {
+    uint32_t transactions, bytes;
+
     ssd1306_setup_i2c(GPIO_NUM_21, GPIO_NUM_22);   // Initialisation I2C
     ssd1306_128x64_i2c_init();                     // Init du SSD1306
     ssd1306_clear_screen();                        // Écran vide
     ssd1306_contrast(0xFF);                        // Contraste fort
     oled_display_centered(" Minuteur ESP32 Connecté ", 3);  // Message par défaut
+    ssd1306_refresh();
+    ssd1306_bus_last_call(&transactions, &bytes);
+    ESP_LOGD(TAG, "Refresh : %lu transaction(s) I2C, %lu octets",
+             (unsigned long)transactions, (unsigned long)bytes);
 }
 
 
@@ -81,7 +106,24 @@ void oled_init(void) {
 
 -- -------------------------------------------------------------------------- */
 void oled_clear(void) {
-    ssd1306_clear_screen();
+    oled_dev_clear(ssd1306_default());
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_dev_clear
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Efface le tampon arrière du panneau "dev"
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_dev_clear(ssd1306_t* dev) {
+    ssd1306_dev_clear_screen(dev);
 }
 
 
@@ -102,8 +144,32 @@ void oled_clear(void) {
 
 -- -------------------------------------------------------------------------- */
 void oled_display_message(const char *message) {
-    oled_clear();
-    ssd1306_display_text(3, message, strlen(message), false);
+    oled_dev_display_message(ssd1306_default(), message);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_dev_display_message
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Message simple (ligne 3) sur le panneau "dev", écran effacé
+
+   --------------------------------------------------------------------------
+   Parameters:
+     dev     : panneau (attaché à la tâche d’affichage)
+     message : Chaîne de caractères à afficher
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_dev_display_message(ssd1306_t* dev, const char *message) {
+    display_begin();
+    oled_dev_clear(dev);
+    ssd1306_dev_draw_string(dev, 0, 3, message, 1, true);
+    display_commit();
 }
 
 
@@ -125,54 +191,324 @@ void oled_display_message(const char *message) {
 
 -- -------------------------------------------------------------------------- */
 void oled_display_centered(const char *msg, uint8_t line) {
+    oled_dev_display_centered(ssd1306_default(), msg, line);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_dev_display_centered
+
+   --------------------------------------------------------------------------
+   Purpose:
+   oled_display_centered sur le panneau "dev"
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_dev_display_centered(ssd1306_t* dev, const char *msg, uint8_t line) {
     int len = strlen(msg);
     int col = (21 - len) / 2;  // Max 21 caractères par ligne
     if (col < 0) col = 0;
-    ssd1306_display_text(line, msg, len, false);  // Affiche sans inversion
+    ssd1306_dev_draw_string(dev, 0, line, msg, 1, true);  // Affiche sans inversion
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_open_panel
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Panneau d’une cabine, prêt à recevoir des images
+
+   --------------------------------------------------------------------------
+   Description:
+   Le panneau par défaut est déjà initialisé par oled_init() ; un autre
+   panneau est initialisé par la tâche d’affichage, seule à utiliser le
+   bus une fois lancée (display_attach).
+
+   --------------------------------------------------------------------------
+   Parameters:
+     addr : adresse I2C (SSD1306_ADDR_PRIMARY / SECONDARY), 0 : aucun
+
+   --------------------------------------------------------------------------
+   Return value:
+   Poignée du panneau, NULL si aucun
+
+-- -------------------------------------------------------------------------- */
+ssd1306_t* oled_open_panel(uint8_t addr) {
+    if (addr == 0) return NULL;
+
+    ssd1306_t* dev = ssd1306_open(I2C_NUM_0, addr);
+    if (dev == NULL) {
+        ESP_LOGE(TAG, "Panneau 0x%02X : plus de place (SSD1306_MAX_PANELS)", addr);
+        return NULL;
+    }
+    if (dev != ssd1306_default()) {
+        display_attach(dev);
+    }
+    return dev;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: format_mmss
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Formate une durée en MM:SS (minutes modulo 100)
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+static void format_mmss(char *buf, size_t len, uint32_t seconds) {
+    snprintf(buf, len, "%02u:%02u",
+             (unsigned int)((seconds / 60) % 100), (unsigned int)(seconds % 60));
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_screen_commit
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Rendu incrémental de la scène du minuteur et envoi (verrou déjà pris)
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+static void timer_screen_commit(oled_timer_screen_t* screen) {
+    oled_scene_render(&screen->scene);
+    display_commit();
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_timer_screen_show
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Compose l’écran du minuteur (efface l’écran précédent)
+
+   --------------------------------------------------------------------------
+   Description:
+   Crée la scène : nom centré, compte à rebours en grands chiffres, goutte
+   et jauge de remplissage. L’alerte et la durée de dépassement sont
+   créées masquées.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     name      : nom de l’utilisateur
+     remain_s  : temps restant en secondes
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_timer_screen_show(const char *name, uint32_t remain_s) {
+    oled_dev_timer_screen_show(&default_screen, ssd1306_default(), name, remain_s);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_dev_timer_screen_show
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Compose l’écran du minuteur "screen" sur le panneau "dev"
+
+   --------------------------------------------------------------------------
+   Parameters:
+     screen    : scène de ce panneau (une par panneau)
+     dev       : panneau attaché à la tâche d’affichage
+     name      : nom de l’utilisateur
+     remain_s  : temps restant en secondes
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_dev_timer_screen_show(oled_timer_screen_t* screen, ssd1306_t* dev,
+                                const char *name, uint32_t remain_s) {
+    char buf[8];
+    format_mmss(buf, sizeof(buf), remain_s);
+
+    display_begin();
+    oled_scene_init(&screen->scene, dev);
+
+    oled_label_init(&screen->name, -1, 0, OLED_FONT_SMALL, name);
+    oled_label_init(&screen->countdown, -1, 1, OLED_FONT_DIGITS, buf);
+    oled_label_init(&screen->alert, -1, 2, OLED_FONT_SMALL, "!! DEPASSE !!");
+    oled_widget_set_visible(&screen->alert, false);
+    oled_widget_set_blink(&screen->alert, true);
+    oled_label_init(&screen->overtime, -1, 4, OLED_FONT_SMALL, "");
+    oled_widget_set_visible(&screen->overtime, false);
+    oled_icon_init(&screen->icon, 4, 46, 8, 16, &icon_goutte[0][0]);
+    oled_gauge_init(&screen->gauge, 16, 48, 80, 12);
+    oled_label_init(&screen->percent, 100, 6, OLED_FONT_SMALL, "0%");
+
+    oled_scene_add(&screen->scene, &screen->name);
+    oled_scene_add(&screen->scene, &screen->countdown);
+    oled_scene_add(&screen->scene, &screen->alert);
+    oled_scene_add(&screen->scene, &screen->overtime);
+    oled_scene_add(&screen->scene, &screen->icon);
+    oled_scene_add(&screen->scene, &screen->gauge);
+    oled_scene_add(&screen->scene, &screen->percent);
+    timer_screen_commit(screen);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_timer_screen_update
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Met à jour le temps restant et le remplissage de la goutte
+
+   --------------------------------------------------------------------------
+   Description:
+   Seuls les widgets dont la valeur change sont redessinés : d’une seconde
+   à l’autre, uniquement les chiffres qui changent partent sur le bus.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     remain_s     : temps restant en secondes
+     fill_percent : remplissage de la goutte (0 à 100)
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_timer_screen_update(uint32_t remain_s, uint8_t fill_percent) {
+    oled_dev_timer_screen_update(&default_screen, remain_s, fill_percent);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_dev_timer_screen_update
+
+   --------------------------------------------------------------------------
+   Purpose:
+   oled_timer_screen_update sur l’écran "screen"
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_dev_timer_screen_update(oled_timer_screen_t* screen, uint32_t remain_s,
+                                  uint8_t fill_percent) {
+    char buf[8];
+    format_mmss(buf, sizeof(buf), remain_s);
+
+    display_begin();
+    oled_label_set(&screen->countdown, buf);
+    oled_gauge_set(&screen->gauge, fill_percent);
+    snprintf(buf, sizeof(buf), "%u%%", (unsigned int)screen->gauge.gauge.percent);
+    oled_label_set(&screen->percent, buf);
+    timer_screen_commit(screen);
 }
 
 
 /* -------------------------------------------------------------------------- --
-   FUNCTION: oled_draw_goutte
+   FUNCTION: oled_timer_screen_overtime
 
    --------------------------------------------------------------------------
    Purpose:
-   Affiche une goutte avec pourcentage de remplissage simulé (debug)
+   Passe l’écran en dépassement et affiche la durée dépassée
+
+   --------------------------------------------------------------------------
+   Description:
+   Masque le compte à rebours, affiche l’alerte (clignotante, voir
+   oled_timer_screen_blink) et la durée "00:00  +Ns". Sans effet sur les
+   widgets déjà dans cet état.
 
    --------------------------------------------------------------------------
    Parameters:
-     fill_percent : Pourcentage à afficher (0-100)
+     overtime_s : durée du dépassement en secondes
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_timer_screen_overtime(uint32_t overtime_s) {
+    oled_dev_timer_screen_overtime(&default_screen, overtime_s);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_dev_timer_screen_overtime
+
+   --------------------------------------------------------------------------
+   Purpose:
+   oled_timer_screen_overtime sur l’écran "screen"
 
    --------------------------------------------------------------------------
    Return value:
    Aucun
 
 -- -------------------------------------------------------------------------- */
-void oled_draw_goutte(uint8_t fill_percent) {
-    char buf[24];
-    snprintf(buf, sizeof(buf), "[GOUTTE %d%%]", fill_percent);
-    ssd1306_display_text(5, buf, strlen(buf), false);
+void oled_dev_timer_screen_overtime(oled_timer_screen_t* screen, uint32_t overtime_s) {
+    char buf[OLED_LABEL_MAX_LEN];
+    snprintf(buf, sizeof(buf), "00:00  +%lus", (unsigned long)overtime_s);
+
+    display_begin();
+    oled_widget_set_visible(&screen->countdown, false);
+    oled_widget_set_visible(&screen->alert, true);
+    oled_widget_set_visible(&screen->overtime, true);
+    oled_label_set(&screen->overtime, buf);
+    oled_gauge_set(&screen->gauge, 100);
+    oled_label_set(&screen->percent, "100%");
+    timer_screen_commit(screen);
 }
 
 
 /* -------------------------------------------------------------------------- --
-   FUNCTION: oled_draw_explosion
+   FUNCTION: oled_timer_screen_blink
 
    --------------------------------------------------------------------------
    Purpose:
-   Affiche un message clignotant pour dépassement de temps de douche
+   Phase du clignotement de l’alerte de dépassement
 
    --------------------------------------------------------------------------
    Parameters:
-     blink : Si true, affiche le message. Sinon, l'efface.
+     on : true = alerte affichée
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_timer_screen_blink(bool on) {
+    oled_dev_timer_screen_blink(&default_screen, on);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_dev_timer_screen_blink
+
+   --------------------------------------------------------------------------
+   Purpose:
+   oled_timer_screen_blink sur l’écran "screen"
 
    --------------------------------------------------------------------------
    Return value:
    Aucun
 
 -- -------------------------------------------------------------------------- */
-void oled_draw_explosion(bool blink) {
-    ssd1306_display_text(2, blink ? "!! DEPASSÉ !!" : "              ", 13, false);
+void oled_dev_timer_screen_blink(oled_timer_screen_t* screen, bool on) {
+    display_begin();
+    oled_scene_set_blink(&screen->scene, on);
+    timer_screen_commit(screen);
 }
 
 
@@ -189,8 +525,10 @@ void oled_draw_explosion(bool blink) {
 
 -- -------------------------------------------------------------------------- */
 void show_boot_screen(void) {
+    display_begin();
     oled_clear();
     oled_display_centered("Bienvenue a vous !", 3);
+    display_commit();
 }
 
 
@@ -211,10 +549,12 @@ void show_boot_screen(void) {
 
 -- -------------------------------------------------------------------------- */
 void show_bienvenue_user(const char* username) {
-    oled_clear();
     char buf[40];
     snprintf(buf, sizeof(buf), "   Bonne douche a vous %s", username);
+    display_begin();
+    oled_clear();
     oled_display_centered(buf, 3);
+    display_commit();
 }
 
 
@@ -10,9 +10,23 @@
    Interface pour la gestion de l'écran OLED via le contrôleur SSD1306 :
    - Initialisation et effacement de l'écran
    - Affichage de messages simples ou formatés
-   - Dessins personnalisés (goutte, explosion)
+   - Écran du minuteur (compte à rebours, goutte, alerte de dépassement)
    - Interaction utilisateur (écran d'accueil, affichage nom)
 
+   Les fonctions de dessin (oled_clear, oled_display_centered) ne font
+   que composer l’image : l’appelant les encadre par display_begin() /
+   display_commit() et la tâche d’affichage envoie l’image (voir
+   display_task.h). Les écrans complets (message, accueil, bienvenue,
+   minuteur) le font eux-mêmes.
+
+   L’écran du minuteur est une scène retenue (oled_widgets.h) : après
+   oled_timer_screen_show(), les mises à jour ne redessinent que les
+   widgets dont la valeur change.
+
+   Les fonctions oled_dev_* font de même sur un panneau donné (une
+   cabine par panneau, voir stall_config.h) ; les autres visent le
+   panneau par défaut (ssd1306_default()).
+
    ==========================================================================
    History:
    --------------------------------------------------------------------------
@@ -25,6 +39,27 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include "ssd1306.h"
+#include "oled_widgets.h"
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: oled_timer_screen_t
+   Écran du minuteur d’un panneau : scène et widgets (un par cabine)
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    oled_scene_t scene;
+    oled_widget_t name;        // Ligne 0 : nom de l’utilisateur
+    oled_widget_t countdown;   // Lignes 1 à 4 : MM:SS en grands chiffres
+    oled_widget_t alert;       // Ligne 2 : alerte de dépassement (clignote)
+    oled_widget_t overtime;    // Ligne 4 : durée du dépassement
+    oled_widget_t icon;        // Goutte
+    oled_widget_t gauge;       // Remplissage de la goutte
+    oled_widget_t percent;     // Pourcentage (ligne 6)
+} oled_timer_screen_t;
 
 /**-------------------------------------------------------------------------- --
    Fonctions de base
@@ -38,7 +73,7 @@ void oled_init(void);
 
 /* -------------------------------------------------------------------------- --
    FUNCTION: oled_clear
-   Efface entièrement l’affichage de l’écran
+   Efface entièrement l’affichage de l’écran (visible au prochain display_commit)
 -- -------------------------------------------------------------------------- */
 void oled_clear(void);
 
@@ -61,17 +96,78 @@ void oled_display_message(const char *message);
 -- -------------------------------------------------------------------------- */
 void oled_display_centered(const char *msg, uint8_t line);
 
+
+/**-------------------------------------------------------------------------- --
+   Écran du minuteur (scène retenue)
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_timer_screen_show
+   Compose l’écran du minuteur : nom, temps restant MM:SS en grands
+   chiffres (lignes 1 à 4), goutte et jauge de remplissage
+-- -------------------------------------------------------------------------- */
+void oled_timer_screen_show(const char *name, uint32_t remain_s);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_timer_screen_update
+   Nouveau temps restant et remplissage (0 à 100) ; seuls les widgets
+   modifiés sont redessinés
+-- -------------------------------------------------------------------------- */
+void oled_timer_screen_update(uint32_t remain_s, uint8_t fill_percent);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_timer_screen_overtime
+   Affiche l’alerte de dépassement et la durée dépassée (en secondes)
+-- -------------------------------------------------------------------------- */
+void oled_timer_screen_overtime(uint32_t overtime_s);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_timer_screen_blink
+   Phase du clignotement de l’alerte (true = affichée)
+-- -------------------------------------------------------------------------- */
+void oled_timer_screen_blink(bool on);
+
+
+/**-------------------------------------------------------------------------- --
+   Panneaux des cabines
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_open_panel
+   Ouvre, initialise et confie à la tâche d’affichage le panneau "addr"
+   du bus d’oled_init() (après display_init())
+   Retour : NULL si addr vaut 0 ou si SSD1306_MAX_PANELS sont ouverts
+-- -------------------------------------------------------------------------- */
+ssd1306_t* oled_open_panel(uint8_t addr);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_dev_clear / oled_dev_display_centered
+   oled_clear / oled_display_centered sur le panneau "dev"
+-- -------------------------------------------------------------------------- */
+void oled_dev_clear(ssd1306_t* dev);
+void oled_dev_display_centered(ssd1306_t* dev, const char *msg, uint8_t line);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_dev_display_message
+   oled_display_message sur le panneau "dev"
+-- -------------------------------------------------------------------------- */
+void oled_dev_display_message(ssd1306_t* dev, const char *message);
+
 /* -------------------------------------------------------------------------- --
-   FUNCTION: oled_draw_goutte
-   Dessine une goutte remplie selon le pourcentage (0 à 100)
+   FUNCTION: oled_dev_timer_screen_show
+   Compose l’écran du minuteur "screen" sur le panneau "dev"
 -- -------------------------------------------------------------------------- */
-void oled_draw_goutte(uint8_t fill_percent);
+void oled_dev_timer_screen_show(oled_timer_screen_t* screen, ssd1306_t* dev,
+                                const char *name, uint32_t remain_s);
 
 /* -------------------------------------------------------------------------- --
-   FUNCTION: oled_draw_explosion
-   Affiche une explosion visuelle (clignotante ou non selon paramètre)
+   FUNCTION: oled_dev_timer_screen_update / _overtime / _blink
+   Mêmes effets que les fonctions oled_timer_screen_* sur "screen"
 -- -------------------------------------------------------------------------- */
-void oled_draw_explosion(bool blink);
+void oled_dev_timer_screen_update(oled_timer_screen_t* screen, uint32_t remain_s,
+                                  uint8_t fill_percent);
+void oled_dev_timer_screen_overtime(oled_timer_screen_t* screen, uint32_t overtime_s);
+void oled_dev_timer_screen_blink(oled_timer_screen_t* screen, bool on);
 
 
 /**-------------------------------------------------------------------------- --
@@ -0,0 +1,345 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: oled_widgets.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Scène retenue de l’écran OLED :
+   - Widgets texte, jauge et icône avec valeur, rectangle et drapeau de
+     modification
+   - Rendu incrémental : seuls les widgets dont la valeur, la visibilité
+     ou la phase de clignotement a changé sont effacés puis redessinés
+   - Le diff par colonnes du pilote n’envoie ensuite que les octets qui
+     ont réellement changé
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "oled_widgets.h"
+#include <string.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define SCREEN_WIDTH    128
+#define SCREEN_HEIGHT   64
+#define DIGITS_HEIGHT   32          // Grands chiffres : 4 lignes
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: widget_reset
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Valeurs communes à la création d’un widget
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void widget_reset(oled_widget_t* w, oled_widget_type_t type) {
+    memset(w, 0, sizeof(*w));
+    w->type = type;
+    w->visible = true;
+    w->dirty = true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: label_layout
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Recalcule la largeur (et la position si centré) d’un texte
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void label_layout(oled_widget_t* w) {
+    if (w->label.font == OLED_FONT_DIGITS) {
+        w->w = ssd1306_gfx_big_digits_width(w->label.text);
+        w->h = DIGITS_HEIGHT;
+    } else {
+        w->w = ssd1306_gfx_text_width(w->label.text, w->label.font);
+        w->h = 8 * w->label.font;
+    }
+    if (w->label.centered) {
+        w->x = (SCREEN_WIDTH - w->w) / 2;
+        if (w->x < 0) w->x = 0;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: widget_draw
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Dessine un widget dans le tampon arrière à sa position courante
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void widget_draw(ssd1306_t* dev, const oled_widget_t* w) {
+    switch (w->type) {
+    case OLED_WIDGET_LABEL:
+        if (w->label.font == OLED_FONT_DIGITS) {
+            ssd1306_dev_draw_big_digits(dev, (uint8_t)w->x, (uint8_t)(w->y / 8), w->label.text);
+        } else {
+            ssd1306_dev_draw_string(dev, (uint8_t)w->x, (uint8_t)(w->y / 8), w->label.text,
+                                    (uint8_t)w->label.font, true);
+        }
+        break;
+
+    case OLED_WIDGET_GAUGE: {
+        int inner = w->w - 4;
+        ssd1306_dev_draw_frame(dev, w->x, w->y, w->w, w->h, SSD1306_MODE_SET);
+        ssd1306_dev_fill_rect(dev, w->x + 2, w->y + 2, inner * w->gauge.percent / 100,
+                              w->h - 4, SSD1306_MODE_SET);
+        break;
+    }
+
+    case OLED_WIDGET_ICON:
+        ssd1306_dev_draw_bitmap_pages(dev, w->x, w->y, w->w, w->h, w->icon.data, SSD1306_MODE_SET);
+        break;
+    }
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_scene_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Scène vide ; l’écran sera effacé au premier rendu
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_scene_init(oled_scene_t* scene, ssd1306_t* dev) {
+    scene->dev = dev;
+    scene->first = NULL;
+    scene->blink_on = true;
+    scene->clear = true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_scene_add
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Ajoute un widget en fin de liste (ordre de rendu)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_scene_add(oled_scene_t* scene, oled_widget_t* widget) {
+    oled_widget_t** link = &scene->first;
+    while (*link) link = &(*link)->next;
+    widget->next = NULL;
+    widget->dirty = true;
+    *link = widget;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_scene_set_blink
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Nouvelle phase de clignotement ; marque les widgets concernés
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_scene_set_blink(oled_scene_t* scene, bool on) {
+    if (scene->blink_on == on) return;
+    scene->blink_on = on;
+    for (oled_widget_t* w = scene->first; w; w = w->next) {
+        if (w->blink && w->visible) w->dirty = true;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_scene_render
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Rendu incrémental de la scène dans le tampon arrière
+
+   --------------------------------------------------------------------------
+   Description:
+   Pour chaque widget modifié : efface le rectangle dessiné au rendu
+   précédent, puis dessine le widget s’il est visible (et allumé s’il
+   clignote). Les widgets ne se chevauchant pas, les autres restent
+   intacts dans le tampon arrière.
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si au moins un widget (ou l’écran) a été redessiné
+
+-- -------------------------------------------------------------------------- */
+bool oled_scene_render(oled_scene_t* scene) {
+    bool changed = false;
+
+    if (scene->clear) {
+        ssd1306_dev_clear_screen(scene->dev);
+        for (oled_widget_t* w = scene->first; w; w = w->next) {
+            w->drawn_w = 0;
+            w->dirty = true;
+        }
+        scene->clear = false;
+        changed = true;
+    }
+
+    for (oled_widget_t* w = scene->first; w; w = w->next) {
+        if (!w->dirty) continue;
+
+        if (w->drawn_w > 0) {
+            ssd1306_dev_fill_rect(scene->dev, w->drawn_x, w->drawn_y, w->drawn_w, w->drawn_h,
+                                  SSD1306_MODE_CLEAR);
+            w->drawn_w = 0;
+        }
+        if (w->visible && (!w->blink || scene->blink_on)) {
+            widget_draw(scene->dev, w);
+            w->drawn_x = w->x;
+            w->drawn_y = w->y;
+            w->drawn_w = w->w;
+            w->drawn_h = w->h;
+        }
+        w->dirty = false;
+        changed = true;
+    }
+    return changed;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_label_init / oled_label_set
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Texte : création et mise à jour (ignorée si le texte est identique)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_label_init(oled_widget_t* w, int x, uint8_t page, oled_font_t font, const char* text) {
+    widget_reset(w, OLED_WIDGET_LABEL);
+    w->x = (x < 0) ? 0 : x;
+    w->y = page * 8;
+    w->label.font = font;
+    w->label.centered = (x < 0);
+    strncpy(w->label.text, text, sizeof(w->label.text) - 1);
+    label_layout(w);
+}
+
+void oled_label_set(oled_widget_t* w, const char* text) {
+    if (strncmp(w->label.text, text, sizeof(w->label.text) - 1) == 0) return;
+    strncpy(w->label.text, text, sizeof(w->label.text) - 1);
+    w->label.text[sizeof(w->label.text) - 1] = '\0';
+    label_layout(w);
+    w->dirty = true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_gauge_init / oled_gauge_set
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Jauge : création et mise à jour (ignorée si le pourcentage est identique)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_gauge_init(oled_widget_t* w, int x, int y, int width, int height) {
+    widget_reset(w, OLED_WIDGET_GAUGE);
+    w->x = x;
+    w->y = y;
+    w->w = width;
+    w->h = height;
+}
+
+void oled_gauge_set(oled_widget_t* w, uint8_t percent) {
+    if (percent > 100) percent = 100;
+    if (w->gauge.percent == percent) return;
+    w->gauge.percent = percent;
+    w->dirty = true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_icon_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Icône au format page
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_icon_init(oled_widget_t* w, int x, int y, int width, int height, const uint8_t* data) {
+    widget_reset(w, OLED_WIDGET_ICON);
+    w->x = x;
+    w->y = y;
+    w->w = width;
+    w->h = height;
+    w->icon.data = data;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_widget_set_visible / oled_widget_set_blink
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Visibilité et clignotement (ignorés si inchangés)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void oled_widget_set_visible(oled_widget_t* w, bool visible) {
+    if (w->visible == visible) return;
+    w->visible = visible;
+    w->dirty = true;
+}
+
+void oled_widget_set_blink(oled_widget_t* w, bool blink) {
+    if (w->blink == blink) return;
+    w->blink = blink;
+    w->dirty = true;
+}
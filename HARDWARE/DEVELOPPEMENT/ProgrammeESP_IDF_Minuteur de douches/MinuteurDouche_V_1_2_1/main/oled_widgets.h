@@ -0,0 +1,180 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: oled_widgets.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Scène retenue pour l’écran OLED : une liste de widgets (texte, jauge,
+   icône) qui gardent leur valeur, leur rectangle englobant et un drapeau
+   de modification.
+   - Les setters ne marquent un widget modifié que si sa valeur change
+   - oled_scene_render() efface l’ancien rectangle et redessine seulement
+     les widgets modifiés dans le tampon arrière du panneau
+   - Le clignotement est une propriété du widget : la scène masque les
+     widgets clignotants pendant la phase éteinte
+
+   Les widgets et la scène appartiennent à l’appelant (aucune allocation) ;
+   les widgets d’une même scène ne doivent pas se chevaucher.
+
+-- ========================================================================== */
+
+#ifndef OLED_WIDGETS_H
+#define OLED_WIDGETS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ssd1306.h"
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define OLED_LABEL_MAX_LEN   24      // Caractères d’un texte, zéro final compris
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   ENUM: oled_widget_type_t
+   Nature du widget (détermine le champ utilisé dans oled_widget_t)
+-- -------------------------------------------------------------------------- */
+typedef enum {
+    OLED_WIDGET_LABEL,
+    OLED_WIDGET_GAUGE,
+    OLED_WIDGET_ICON
+} oled_widget_type_t;
+
+/* -------------------------------------------------------------------------- --
+   ENUM: oled_font_t
+   Police d’un texte : 6x8 agrandie 1 à 4 fois, ou grands chiffres 7
+   segments (4 lignes de haut, caractères "0123456789: -")
+-- -------------------------------------------------------------------------- */
+typedef enum {
+    OLED_FONT_SMALL = 1,
+    OLED_FONT_X2 = 2,
+    OLED_FONT_X3 = 3,
+    OLED_FONT_X4 = 4,
+    OLED_FONT_DIGITS = 0
+} oled_font_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: oled_widget_t
+   Widget d’une scène. Les champs se manipulent par les fonctions
+   oled_*_init / oled_*_set ci-dessous
+-- -------------------------------------------------------------------------- */
+typedef struct oled_widget {
+    oled_widget_type_t type;
+    int16_t x, y, w, h;             // Rectangle englobant (pixels)
+    int16_t drawn_x, drawn_y;       // Rectangle effectivement dessiné,
+    int16_t drawn_w, drawn_h;       // effacé au prochain rendu
+    bool dirty;                     // À redessiner au prochain rendu
+    bool visible;
+    bool blink;                     // Masqué pendant la phase éteinte
+
+    union {
+        struct {
+            char text[OLED_LABEL_MAX_LEN];
+            oled_font_t font;
+            bool centered;          // Centré horizontalement sur l’écran
+        } label;
+        struct {
+            uint8_t percent;        // 0 à 100
+        } gauge;
+        struct {
+            const uint8_t* data;    // Format page : (h + 7) / 8 bandes de w octets
+        } icon;
+    };
+
+    struct oled_widget* next;
+} oled_widget_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: oled_scene_t
+   Ensemble de widgets rendus sur un panneau
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    ssd1306_t* dev;
+    oled_widget_t* first;
+    bool blink_on;                  // Phase du clignotement
+    bool clear;                     // Effacer tout l’écran au prochain rendu
+} oled_scene_t;
+
+
+/**-------------------------------------------------------------------------- --
+   Scène
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_scene_init
+   Prépare une scène vide sur le panneau donné ; le premier rendu efface
+   l’écran
+-- -------------------------------------------------------------------------- */
+void oled_scene_init(oled_scene_t* scene, ssd1306_t* dev);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_scene_add
+   Ajoute un widget initialisé à la scène (dessiné au prochain rendu)
+-- -------------------------------------------------------------------------- */
+void oled_scene_add(oled_scene_t* scene, oled_widget_t* widget);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_scene_set_blink
+   Change la phase du clignotement : seuls les widgets clignotants sont
+   marqués modifiés, et seulement si la phase change
+-- -------------------------------------------------------------------------- */
+void oled_scene_set_blink(oled_scene_t* scene, bool on);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_scene_render
+   Redessine les widgets modifiés dans le tampon arrière du panneau.
+   À appeler entre display_begin() et display_commit()
+   Retour : true si le tampon arrière a changé
+-- -------------------------------------------------------------------------- */
+bool oled_scene_render(oled_scene_t* scene);
+
+
+/**-------------------------------------------------------------------------- --
+   Widgets
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_label_init
+   Texte en haut de la ligne page, à la colonne x (ou centré si x < 0)
+-- -------------------------------------------------------------------------- */
+void oled_label_init(oled_widget_t* w, int x, uint8_t page, oled_font_t font, const char* text);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_label_set
+   Remplace le texte (tronqué à OLED_LABEL_MAX_LEN - 1 caractères)
+-- -------------------------------------------------------------------------- */
+void oled_label_set(oled_widget_t* w, const char* text);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_gauge_init
+   Jauge horizontale : cadre de 1 pixel, remplissage de gauche à droite
+-- -------------------------------------------------------------------------- */
+void oled_gauge_init(oled_widget_t* w, int x, int y, int width, int height);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_gauge_set
+   Remplissage en pourcentage (borné à 100)
+-- -------------------------------------------------------------------------- */
+void oled_gauge_set(oled_widget_t* w, uint8_t percent);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_icon_init
+   Image au format page du SSD1306, dessinée en mode SET
+-- -------------------------------------------------------------------------- */
+void oled_icon_init(oled_widget_t* w, int x, int y, int width, int height, const uint8_t* data);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oled_widget_set_visible / oled_widget_set_blink
+   Affiche ou masque un widget ; le fait clignoter avec la scène
+-- -------------------------------------------------------------------------- */
+void oled_widget_set_visible(oled_widget_t* w, bool visible);
+void oled_widget_set_blink(oled_widget_t* w, bool blink);
+
+#endif // OLED_WIDGETS_H
@@ -0,0 +1,146 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: power_manager.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Configuration de la gestion d’énergie ESP-IDF (voir power_manager.h).
+
+   Sur ESP32, le contrôleur BLE interdit le light sleep tant que son
+   horloge basse consommation est le quartz principal
+   (CONFIG_BTDM_CTRL_LPCLK_SEL_MAIN_XTAL) : seuls la fréquence variable et
+   le modem sleep s’appliquent alors. Les cartes équipées d’un quartz
+   32 kHz (CONFIG_BTDM_CTRL_LPCLK_SEL_EXT_32K_XTAL) dorment en light sleep
+   entre deux événements radio.
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "power_manager.h"
+#include <stdio.h>
+#include "sdkconfig.h"
+#include "esp_pm.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define POWER_MIN_FREQ_MHZ      CONFIG_XTAL_FREQ            // CPU sur le quartz au repos
+#define POWER_DUMP_PERIOD_US    (10LL * 60 * 1000000)       // Profilage : toutes les 10 min
+
+static const char* TAG = "POWER";
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+#if CONFIG_PM_PROFILING
+/* -------------------------------------------------------------------------- --
+   FUNCTION: dump_cb
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Callback esp_timer périodique de la version de profilage
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+static void dump_cb(void *arg) {
+    power_manager_dump();
+}
+#endif
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: power_manager_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Active la fréquence variable et le light sleep automatique
+
+   --------------------------------------------------------------------------
+   Description:
+   - Fréquence maximale : celle de sdkconfig (CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ)
+   - Fréquence minimale : quartz (40 MHz), APB abaissé en conséquence
+   - Light sleep quand aucune tâche n’est prête et qu’aucun verrou ne
+     l’interdit (CONFIG_FREERTOS_USE_TICKLESS_IDLE)
+   - Version de profilage : esp_timer périodique qui publie la
+     répartition du temps par mode
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void power_manager_init(void) {
+#if CONFIG_PM_ENABLE
+    esp_pm_config_t config = {
+        .max_freq_mhz = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ,
+        .min_freq_mhz = POWER_MIN_FREQ_MHZ,
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE
+        .light_sleep_enable = true,
+#endif
+    };
+    esp_err_t err = esp_pm_configure(&config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "esp_pm_configure : %s", esp_err_to_name(err));
+        return;
+    }
+    ESP_LOGI(TAG, "DFS %d-%d MHz, light sleep %s", POWER_MIN_FREQ_MHZ,
+             CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, config.light_sleep_enable ? "actif" : "inactif");
+
+#if CONFIG_FREERTOS_USE_TICKLESS_IDLE && CONFIG_BTDM_CTRL_LPCLK_SEL_MAIN_XTAL
+    ESP_LOGW(TAG, "Horloge BLE sur quartz principal : light sleep bloque par le controleur");
+#endif
+
+#if CONFIG_PM_PROFILING
+    const esp_timer_create_args_t args = {
+        .callback = dump_cb,
+        .name = "pm_dump",
+    };
+    esp_timer_handle_t dump_timer;
+    if (esp_timer_create(&args, &dump_timer) == ESP_OK) {
+        esp_timer_start_periodic(dump_timer, POWER_DUMP_PERIOD_US);
+    }
+#endif
+#else
+    ESP_LOGI(TAG, "Gestion d'energie desactivee (CONFIG_PM_ENABLE)");
+#endif
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: power_manager_dump
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Publie l’état de la gestion d’énergie
+
+   --------------------------------------------------------------------------
+   Description:
+   esp_pm_dump_locks() liste les verrous tenus (BLE, pilotes) ; avec
+   CONFIG_PM_PROFILING elle donne aussi le temps cumulé par mode
+   (light sleep, APB_MIN, APB_MAX, CPU_FREQ_MAX)
+
+   --------------------------------------------------------------------------
+   Return value:
+   Aucun
+
+-- -------------------------------------------------------------------------- */
+void power_manager_dump(void) {
+#if CONFIG_PM_ENABLE
+    esp_pm_dump_locks(stdout);
+#endif
+}
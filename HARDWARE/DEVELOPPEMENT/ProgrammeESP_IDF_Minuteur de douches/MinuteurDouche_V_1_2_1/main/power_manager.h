@@ -0,0 +1,43 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: power_manager.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Gestion d’énergie entre deux douches :
+   - Fréquence CPU variable (DFS) : pleine vitesse seulement quand un
+     pilote ou le contrôleur BLE le demande
+   - Light sleep automatique au repos (FreeRTOS tickless idle), réveil
+     par le bouton (button_init) ou par un esp_timer
+   - Version de profilage (CONFIG_PM_PROFILING) : répartition du temps
+     par mode publiée périodiquement dans les logs, à multiplier par le
+     courant mesuré sur banc dans chaque mode
+
+-- ========================================================================== */
+
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: power_manager_init
+   Applique la configuration de gestion d’énergie (sans effet si
+   CONFIG_PM_ENABLE n’est pas activé). À appeler en fin d’initialisation,
+   une fois les pilotes et le BLE démarrés
+-- -------------------------------------------------------------------------- */
+void power_manager_init(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: power_manager_dump
+   Écrit dans la console les verrous de gestion d’énergie et, en version
+   de profilage, le temps passé dans chaque mode depuis le démarrage
+-- -------------------------------------------------------------------------- */
+void power_manager_dump(void);
+
+#endif // POWER_MANAGER_H
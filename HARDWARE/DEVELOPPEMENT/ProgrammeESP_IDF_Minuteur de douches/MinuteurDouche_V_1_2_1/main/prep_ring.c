@@ -0,0 +1,217 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: prep_ring.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Réassemblage des écritures longues BLE (voir prep_ring.h).
+
+   Les messages exécutés occupent l’anneau dans l’ordre d’arrivée. Tant
+   que le plus récent est après le plus ancien, la place libre est en fin
+   d’anneau puis avant le plus ancien ; une fois repartis au début, elle
+   est entre le plus récent et le plus ancien. Un message n’est jamais
+   coupé en deux : le consommateur le lit d’un seul bloc.
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "prep_ring.h"
+#include <string.h>
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: oldest_start
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Position du plus ancien message exécuté (cap si aucun)
+
+-- -------------------------------------------------------------------------- */
+static size_t oldest_start(const prep_ring_t* r) {
+    return r->count ? (size_t)(r->msgs[r->first].data - r->buf) : r->cap;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: fail
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Fragment refusé : le message sera rejeté à l’exécution
+
+   --------------------------------------------------------------------------
+   Return value:
+     false
+
+-- -------------------------------------------------------------------------- */
+static bool fail(prep_ring_t* r) {
+    r->state = PREP_FAILED;
+    return false;
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: prep_ring_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Anneau vide
+
+   --------------------------------------------------------------------------
+   Parameters:
+     r   : anneau
+     buf : stockage (statique chez l’appelant)
+     cap : sa taille
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void prep_ring_init(prep_ring_t* r, uint8_t* buf, size_t cap) {
+    memset(r, 0, sizeof(*r));
+    r->buf = buf;
+    r->cap = cap;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: prep_ring_prepare
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Ajoute un fragment au message en préparation
+
+   --------------------------------------------------------------------------
+   Description:
+   Le premier fragment ouvre le message derrière le plus récent. Les
+   suivants doivent viser le même attribut, à l’offset qui suit le
+   précédent (écriture longue d’un client). Quand le message atteint la
+   fin de l’anneau, il est recopié au début s’il y tient.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     r      : anneau
+     handle : attribut écrit
+     offset : position du fragment dans la valeur
+     data   : fragment
+     len    : sa longueur
+
+   --------------------------------------------------------------------------
+   Return value:
+     false si le fragment est refusé
+
+-- -------------------------------------------------------------------------- */
+bool prep_ring_prepare(prep_ring_t* r, uint16_t handle, uint16_t offset,
+                       const uint8_t* data, size_t len) {
+    if (r->state == PREP_FAILED) return false;
+    if (r->state == PREP_IDLE) {
+        r->state = PREP_PREPARING;
+        r->handle = handle;
+        r->start = r->count ? r->tail : 0;
+        r->len = 0;
+    }
+    if (handle != r->handle || offset != r->len) return fail(r);
+
+    // Place libre : jusqu’au plus ancien message s’il est devant, sinon jusqu’à la fin
+    size_t need = r->len + len;
+    size_t oldest = oldest_start(r);
+    size_t limit = (r->count && r->start <= oldest) ? oldest : r->cap;
+    if (r->start + need > limit) {
+        if (limit != r->cap || r->start == 0 || need > oldest) return fail(r);
+        memmove(r->buf, r->buf + r->start, r->len);
+        r->start = 0;
+    }
+    memcpy(r->buf + r->start + r->len, data, len);
+    r->len = need;
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: prep_ring_execute
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Termine le message en préparation
+
+   --------------------------------------------------------------------------
+   Parameters:
+     r   : anneau
+     msg : message remis (lisible jusqu’à sa libération)
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si un message est remis
+
+-- -------------------------------------------------------------------------- */
+bool prep_ring_execute(prep_ring_t* r, prep_msg_t* msg) {
+    prep_state_t state = r->state;
+
+    r->state = PREP_IDLE;
+    if (state == PREP_IDLE || (state == PREP_PREPARING && r->len == 0)) return false;
+    if (state == PREP_FAILED || r->count == PREP_RING_MSGS) {
+        r->rejected++;
+        return false;
+    }
+
+    prep_msg_t* m = &r->msgs[(r->first + r->count) % PREP_RING_MSGS];
+    m->handle = r->handle;
+    m->data = r->buf + r->start;
+    m->len = r->len;
+    r->count++;
+    r->tail = r->start + r->len;
+    r->executed++;
+    *msg = *m;
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: prep_ring_cancel
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Oublie le message en préparation
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void prep_ring_cancel(prep_ring_t* r) {
+    if (r->state != PREP_IDLE) r->cancelled++;
+    r->state = PREP_IDLE;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: prep_ring_release
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Rend la place du plus ancien message exécuté
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void prep_ring_release(prep_ring_t* r) {
+    if (r->count == 0) return;
+    r->first = (uint8_t)((r->first + 1) % PREP_RING_MSGS);
+    r->count--;
+    if (r->count == 0) r->tail = 0;
+}
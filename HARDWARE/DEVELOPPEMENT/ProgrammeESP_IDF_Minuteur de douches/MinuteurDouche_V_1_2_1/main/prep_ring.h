@@ -0,0 +1,123 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: prep_ring.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Réassemblage des écritures longues BLE (Prepare Write / Execute Write)
+   dans un anneau d’octets fourni par l’appelant, sans allocation :
+   - Préparation : les fragments d’un même attribut sont recopiés bout à
+     bout à leur offset ; un fragment hors ordre, d’un autre attribut ou
+     sans place fait rejeter le message à l’exécution
+   - Exécution : le message devient un bloc contigu (prep_msg_t), remis
+     au consommateur ; annulation : il est oublié
+   - Les messages exécutés restent lisibles jusqu’à prep_ring_release
+     (ordre d’arrivée, PREP_RING_MSGS au plus) ; un message en préparation
+     qui atteint la fin de l’anneau repart au début s’il y tient
+   L’appelant sérialise les appels ; aucune dépendance ESP-IDF : module
+   testé sur PC.
+
+-- ========================================================================== */
+
+#ifndef PREP_RING_H
+#define PREP_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define PREP_RING_MSGS          4           // Messages exécutés non libérés, au plus
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   ENUM: prep_state_t
+   État de l’écriture longue en cours
+-- -------------------------------------------------------------------------- */
+typedef enum {
+    PREP_IDLE,                         // Aucune écriture préparée
+    PREP_PREPARING,                    // Fragments reçus, en attente d’exécution
+    PREP_FAILED                        // Fragment refusé : message rejeté à l’exécution
+} prep_state_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: prep_msg_t
+   Message complet, contigu dans l’anneau
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint16_t handle;                   // Attribut écrit
+    const uint8_t* data;
+    size_t len;
+} prep_msg_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: prep_ring_t
+   Anneau de réassemblage
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint8_t* buf;
+    size_t cap;
+    size_t tail;                       // Fin du dernier message exécuté
+
+    prep_msg_t msgs[PREP_RING_MSGS];   // Messages exécutés, du plus ancien au plus récent
+    uint8_t first;
+    uint8_t count;
+
+    prep_state_t state;                // Message en préparation
+    uint16_t handle;
+    size_t start;
+    size_t len;
+
+    uint32_t executed;                 // Messages remis
+    uint32_t rejected;                 // Messages rejetés à l’exécution
+    uint32_t cancelled;
+} prep_ring_t;
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: prep_ring_init
+   Anneau vide sur buf (cap octets, alloué par l’appelant)
+-- -------------------------------------------------------------------------- */
+void prep_ring_init(prep_ring_t* r, uint8_t* buf, size_t cap);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: prep_ring_prepare
+   Fragment d’une écriture longue (ESP_GATTS_WRITE_EVT, is_prep)
+   Retour : false si le fragment est refusé (message rejeté à l’exécution)
+-- -------------------------------------------------------------------------- */
+bool prep_ring_prepare(prep_ring_t* r, uint16_t handle, uint16_t offset,
+                       const uint8_t* data, size_t len);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: prep_ring_execute
+   Exécution (ESP_GATTS_EXEC_WRITE_EVT) : message complet dans *msg
+   Retour : false si rien n’est remis (aucun fragment, message rejeté,
+   PREP_RING_MSGS messages non libérés)
+-- -------------------------------------------------------------------------- */
+bool prep_ring_execute(prep_ring_t* r, prep_msg_t* msg);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: prep_ring_cancel
+   Annulation par le client, ou déconnexion : message en préparation oublié
+-- -------------------------------------------------------------------------- */
+void prep_ring_cancel(prep_ring_t* r);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: prep_ring_release
+   Libère le plus ancien message exécuté (son bloc n’est plus lisible)
+-- -------------------------------------------------------------------------- */
+void prep_ring_release(prep_ring_t* r);
+
+#endif // PREP_RING_H
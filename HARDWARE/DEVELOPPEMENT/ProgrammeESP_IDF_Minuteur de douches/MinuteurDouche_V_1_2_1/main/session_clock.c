@@ -0,0 +1,174 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: session_clock.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Base de temps des sessions de douche :
+   - Lecture de l’horloge esp_timer (64 bits, microsecondes)
+   - Arithmétique des durées en int64_t : l’ancien calcul
+     xTaskGetTickCount() * portTICK_PERIOD_MS en uint32_t débordait après
+     49,7 jours de fonctionnement
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "session_clock.h"
+#include "esp_timer.h"
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_now_us
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Horloge monotone du firmware
+
+   --------------------------------------------------------------------------
+   Return value:
+     Microsecondes depuis le démarrage (esp_timer_get_time)
+
+-- -------------------------------------------------------------------------- */
+int64_t session_clock_now_us(void) {
+    return esp_timer_get_time();
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_start
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Ouvre une session
+
+   --------------------------------------------------------------------------
+   Parameters:
+     c           : session à initialiser
+     duration_us : durée allouée avant dépassement
+     now_us      : instant du démarrage
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void session_clock_start(session_clock_t* c, int64_t duration_us, int64_t now_us) {
+    c->start_us = now_us;
+    c->stop_us = 0;
+    c->duration_us = duration_us;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_stop
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Ferme la session ; un second arrêt ne change pas l’instant retenu
+
+   --------------------------------------------------------------------------
+   Parameters:
+     c      : session en cours
+     now_us : instant de l’arrêt
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void session_clock_stop(session_clock_t* c, int64_t now_us) {
+    if (c->stop_us != 0) return;
+    // 0 est réservé à "en cours" : un arrêt à l’instant 0 est décalé d’1 µs
+    c->stop_us = (now_us > c->start_us) ? now_us : c->start_us + 1;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_running
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la session n’a pas été arrêtée
+
+-- -------------------------------------------------------------------------- */
+bool session_clock_running(const session_clock_t* c) {
+    return c->stop_us == 0;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_elapsed_us
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Durée de la session, bornée à l’arrêt s’il a eu lieu
+
+   --------------------------------------------------------------------------
+   Return value:
+     Microsecondes écoulées, 0 si now_us précède le démarrage
+
+-- -------------------------------------------------------------------------- */
+int64_t session_clock_elapsed_us(const session_clock_t* c, int64_t now_us) {
+    int64_t end = (c->stop_us != 0) ? c->stop_us : now_us;
+    return (end > c->start_us) ? end - c->start_us : 0;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_remaining_us
+
+   --------------------------------------------------------------------------
+   Return value:
+     Microsecondes avant l’échéance, 0 au-delà
+
+-- -------------------------------------------------------------------------- */
+int64_t session_clock_remaining_us(const session_clock_t* c, int64_t now_us) {
+    int64_t elapsed = session_clock_elapsed_us(c, now_us);
+    return (elapsed < c->duration_us) ? c->duration_us - elapsed : 0;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_overtime_us
+
+   --------------------------------------------------------------------------
+   Return value:
+     Microsecondes de dépassement, 0 avant l’échéance
+
+-- -------------------------------------------------------------------------- */
+int64_t session_clock_overtime_us(const session_clock_t* c, int64_t now_us) {
+    int64_t elapsed = session_clock_elapsed_us(c, now_us);
+    return (elapsed > c->duration_us) ? elapsed - c->duration_us : 0;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_next_tick_us
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Délai jusqu’à la prochaine frontière de seconde de la session
+
+   --------------------------------------------------------------------------
+   Description:
+   Les frontières sont comptées depuis start_us : le réveil tombe sur le
+   changement de seconde affiché, sans dérive d’un tick à l’autre ; une
+   durée allouée en secondes entières est l’une de ces frontières.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Délai en microsecondes, dans ]0 ; 1 s]
+
+-- -------------------------------------------------------------------------- */
+int64_t session_clock_next_tick_us(const session_clock_t* c, int64_t now_us) {
+    int64_t elapsed = session_clock_elapsed_us(c, now_us);
+    return SESSION_US_PER_S - elapsed % SESSION_US_PER_S;
+}
@@ -0,0 +1,110 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: session_clock.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Base de temps des sessions de douche :
+   - Horloge monotone 64 bits en microsecondes (esp_timer), commune à tout
+     le firmware : pas de débordement sur la durée de vie d’un appareil
+   - Début, arrêt et dépassement d’une session en microsecondes
+   - Calcul de la prochaine frontière de seconde de la session
+
+   Toutes les fonctions de calcul reçoivent l’instant "now_us" : elles ne
+   lisent pas l’horloge elles-mêmes et restent testables sur PC.
+
+-- ========================================================================== */
+
+#ifndef SESSION_CLOCK_H
+#define SESSION_CLOCK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define SESSION_US_PER_MS    1000LL
+#define SESSION_US_PER_S     1000000LL
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: session_clock_t
+   Chronologie d’une session (base session_clock_now_us) :
+     - start_us    : instant du démarrage
+     - stop_us     : instant de l’arrêt, 0 tant que la session court
+     - duration_us : durée allouée avant dépassement
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    int64_t start_us;
+    int64_t stop_us;
+    int64_t duration_us;
+} session_clock_t;
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_now_us
+   Horloge monotone du firmware en microsecondes depuis le démarrage
+-- -------------------------------------------------------------------------- */
+int64_t session_clock_now_us(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_start
+   Ouvre une session de durée "duration_us" à l’instant "now_us"
+-- -------------------------------------------------------------------------- */
+void session_clock_start(session_clock_t* c, int64_t duration_us, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_stop
+   Fige la session à l’instant "now_us" (les durées ne bougent plus)
+-- -------------------------------------------------------------------------- */
+void session_clock_stop(session_clock_t* c, int64_t now_us);
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions utilitaires
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_running
+   Vrai entre session_clock_start et session_clock_stop
+-- -------------------------------------------------------------------------- */
+bool session_clock_running(const session_clock_t* c);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_elapsed_us
+   Durée écoulée depuis le démarrage (jusqu’à l’arrêt si la session est
+   close) ; jamais négative
+-- -------------------------------------------------------------------------- */
+int64_t session_clock_elapsed_us(const session_clock_t* c, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_remaining_us
+   Temps restant avant l’échéance, 0 une fois l’échéance atteinte
+-- -------------------------------------------------------------------------- */
+int64_t session_clock_remaining_us(const session_clock_t* c, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_overtime_us
+   Dépassement au-delà de l’échéance, 0 avant l’échéance
+-- -------------------------------------------------------------------------- */
+int64_t session_clock_overtime_us(const session_clock_t* c, int64_t now_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_clock_next_tick_us
+   Délai jusqu’à la prochaine seconde entière comptée depuis le démarrage
+   (entre 1 µs et 1 s)
+-- -------------------------------------------------------------------------- */
+int64_t session_clock_next_tick_us(const session_clock_t* c, int64_t now_us);
+
+#endif // SESSION_CLOCK_H
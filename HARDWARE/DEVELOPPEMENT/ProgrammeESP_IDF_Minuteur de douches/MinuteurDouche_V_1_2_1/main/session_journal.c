@@ -0,0 +1,503 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: session_journal.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Journal hors ligne des douches (voir session_journal.h) :
+   - Partition de données "journal" (partitions.csv) lue et écrite par
+     esp_partition, format géré par journal_ring
+   - Un seul lot en vol : le suivant n’est préparé qu’après l’acquittement
+     du précédent, ce qui règle le débit sur celui du pont et du backend
+   - Numéro de démarrage incrémenté en NVS à chaque mise sous tension :
+     les débuts de douche sont datés par rapport à ce démarrage
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "session_journal.h"
+#include "journal_ring.h"
+#include "session_clock.h"
+#include "esp_partition.h"
+#include "nvs.h"
+#include "esp_log.h"
+#include <string.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define JOURNAL_PARTITION   "journal"
+#define NVS_NAMESPACE       "minuteur"
+#define NVS_KEY_ACK         "jrn_ack"
+#define NVS_KEY_BOOT        "boot"
+
+static const char* TAG = "JOURNAL";
+
+/**-------------------------------------------------------------------------- --
+   Static variables
+-- -------------------------------------------------------------------------- */
+static journal_ring_t ring;
+static bool ready = false;                // Partition trouvée et lue
+static uint16_t boot_id = 0;              // Numéro de ce démarrage
+static uint32_t acked_seq = 0;            // Dernier numéro enregistré par le pont
+static uint32_t sent_seq = 0;             // Dernier numéro du lot en vol
+static journal_cursor_t cursor;           // Position du prochain lot
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: part_read / part_write / part_erase
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Accès flash de journal_ring sur la partition ESP-IDF
+
+   --------------------------------------------------------------------------
+   Return value:
+     0 (ESP_OK) ou code d’erreur esp_partition
+
+-- -------------------------------------------------------------------------- */
+static int part_read(void* ctx, uint32_t offset, void* dst, size_t len) {
+    return esp_partition_read((const esp_partition_t*)ctx, offset, dst, len);
+}
+
+static int part_write(void* ctx, uint32_t offset, const void* src, size_t len) {
+    return esp_partition_write((const esp_partition_t*)ctx, offset, src, len);
+}
+
+static int part_erase(void* ctx, uint32_t offset, size_t len) {
+    return esp_partition_erase_range((const esp_partition_t*)ctx, offset, len);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: nvs_load_state
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Lit le dernier acquittement et incrémente le numéro de démarrage
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void nvs_load_state(void) {
+    nvs_handle_t h;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &h) != ESP_OK) return;
+
+    nvs_get_u32(h, NVS_KEY_ACK, &acked_seq);
+    nvs_get_u16(h, NVS_KEY_BOOT, &boot_id);
+    boot_id++;
+    if (nvs_set_u16(h, NVS_KEY_BOOT, boot_id) == ESP_OK) nvs_commit(h);
+    nvs_close(h);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: nvs_save_ack
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Mémorise le dernier numéro acquitté (une écriture par lot)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void nvs_save_ack(void) {
+    nvs_handle_t h;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &h) != ESP_OK) return;
+
+    if (nvs_set_u32(h, NVS_KEY_ACK, acked_seq) == ESP_OK) nvs_commit(h);
+    nvs_close(h);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: fill_record
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Enregistrement du journal d’une douche terminée (seq et crc à 0)
+
+   --------------------------------------------------------------------------
+   Parameters:
+     rec         : enregistrement à remplir
+     stall       : cabine
+     user        : nom de l’utilisateur
+     start_us    : début (session_clock_now_us)
+     duration_us : durée totale
+     overtime_us : dépassement
+     flow        : eau mesurée (NULL : pas de débitmètre)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void fill_record(journal_record_t* rec, uint8_t stall, const char* user, int64_t start_us,
+                        int64_t duration_us, int64_t overtime_us, const flow_result_t* flow) {
+    memset(rec, 0, sizeof(*rec));
+    rec->boot = boot_id;
+    rec->stall = stall;
+    rec->start_s = (uint32_t)(start_us / SESSION_US_PER_S);
+    rec->duration_ms = (uint32_t)(duration_us / SESSION_US_PER_MS);
+    rec->overtime_ms = (uint32_t)(overtime_us / SESSION_US_PER_MS);
+    rec->flags = JOURNAL_FLAG_MS;
+    strncpy(rec->user, user, sizeof(rec->user) - 1);
+    if (flow) {
+        rec->volume_ml = flow->volume_ml;
+        rec->peak_ml_min = flow->peak_ml_min > UINT16_MAX ? UINT16_MAX : (uint16_t)flow->peak_ml_min;
+        rec->flags |= JOURNAL_FLAG_FLOW;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: to_session_record
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Douche du journal telle qu’envoyée au pont (voir session_record.h)
+
+   --------------------------------------------------------------------------
+   Description:
+   Les enregistrements des anciens firmwares (sans JOURNAL_FLAG_MS) ont
+   leurs durées en secondes : elles sont converties en ms.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     rec : enregistrement lu
+     out : douche à envoyer
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void to_session_record(const journal_record_t* rec, session_record_t* out) {
+    uint32_t unit = (rec->flags & JOURNAL_FLAG_MS) ? 1u : 1000u;
+
+    memset(out, 0, sizeof(*out));
+    out->seq = rec->seq;
+    out->boot = rec->boot;
+    out->stall = (uint8_t)rec->stall;
+    out->start_s = rec->start_s;
+    out->duration_ms = rec->duration_ms * unit;
+    out->overtime_ms = rec->overtime_ms * unit;
+    if (rec->flags & JOURNAL_FLAG_FLOW) {
+        out->flags |= SESSION_RECORD_FLOW;
+        out->volume_ml = rec->volume_ml;
+        out->peak_ml_min = rec->peak_ml_min;
+    }
+    memcpy(out->user, rec->user, sizeof(out->user));
+    out->user[sizeof(out->user) - 1] = '\0';
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Ouvre le journal et reprend l’état de synchronisation
+
+   --------------------------------------------------------------------------
+   Description:
+   Un acquittement supérieur au dernier numéro du journal (partition
+   effacée au flash) fait continuer la numérotation au-delà : le backend
+   ne confond pas les nouvelles douches avec celles déjà reçues.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void session_journal_init(void) {
+    const esp_partition_t* part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           ESP_PARTITION_SUBTYPE_ANY,
+                                                           JOURNAL_PARTITION);
+    nvs_load_state();
+
+    if (part == NULL) {
+        ESP_LOGE(TAG, "Partition \"%s\" absente : douches hors ligne non conservees", JOURNAL_PARTITION);
+        return;
+    }
+
+    journal_flash_t flash = {
+        .read = part_read,
+        .write = part_write,
+        .erase = part_erase,
+        .ctx = (void*)part,
+        .size = part->size,
+        .sector_size = part->erase_size,
+    };
+    if (!journal_ring_open(&ring, &flash)) {
+        ESP_LOGE(TAG, "Lecture du journal impossible");
+        return;
+    }
+
+    if (acked_seq > ring.last_seq) ring.last_seq = acked_seq;
+    sent_seq = acked_seq;
+    journal_ring_cursor(&ring, &cursor);
+    ready = true;
+
+    ESP_LOGI(TAG, "Journal : dernier %lu, acquitte %lu, demarrage %u",
+             (unsigned long)ring.last_seq, (unsigned long)acked_seq, boot_id);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_append
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Écrit une douche terminée dans le journal
+
+   --------------------------------------------------------------------------
+   Description:
+   Le journal garde au moins (cases - cases d’un secteur) douches : au-delà,
+   les plus anciennes non transmises sont écrasées, ce qui est signalé.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall       : cabine
+     user        : nom de l’utilisateur
+     start_us    : début (session_clock_now_us)
+     duration_us : durée totale
+     overtime_us : dépassement
+     flow        : eau mesurée (NULL : pas de débitmètre)
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la douche est enregistrée
+
+-- -------------------------------------------------------------------------- */
+bool session_journal_append(uint8_t stall, const char* user, int64_t start_us,
+                            int64_t duration_us, int64_t overtime_us,
+                            const flow_result_t* flow) {
+    if (!ready) return false;
+
+    journal_record_t rec;
+    fill_record(&rec, stall, user, start_us, duration_us, overtime_us, flow);
+
+    uint32_t seq = journal_ring_append(&ring, &rec);
+    if (seq == JOURNAL_SEQ_NONE) {
+        ESP_LOGE(TAG, "Ecriture du journal impossible");
+        return false;
+    }
+
+    uint32_t keep = ring.slots - ring.flash.sector_size / JOURNAL_RECORD_SIZE;
+    if (seq - acked_seq > keep) {
+        ESP_LOGW(TAG, "Journal plein : %lu douches non transmises, les plus anciennes sont perdues",
+                 (unsigned long)(seq - acked_seq));
+    }
+    ESP_LOGI(TAG, "Douche %lu journalisee (%s, cabine %u, %lu ms)", (unsigned long)seq, rec.user,
+             (unsigned)stall, (unsigned long)rec.duration_ms);
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_rewind
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Oublie le lot en vol (perdu avec l’ancienne connexion)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void session_journal_rewind(void) {
+    sent_seq = acked_seq;
+    if (ready) journal_ring_cursor(&ring, &cursor);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_batch
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Prépare le lot suivant de la synchronisation (un bloc DATA_NOTIFY)
+
+   --------------------------------------------------------------------------
+   Description:
+   Le curseur n’avance que sur les douches placées dans la trame : celle
+   qui ne tient plus ouvre le lot suivant. Un parcours complet du journal
+   lit chaque case une fois, quel que soit le nombre de lots ; une douche
+   écrite derrière le curseur est trouvée par le parcours suivant.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     buf : tampon d’au moins max octets
+     max : taille du lot (JOURNAL_BATCH_MAX), au moins
+           SESSION_FRAME_MIN_LEN ; ble_tx le fragmente ensuite à la
+           taille du MTU
+
+   --------------------------------------------------------------------------
+   Return value:
+     Longueur du lot, 0 s’il n’y a rien à envoyer maintenant
+
+-- -------------------------------------------------------------------------- */
+size_t session_journal_batch(uint8_t* buf, size_t max) {
+    if (!ready || sent_seq != acked_seq || acked_seq == ring.last_seq) return 0;
+
+    session_frame_t frame;
+    bool restarted = false;
+
+    session_frame_begin(&frame, buf, max, boot_id,
+                        (uint32_t)(session_clock_now_us() / SESSION_US_PER_S));
+
+    while (1) {
+        journal_cursor_t before = cursor;
+        journal_record_t rec;
+
+        if (!journal_ring_next(&ring, &cursor, sent_seq, &rec)) {
+            // Fin du parcours : le suivant repart de la case d’écriture
+            journal_ring_cursor(&ring, &cursor);
+            if (frame.count == 0 && !restarted) {
+                restarted = true;
+                continue;
+            }
+            break;
+        }
+
+        session_record_t out;
+        to_session_record(&rec, &out);
+        if (!session_frame_add(&frame, &out)) {
+            cursor = before;
+            break;
+        }
+        sent_seq = rec.seq;
+    }
+    return session_frame_end(&frame);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_unsaved
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Trame d’une douche qui n’a pas pu être journalisée
+
+   --------------------------------------------------------------------------
+   Parameters:
+     buf, max    : destination (max >= SESSION_FRAME_MIN_LEN)
+     stall ...   : comme session_journal_append
+
+   --------------------------------------------------------------------------
+   Return value:
+     Longueur de la trame
+
+-- -------------------------------------------------------------------------- */
+size_t session_journal_unsaved(uint8_t* buf, size_t max, uint8_t stall, const char* user,
+                               int64_t start_us, int64_t duration_us, int64_t overtime_us,
+                               const flow_result_t* flow) {
+    journal_record_t rec;
+    session_record_t out;
+    session_frame_t frame;
+
+    fill_record(&rec, stall, user, start_us, duration_us, overtime_us, flow);
+    to_session_record(&rec, &out);
+    session_frame_begin(&frame, buf, max, boot_id,
+                        (uint32_t)(session_clock_now_us() / SESSION_US_PER_S));
+    session_frame_add(&frame, &out);
+    return session_frame_end(&frame);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_ack
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Enregistre l’acquittement du pont
+
+   --------------------------------------------------------------------------
+   Parameters:
+     seq : dernier numéro enregistré par le backend
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si le lot en vol est entièrement acquitté (lot suivant possible)
+
+-- -------------------------------------------------------------------------- */
+bool session_journal_ack(uint32_t seq) {
+    if (!ready || seq > ring.last_seq) return false;
+
+    if (seq > acked_seq) {
+        acked_seq = seq;
+        nvs_save_ack();
+    }
+    if (sent_seq < acked_seq) sent_seq = acked_seq;
+    return sent_seq == acked_seq;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_replay
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Reprend la transmission après seq
+
+   --------------------------------------------------------------------------
+   Description:
+   Le pont déclare n’avoir enregistré que jusqu’à seq (backend restauré,
+   historique à reconstruire) : l’acquittement recule, le lot en vol est
+   oublié et le parcours repart de la plus ancienne case. Les douches
+   renvoyées sont acquittées comme les autres.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     seq : dernier numéro que le pont garde
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la transmission reprend après seq
+
+-- -------------------------------------------------------------------------- */
+bool session_journal_replay(uint32_t seq) {
+    if (!ready || seq > ring.last_seq) return false;
+
+    if (seq != acked_seq) {
+        acked_seq = seq;
+        nvs_save_ack();
+    }
+    session_journal_rewind();
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_pending
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Douches en attente de transmission
+
+   --------------------------------------------------------------------------
+   Return value:
+     Nombre de douches non acquittées
+
+-- -------------------------------------------------------------------------- */
+uint32_t session_journal_pending(void) {
+    return ready ? ring.last_seq - acked_seq : 0;
+}
@@ -0,0 +1,104 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: session_journal.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Journal hors ligne des douches terminées :
+   - Chaque douche est écrite dans la partition "journal" (journal_ring)
+     avant toute tentative d’envoi BLE : rien n’est perdu si le pont est
+     hors de portée
+   - À la reconnexion, tout ce qui n’a pas été acquitté est renvoyé par
+     lots de la taille d’une notification ; le lot suivant part à la
+     réception de "ACK:<seq>" (dernier numéro enregistré par le pont)
+   - Dernier numéro acquitté et numéro de démarrage conservés en NVS
+   Seule timer_manager_task appelle ce module (pas de verrou).
+
+   Un lot est une trame binaire session_record (voir session_record.h),
+   une douche par enregistrement. Les douches écrites par les anciens
+   firmwares y figurent avec leurs durées en secondes converties en ms,
+   la cabine 0 et sans mesure d’eau.
+
+-- ========================================================================== */
+
+#ifndef SESSION_JOURNAL_H
+#define SESSION_JOURNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "flow_accum.h"
+#include "session_record.h"
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_init
+   Ouvre la partition du journal (après nvs_flash_init) ; sans partition,
+   le journal est désactivé et les douches ne sont plus conservées
+-- -------------------------------------------------------------------------- */
+void session_journal_init(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_append
+   Enregistre une douche terminée dans la cabine "stall" (instants
+   session_clock, en µs) ; flow : eau mesurée, NULL sans débitmètre
+   Retour : false si le journal est désactivé ou l’écriture échoue
+-- -------------------------------------------------------------------------- */
+bool session_journal_append(uint8_t stall, const char* user, int64_t start_us,
+                            int64_t duration_us, int64_t overtime_us,
+                            const flow_result_t* flow);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_rewind
+   Nouvelle connexion : le prochain lot repart du dernier acquittement
+-- -------------------------------------------------------------------------- */
+void session_journal_rewind(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_batch
+   Prépare le lot suivant dans buf : une trame d’au plus max octets
+   (max >= SESSION_FRAME_MIN_LEN), au moins une douche
+   Retour : longueur du lot, 0 si tout est transmis ou si le lot précédent
+   attend son acquittement
+-- -------------------------------------------------------------------------- */
+size_t session_journal_batch(uint8_t* buf, size_t max);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_unsaved
+   Trame d’une seule douche, hors journal (partition absente ou écriture
+   impossible) : numéro SESSION_RECORD_SEQ_NONE, le pont ne l’acquitte pas
+   Retour : longueur de la trame
+-- -------------------------------------------------------------------------- */
+size_t session_journal_unsaved(uint8_t* buf, size_t max, uint8_t stall, const char* user,
+                               int64_t start_us, int64_t duration_us, int64_t overtime_us,
+                               const flow_result_t* flow);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_ack
+   Le pont a enregistré toutes les douches jusqu’à seq
+   Retour : true si le lot en attente est entièrement acquitté
+-- -------------------------------------------------------------------------- */
+bool session_journal_ack(uint32_t seq);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_replay
+   Historique demandé par le pont : le journal est renvoyé à partir de la
+   douche qui suit seq (acquittement ramené à seq, au plus le dernier
+   numéro écrit ; les douches effacées par la rotation sont perdues)
+   Retour : false si le journal est désactivé ou seq inconnu
+-- -------------------------------------------------------------------------- */
+bool session_journal_replay(uint32_t seq);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_journal_pending
+   Nombre de douches enregistrées et non acquittées
+-- -------------------------------------------------------------------------- */
+uint32_t session_journal_pending(void);
+
+#endif // SESSION_JOURNAL_H
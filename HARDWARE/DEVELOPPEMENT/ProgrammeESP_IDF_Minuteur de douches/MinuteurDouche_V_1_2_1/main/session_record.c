@@ -0,0 +1,197 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: session_record.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Codage et décodage des trames de douches (voir session_record.h).
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "session_record.h"
+#include "crc32.h"
+#include <string.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define CRC_LEN         offsetof(session_record_wire_t, crc)
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_frame_begin
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Prépare une trame vide
+
+   --------------------------------------------------------------------------
+   Parameters:
+     f        : trame
+     buf      : destination
+     cap      : place disponible
+     boot     : démarrage en cours
+     uptime_s : secondes depuis ce démarrage
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void session_frame_begin(session_frame_t* f, uint8_t* buf, size_t cap,
+                         uint16_t boot, uint32_t uptime_s) {
+    session_frame_header_t h;
+
+    memset(&h, 0, sizeof(h));
+    h.magic = SESSION_FRAME_MAGIC;
+    h.version = SESSION_RECORD_VERSION;
+    h.record_size = sizeof(session_record_wire_t);
+    h.boot = boot;
+    h.uptime_s = uptime_s;
+
+    f->buf = buf;
+    f->cap = cap;
+    f->count = 0;
+    f->len = 0;
+    if (cap >= sizeof(h)) {
+        memcpy(buf, &h, sizeof(h));
+        f->len = sizeof(h);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_frame_add
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Ajoute une douche à la trame
+
+   --------------------------------------------------------------------------
+   Parameters:
+     f   : trame commencée par session_frame_begin
+     rec : douche
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la douche est dans la trame
+
+-- -------------------------------------------------------------------------- */
+bool session_frame_add(session_frame_t* f, const session_record_t* rec) {
+    session_record_wire_t w;
+
+    if (f->len == 0 || f->count == UINT8_MAX || f->len + sizeof(w) > f->cap) return false;
+
+    memset(&w, 0, sizeof(w));
+    w.seq = rec->seq;
+    w.boot = rec->boot;
+    w.stall = rec->stall;
+    w.flags = rec->flags;
+    w.start_s = rec->start_s;
+    w.duration_ms = rec->duration_ms;
+    w.overtime_ms = rec->overtime_ms;
+    w.volume_ml = rec->volume_ml;
+    w.peak_ml_min = rec->peak_ml_min;
+    strncpy(w.user, rec->user, sizeof(w.user) - 1);
+    w.crc = crc32_calc(&w, CRC_LEN);
+
+    memcpy(f->buf + f->len, &w, sizeof(w));
+    f->len += sizeof(w);
+    f->count++;
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_frame_end
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Écrit le nombre d’enregistrements dans l’en-tête
+
+   --------------------------------------------------------------------------
+   Return value:
+     Longueur de la trame, 0 si elle ne contient aucune douche
+
+-- -------------------------------------------------------------------------- */
+size_t session_frame_end(session_frame_t* f) {
+    if (f->count == 0) return 0;
+    f->buf[offsetof(session_frame_header_t, count)] = f->count;
+    return f->len;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_frame_decode
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Relit une trame reçue
+
+   --------------------------------------------------------------------------
+   Description:
+   La trame est rejetée en entier au moindre défaut (magique, version,
+   longueur, CRC d’un enregistrement) : le pont ne l’acquitte pas et
+   elle est renvoyée.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     buf  : trame
+     len  : longueur reçue
+     info : en-tête relu
+     out  : enregistrements relus
+     max  : place dans out
+
+   --------------------------------------------------------------------------
+   Return value:
+     Nombre d’enregistrements (au plus max), -1 si la trame est invalide
+
+-- -------------------------------------------------------------------------- */
+int session_frame_decode(const uint8_t* buf, size_t len, session_frame_info_t* info,
+                         session_record_t* out, size_t max) {
+    session_frame_header_t h;
+
+    if (len < sizeof(h)) return -1;
+    memcpy(&h, buf, sizeof(h));
+    if (h.magic != SESSION_FRAME_MAGIC || h.version != SESSION_RECORD_VERSION ||
+        h.record_size != sizeof(session_record_wire_t) ||
+        len != sizeof(h) + (size_t)h.count * sizeof(session_record_wire_t)) {
+        return -1;
+    }
+
+    info->version = h.version;
+    info->count = h.count;
+    info->boot = h.boot;
+    info->uptime_s = h.uptime_s;
+
+    size_t n = 0;
+    for (uint8_t i = 0; i < h.count; i++) {
+        session_record_wire_t w;
+        memcpy(&w, buf + sizeof(h) + (size_t)i * sizeof(w), sizeof(w));
+        if (w.crc != crc32_calc(&w, CRC_LEN)) return -1;
+        if (n == max) continue;
+
+        session_record_t* r = &out[n++];
+        r->seq = w.seq;
+        r->boot = w.boot;
+        r->stall = w.stall;
+        r->flags = w.flags;
+        r->start_s = w.start_s;
+        r->duration_ms = w.duration_ms;
+        r->overtime_ms = w.overtime_ms;
+        r->volume_ml = w.volume_ml;
+        r->peak_ml_min = w.peak_ml_min;
+        memcpy(r->user, w.user, sizeof(r->user));
+        r->user[sizeof(r->user) - 1] = '\0';
+    }
+    return (int)n;
+}
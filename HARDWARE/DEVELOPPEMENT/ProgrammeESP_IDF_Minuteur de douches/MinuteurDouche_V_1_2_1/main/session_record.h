@@ -0,0 +1,157 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: session_record.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Format binaire des douches envoyées au pont (notification DATA) :
+   - Une trame = un en-tête session_frame_header_t puis "count"
+     enregistrements session_record_wire_t de taille fixe, autant qu’en
+     tient une notification (MTU - 3)
+   - Little-endian, champs à position fixe ; chaque enregistrement porte
+     son CRC-32 (polynôme réfléchi 0xEDB88320, celui de zlib.crc32)
+   - Le premier octet (SESSION_FRAME_MAGIC) n’est pas un caractère ASCII :
+     le pont distingue une trame des lignes texte des anciens firmwares
+   - L’en-tête donne le démarrage en cours et son âge : le pont en déduit
+     la date de début des douches de ce démarrage (pas d’horloge
+     calendaire sur la carte)
+   Le décodeur Python du pont (session_record.py) suit la même
+   description ; les deux sont vérifiés sur la même trame de référence.
+   Aucune dépendance ESP-IDF : module testé sur PC.
+
+   Format (little-endian, version SESSION_RECORD_VERSION) :
+     session_frame_header_t, puis count × session_record_wire_t
+
+-- ========================================================================== */
+
+#ifndef SESSION_RECORD_H
+#define SESSION_RECORD_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define SESSION_FRAME_MAGIC         0xD5
+#define SESSION_RECORD_VERSION      1
+#define SESSION_RECORD_USER_MAX     32          // Nom, '\0' compris
+#define SESSION_RECORD_SEQ_NONE     0u          // Douche hors journal (pas d’acquittement)
+
+#define SESSION_RECORD_FLOW         0x01        // volume_ml et peak_ml_min mesurés (flags)
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: session_record_t
+   Douche terminée ; start_s est compté depuis le démarrage "boot"
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint32_t seq;                      // Numéro du journal (SESSION_RECORD_SEQ_NONE : hors journal)
+    uint16_t boot;                     // Numéro de démarrage
+    uint8_t stall;                     // Cabine
+    uint8_t flags;                     // SESSION_RECORD_*
+    uint32_t start_s;
+    uint32_t duration_ms;              // Durée totale
+    uint32_t overtime_ms;              // Dont dépassement de la durée allouée
+    uint32_t volume_ml;
+    uint16_t peak_ml_min;
+    char user[SESSION_RECORD_USER_MAX];
+} session_record_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: session_frame_info_t
+   En-tête d’une trame relue
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint8_t version;
+    uint8_t count;                     // Enregistrements de la trame
+    uint16_t boot;                     // Démarrage en cours à l’envoi
+    uint32_t uptime_s;                 // Secondes depuis ce démarrage, à l’envoi
+} session_frame_info_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: session_frame_header_t / session_record_wire_t
+   Format binaire transmis en BLE
+-- -------------------------------------------------------------------------- */
+typedef struct __attribute__((packed)) {
+    uint8_t magic;                     // SESSION_FRAME_MAGIC
+    uint8_t version;
+    uint8_t count;
+    uint8_t record_size;               // sizeof(session_record_wire_t)
+    uint16_t boot;
+    uint32_t uptime_s;
+} session_frame_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t seq;
+    uint16_t boot;
+    uint8_t stall;
+    uint8_t flags;
+    uint32_t start_s;
+    uint32_t duration_ms;
+    uint32_t overtime_ms;
+    uint32_t volume_ml;
+    uint16_t peak_ml_min;
+    char user[SESSION_RECORD_USER_MAX];    // Complété par des '\0'
+    uint32_t crc;                          // CRC-32 des 58 octets précédents
+} session_record_wire_t;
+
+_Static_assert(sizeof(session_frame_header_t) == 10, "taille d'en-tete");
+_Static_assert(sizeof(session_record_wire_t) == 62, "taille d'enregistrement");
+
+#define SESSION_FRAME_MIN_LEN   (sizeof(session_frame_header_t) + sizeof(session_record_wire_t))
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: session_frame_t
+   Trame en cours de construction
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint8_t* buf;
+    size_t cap;                        // Place disponible (charge d’une notification)
+    size_t len;
+    uint8_t count;
+} session_frame_t;
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_frame_begin
+   Commence une trame dans buf (cap octets, au moins SESSION_FRAME_MIN_LEN)
+-- -------------------------------------------------------------------------- */
+void session_frame_begin(session_frame_t* f, uint8_t* buf, size_t cap,
+                         uint16_t boot, uint32_t uptime_s);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_frame_add
+   Ajoute un enregistrement
+   Retour : false s’il ne tient plus dans la trame
+-- -------------------------------------------------------------------------- */
+bool session_frame_add(session_frame_t* f, const session_record_t* rec);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_frame_end
+   Termine la trame
+   Retour : longueur à envoyer, 0 si elle est vide
+-- -------------------------------------------------------------------------- */
+size_t session_frame_end(session_frame_t* f);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: session_frame_decode
+   Relit une trame (en-tête, longueur et CRC vérifiés) ; au plus max
+   enregistrements sont rendus dans out
+   Retour : nombre d’enregistrements, -1 si la trame est invalide
+-- -------------------------------------------------------------------------- */
+int session_frame_decode(const uint8_t* buf, size_t len, session_frame_info_t* info,
+                         session_record_t* out, size_t max);
+
+#endif // SESSION_RECORD_H
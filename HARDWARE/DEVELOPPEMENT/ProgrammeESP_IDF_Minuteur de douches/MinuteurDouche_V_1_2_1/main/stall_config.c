@@ -0,0 +1,42 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: stall_config.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Table des cabines de la carte (voir stall_config.h).
+   - Boutons : toute broche d’entrée avec pull-up interne (pas les GPIO
+     34 à 39, sans pull-up), chacune réveille aussi le light sleep
+   - Écrans : deux adresses possibles sur le bus I2C (GPIO 21/22), donc
+     deux cabines au plus avec écran ; les autres n’ont que leur LED
+   - Débitmètres : un compteur PCNT par cabine équipée (8 sur l’ESP32),
+     entrée avec pull-up interne (sortie collecteur ouvert du capteur)
+   - Une broche ou une adresse ne sert qu’à une seule cabine
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "stall_config.h"
+#include "led_control.h"
+#include "ssd1306.h"
+#include "flow_accum.h"
+
+/**-------------------------------------------------------------------------- --
+   Table des cabines
+-- -------------------------------------------------------------------------- */
+const stall_config_t stall_table[] = {
+    /* bouton        LED            écran                   débitmètre          */
+    { GPIO_NUM_5,  LED_GPIO,     SSD1306_ADDR_PRIMARY,   GPIO_NUM_NC, 0 },                  // Cabine 0 : câblage d’origine
+    // { GPIO_NUM_18, GPIO_NUM_4,  SSD1306_ADDR_SECONDARY, GPIO_NUM_27, FLOW_PPL_YF_S201 }, // Cabine 1 avec débitmètre
+    // { GPIO_NUM_19, GPIO_NUM_16, 0,                      GPIO_NUM_NC, 0 },                // Cabine 2 : LED seule
+    // { GPIO_NUM_23, GPIO_NUM_17, 0,                      GPIO_NUM_NC, 0 },                // Cabine 3 : LED seule
+};
+
+const uint8_t stall_count = sizeof(stall_table) / sizeof(stall_table[0]);
+
+_Static_assert(sizeof(stall_table) / sizeof(stall_table[0]) <= STALL_MAX, "trop de cabines");
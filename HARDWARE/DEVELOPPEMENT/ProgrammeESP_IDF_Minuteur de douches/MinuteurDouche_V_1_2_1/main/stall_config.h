@@ -0,0 +1,52 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: stall_config.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Câblage des cabines pilotées par la carte : une ligne de stall_table
+   par cabine (bouton, LED, écran). Le numéro de cabine (0, 1, ...) est
+   l’indice de la ligne ; c’est lui qui accompagne chaque douche envoyée
+   en BLE. La carte d’origine est une table d’une seule cabine.
+
+-- ========================================================================== */
+
+#ifndef STALL_CONFIG_H
+#define STALL_CONFIG_H
+
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "stall_schedule.h"
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: stall_config_t
+   Câblage d’une cabine :
+     - button_gpio : bouton poussoir vers la masse (pull-up interne)
+     - led_gpio    : LED de dépassement (GPIO_NUM_NC : aucune)
+     - oled_addr   : adresse de l’écran sur le bus I2C des écrans
+                     (SSD1306_ADDR_PRIMARY / SECONDARY, 0 : aucun écran)
+     - flow_gpio   : sortie impulsions du débitmètre (GPIO_NUM_NC : aucun)
+     - flow_ppl    : impulsions par litre du débitmètre (0 : YF-S201)
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    gpio_num_t button_gpio;
+    gpio_num_t led_gpio;
+    uint8_t oled_addr;
+    gpio_num_t flow_gpio;
+    uint16_t flow_ppl;
+} stall_config_t;
+
+/**-------------------------------------------------------------------------- --
+   Table des cabines (stall_config.c)
+-- -------------------------------------------------------------------------- */
+extern const stall_config_t stall_table[];
+extern const uint8_t stall_count;             // 1 à STALL_MAX
+
+#endif // STALL_CONFIG_H
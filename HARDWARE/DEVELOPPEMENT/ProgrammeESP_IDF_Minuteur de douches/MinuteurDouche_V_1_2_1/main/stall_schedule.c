@@ -0,0 +1,124 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: stall_schedule.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Échéances des cabines (voir stall_schedule.h). Un masque de bits par
+   type d’échéance : la tâche du minuteur traite les cabines atteintes
+   dans l’ordre de leur numéro, sans tri.
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "stall_schedule.h"
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: stall_schedule_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Toutes les cabines à l’arrêt
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void stall_schedule_init(stall_schedule_t* s, uint8_t count) {
+    s->count = (count > STALL_MAX) ? STALL_MAX : count;
+    for (uint8_t i = 0; i < STALL_MAX; i++) {
+        s->tick_us[i] = STALL_NO_DEADLINE;
+        s->blink_us[i] = STALL_NO_DEADLINE;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: stall_schedule_clear
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Plus aucune échéance pour la cabine "stall"
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void stall_schedule_clear(stall_schedule_t* s, uint8_t stall) {
+    if (stall >= s->count) return;
+    s->tick_us[stall] = STALL_NO_DEADLINE;
+    s->blink_us[stall] = STALL_NO_DEADLINE;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: stall_schedule_next
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Instant du prochain réveil de la tâche du minuteur
+
+   --------------------------------------------------------------------------
+   Return value:
+     Instant en µs, STALL_NO_DEADLINE si aucun
+
+-- -------------------------------------------------------------------------- */
+int64_t stall_schedule_next(const stall_schedule_t* s) {
+    int64_t next = STALL_NO_DEADLINE;
+
+    for (uint8_t i = 0; i < s->count; i++) {
+        if (s->tick_us[i] < next) next = s->tick_us[i];
+    }
+    for (uint8_t i = 0; i < s->count; i++) {
+        if (s->blink_us[i] < next) next = s->blink_us[i];
+    }
+    return next;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: stall_schedule_due
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Échéances atteintes à now_us
+
+   --------------------------------------------------------------------------
+   Description:
+   Les échéances ne sont pas modifiées : l’appelant programme l’échéance
+   suivante de chaque cabine traitée (ou la retire). Une échéance
+   retirée entre l’armement du timer et le réveil n’apparaît donc plus.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     s          : échéances
+     now_us     : instant courant
+     blink_mask : clignotements atteints (sortie)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Masque des ticks atteints
+
+-- -------------------------------------------------------------------------- */
+uint32_t stall_schedule_due(const stall_schedule_t* s, int64_t now_us, uint32_t* blink_mask) {
+    uint32_t ticks = 0;
+    uint32_t blinks = 0;
+
+    for (uint8_t i = 0; i < s->count; i++) {
+        if (s->tick_us[i] <= now_us) ticks |= 1u << i;
+        if (s->blink_us[i] <= now_us) blinks |= 1u << i;
+    }
+    *blink_mask = blinks;
+    return ticks;
+}
@@ -0,0 +1,80 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: stall_schedule.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Échéances de toutes les cabines d’une carte, rangées en tableaux
+   parallèles (une entrée par cabine) :
+   - tick_us  : prochaine frontière de seconde de la session en cours
+   - blink_us : prochain front de clignotement en dépassement
+   La tâche du minuteur n’arme qu’un seul esp_timer, sur la plus proche
+   de ces échéances (stall_schedule_next), puis traite d’un coup toutes
+   celles qui sont atteintes (stall_schedule_due). La recherche ne
+   parcourt que deux petits tableaux contigus de int64_t.
+   Aucune dépendance ESP-IDF : module testé sur PC.
+
+-- ========================================================================== */
+
+#ifndef STALL_SCHEDULE_H
+#define STALL_SCHEDULE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define STALL_MAX               8           // Cabines pilotées par une carte (masques 32 bits)
+#define STALL_NO_DEADLINE       INT64_MAX   // Aucune échéance (cabine à l’arrêt)
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: stall_schedule_t
+   Échéances par cabine (instants session_clock, en µs), modifiées
+   directement par la tâche du minuteur, seule à y accéder
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    int64_t tick_us[STALL_MAX];        // Prochaine seconde (STALL_NO_DEADLINE : arrêt)
+    int64_t blink_us[STALL_MAX];       // Prochain clignotement (hors dépassement : aucun)
+    uint8_t count;                     // Cabines utilisées
+} stall_schedule_t;
+
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: stall_schedule_init
+   Aucune échéance pour les "count" premières cabines (count <= STALL_MAX)
+-- -------------------------------------------------------------------------- */
+void stall_schedule_init(stall_schedule_t* s, uint8_t count);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: stall_schedule_clear
+   Retire toutes les échéances d’une cabine (arrêt, reset)
+-- -------------------------------------------------------------------------- */
+void stall_schedule_clear(stall_schedule_t* s, uint8_t stall);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: stall_schedule_next
+   Plus proche échéance, toutes cabines confondues
+   Retour : STALL_NO_DEADLINE si aucune cabine n’attend
+-- -------------------------------------------------------------------------- */
+int64_t stall_schedule_next(const stall_schedule_t* s);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: stall_schedule_due
+   Cabines dont une échéance est atteinte à now_us (bit i = cabine i)
+   Retour : masque des ticks ; *blink_mask : masque des clignotements
+-- -------------------------------------------------------------------------- */
+uint32_t stall_schedule_due(const stall_schedule_t* s, int64_t now_us, uint32_t* blink_mask);
+
+#endif // STALL_SCHEDULE_H
@@ -0,0 +1,347 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: timer_control.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Contrôle du minuteur sans verrou :
+   - File MPSC bornée à numéros de séquence par case : un producteur
+     réserve une case par compare-and-swap sur "tail", la remplit puis la
+     publie ; le consommateur unique la lit puis la rend aux producteurs
+   - Machine d’états start / stop / utilisateur / durée allouée
+   - Instantané publié par seqlock : le consommateur n’attend jamais les
+     lecteurs, un lecteur recommence sa copie si une publication l’a
+     croisée
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "timer_control.h"
+#include <string.h>
+
+#if (TIMER_CMD_DEPTH & (TIMER_CMD_DEPTH - 1)) != 0
+#error "TIMER_CMD_DEPTH doit etre une puissance de 2"
+#endif
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: copy_user
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Copie bornée d’un nom d’utilisateur, toujours terminée par '\0'
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void copy_user(char* dst, const char* src) {
+    size_t len = strnlen(src, TIMER_USER_MAX - 1);
+    memcpy(dst, src, len);
+    dst[len] = '\0';
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: user_selected
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si un vrai utilisateur est choisi ("User" est le nom par défaut
+     de l’application)
+
+-- -------------------------------------------------------------------------- */
+static bool user_selected(const char* user) {
+    return user[0] != '\0' && strcmp(user, "User") != 0;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: select_user
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Change l’utilisateur courant et applique sa durée allouée
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void select_user(timer_sm_t* sm, const char* user) {
+    copy_user(sm->user, user);
+    if (sm->budget_of) {
+        int64_t budget_us = sm->budget_of(sm->user);
+        if (budget_us > 0) sm->budget_us = budget_us;
+    }
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_cmd_queue_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Toutes les cases sont libres pour le premier tour des producteurs
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void timer_cmd_queue_init(timer_cmd_queue_t* q) {
+    for (unsigned i = 0; i < TIMER_CMD_DEPTH; i++) {
+        atomic_init(&q->slot[i].seq, i);
+    }
+    atomic_init(&q->tail, 0);
+    q->head = 0;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_cmd_push
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Dépose une commande sans verrou
+
+   --------------------------------------------------------------------------
+   Description:
+   La case "pos" est libre quand son numéro vaut pos ; le producteur qui
+   gagne le compare-and-swap sur tail la remplit puis publie pos + 1. Un
+   numéro inférieur signifie que le consommateur n’a pas encore rendu la
+   case : la file est pleine.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     q   : file
+     cmd : commande copiée dans la file
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si déposée, false si la file est pleine
+
+-- -------------------------------------------------------------------------- */
+bool timer_cmd_push(timer_cmd_queue_t* q, const timer_cmd_t* cmd) {
+    unsigned pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    for (;;) {
+        unsigned seq = atomic_load_explicit(&q->slot[pos % TIMER_CMD_DEPTH].seq,
+                                            memory_order_acquire);
+        int diff = (int)(seq - pos);
+
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+                break;                              // Case réservée
+        }
+        else if (diff < 0) {
+            return false;                           // Pleine
+        }
+        else {
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        }
+    }
+
+    q->slot[pos % TIMER_CMD_DEPTH].cmd = *cmd;
+    atomic_store_explicit(&q->slot[pos % TIMER_CMD_DEPTH].seq, pos + 1, memory_order_release);
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_cmd_pop
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Retire la commande la plus ancienne (consommateur unique)
+
+   --------------------------------------------------------------------------
+   Description:
+   La case est prête quand son numéro vaut head + 1 ; après lecture, elle
+   est rendue aux producteurs pour le tour suivant (head + DEPTH).
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si une commande a été lue dans *cmd
+
+-- -------------------------------------------------------------------------- */
+bool timer_cmd_pop(timer_cmd_queue_t* q, timer_cmd_t* cmd) {
+    unsigned pos = q->head;
+    unsigned seq = atomic_load_explicit(&q->slot[pos % TIMER_CMD_DEPTH].seq,
+                                        memory_order_acquire);
+    if (seq != pos + 1) return false;
+
+    *cmd = q->slot[pos % TIMER_CMD_DEPTH].cmd;
+    atomic_store_explicit(&q->slot[pos % TIMER_CMD_DEPTH].seq, pos + TIMER_CMD_DEPTH,
+                          memory_order_release);
+    q->head = pos + 1;
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_sm_init
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void timer_sm_init(timer_sm_t* sm, int64_t budget_us) {
+    memset(sm, 0, sizeof(*sm));
+    sm->state = TIMER_STOPPED;
+    sm->budget_us = budget_us;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_sm_apply
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Transition de la machine d’états pour une commande
+
+   --------------------------------------------------------------------------
+   Description:
+   - START : ignoré si une session court ; refusé sans utilisateur ; sinon
+     ouvre une session de la durée allouée courante
+   - STOP : ignoré à l’arrêt ; sinon fige la session à now_us
+   - RESET : toujours appliqué ; fige la session éventuelle et oublie
+     l’utilisateur (la durée allouée courante est conservée)
+   - SET_USER / SET_BUDGET : valent pour les sessions suivantes, la
+     session en cours n’est pas modifiée ; choisir un utilisateur applique
+     sa durée (budget_of), la durée d’un autre utilisateur est ignorée ici
+     (mémorisée par l’appelant)
+   Le passage RUNNING -> OVERTIME reste décidé par le consommateur sur
+   son tick d’échéance.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     sm     : état (consommateur uniquement)
+     cmd    : commande à appliquer
+     now_us : instant de traitement (session_clock_now_us)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Effet de la commande
+
+-- -------------------------------------------------------------------------- */
+timer_sm_result_t timer_sm_apply(timer_sm_t* sm, const timer_cmd_t* cmd, int64_t now_us) {
+    switch (cmd->type) {
+    case TIMER_CMD_START:
+        if (sm->state != TIMER_STOPPED) return TIMER_SM_IGNORED;
+        if (cmd->user[0] != '\0') select_user(sm, cmd->user);
+        if (!user_selected(sm->user)) return TIMER_SM_NO_USER;
+        session_clock_start(&sm->session, sm->budget_us, now_us);
+        sm->state = TIMER_RUNNING;
+        sm->sessions++;
+        return TIMER_SM_STARTED;
+
+    case TIMER_CMD_STOP:
+        if (sm->state == TIMER_STOPPED) return TIMER_SM_IGNORED;
+        session_clock_stop(&sm->session, now_us);
+        sm->state = TIMER_STOPPED;
+        return TIMER_SM_STOPPED;
+
+    case TIMER_CMD_SET_USER:
+        select_user(sm, cmd->user);
+        return TIMER_SM_USER_SET;
+
+    case TIMER_CMD_SET_BUDGET:
+        if (cmd->budget_us <= 0) return TIMER_SM_IGNORED;
+        if (cmd->user[0] != '\0' && strcmp(cmd->user, sm->user) != 0) return TIMER_SM_IGNORED;
+        sm->budget_us = cmd->budget_us;
+        return TIMER_SM_BUDGET_SET;
+
+    case TIMER_CMD_JOURNAL_SYNC:
+    case TIMER_CMD_JOURNAL_ACK:
+    case TIMER_CMD_JOURNAL_REPLAY:
+        return TIMER_SM_IGNORED;           // Journal : traité par le consommateur
+
+    case TIMER_CMD_RESET:
+        if (sm->state != TIMER_STOPPED) session_clock_stop(&sm->session, now_us);
+        sm->state = TIMER_STOPPED;
+        copy_user(sm->user, "");
+        return TIMER_SM_RESET;
+    }
+    return TIMER_SM_IGNORED;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_snapshot_publish
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Publie l’état du consommateur
+
+   --------------------------------------------------------------------------
+   Description:
+   seq passe à une valeur impaire pendant la copie puis à la valeur paire
+   suivante : un lecteur qui voit un numéro impair ou différent avant et
+   après sa propre copie recommence. Le lecteur attend sans céder le
+   processeur : l’appelant publie en section critique, l’attente ne dure
+   donc au plus qu’une copie.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void timer_snapshot_publish(timer_snapshot_cell_t* cell, const timer_sm_t* sm) {
+    unsigned seq = atomic_load_explicit(&cell->seq, memory_order_relaxed);
+
+    atomic_store_explicit(&cell->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    cell->snap.state = sm->state;
+    cell->snap.start_us = sm->session.start_us;
+    cell->snap.stop_us = sm->session.stop_us;
+    cell->snap.duration_us = sm->session.duration_us;
+    cell->snap.budget_us = sm->budget_us;
+    cell->snap.sessions = sm->sessions;
+    memcpy(cell->snap.user, sm->user, TIMER_USER_MAX);
+
+    atomic_store_explicit(&cell->seq, seq + 2, memory_order_release);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_snapshot_read
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Copie cohérente du dernier état publié, sans verrou
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun (copie dans *out)
+
+-- -------------------------------------------------------------------------- */
+void timer_snapshot_read(timer_snapshot_cell_t* cell, timer_snapshot_t* out) {
+    unsigned before, after;
+
+    do {
+        before = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        if (before & 1u) continue;                  // Publication en cours
+        memcpy(out, &cell->snap, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&cell->seq, memory_order_relaxed);
+        if (before == after) return;
+    } while (1);
+}
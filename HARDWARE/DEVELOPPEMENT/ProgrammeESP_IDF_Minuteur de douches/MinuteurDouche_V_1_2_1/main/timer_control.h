@@ -0,0 +1,183 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: timer_control.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Briques sans verrou du contrôle du minuteur :
+   - File de commandes bornée, plusieurs producteurs (bouton, BLE) et un
+     seul consommateur (timer_manager_task) ; push ne bloque jamais
+   - Machine d’états du minuteur, modifiée uniquement par le consommateur
+   - Instantané de l’état publié par séquence (seqlock) : les lecteurs
+     obtiennent une copie cohérente sans verrou et sans jamais retarder
+     le consommateur
+
+   Aucune dépendance FreeRTOS : le réveil du consommateur est laissé à
+   l’appelant, ce qui permet de tester le module sur PC.
+
+-- ========================================================================== */
+
+#ifndef TIMER_CONTROL_H
+#define TIMER_CONTROL_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "timer_manager.h"
+#include "session_clock.h"
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define TIMER_CMD_DEPTH      8       // Commandes en attente (puissance de 2)
+
+/**-------------------------------------------------------------------------- --
+   Types publics
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   ENUM: timer_cmd_type_t
+   Commandes adressées au propriétaire du minuteur
+-- -------------------------------------------------------------------------- */
+typedef enum {
+    TIMER_CMD_START,         // Démarre (user : nom optionnel)
+    TIMER_CMD_STOP,          // Arrête la session en cours
+    TIMER_CMD_SET_USER,      // Change l’utilisateur des prochaines sessions
+    TIMER_CMD_SET_BUDGET,    // Change la durée allouée (user : "" = utilisateur courant)
+    TIMER_CMD_JOURNAL_SYNC,  // Reprend l’envoi du journal (nouvelle connexion)
+    TIMER_CMD_JOURNAL_ACK,   // Le pont a enregistré le journal jusqu’à seq
+    TIMER_CMD_JOURNAL_REPLAY,// Renvoie le journal après seq (historique demandé par le pont)
+    TIMER_CMD_RESET          // Abandonne la session sans l’enregistrer, oublie l’utilisateur
+} timer_cmd_type_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: timer_cmd_t
+   Commande et son argument (selon le type)
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    timer_cmd_type_t type;
+    uint8_t stall;                     // Cabine visée (sauf journal, durée nommée)
+    int64_t budget_us;                 // TIMER_CMD_SET_BUDGET
+    uint32_t seq;                      // TIMER_CMD_JOURNAL_ACK / REPLAY
+    char user[TIMER_USER_MAX];         // START / SET_USER / SET_BUDGET ("" = courant)
+} timer_cmd_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: timer_cmd_queue_t
+   File MPSC bornée : chaque case porte un numéro de séquence qui indique
+   si elle est libre pour le tour courant du producteur ou prête pour le
+   consommateur
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    struct {
+        atomic_uint seq;
+        timer_cmd_t cmd;
+    } slot[TIMER_CMD_DEPTH];
+    atomic_uint tail;                  // Prochaine case réservée par un producteur
+    unsigned head;                     // Prochaine case lue (consommateur seul)
+} timer_cmd_queue_t;
+
+/* -------------------------------------------------------------------------- --
+   ENUM: timer_sm_result_t
+   Effet d’une commande sur la machine d’états (à traduire en écran / LED /
+   BLE par le consommateur)
+-- -------------------------------------------------------------------------- */
+typedef enum {
+    TIMER_SM_IGNORED,        // Sans effet (déjà démarré, déjà arrêté...)
+    TIMER_SM_STARTED,
+    TIMER_SM_STOPPED,
+    TIMER_SM_NO_USER,        // Démarrage refusé : aucun utilisateur choisi
+    TIMER_SM_USER_SET,
+    TIMER_SM_BUDGET_SET,
+    TIMER_SM_RESET           // Session abandonnée (ou aucune), plus d’utilisateur
+} timer_sm_result_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: timer_sm_t
+   État du minuteur, propriété exclusive du consommateur
+   budget_of (optionnel) donne la durée allouée d’un utilisateur : elle
+   s’applique dès qu’il est choisi
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    timer_state_t state;
+    session_clock_t session;           // Session en cours ou dernière session
+    int64_t budget_us;                 // Durée allouée aux prochaines sessions
+    uint32_t sessions;                 // Sessions démarrées depuis le boot
+    char user[TIMER_USER_MAX];
+    int64_t (*budget_of)(const char* user);
+} timer_sm_t;
+
+/* -------------------------------------------------------------------------- --
+   STRUCT: timer_snapshot_cell_t
+   Instantané publié : seq impair pendant une écriture
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    atomic_uint seq;
+    timer_snapshot_t snap;
+} timer_snapshot_cell_t;
+
+
+/**-------------------------------------------------------------------------- --
+   File de commandes
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_cmd_queue_init
+   Vide la file (avant tout accès concurrent)
+-- -------------------------------------------------------------------------- */
+void timer_cmd_queue_init(timer_cmd_queue_t* q);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_cmd_push
+   Dépose une commande (tout contexte de tâche, sans verrou ni attente)
+   Retour : false si la file est pleine
+-- -------------------------------------------------------------------------- */
+bool timer_cmd_push(timer_cmd_queue_t* q, const timer_cmd_t* cmd);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_cmd_pop
+   Retire la commande la plus ancienne (consommateur uniquement)
+   Retour : false si la file est vide
+-- -------------------------------------------------------------------------- */
+bool timer_cmd_pop(timer_cmd_queue_t* q, timer_cmd_t* cmd);
+
+
+/**-------------------------------------------------------------------------- --
+   Machine d’états
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_sm_init
+   Minuteur arrêté, sans utilisateur, durée allouée "budget_us"
+-- -------------------------------------------------------------------------- */
+void timer_sm_init(timer_sm_t* sm, int64_t budget_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_sm_apply
+   Applique une commande à l’instant "now_us"
+-- -------------------------------------------------------------------------- */
+timer_sm_result_t timer_sm_apply(timer_sm_t* sm, const timer_cmd_t* cmd, int64_t now_us);
+
+
+/**-------------------------------------------------------------------------- --
+   Instantané
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_snapshot_publish
+   Publie l’état courant (consommateur uniquement). À appeler sans
+   préemption possible (section critique) : un lecteur plus prioritaire
+   qui interromprait la copie attendrait sinon indéfiniment
+-- -------------------------------------------------------------------------- */
+void timer_snapshot_publish(timer_snapshot_cell_t* cell, const timer_sm_t* sm);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_snapshot_read
+   Copie cohérente du dernier état publié (tout contexte de tâche)
+-- -------------------------------------------------------------------------- */
+void timer_snapshot_read(timer_snapshot_cell_t* cell, timer_snapshot_t* out);
+
+#endif // TIMER_CONTROL_H
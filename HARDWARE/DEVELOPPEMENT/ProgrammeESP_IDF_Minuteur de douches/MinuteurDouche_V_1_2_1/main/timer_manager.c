@@ -11,7 +11,23 @@
    - Démarrage et arrêt du timer (5 minutes par défaut)
    - Gestion de l’affichage OLED pendant le timer et en dépassement
    - Clignotement visuel avec LED et message OLED en dépassement
-   - Envoi de données via BLE à la fin de la douche
+   - Cadencement par esp_timer : réveils exacts à chaque seconde, à
+     l’échéance et à chaque front de clignotement, aucun réveil à l’arrêt
+   - Durées en microsecondes sur l’horloge 64 bits de session_clock
+   - timer_manager_task est l’unique propriétaire de l’état : bouton et
+     BLE déposent des commandes dans une file sans verrou et lisent un
+     instantané publié, sans jamais attendre l’écran
+   - Durée allouée propre à chaque utilisateur (user_budget, en NVS),
+     appliquée dès qu’il est choisi
+   - Chaque douche terminée est écrite dans le journal en flash
+     (session_journal) puis envoyée en BLE par lots acquittés : les
+     douches prises pendant une absence du pont sont transmises à la
+     reconnexion
+   - Plusieurs cabines par carte (stall_config.h) : une machine d’états,
+     un instantané, un écran et une LED par cabine, dans des tableaux
+     indexés par le numéro de cabine ; les échéances de toutes les
+     cabines (stall_schedule) partagent un seul esp_timer, armé sur la
+     plus proche
    - État global du timer accessible via getter
 
    ==========================================================================
@@ -27,41 +43,775 @@
 -- -------------------------------------------------------------------------- */
 #include "timer_manager.h"
 #include "oled_display.h"
+#include "display_task.h"
 #include "led_control.h"
 #include "ble_spp_server.h"
+#include "session_clock.h"
+#include "timer_control.h"
+#include "user_budget.h"
+#include "session_journal.h"
+#include "stall_config.h"
+#include "stall_schedule.h"
+#include "flow_meter.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
-#include "esp_gatts_api.h"
 
 /**-------------------------------------------------------------------------- --
    External variables (depuis BLE)
 -- -------------------------------------------------------------------------- */
 extern bool is_connected;
 extern bool enable_data_ntf;
-extern uint16_t spp_conn_id;
-extern esp_gatt_if_t spp_gatts_if;
-extern uint16_t spp_handle_table[];
-#define SPP_IDX_SPP_DATA_NTY_VAL 4
 
-extern char user_name[32];  // Nom d’utilisateur global partagé
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define OVERTIME_BLINK_US    (400 * SESSION_US_PER_MS)    // Demi-période du clignotement en dépassement
+#define JITTER_REPORT_US     (10 * SESSION_US_PER_S)      // Période du bilan de gigue (log debug)
+#define JOURNAL_BATCH_RECORDS 64                          // Douches par lot du journal (fragmenté au MTU)
+#define JOURNAL_BATCH_MAX    (sizeof(session_frame_header_t) + JOURNAL_BATCH_RECORDS * sizeof(session_record_wire_t))
+#define UNSAVED_MAX          4                            // Douches hors journal gardées en RAM
+#define TX_RETRY_US          (10 * SESSION_US_PER_S)      // Relance après un envoi abandonné (pont : 30 s)
+
+/* Événements notifiés à timer_manager_task (bits de la notification) */
+#define EVT_CMD              (1u << 0)        // Commande(s) dans la file
+#define EVT_DEADLINE         (1u << 1)        // Échéance d’une cabine (seconde ou clignotement)
+#define EVT_UNSAVED          (1u << 2)        // Trame hors journal confirmée
+#define EVT_RETRY            (1u << 3)        // Fin du délai de relance après un envoi abandonné
+
+static const char* TAG = "TIMER";
+
+/**-------------------------------------------------------------------------- --
+   Static variables
+-- -------------------------------------------------------------------------- */
+static timer_cmd_queue_t cmd_queue;           // Commandes des autres tâches
+
+/* Cabines : un élément par cabine (timer_manager_task seule, sauf snapshot) */
+static timer_sm_t sm[STALL_MAX];                      // États des timers
+static timer_snapshot_cell_t snapshot[STALL_MAX];     // États publiés pour les lecteurs
+static portMUX_TYPE snapshot_mux = portMUX_INITIALIZER_UNLOCKED;    // Publication non préemptible
+static stall_schedule_t sched;                        // Échéances (seconde, clignotement)
+static bool blink_on[STALL_MAX];                      // Phase du clignotement
+static bool screen_shown[STALL_MAX];                  // Écran du minuteur composé
+static ssd1306_t* panel[STALL_MAX];                   // Écran de la cabine (NULL : aucun)
+static oled_timer_screen_t screen[STALL_MAX];         // Scène de cet écran
+
+static TaskHandle_t timer_task_handle = NULL;
+static esp_timer_handle_t sched_timer = NULL; // One-shot : prochaine échéance
+static int64_t armed_us = STALL_NO_DEADLINE;  // Échéance sur laquelle il est armé
+static esp_timer_handle_t retry_timer = NULL; // One-shot : relance des envois abandonnés
+static atomic_bool retry_armed = false;       // Relance en attente (tâche Bluedroid ou minuteur)
+
+/* Douches non journalisées (partition absente, écriture refusée) en
+   attente d’envoi : file de timer_manager_task, état de la trame en
+   cours d’envoi mis à jour par la tâche Bluedroid */
+typedef enum { UNSAVED_IDLE, UNSAVED_INFLIGHT, UNSAVED_SENT, UNSAVED_FAILED } unsaved_tx_t;
+static uint8_t unsaved[UNSAVED_MAX][SESSION_FRAME_MIN_LEN];
+static size_t unsaved_len[UNSAVED_MAX];
+static uint8_t unsaved_head = 0;
+static uint8_t unsaved_count = 0;
+static uint32_t unsaved_dropped = 0;          // Douches perdues (file pleine)
+static uint8_t unsaved_frame[SESSION_FRAME_MIN_LEN];    // Lu par la pile pendant l’envoi
+static atomic_int unsaved_tx = UNSAVED_IDLE;
+
+/* Mesure du retard des réveils de timer_manager_task */
+static int64_t jitter_max_us = 0;             // Pire retard depuis le dernier bilan
+static int64_t jitter_window_us = 0;          // Début de la fenêtre de mesure
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: publish_snapshot
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Publie l’état d’une cabine pour les lecteurs
+
+   --------------------------------------------------------------------------
+   Description:
+   Publication en section critique : un lecteur plus prioritaire du même
+   cœur (spp_cmd_task, tâche Bluedroid) ne peut pas interrompre la copie
+   et tourner ensuite sur un numéro de séquence impair ; sur l’autre
+   cœur, il attend au plus la durée de la copie.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : cabine
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void publish_snapshot(uint8_t stall) {
+    portENTER_CRITICAL(&snapshot_mux);
+    timer_snapshot_publish(&snapshot[stall], &sm[stall]);
+    portEXIT_CRITICAL(&snapshot_mux);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: jitter_record
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Mesure le retard du réveil de la tâche sur l’échéance programmée
+
+   --------------------------------------------------------------------------
+   Description:
+   Le retard comprend la latence du callback esp_timer et la préemption
+   de la tâche : un envoi I2C bloquant s’y verrait directement. Le pire
+   retard est journalisé (niveau debug) toutes les JITTER_REPORT_US avec
+   les statistiques de la tâche d’affichage. Comparaison envoi direct /
+   tâche d’affichage / écran au repos sur PC : host/bench_jitter.c.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     due_us : échéance programmée (base session_clock_now_us)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void jitter_record(int64_t due_us) {
+    int64_t now = session_clock_now_us();
+    int64_t late = now - due_us;
+
+    if (jitter_window_us == 0) jitter_window_us = now;
+    if (late > jitter_max_us) jitter_max_us = late;
+
+    if (now - jitter_window_us >= JITTER_REPORT_US) {
+        display_stats_t ds;
+        display_get_stats(&ds);
+        ESP_LOGD(TAG, "Retard reveil max %lld us | affichage : %lu images, envoi max %lld us",
+                 (long long)jitter_max_us, (unsigned long)ds.frames, (long long)ds.max_send_us);
+        jitter_max_us = 0;
+        jitter_window_us = now;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_event_cb
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Callback esp_timer : transmet l’événement (arg) à timer_manager_task
+
+   --------------------------------------------------------------------------
+   Description:
+   Exécuté dans la tâche esp_timer : aucun dessin ni accès I2C ici, seule
+   une notification (bits fusionnés si la tâche est en retard).
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void timer_event_cb(void *arg) {
+    xTaskNotify(timer_task_handle, (uint32_t)(uintptr_t)arg, eSetBits);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: schedule_next_tick
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Programme le prochain tick de la cabine sur sa frontière de seconde
+   suivante
+
+   --------------------------------------------------------------------------
+   Description:
+   Les frontières sont comptées depuis le démarrage de la session (voir
+   session_clock_next_tick_us) : l’échéance est l’une d’elles. Le timer
+   n’est réarmé qu’une fois toutes les cabines traitées (arm_schedule).
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : cabine
+     now   : instant courant (session_clock_now_us)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void schedule_next_tick(uint8_t stall, int64_t now) {
+    sched.tick_us[stall] = now + session_clock_next_tick_us(&sm[stall].session, now);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: arm_schedule
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Arme l’unique esp_timer sur la plus proche échéance des cabines
+
+   --------------------------------------------------------------------------
+   Description:
+   Rien n’est fait si l’échéance n’a pas changé ; plus aucune échéance
+   (toutes les cabines arrêtées) : timer désarmé, aucun réveil. Une
+   échéance déjà dépassée déclenche le timer immédiatement.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void arm_schedule(void) {
+    int64_t next = stall_schedule_next(&sched);
+    if (next == armed_us) return;
+
+    esp_timer_stop(sched_timer);    // Sans effet s’il n’est pas armé
+    armed_us = next;
+    if (next == STALL_NO_DEADLINE) return;
+
+    int64_t delay_us = next - session_clock_now_us();
+    esp_timer_start_once(sched_timer, delay_us > 0 ? (uint64_t)delay_us : 0);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: budget_of_user
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Durée allouée d’un utilisateur pour la machine d’états (table en RAM,
+   aucun accès flash)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Durée en microsecondes
+
+-- -------------------------------------------------------------------------- */
+static int64_t budget_of_user(const char* user) {
+    return (int64_t)user_budget_get(user) * SESSION_US_PER_S;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: post_cmd
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Dépose une commande pour timer_manager_task et la réveille
+
+   --------------------------------------------------------------------------
+   Description:
+   Ne bloque jamais : utilisable depuis les callbacks BLE. Si la file est
+   pleine (tâche propriétaire bloquée), la commande est perdue et signalée.
+   Une commande pour une cabine absente de stall_table est refusée.
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la commande a été déposée
+
+-- -------------------------------------------------------------------------- */
+static bool post_cmd(const timer_cmd_t* cmd) {
+    if (cmd->stall >= stall_count) {
+        ESP_LOGW(TAG, "Cabine %u inconnue", (unsigned)cmd->stall);
+        return false;
+    }
+    if (!timer_cmd_push(&cmd_queue, cmd)) {
+        ESP_LOGW(TAG, "File de commandes pleine, commande %d perdue", (int)cmd->type);
+        return false;
+    }
+    if (timer_task_handle) xTaskNotify(timer_task_handle, EVT_CMD, eSetBits);
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: retry_arm
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Programme la relance des envois après un échec (TX_RETRY_US)
+
+   --------------------------------------------------------------------------
+   Description:
+   Un échec ne relance rien tout de suite : une pile qui refuse en boucle
+   ferait tourner l’envoi sans répit. Une seule relance en attente à la
+   fois, traitée par timer_manager_task (EVT_RETRY). Appelable depuis la
+   tâche Bluedroid.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void retry_arm(void) {
+    if (atomic_exchange(&retry_armed, true)) return;
+    esp_timer_start_once(retry_timer, TX_RETRY_US);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: journal_tx_done
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Fin d’envoi d’un lot du journal (tâche Bluedroid)
+
+   --------------------------------------------------------------------------
+   Description:
+   Un lot abandonné (échec de la pile, déconnexion) n’arrive pas entier
+   au pont, qui ne l’acquitte pas : tout ce qui n’est pas acquitté est
+   renvoyé après TX_RETRY_US (sans effet si le pont est parti).
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void journal_tx_done(void* ctx, bool ok) {
+    if (!ok) retry_arm();
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: unsaved_tx_done
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Fin d’envoi d’une douche hors journal (tâche Bluedroid)
+
+   --------------------------------------------------------------------------
+   Description:
+   Le résultat est relevé par timer_manager_task (unsaved_collect), seule à
+   modifier la file : retrait de la douche et envoi suivant si elle est
+   partie, nouvel essai après TX_RETRY_US sinon.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void unsaved_tx_done(void* ctx, bool ok) {
+    atomic_store(&unsaved_tx, ok ? UNSAVED_SENT : UNSAVED_FAILED);
+    if (!ok) {
+        retry_arm();
+    } else if (timer_task_handle) {
+        xTaskNotify(timer_task_handle, EVT_UNSAVED, eSetBits);
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: unsaved_collect
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Relève le résultat du dernier envoi hors journal
+
+   --------------------------------------------------------------------------
+   Description:
+   La douche en tête n’est retirée qu’une fois sa dernière notification
+   confirmée ; après un envoi abandonné (déconnexion), elle reste en tête
+   et repart à la prochaine synchronisation.
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si un envoi hors journal est encore en cours
+
+-- -------------------------------------------------------------------------- */
+static bool unsaved_collect(void) {
+    int st = atomic_load(&unsaved_tx);
+
+    if (st == UNSAVED_INFLIGHT) return true;
+    if (st == UNSAVED_SENT) {
+        unsaved_head = (unsaved_head + 1) % UNSAVED_MAX;
+        unsaved_count--;
+    }
+    atomic_store(&unsaved_tx, UNSAVED_IDLE);
+    return false;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: unsaved_push
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Garde en RAM une douche que le journal n’a pas pu enregistrer
+
+   --------------------------------------------------------------------------
+   Description:
+   File pleine : la plus ancienne douche en attente est perdue, comptée
+   et signalée (jamais celle en cours d’envoi).
+
+   --------------------------------------------------------------------------
+   Parameters:
+     frame : trame de la douche (session_journal_unsaved)
+     len   : sa longueur
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void unsaved_push(const uint8_t* frame, size_t len) {
+    bool inflight = unsaved_collect();
+
+    if (unsaved_count == UNSAVED_MAX) {
+        // Tête en cours d’envoi : la suivante est sacrifiée
+        uint8_t victim = inflight ? 1 : 0;
+        for (uint8_t i = victim; i + 1 < unsaved_count; i++) {
+            uint8_t to = (unsaved_head + i) % UNSAVED_MAX;
+            uint8_t from = (unsaved_head + i + 1) % UNSAVED_MAX;
+            memcpy(unsaved[to], unsaved[from], unsaved_len[from]);
+            unsaved_len[to] = unsaved_len[from];
+        }
+        unsaved_count--;
+        unsaved_dropped++;
+        ESP_LOGE(TAG, "Douche hors journal perdue (%lu depuis le demarrage)",
+                 (unsigned long)unsaved_dropped);
+    }
+
+    uint8_t slot = (unsaved_head + unsaved_count) % UNSAVED_MAX;
+    memcpy(unsaved[slot], frame, len);
+    unsaved_len[slot] = len;
+    unsaved_count++;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: unsaved_send
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Envoie la plus ancienne douche hors journal en attente
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si un envoi hors journal est en cours ou vient d’être refusé
+     (le lot du journal attend)
+
+-- -------------------------------------------------------------------------- */
+static bool unsaved_send(void) {
+    if (unsaved_collect()) return true;
+    if (unsaved_count == 0 || !(is_connected && enable_data_ntf) || ble_spp_data_busy()) {
+        return false;
+    }
+    memcpy(unsaved_frame, unsaved[unsaved_head], unsaved_len[unsaved_head]);
+    atomic_store(&unsaved_tx, UNSAVED_INFLIGHT);
+    if (!ble_spp_data_send(unsaved_frame, unsaved_len[unsaved_head], unsaved_tx_done, NULL)) {
+        atomic_store(&unsaved_tx, UNSAVED_IDLE);
+        retry_arm();
+        return true;                // Le lot du journal attend aussi la relance
+    }
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: journal_send_batch
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Envoie le lot suivant du journal (JOURNAL_BATCH_RECORDS douches au plus)
+
+   --------------------------------------------------------------------------
+   Description:
+   Les douches hors journal en attente partent d’abord (unsaved_send).
+   Le lot est fragmenté au MTU négocié et envoyé au rythme de la liaison
+   (ble_spp_data_send) ; rien ne part tant que le lot précédent n’est pas
+   acquitté ni sans abonnement du pont. Tant qu’un bloc est en cours
+   d’envoi, le tampon du lot n’est pas réécrit : l’acquittement de ce
+   lot (ou la prochaine synchronisation) relance l’envoi. Après un envoi
+   abandonné ou refusé, plus rien ne part avant la relance (retry_arm).
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void journal_send_batch(void) {
+    static uint8_t batch[JOURNAL_BATCH_MAX];
+
+    if (atomic_load(&retry_armed)) return;
+    if (unsaved_send()) return;
+    if (!(is_connected && enable_data_ntf) || ble_spp_data_busy()) return;
+
+    size_t len = session_journal_batch(batch, sizeof(batch));
+    if (len > 0 && !ble_spp_data_send(batch, len, journal_tx_done, NULL)) {
+        ESP_LOGW(TAG, "Envoi du journal impossible");
+        session_journal_rewind();
+        retry_arm();
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: show_stop_summary
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Affiche la durée totale de la session close et la journalise
+
+   --------------------------------------------------------------------------
+   Description:
+   La douche est écrite dans le journal, avec sa cabine et l’eau mesurée
+   (cabine équipée d’un débitmètre), puis envoyée si le pont est là. Sans
+   journal (partition absente, écriture refusée), la trame hors journal
+   (session_journal_unsaved) attend en RAM son envoi, dans la limite de
+   UNSAVED_MAX douches.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : cabine dont la session vient de s’arrêter
+     flow  : eau mesurée (NULL : pas de débitmètre)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void show_stop_summary(uint8_t stall, const flow_result_t* flow) {
+    const timer_sm_t* s = &sm[stall];
+    int64_t total_us = session_clock_elapsed_us(&s->session, s->session.stop_us);
+    int64_t over_us = session_clock_overtime_us(&s->session, s->session.stop_us);
+    uint32_t total_s = (uint32_t)(total_us / SESSION_US_PER_S);
+
+    if (panel[stall]) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%s %02u:%02u", "Total",
+                 (unsigned int)(total_s / 60),
+                 (unsigned int)(total_s % 60));
+        display_begin();
+        oled_dev_clear(panel[stall]);
+        oled_dev_display_centered(panel[stall], buf, 3);
+        if (flow) {
+            snprintf(buf, sizeof(buf), "%lu.%lu L",
+                     (unsigned long)(flow->volume_ml / 1000),
+                     (unsigned long)(flow->volume_ml % 1000 / 100));
+            oled_dev_display_centered(panel[stall], buf, 5);
+        }
+        display_commit();
+    }
+
+    ESP_LOGI(TAG, "Cabine %u : timer arrete. Duree totale = %lld us",
+             (unsigned)stall, (long long)total_us);
+    if (flow) {
+        ESP_LOGI(TAG, "Cabine %u : %lu mL, debit de pointe %lu mL/min", (unsigned)stall,
+                 (unsigned long)flow->volume_ml, (unsigned long)flow->peak_ml_min);
+    }
+
+    if (!session_journal_append(stall, s->user, s->session.start_us, total_us, over_us, flow)) {
+        uint8_t frame[SESSION_FRAME_MIN_LEN];
+        size_t len = session_journal_unsaved(frame, sizeof(frame), stall, s->user,
+                                             s->session.start_us, total_us, over_us, flow);
+        ESP_LOGW(TAG, "Cabine %u : douche hors journal, gardee en RAM", (unsigned)stall);
+        unsaved_push(frame, len);
+    }
+    journal_send_batch();
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: show_select_user
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Invite à choisir un utilisateur (démarrage refusé)
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : cabine
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void show_select_user(uint8_t stall) {
+    ssd1306_t* dev = panel[stall];
+    if (dev == NULL) return;
+
+    display_begin();
+    ssd1306_dev_clear_screen(dev);
+    ssd1306_dev_draw_string(dev, 0, 2, "Selectionnez un", 1, true);
+    ssd1306_dev_draw_string(dev, 0, 3, "utilisateur avant", 1, true);
+    ssd1306_dev_draw_string(dev, 0, 4, "la douche", 1, true);
+    display_commit();
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: show_message
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Message simple sur l’écran de la cabine (s’il y en a un)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void show_message(uint8_t stall, const char* msg) {
+    if (panel[stall]) oled_dev_display_message(panel[stall], msg);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: apply_result
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Effets d’une commande appliquée à la machine d’états d’une cabine
+
+   --------------------------------------------------------------------------
+   Description:
+   L’instantané de la cabine est publié. Un démarrage programme le
+   premier tick ; un arrêt ou un reset retire toutes les échéances de la
+   cabine : un tick de l’ancienne session ne peut plus redessiner l’écran
+   (les échéances sont relues au réveil, pas mémorisées dans la
+   notification).
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : cabine
+     res   : résultat de timer_sm_apply
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
 
-/**-------------------------------------------------------------------------- --
-   Constants and macros
 -- -------------------------------------------------------------------------- */
-#define TIMER_DURATION_MS    (5 * 60 * 1000)  // Durée timer = 5 minutes
-#define OVERTIME_BLINK_MS    400              // Période blink en dépassement
+static void apply_result(uint8_t stall, timer_sm_result_t res) {
+    timer_sm_t* s = &sm[stall];
 
-static const char* TAG = "TIMER";
+    switch (res) {
+    case TIMER_SM_STARTED:
+        publish_snapshot(stall);
+        stall_schedule_clear(&sched, stall);
+        screen_shown[stall] = false;
+
+        if (panel[stall]) {
+            display_begin();
+            oled_dev_clear(panel[stall]);
+            oled_dev_display_centered(panel[stall], "Debut douche !", 3);
+            display_commit();
+        }
+        led_stall_set(stall, false);
+        flow_meter_start(stall, s->session.start_us);
+        schedule_next_tick(stall, session_clock_now_us());
+        ESP_LOGI(TAG, "Cabine %u : timer demarre pour %s", (unsigned)stall, s->user);
+        break;
+
+    case TIMER_SM_STOPPED: {
+        flow_result_t flow;
+        bool measured = flow_meter_stop(stall, s->session.stop_us, &flow);
+
+        publish_snapshot(stall);
+        stall_schedule_clear(&sched, stall);
+        led_stall_set(stall, false);
+        show_stop_summary(stall, measured ? &flow : NULL);
+        break;
+    }
+
+    case TIMER_SM_RESET:
+        // Appui long : rien n’est enregistré ni envoyé
+        flow_meter_stop(stall, session_clock_now_us(), NULL);
+        publish_snapshot(stall);
+        stall_schedule_clear(&sched, stall);
+        led_stall_set(stall, false);
+        show_message(stall, "Reset !");
+        ESP_LOGI(TAG, "Cabine %u : reset, session abandonnee, utilisateur oublie", (unsigned)stall);
+        break;
+
+    case TIMER_SM_NO_USER:
+        show_select_user(stall);
+        break;
+
+    case TIMER_SM_USER_SET:
+        publish_snapshot(stall);
+        // Pendant une douche, le nom vaut pour la suivante : l’écran ne change pas
+        if (s->state == TIMER_STOPPED) show_message(stall, s->user);
+        break;
+
+    case TIMER_SM_BUDGET_SET:
+        publish_snapshot(stall);
+        ESP_LOGI(TAG, "Cabine %u : duree allouee = %lld s", (unsigned)stall,
+                 (long long)(s->budget_us / SESSION_US_PER_S));
+        break;
+
+    case TIMER_SM_IGNORED:
+        break;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: process_commands
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Vide la file de commandes et applique leurs effets
+
+   --------------------------------------------------------------------------
+   Description:
+   Chaque commande passe par timer_sm_apply sur la machine d’états de sa
+   cabine (voir apply_result). La durée d’un utilisateur nommé est
+   d’abord écrite en NVS (rare, hors des callbacks BLE) puis appliquée à
+   toutes les cabines où il est choisi. Les commandes du journal
+   (synchronisation, acquittement, historique) ne concernent aucune
+   cabine.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
 
-/**-------------------------------------------------------------------------- --
-   Static variables
 -- -------------------------------------------------------------------------- */
-static timer_state_t state = TIMER_STOPPED;   // État actuel du timer
-static uint32_t start_ms = 0;                 // Timestamp du démarrage
-static uint32_t overtime_ms = 0;              // Durée de dépassement
+static void process_commands(void) {
+    timer_cmd_t cmd;
+
+    while (timer_cmd_pop(&cmd_queue, &cmd)) {
+        if (cmd.type == TIMER_CMD_JOURNAL_SYNC) {
+            ESP_LOGI(TAG, "Synchronisation du journal : %lu douche(s) en attente",
+                     (unsigned long)session_journal_pending());
+            esp_timer_stop(retry_timer);        // La synchronisation tient lieu de relance
+            atomic_store(&retry_armed, false);
+            session_journal_rewind();
+            journal_send_batch();
+            continue;
+        }
+        if (cmd.type == TIMER_CMD_JOURNAL_ACK) {
+            if (session_journal_ack(cmd.seq)) journal_send_batch();
+            continue;
+        }
+        if (cmd.type == TIMER_CMD_JOURNAL_REPLAY) {
+            if (session_journal_replay(cmd.seq)) {
+                ESP_LOGI(TAG, "Historique demande apres %lu : %lu douche(s)",
+                         (unsigned long)cmd.seq, (unsigned long)session_journal_pending());
+                journal_send_batch();
+            }
+            continue;
+        }
+
+        // Durée d’un utilisateur nommé : mémorisée même s’il n’est pas choisi
+        if (cmd.type == TIMER_CMD_SET_BUDGET && cmd.user[0] != '\0') {
+            user_budget_set(cmd.user, (uint16_t)(cmd.budget_us / SESSION_US_PER_S));
+            for (uint8_t i = 0; i < stall_count; i++) {
+                apply_result(i, timer_sm_apply(&sm[i], &cmd, session_clock_now_us()));
+            }
+            continue;
+        }
+
+        apply_result(cmd.stall, timer_sm_apply(&sm[cmd.stall], &cmd, session_clock_now_us()));
+    }
+}
+
 
 /**========================================================================== --
    Public functions
@@ -72,75 +822,128 @@ static uint32_t overtime_ms = 0;              // Durée de dépassement
 
    --------------------------------------------------------------------------
    Purpose:
-   Accès à l’état courant du timer (stopped, running, overtime)
+   Accès à l’état courant du timer d’une cabine (stopped, running, overtime)
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : cabine
 
    --------------------------------------------------------------------------
    Return value:
-     timer_state_t
+     timer_state_t (dernier état publié, TIMER_STOPPED si cabine inconnue)
 
 -- -------------------------------------------------------------------------- */
-timer_state_t timer_manager_get_state(void) {
-    return state;
+timer_state_t timer_manager_get_state(uint8_t stall) {
+    timer_snapshot_t snap;
+    timer_manager_get_snapshot(stall, &snap);
+    return snap.state;
 }
 
 
 /* -------------------------------------------------------------------------- --
-   FUNCTION: timer_manager_get_total_time
+   FUNCTION: timer_manager_get_snapshot
 
    --------------------------------------------------------------------------
    Purpose:
-   Donne le temps écoulé depuis le démarrage du timer
+   Copie cohérente de l’état du timer d’une cabine, sans verrou
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : cabine (inconnue : état arrêté, vide)
+     out   : copie de l’état publié
 
    --------------------------------------------------------------------------
    Return value:
-     Temps en millisecondes
+     Aucun
 
 -- -------------------------------------------------------------------------- */
-uint32_t timer_manager_get_total_time(void) {
-    if (state == TIMER_STOPPED)
-        return 0;
+void timer_manager_get_snapshot(uint8_t stall, timer_snapshot_t* out) {
+    if (stall >= stall_count) {
+        memset(out, 0, sizeof(*out));
+        out->state = TIMER_STOPPED;
+        return;
+    }
+    timer_snapshot_read(&snapshot[stall], out);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_get_total_time_us
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Donne le temps écoulé depuis le démarrage du timer d’une cabine
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : cabine
 
-    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    if ((state == TIMER_RUNNING || state == TIMER_OVERTIME) && now > start_ms)
-        return now - start_ms;
+   --------------------------------------------------------------------------
+   Return value:
+     Temps en microsecondes (0 si le timer est arrêté)
 
-    return 0;
+-- -------------------------------------------------------------------------- */
+int64_t timer_manager_get_total_time_us(uint8_t stall) {
+    timer_snapshot_t snap;
+    timer_manager_get_snapshot(stall, &snap);
+    return timer_manager_snapshot_elapsed_us(&snap);
 }
 
 
 /* -------------------------------------------------------------------------- --
-   FUNCTION: timer_manager_start
+   FUNCTION: timer_manager_snapshot_elapsed_us
 
    --------------------------------------------------------------------------
    Purpose:
-   Démarre le timer avec un nom d’utilisateur facultatif
+   Donne le temps écoulé selon un instantané déjà lu
+
+   --------------------------------------------------------------------------
+   Description:
+   Évite une seconde lecture de l’instantané : la durée reste cohérente
+   avec l’état et la session décrits par snap.
 
    --------------------------------------------------------------------------
    Parameters:
-     username : chaîne reçue depuis BLE ou locale
+     snap : instantané (timer_manager_get_snapshot)
 
    --------------------------------------------------------------------------
    Return value:
-     Aucun
+     Temps en microsecondes (0 si le timer est arrêté)
 
 -- -------------------------------------------------------------------------- */
-void timer_manager_start(const char* username) {
-    if (state == TIMER_RUNNING || state == TIMER_OVERTIME) return;
+int64_t timer_manager_snapshot_elapsed_us(const timer_snapshot_t* snap) {
+    if (snap->state == TIMER_STOPPED)
+        return 0;
 
-    start_ms = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    state = TIMER_RUNNING;
-    overtime_ms = 0;
+    session_clock_t c = { snap->start_us, snap->stop_us, snap->duration_us };
+    return session_clock_elapsed_us(&c, session_clock_now_us());
+}
 
-    if (username && username[0] != '\0') {
-        strncpy(user_name, username, sizeof(user_name)-1);
-        user_name[sizeof(user_name)-1] = '\0';
-    }
 
-    oled_clear();
-    oled_display_centered("Debut douche !", 3);
-    led_off();
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_start
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Demande le démarrage du timer avec un nom d’utilisateur facultatif
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall    : cabine
+     username : chaîne reçue depuis BLE ou locale (NULL ou "" : utilisateur
+                courant)
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la commande a été déposée
 
-    ESP_LOGI(TAG, "Timer demarre pour %s", user_name);
+-- -------------------------------------------------------------------------- */
+bool timer_manager_start(uint8_t stall, const char* username) {
+    timer_cmd_t cmd = { .type = TIMER_CMD_START, .stall = stall };
+    if (username) {
+        strncpy(cmd.user, username, sizeof(cmd.user) - 1);
+    }
+    return post_cmd(&cmd);
 }
 
 
@@ -149,45 +952,289 @@ void timer_manager_start(const char* username) {
 
    --------------------------------------------------------------------------
    Purpose:
-   Arrête le timer, affiche le temps total et l’envoie en BLE
+   Demande l’arrêt du timer (affichage du total et envoi BLE par la tâche)
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : cabine
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la commande a été déposée
+
+-- -------------------------------------------------------------------------- */
+bool timer_manager_stop(uint8_t stall) {
+    timer_cmd_t cmd = { .type = TIMER_CMD_STOP, .stall = stall };
+    return post_cmd(&cmd);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_reset
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Demande l’abandon de la douche en cours (appui long) : ni journal ni
+   envoi BLE, l’utilisateur doit être choisi à nouveau
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : cabine
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la commande a été déposée
+
+-- -------------------------------------------------------------------------- */
+bool timer_manager_reset(uint8_t stall) {
+    timer_cmd_t cmd = { .type = TIMER_CMD_RESET, .stall = stall };
+    return post_cmd(&cmd);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_set_user
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Change l’utilisateur des prochaines douches (message de bienvenue si
+   aucune douche n’est en cours)
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall    : cabine
+     username : nom reçu (tronqué à 31 caractères)
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la commande a été déposée
+
+-- -------------------------------------------------------------------------- */
+bool timer_manager_set_user(uint8_t stall, const char* username) {
+    timer_cmd_t cmd = { .type = TIMER_CMD_SET_USER, .stall = stall };
+    strncpy(cmd.user, username, sizeof(cmd.user) - 1);
+    return post_cmd(&cmd);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_set_budget
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Change la durée allouée des prochaines douches
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall     : cabine
+     budget_us : durée en microsecondes (> 0)
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la commande a été déposée
+
+-- -------------------------------------------------------------------------- */
+bool timer_manager_set_budget(uint8_t stall, int64_t budget_us) {
+    timer_cmd_t cmd = { .type = TIMER_CMD_SET_BUDGET, .stall = stall, .budget_us = budget_us };
+    return post_cmd(&cmd);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_set_user_budget
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Mémorise la durée allouée d’un utilisateur (envoyée par le backend)
+
+   --------------------------------------------------------------------------
+   Description:
+   La durée est écrite en NVS par la tâche du minuteur ; elle s’applique
+   tout de suite aux cabines où cet utilisateur est déjà choisi, sinon au
+   moment où il le sera.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     username : nom de l’utilisateur
+     budget_s : durée en secondes (1 à USER_BUDGET_MAX_S)
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la commande a été déposée
+
+-- -------------------------------------------------------------------------- */
+bool timer_manager_set_user_budget(const char* username, uint16_t budget_s) {
+    if (username[0] == '\0' || budget_s == 0 || budget_s > USER_BUDGET_MAX_S) return false;
+
+    timer_cmd_t cmd = { .type = TIMER_CMD_SET_BUDGET,
+                        .budget_us = (int64_t)budget_s * SESSION_US_PER_S };
+    strncpy(cmd.user, username, sizeof(cmd.user) - 1);
+    return post_cmd(&cmd);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_sync_journal
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Demande l’envoi des douches non acquittées du journal
+
+   --------------------------------------------------------------------------
+   Description:
+   Appelée quand le pont active les notifications : le lot éventuellement
+   perdu avec l’ancienne connexion est renvoyé.
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la commande a été déposée
+
+-- -------------------------------------------------------------------------- */
+bool timer_manager_sync_journal(void) {
+    timer_cmd_t cmd = { .type = TIMER_CMD_JOURNAL_SYNC };
+    return post_cmd(&cmd);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_ack_journal
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Transmet l’acquittement du pont à la tâche du minuteur
+
+   --------------------------------------------------------------------------
+   Parameters:
+     seq : dernier numéro de douche enregistré par le backend
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la commande a été déposée
+
+-- -------------------------------------------------------------------------- */
+bool timer_manager_ack_journal(uint32_t seq) {
+    timer_cmd_t cmd = { .type = TIMER_CMD_JOURNAL_ACK, .seq = seq };
+    return post_cmd(&cmd);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_replay_journal
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Demande le renvoi du journal après un numéro (commande HISTORY du pont)
+
+   --------------------------------------------------------------------------
+   Parameters:
+     seq : dernier numéro de douche que le pont garde
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si la commande a été déposée
+
+-- -------------------------------------------------------------------------- */
+bool timer_manager_replay_journal(uint32_t seq) {
+    timer_cmd_t cmd = { .type = TIMER_CMD_JOURNAL_REPLAY, .seq = seq };
+    return post_cmd(&cmd);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: stall_tick
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Frontière de seconde d’une cabine
+
+   --------------------------------------------------------------------------
+   Description:
+   En mode RUNNING, compose l’écran du minuteur au premier passage puis
+   ne transmet que le temps restant et le remplissage ; à l’échéance,
+   bascule en OVERTIME et programme le clignotement ; en OVERTIME,
+   affiche le dépassement. Programme ensuite le tick suivant. Le
+   débitmètre de la cabine est lu à chaque tick.
+
+   --------------------------------------------------------------------------
+   Parameters:
+     stall : cabine dont le tick est atteint
+     now   : instant du réveil
 
    --------------------------------------------------------------------------
    Return value:
      Aucun
 
 -- -------------------------------------------------------------------------- */
-void timer_manager_stop(void) {
-    if (state == TIMER_STOPPED) return;
-
-    uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
-    uint32_t total_time = now - start_ms;
-
-    state = TIMER_STOPPED;
-    led_off();
-
-    char buf[32];
-    snprintf(buf, sizeof(buf), "%s %02u:%02u", "Total",
-             (unsigned int)(total_time / 60000),
-             (unsigned int)((total_time / 1000) % 60));
-    oled_clear();
-    oled_display_centered(buf, 3);
-
-    ESP_LOGI(TAG, "Timer arrete. Duree totale = %lu ms", (unsigned long)total_time);
-
-    // Envoi BLE du résumé de la douche
-    if (is_connected && enable_data_ntf) {
-        char ble_msg[64];
-        snprintf(ble_msg, sizeof(ble_msg), "User:%s;Time:%lu s",
-                 user_name, (unsigned long)(total_time / 1000));
-        esp_ble_gatts_send_indicate(
-            spp_gatts_if,
-            spp_conn_id,
-            spp_handle_table[SPP_IDX_SPP_DATA_NTY_VAL],
-            strlen(ble_msg),
-            (uint8_t*)ble_msg,
-            false
-        );
+static void stall_tick(uint8_t stall, int64_t now) {
+    timer_sm_t* s = &sm[stall];
+    ssd1306_t* dev = panel[stall];
+
+    flow_meter_sample(stall, now);
+
+    if (s->state == TIMER_RUNNING && session_clock_remaining_us(&s->session, now) == 0) {
+        s->state = TIMER_OVERTIME;
+        publish_snapshot(stall);
+        ESP_LOGI(TAG, "Cabine %u : mode depassement ! Temps depasse.", (unsigned)stall);
+        if (dev) {
+            if (!screen_shown[stall]) {
+                oled_dev_timer_screen_show(&screen[stall], dev, s->user, 0);
+                screen_shown[stall] = true;
+            }
+            oled_dev_timer_screen_overtime(&screen[stall], 0);
+        }
+        led_stall_set(stall, true);
+        blink_on[stall] = true;
+        sched.blink_us[stall] = now + OVERTIME_BLINK_US;
+    }
+    else if (s->state == TIMER_RUNNING) {
+        // Arrondi : un réveil en retard de quelques ms reste sur la bonne seconde
+        int64_t budget_s = s->session.duration_us / SESSION_US_PER_S;
+        uint32_t remain = (uint32_t)((session_clock_remaining_us(&s->session, now)
+                                      + SESSION_US_PER_S / 2) / SESSION_US_PER_S);
+        uint8_t fill = 100 - (uint8_t)((remain * 100) / (budget_s > 0 ? budget_s : 1));
+
+        if (dev) {
+            if (!screen_shown[stall]) {
+                oled_dev_timer_screen_show(&screen[stall], dev, s->user, remain);
+                screen_shown[stall] = true;
+            }
+            oled_dev_timer_screen_update(&screen[stall], remain, fill);
+        }
+    }
+    else if (dev) {
+        int64_t overtime_us = session_clock_overtime_us(&s->session, now);
+        oled_dev_timer_screen_overtime(&screen[stall], (uint32_t)((overtime_us + SESSION_US_PER_S / 2)
+                                                                 / SESSION_US_PER_S));
     }
+    schedule_next_tick(stall, now);
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: stall_blink
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Front de clignotement d’une cabine en dépassement : phase de l’alerte
+   (propriété du widget) et LED
+
+   --------------------------------------------------------------------------
+   Description:
+   L’échéance suivante est comptée depuis la précédente (pas de dérive) ;
+   après un long retard, elle repart de l’instant courant.
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+static void stall_blink(uint8_t stall, int64_t now) {
+    sched.blink_us[stall] += OVERTIME_BLINK_US;
+    if (sched.blink_us[stall] <= now) sched.blink_us[stall] = now + OVERTIME_BLINK_US;
+
+    blink_on[stall] = !blink_on[stall];
+    if (panel[stall]) oled_dev_timer_screen_blink(&screen[stall], blink_on[stall]);
+    led_stall_set(stall, blink_on[stall]);
 }
 
 
@@ -196,13 +1243,24 @@ void timer_manager_stop(void) {
 
    --------------------------------------------------------------------------
    Purpose:
-   Tâche FreeRTOS principale : actualise écran et LED en fonction de l’état
+   Tâche FreeRTOS propriétaire des timers de toutes les cabines :
+   commandes, échéances, écrans et LED
 
    --------------------------------------------------------------------------
    Description:
-   - En mode RUNNING : affiche le temps restant et une jauge
-   - En mode OVERTIME : clignote OLED et LED, compte le dépassement
-   - Sinon : ne fait rien
+   La tâche dort sur sa notification : aucun réveil quand toutes les
+   cabines sont arrêtées et qu’aucune commande n’arrive.
+   - EVT_CMD : commandes du bouton et du BLE (voir process_commands)
+   - EVT_UNSAVED : fin d’envoi d’une douche hors journal, la suivante
+     (ou le lot du journal) peut partir
+   - EVT_RETRY (esp_timer de relance) : après un envoi abandonné, les
+     douches non acquittées repartent comme à la synchronisation
+   - EVT_DEADLINE (callback de l’esp_timer des échéances) : toutes les
+     échéances atteintes sont traitées d’un coup, cabine par cabine
+     (stall_tick chaque seconde, stall_blink toutes les
+     OVERTIME_BLINK_US en dépassement)
+   Les commandes sont traitées avant les échéances du même réveil ; le
+   timer est ensuite réarmé sur la plus proche échéance restante.
 
    --------------------------------------------------------------------------
    Return value:
@@ -210,50 +1268,33 @@ void timer_manager_stop(void) {
 
 -- -------------------------------------------------------------------------- */
 static void timer_manager_task(void *arg) {
-    bool blink = false;
     while (1) {
-        if (state == TIMER_RUNNING) {
-            uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
-            uint32_t elapsed = now - start_ms;
-
-            if (elapsed >= TIMER_DURATION_MS) {
-                state = TIMER_OVERTIME;
-                overtime_ms = 0;
-                ESP_LOGI(TAG, "Mode depassement ! Temps depasse.");
-                oled_draw_explosion(true);
-                led_on();
-            } else {
-                uint32_t remain = (TIMER_DURATION_MS - elapsed) / 1000;
-                uint8_t fill = 100 - (remain * 100) / (TIMER_DURATION_MS/1000);
-
-                oled_clear();
-                char buf[64];
-                snprintf(buf, sizeof(buf), "%s %02u:%02u", user_name,
-                         (unsigned int)(remain / 60), (unsigned int)(remain % 60));
-                oled_display_centered(buf, 1);
-                oled_draw_goutte(fill);
-                led_off();
-            }
-        }
-
-        else if (state == TIMER_OVERTIME) {
-            uint32_t now = xTaskGetTickCount() * portTICK_PERIOD_MS;
-            overtime_ms = now - start_ms - TIMER_DURATION_MS;
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
 
-            char buf[32];
-            snprintf(buf, sizeof(buf), "00:00  +%lus", (unsigned long)(overtime_ms / 1000));
-            oled_draw_explosion(blink);
-            oled_display_centered(buf, 5);
+        if (events & EVT_CMD) process_commands();
+        if (events & EVT_UNSAVED) journal_send_batch();
+        if (events & EVT_RETRY) {
+            atomic_store(&retry_armed, false);
+            session_journal_rewind();
+            journal_send_batch();
+        }
 
-            if (blink) led_on();
-            else       led_off();
+        int64_t now = session_clock_now_us();
+        uint32_t blinks;
+        uint32_t ticks = stall_schedule_due(&sched, now, &blinks);
 
-            blink = !blink;
-            vTaskDelay(pdMS_TO_TICKS(OVERTIME_BLINK_MS));
-            continue;
+        for (uint8_t i = 0; i < stall_count; i++) {
+            if (ticks & (1u << i)) {
+                jitter_record(sched.tick_us[i]);
+                stall_tick(i, now);
+            }
+            if ((blinks & (1u << i)) && sm[i].state == TIMER_OVERTIME) {
+                jitter_record(sched.blink_us[i]);
+                stall_blink(i, now);
+            }
         }
-
-        vTaskDelay(pdMS_TO_TICKS(200));  // Actualisation régulière
+        arm_schedule();
     }
 }
 
@@ -263,7 +1304,9 @@ static void timer_manager_task(void *arg) {
 
    --------------------------------------------------------------------------
    Purpose:
-   Initialise le système de minuterie (démarrage de la tâche)
+   Initialise le système de minuterie (durées par utilisateur, journal,
+   débitmètres, cabines et leurs écrans, file, esp_timer et tâche) ; la NVS doit être
+   initialisée, la tâche d’affichage lancée
 
    --------------------------------------------------------------------------
    Return value:
@@ -271,5 +1314,33 @@ static void timer_manager_task(void *arg) {
 
 -- -------------------------------------------------------------------------- */
 void timer_manager_init(void) {
-    xTaskCreate(timer_manager_task, "timer_manager_task", 4096, NULL, 6, NULL);
+    user_budget_init();
+    session_journal_init();
+    flow_meter_init();
+
+    stall_schedule_init(&sched, stall_count);
+    for (uint8_t i = 0; i < stall_count; i++) {
+        timer_sm_init(&sm[i], (int64_t)USER_BUDGET_DEFAULT_S * SESSION_US_PER_S);
+        sm[i].budget_of = budget_of_user;
+        publish_snapshot(i);
+        panel[i] = oled_open_panel(stall_table[i].oled_addr);
+    }
+    timer_cmd_queue_init(&cmd_queue);
+    ESP_LOGI(TAG, "%u cabine(s)", (unsigned)stall_count);
+
+    const esp_timer_create_args_t sched_args = {
+        .callback = timer_event_cb,
+        .arg = (void *)(uintptr_t)EVT_DEADLINE,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "timer_sched",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&sched_args, &sched_timer));
+    const esp_timer_create_args_t retry_args = {
+        .callback = timer_event_cb,
+        .arg = (void *)(uintptr_t)EVT_RETRY,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "timer_retry",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&retry_args, &retry_timer));
+    xTaskCreate(timer_manager_task, "timer_manager_task", 4096, NULL, 6, &timer_task_handle);
 }
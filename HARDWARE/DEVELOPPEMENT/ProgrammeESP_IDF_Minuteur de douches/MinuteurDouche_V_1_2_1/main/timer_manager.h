@@ -13,6 +13,14 @@
    - Informations sur la durée et l’état du minuteur
    - À utiliser avec FreeRTOS
 
+   Les fonctions de commande ne font que déposer une demande pour la tâche
+   du minuteur (jamais bloquantes) ; les lectures sont des instantanés
+   sans verrou.
+
+   Une carte minute plusieurs cabines (stall_config.h) : chaque commande
+   et chaque lecture désigne sa cabine par son numéro "stall" (0 à
+   stall_count - 1). La carte d’origine n’a que la cabine 0.
+
    ==========================================================================
    History:
    --------------------------------------------------------------------------
@@ -23,8 +31,14 @@
 #ifndef TIMER_MANAGER_H
 #define TIMER_MANAGER_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define TIMER_USER_MAX       32      // Nom d’utilisateur, zéro final compris
+
 /**-------------------------------------------------------------------------- --
    Types publics
 -- -------------------------------------------------------------------------- */
@@ -42,6 +56,27 @@ typedef enum {
     TIMER_OVERTIME
 } timer_state_t;
 
+/* -------------------------------------------------------------------------- --
+   STRUCT: timer_snapshot_t
+   Copie cohérente de l’état du minuteur (instants en µs, base
+   session_clock_now_us) :
+     - start_us / stop_us : session en cours ou dernière session
+       (stop_us = 0 tant qu’elle court)
+     - duration_us        : durée allouée à cette session
+     - budget_us          : durée allouée aux prochaines sessions
+     - sessions           : sessions démarrées depuis le démarrage
+     - user               : utilisateur courant
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    timer_state_t state;
+    int64_t start_us;
+    int64_t stop_us;
+    int64_t duration_us;
+    int64_t budget_us;
+    uint32_t sessions;
+    char user[TIMER_USER_MAX];
+} timer_snapshot_t;
+
 
 /**-------------------------------------------------------------------------- --
    Fonctions principales
@@ -50,21 +85,73 @@ typedef enum {
 /* -------------------------------------------------------------------------- --
    FUNCTION: timer_manager_start
    Démarre le minuteur avec un utilisateur donné (affichage personnalisé)
-   Paramètre :
-     username : nom de l’utilisateur à afficher sur l’OLED
+   Paramètres :
+     stall    : cabine
+     username : nom de l’utilisateur à afficher sur l’OLED (NULL ou "" :
+                utilisateur courant ; sans utilisateur, invite à en choisir)
+   Retour : false si la commande n’a pas pu être déposée (ou cabine inconnue)
 -- -------------------------------------------------------------------------- */
-void timer_manager_start(const char* username);
+bool timer_manager_start(uint8_t stall, const char* username);
 
 /* -------------------------------------------------------------------------- --
    FUNCTION: timer_manager_stop
    Arrête le minuteur en cours, affiche la durée et envoie la donnée via BLE
+   Retour : false si la commande n’a pas pu être déposée
+-- -------------------------------------------------------------------------- */
+bool timer_manager_stop(uint8_t stall);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_reset
+   Abandonne la douche en cours sans l’enregistrer et oublie l’utilisateur
+   Retour : false si la commande n’a pas pu être déposée
+-- -------------------------------------------------------------------------- */
+bool timer_manager_reset(uint8_t stall);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_set_user
+   Change l’utilisateur des prochaines douches de la cabine (bienvenue
+   affichée si aucune douche n’y est en cours)
 -- -------------------------------------------------------------------------- */
-void timer_manager_stop(void);
+bool timer_manager_set_user(uint8_t stall, const char* username);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_set_budget
+   Change la durée allouée des prochaines douches de la cabine (en
+   microsecondes)
+-- -------------------------------------------------------------------------- */
+bool timer_manager_set_budget(uint8_t stall, int64_t budget_us);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_set_user_budget
+   Mémorise en NVS la durée allouée (secondes) d’un utilisateur ; elle
+   s’applique dès que cet utilisateur est choisi, dans toute cabine
+-- -------------------------------------------------------------------------- */
+bool timer_manager_set_user_budget(const char* username, uint16_t budget_s);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_sync_journal
+   Renvoie les douches du journal non acquittées (notifications activées
+   ou demande "SYNC" du pont)
+-- -------------------------------------------------------------------------- */
+bool timer_manager_sync_journal(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_ack_journal
+   Acquittement du pont ("ACK:<seq>") : envoie le lot suivant du journal
+-- -------------------------------------------------------------------------- */
+bool timer_manager_ack_journal(uint32_t seq);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_replay_journal
+   Historique demandé par le pont : renvoie le journal après seq (même
+   acquitté, tant qu’il est encore en flash)
+-- -------------------------------------------------------------------------- */
+bool timer_manager_replay_journal(uint32_t seq);
 
 /* -------------------------------------------------------------------------- --
    FUNCTION: timer_manager_init
    Initialise et lance la tâche timer_manager_task (FreeRTOS)
-   À appeler dans app_main
+   À appeler dans app_main, après l’initialisation de la NVS (BLE)
 -- -------------------------------------------------------------------------- */
 void timer_manager_init(void);
 
@@ -75,15 +162,30 @@ void timer_manager_init(void);
 
 /* -------------------------------------------------------------------------- --
    FUNCTION: timer_manager_get_state
-   Retourne l’état actuel du minuteur (voir timer_state_t)
+   Retourne l’état actuel du minuteur de la cabine (voir timer_state_t)
+-- -------------------------------------------------------------------------- */
+timer_state_t timer_manager_get_state(uint8_t stall);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_get_snapshot
+   Copie cohérente de tout l’état du minuteur de la cabine (voir
+   timer_snapshot_t)
 -- -------------------------------------------------------------------------- */
-timer_state_t timer_manager_get_state(void);
+void timer_manager_get_snapshot(uint8_t stall, timer_snapshot_t* out);
 
 /* -------------------------------------------------------------------------- --
-   FUNCTION: timer_manager_get_total_time
-   Retourne la durée écoulée depuis le démarrage (en millisecondes)
+   FUNCTION: timer_manager_get_total_time_us
+   Retourne la durée écoulée depuis le démarrage (en microsecondes, horloge
+   64 bits de session_clock)
    Si stoppé : retourne 0
 -- -------------------------------------------------------------------------- */
-uint32_t timer_manager_get_total_time(void);
+int64_t timer_manager_get_total_time_us(uint8_t stall);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: timer_manager_snapshot_elapsed_us
+   Durée écoulée selon un instantané déjà lu (cohérente avec ses autres
+   champs) ; 0 si stoppé
+-- -------------------------------------------------------------------------- */
+int64_t timer_manager_snapshot_elapsed_us(const timer_snapshot_t* snap);
 
 #endif // TIMER_MANAGER_H
@@ -0,0 +1,224 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: user_budget.c
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Durées allouées par utilisateur :
+   - Entrées de 40 octets : empreinte FNV-1a du nom (recherche rapide),
+     nom (deux noms de même empreinte restent distincts), durée en
+     secondes et ordre d’utilisation (pour remplacer la plus ancienne)
+   - La table entière est un seul blob NVS : une lecture au démarrage,
+     une écriture par mise à jour venant du backend
+   - Seule timer_manager_task appelle ce module (pas de verrou)
+
+-- ========================================================================== */
+
+/**-------------------------------------------------------------------------- --
+   Include header files
+-- -------------------------------------------------------------------------- */
+#include "user_budget.h"
+#include "nvs.h"
+#include "esp_log.h"
+#include <string.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define NVS_NAMESPACE   "minuteur"
+#define NVS_KEY         "budgets"
+
+static const char* TAG = "BUDGET";
+
+/**-------------------------------------------------------------------------- --
+   Types
+-- -------------------------------------------------------------------------- */
+typedef struct {
+    uint32_t key;           // Empreinte du nom (0 = entrée libre)
+    char name[USER_BUDGET_NAME_MAX];
+    uint16_t budget_s;      // Durée allouée
+    uint16_t stamp;         // Ordre de dernière mise à jour
+} budget_entry_t;
+
+/**-------------------------------------------------------------------------- --
+   Static variables
+-- -------------------------------------------------------------------------- */
+static budget_entry_t table[USER_BUDGET_MAX];
+static uint16_t next_stamp = 1;
+
+/**========================================================================== --
+   Private functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: user_key
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Empreinte FNV-1a 32 bits du nom (jamais 0, valeur des entrées libres)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Empreinte du nom
+
+-- -------------------------------------------------------------------------- */
+static uint32_t user_key(const char* user) {
+    uint32_t h = 2166136261u;
+    for (; *user; user++) {
+        h ^= (uint8_t)*user;
+        h *= 16777619u;
+    }
+    return h ? h : 1;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: table_find
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Entrée d’un utilisateur : empreinte comparée d’abord, puis le nom
+
+   --------------------------------------------------------------------------
+   Return value:
+     Entrée, NULL si l’utilisateur est inconnu
+
+-- -------------------------------------------------------------------------- */
+static budget_entry_t* table_find(const char* user, uint32_t key) {
+    for (int i = 0; i < USER_BUDGET_MAX; i++) {
+        if (table[i].key == key && strncmp(table[i].name, user, USER_BUDGET_NAME_MAX) == 0)
+            return &table[i];
+    }
+    return NULL;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: table_save
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Réécrit la table en NVS
+
+   --------------------------------------------------------------------------
+   Return value:
+     ESP_OK ou code d’erreur NVS
+
+-- -------------------------------------------------------------------------- */
+static esp_err_t table_save(void) {
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &h);
+    if (err != ESP_OK) return err;
+
+    err = nvs_set_blob(h, NVS_KEY, table, sizeof(table));
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    return err;
+}
+
+
+/**========================================================================== --
+   Public functions
+-- ========================================================================== */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: user_budget_init
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Charge la table mémorisée ; table vide si absente ou de taille
+   différente (changement de USER_BUDGET_MAX ou du format des entrées)
+
+   --------------------------------------------------------------------------
+   Return value:
+     Aucun
+
+-- -------------------------------------------------------------------------- */
+void user_budget_init(void) {
+    nvs_handle_t h;
+    size_t len = sizeof(table);
+
+    memset(table, 0, sizeof(table));
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &h) != ESP_OK) return;
+
+    if (nvs_get_blob(h, NVS_KEY, table, &len) != ESP_OK || len != sizeof(table)) {
+        memset(table, 0, sizeof(table));
+    }
+    nvs_close(h);
+
+    for (int i = 0; i < USER_BUDGET_MAX; i++) {
+        if (table[i].key && table[i].stamp >= next_stamp) next_stamp = table[i].stamp + 1;
+    }
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: user_budget_set
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Enregistre la durée allouée à un utilisateur
+
+   --------------------------------------------------------------------------
+   Parameters:
+     user     : nom de l’utilisateur
+     budget_s : durée en secondes (1 à USER_BUDGET_MAX_S)
+
+   --------------------------------------------------------------------------
+   Return value:
+     true si enregistrée en RAM et en NVS
+
+-- -------------------------------------------------------------------------- */
+bool user_budget_set(const char* user, uint16_t budget_s) {
+    if (user[0] == '\0' || budget_s == 0 || budget_s > USER_BUDGET_MAX_S) return false;
+
+    uint32_t key = user_key(user);
+    budget_entry_t* slot = table_find(user, key);
+
+    if (slot && slot->budget_s == budget_s) return true;    // Inchangé : pas d’écriture flash
+
+    if (!slot) {
+        // Entrée libre, sinon la moins récemment mise à jour
+        slot = &table[0];
+        for (int i = 0; i < USER_BUDGET_MAX; i++) {
+            if (table[i].key == 0) { slot = &table[i]; break; }
+            if ((uint16_t)(next_stamp - table[i].stamp) > (uint16_t)(next_stamp - slot->stamp))
+                slot = &table[i];
+        }
+    }
+
+    slot->key = key;
+    strncpy(slot->name, user, USER_BUDGET_NAME_MAX - 1);
+    slot->name[USER_BUDGET_NAME_MAX - 1] = '\0';
+    slot->budget_s = budget_s;
+    slot->stamp = next_stamp++;
+
+    esp_err_t err = table_save();
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Ecriture NVS impossible : %s", esp_err_to_name(err));
+        return false;
+    }
+    ESP_LOGI(TAG, "Duree de %s = %u s", user, (unsigned)budget_s);
+    return true;
+}
+
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: user_budget_get
+
+   --------------------------------------------------------------------------
+   Purpose:
+   Durée allouée à un utilisateur, lue en RAM
+
+   --------------------------------------------------------------------------
+   Return value:
+     Secondes (USER_BUDGET_DEFAULT_S si l’utilisateur est inconnu)
+
+-- -------------------------------------------------------------------------- */
+uint16_t user_budget_get(const char* user) {
+    const budget_entry_t* e = table_find(user, user_key(user));
+    return e ? e->budget_s : USER_BUDGET_DEFAULT_S;
+}
@@ -0,0 +1,57 @@
+/* ========================================================================== --
+                     Projet : Smart Minuteur de Douche - ESP32
+
+   ==========================================================================
+   File: user_budget.h
+
+   ==========================================================================
+   Functional description:
+   --------------------------------------------------------------------------
+   Durée de douche allouée à chaque utilisateur :
+   - Table compacte en RAM (nom + durée en secondes), chargée depuis la
+     NVS au démarrage
+   - Mise à jour par le backend via le pont BLE, réécrite en NVS
+   - Consultation sans accès flash au moment où un utilisateur est choisi
+
+-- ========================================================================== */
+
+#ifndef USER_BUDGET_H
+#define USER_BUDGET_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**-------------------------------------------------------------------------- --
+   Constants and macros
+-- -------------------------------------------------------------------------- */
+#define USER_BUDGET_MAX        16      // Utilisateurs mémorisés
+#define USER_BUDGET_DEFAULT_S  300     // Durée par défaut (5 minutes)
+#define USER_BUDGET_MAX_S      3600    // Durée maximale acceptée
+#define USER_BUDGET_NAME_MAX   32      // Nom mémorisé, zéro final compris (comme TIMER_USER_MAX)
+
+/**-------------------------------------------------------------------------- --
+   Fonctions principales
+-- -------------------------------------------------------------------------- */
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: user_budget_init
+   Charge la table depuis la NVS (après nvs_flash_init)
+-- -------------------------------------------------------------------------- */
+void user_budget_init(void);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: user_budget_set
+   Enregistre la durée d’un utilisateur (RAM + NVS) ; remplace l’entrée
+   mise à jour le moins récemment si la table est pleine
+   Retour : false si la durée est hors limites ou l’écriture NVS échoue
+-- -------------------------------------------------------------------------- */
+bool user_budget_set(const char* user, uint16_t budget_s);
+
+/* -------------------------------------------------------------------------- --
+   FUNCTION: user_budget_get
+   Durée allouée à un utilisateur (USER_BUDGET_DEFAULT_S s’il est inconnu)
+   Lecture en RAM uniquement
+-- -------------------------------------------------------------------------- */
+uint16_t user_budget_get(const char* user);
+
+#endif // USER_BUDGET_H
@@ -4,5 +4,11 @@ public class DoucheDTO {
     //public String user;      // nom d'utilisateur (doit correspondre au champ dans la BDD User)
     public Long userId;
     public int timeSeconds;  // durée de la douche en secondes
+    public Integer overtimeSeconds; // dont dépassement de la durée allouée (null : ancien pont)
+    public Long journalSeq;     // numéro dans le journal de l'ESP32 (null : ancien firmware)
+    public Integer ageSeconds;  // secondes écoulées depuis la fin (douche prise hors connexion)
+    public Integer stall;       // cabine de la carte (null : ancien firmware, cabine 0)
+    public Integer volumeMl;       // eau mesurée en mL (null : cabine sans débitmètre)
+    public Integer peakFlowMlMin;  // débit de pointe en mL/min (null : idem)
 }
 
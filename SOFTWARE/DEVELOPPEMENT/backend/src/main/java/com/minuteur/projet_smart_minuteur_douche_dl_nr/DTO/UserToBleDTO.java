@@ -5,4 +5,5 @@ import lombok.Data;
 @Data
 public class UserToBleDTO {
     private String username;
+    private Integer stall;      // cabine de la carte (null ou 0 : cabine 0)
 }
\ No newline at end of file
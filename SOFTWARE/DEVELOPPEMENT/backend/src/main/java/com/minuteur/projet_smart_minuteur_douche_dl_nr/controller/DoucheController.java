@@ -37,15 +37,33 @@ public class DoucheController {
 
         User user = userOpt.get();
 
+        if (dto.journalSeq != null) {
+            Optional<Douche> deja = doucheService.getDoucheDuJournal(dto.journalSeq, user, dto.timeSeconds);
+            if (deja.isPresent()) {
+                return ResponseEntity.ok(deja.get());
+            }
+        }
+
+        // Douche transmise en différé : datée à partir de son âge
+        LocalDateTime debut = LocalDateTime.now();
+        LocalDateTime fin = debut.plusSeconds(dto.timeSeconds);
+        if (dto.ageSeconds != null) {
+            fin = LocalDateTime.now().minusSeconds(dto.ageSeconds);
+            debut = fin.minusSeconds(dto.timeSeconds);
+        }
+
         Douche douche = Douche.builder()
                 .user(user)
-                .dateDebut(LocalDateTime.now())
-                .dateFin(LocalDateTime.now().plusSeconds(dto.timeSeconds))
+                .dateDebut(debut)
+                .dateFin(fin)
                 .duree(dto.timeSeconds)
-                .tempsDepasse(0)
+                .journalSeq(dto.journalSeq)
+                .cabine(dto.stall != null ? dto.stall : 0)
+                .volumeMl(dto.volumeMl)
+                .debitMaxMlMin(dto.peakFlowMlMin)
                 .build();
 
-        return ResponseEntity.ok(doucheService.enregistrerDouche(douche));
+        return ResponseEntity.ok(doucheService.enregistrerDouche(douche, dto.overtimeSeconds));
     }
     @GetMapping
     public List<Douche> getAllDouches() {
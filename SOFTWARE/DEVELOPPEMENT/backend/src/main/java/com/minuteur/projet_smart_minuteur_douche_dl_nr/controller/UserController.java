@@ -1,6 +1,7 @@
 package com.minuteur.projet_smart_minuteur_douche_dl_nr.controller;
 
 import com.minuteur.projet_smart_minuteur_douche_dl_nr.model.User;
+import com.minuteur.projet_smart_minuteur_douche_dl_nr.service.BleBridgeService;
 import com.minuteur.projet_smart_minuteur_douche_dl_nr.service.UserService;
 import org.springframework.beans.factory.annotation.Autowired;
 import org.springframework.http.ResponseEntity; // ✅ Import manquant
@@ -17,6 +18,9 @@ public class UserController {
     @Autowired
     private UserService userService;
 
+    @Autowired
+    private BleBridgeService bleBridgeService;
+
     @PostMapping
     public User createUser(@RequestBody User user) {
         return userService.createUser(user);
@@ -43,4 +47,22 @@ public class UserController {
     public void addTempsToUser(@PathVariable Long id, @RequestParam int duree) {
         userService.ajouterTemps(id, duree);
     }
+
+    // Durée allouée par douche (1 s à 1 h), poussée à l'ESP32 qui la garde en NVS
+    @PatchMapping("/{id}/budget")
+    public ResponseEntity<User> setBudget(@PathVariable Long id, @RequestParam int secondes) {
+        if (secondes < 1 || secondes > 3600) {
+            return ResponseEntity.badRequest().build();
+        }
+        Optional<User> user = userService.definirBudget(id, secondes);
+        user.ifPresent(u -> {
+            try {
+                bleBridgeService.envoyerBudget(u);
+            } catch (Exception e) {
+                // ESP32 hors de portée : la durée sera renvoyée à la prochaine sélection
+            }
+        });
+        return user.map(ResponseEntity::ok)
+                .orElseGet(() -> ResponseEntity.notFound().build());
+    }
 }
\ No newline at end of file
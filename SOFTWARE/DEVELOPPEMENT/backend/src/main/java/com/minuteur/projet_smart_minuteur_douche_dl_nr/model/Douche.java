@@ -27,4 +27,19 @@ public class Douche {
 
     @Column(name = "temps_depasse")
     private int tempsDepasse;
+
+    // Numéro de la douche dans le journal de l'ESP32 (renvois après une coupure)
+    @Column(name = "journal_seq")
+    private Long journalSeq;
+
+    // Cabine de la carte ESP32 (0 sur une carte à une seule cabine)
+    @Column(name = "cabine")
+    private Integer cabine;
+
+    // Eau mesurée par le débitmètre de la cabine (null : cabine sans débitmètre)
+    @Column(name = "volume_ml")
+    private Integer volumeMl;
+
+    @Column(name = "debit_max_ml_min")
+    private Integer debitMaxMlMin;
 }
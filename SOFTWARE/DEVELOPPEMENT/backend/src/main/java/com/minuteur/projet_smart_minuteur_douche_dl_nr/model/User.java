@@ -1,5 +1,6 @@
 package com.minuteur.projet_smart_minuteur_douche_dl_nr.model;
 
+import com.fasterxml.jackson.annotation.JsonIgnore;
 import jakarta.persistence.*;
 import lombok.*;
 
@@ -21,4 +22,16 @@ public class User {
 
     @Column(name = "temps_total")
     private int tempsTotal;
+
+    // Durée allouée par douche (secondes) ; null = durée par défaut
+    public static final int BUDGET_DEFAUT_SECONDES = 300;
+
+    @Column(name = "budget_secondes")
+    private Integer budgetSecondes;
+
+    // Durée réellement appliquée (ESP32 et calcul du dépassement)
+    @JsonIgnore
+    public int getBudgetEffectif() {
+        return budgetSecondes != null ? budgetSecondes : BUDGET_DEFAUT_SECONDES;
+    }
 }
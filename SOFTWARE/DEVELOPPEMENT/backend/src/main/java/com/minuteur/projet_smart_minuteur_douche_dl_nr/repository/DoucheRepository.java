@@ -5,9 +5,12 @@ import com.minuteur.projet_smart_minuteur_douche_dl_nr.model.User;
 import org.springframework.data.jpa.repository.JpaRepository;
 
 import java.util.List;
+import java.util.Optional;
 
 public interface DoucheRepository extends JpaRepository<Douche, Long> {
     List<Douche> findByUser(User user); // Toutes les douches d’un utilisateur
 
     List<Douche> findByUserId(Long userId);
+
+    Optional<Douche> findFirstByJournalSeqAndUserAndDuree(Long journalSeq, User user, int duree);
 }
@@ -0,0 +1,43 @@
+package com.minuteur.projet_smart_minuteur_douche_dl_nr.service;
+
+import com.minuteur.projet_smart_minuteur_douche_dl_nr.model.User;
+import org.springframework.http.HttpEntity;
+import org.springframework.http.HttpHeaders;
+import org.springframework.http.MediaType;
+import org.springframework.stereotype.Service;
+import org.springframework.web.client.RestTemplate;
+
+import java.util.HashMap;
+import java.util.Map;
+
+// Envoi de messages à l’ESP32 via le pont Python BLE
+@Service
+public class BleBridgeService {
+
+    private static final String URL_PONT = "http://localhost:5001/sendToEsp32";
+
+    private final RestTemplate restTemplate = new RestTemplate();
+
+    public void envoyerMessage(String message) {
+        HttpHeaders headers = new HttpHeaders();
+        headers.setContentType(MediaType.APPLICATION_JSON);
+        Map<String, String> body = new HashMap<>();
+        body.put("message", message);
+        restTemplate.postForEntity(URL_PONT, new HttpEntity<>(body, headers), String.class);
+    }
+
+    // Format compris par l’ESP32 : "BUDGET:<nom>=<secondes>" (mis en cache en NVS)
+    public void envoyerBudget(User user) {
+        envoyerMessage("BUDGET:" + user.getNom() + "=" + user.getBudgetEffectif());
+    }
+
+    // Utilisateur d’une cabine : nom seul pour la cabine 0 (compris par tous
+    // les firmwares), "STALL:<cabine>=<nom>" pour les autres
+    public void envoyerUtilisateur(User user, Integer cabine) {
+        if (cabine == null || cabine == 0) {
+            envoyerMessage(user.getNom());
+        } else {
+            envoyerMessage("STALL:" + cabine + "=" + user.getNom());
+        }
+    }
+}
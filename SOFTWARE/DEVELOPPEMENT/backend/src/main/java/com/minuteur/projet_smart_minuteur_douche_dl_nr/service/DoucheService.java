@@ -22,11 +22,20 @@ public class DoucheService {
         this.userRepository = userRepository;
     }
 
-    public Douche enregistrerDouche(Douche douche) {
-        // Calcul du dépassement (si besoin)
-        int duree = douche.getDuree();
-        int depassement = Math.max(0, duree - 300);
-        douche.setTempsDepasse(depassement);
+    // depassementMesure : dépassement mesuré par l'ESP32 avec la durée qu'il appliquait
+    // (null : ancien pont, calculé ici avec la durée allouée actuelle)
+    public Douche enregistrerDouche(Douche douche, Integer depassementMesure) {
+        if (depassementMesure != null) {
+            douche.setTempsDepasse(Math.max(0, depassementMesure));
+        } else {
+            int duree = douche.getDuree();
+            int budget = douche.getUser() != null && douche.getUser().getId() != null
+                    ? userRepository.findById(douche.getUser().getId())
+                            .map(User::getBudgetEffectif)
+                            .orElse(User.BUDGET_DEFAUT_SECONDES)
+                    : User.BUDGET_DEFAUT_SECONDES;
+            douche.setTempsDepasse(Math.max(0, duree - budget));
+        }
 
         Douche saved = doucheRepository.save(douche);
 
@@ -46,6 +55,11 @@ public class DoucheService {
         return saved;
     }
 
+    // Douche du journal ESP32 déjà reçue (lot renvoyé faute d'acquittement)
+    public Optional<Douche> getDoucheDuJournal(Long journalSeq, User user, int duree) {
+        return doucheRepository.findFirstByJournalSeqAndUserAndDuree(journalSeq, user, duree);
+    }
+
     public List<Douche> getAllDouches() {
         return doucheRepository.findAll();
     }
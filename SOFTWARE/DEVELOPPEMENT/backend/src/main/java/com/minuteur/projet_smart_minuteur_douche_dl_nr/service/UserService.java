@@ -37,6 +37,13 @@ public class UserService {
         });
     }
 
+    public Optional<User> definirBudget(Long id, int secondes) {
+        return userRepository.findById(id).map(user -> {
+            user.setBudgetSecondes(secondes);
+            return userRepository.save(user);
+        });
+    }
+
     // Méthode utilisée pour retrouver un utilisateur par son nom (nom = champ dans User.java)
     public Optional<User> getUserByNom(String nom) {
         return userRepository.findByNom(nom);
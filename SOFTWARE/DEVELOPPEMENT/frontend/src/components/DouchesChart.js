@@ -22,7 +22,17 @@ function DouchesChart({ douches }) {
                 data: douches.map(d => d.duree),
                 borderColor: 'blue',
                 backgroundColor: 'lightblue',
-                tension: 0.3
+                tension: 0.3,
+                yAxisID: 'y',
+            },
+            {
+                // Douches des cabines sans débitmètre : pas de point
+                label: 'Volume mesuré (litres)',
+                data: douches.map(d => d.volumeMl != null ? d.volumeMl / 1000 : null),
+                borderColor: 'teal',
+                backgroundColor: 'paleturquoise',
+                tension: 0.3,
+                yAxisID: 'y1',
             },
         ],
     };
@@ -38,6 +48,15 @@ function DouchesChart({ douches }) {
                 text: 'Évolution des durées de douche',
             },
         },
+        scales: {
+            y: { beginAtZero: true, title: { display: true, text: 'Secondes' } },
+            y1: {
+                beginAtZero: true,
+                position: 'right',
+                grid: { drawOnChartArea: false },
+                title: { display: true, text: 'Litres' },
+            },
+        },
     };
 
     return <Line data={data} options={options} />;
@@ -19,11 +19,15 @@ function UserDouches() {
     const [douches, setDouches] = useState([]);
     const [userName, setUserName] = useState('');
     const [userStats, setUserStats] = useState({ total: 0, moyenne: 0 });
+    const [budget, setBudget] = useState(300); // durée allouée sur le minuteur (s)
 
     useEffect(() => {
         fetch(`http://localhost:8080/users/${id}`)
             .then(res => res.json())
-            .then(user => setUserName(`${user.prenom} ${user.nom}`));
+            .then(user => {
+                setUserName(`${user.prenom} ${user.nom}`);
+                setBudget(user.budgetSecondes ?? 300);
+            });
 
         fetch('http://localhost:8080/douches')
             .then(res => res.json())
@@ -54,8 +58,6 @@ function UserDouches() {
         return res;
     };
 
-    const DUREE_OBJECTIF = 300; // 5 min = 300s
-
     function objectifProchaineDouche() {
         if (douches.length === 0) {
             return (
@@ -67,13 +69,13 @@ function UserDouches() {
                     </p>
                     <p style={{margin: 0}}>
                         <b>Objectif de temps de la prochaine douche :</b><br />
-                        Vous n'avez pas encore démarré de douches, essayez de prendre de bonnes habitudes ! Pour votre première douche, essayez d'atteindre l'objectif suivant : <b>5 min</b>
+                        Vous n'avez pas encore démarré de douches, essayez de prendre de bonnes habitudes ! Pour votre première douche, essayez d'atteindre l'objectif suivant : <b>{formatTemps(budget)}</b>
                     </p>
                 </div>
             );
         }
         const moyenne = userStats.moyenne;
-        if (moyenne <= DUREE_OBJECTIF) {
+        if (moyenne <= budget) {
             return (
                 <div style={{
                     background: "#f8f8f8", borderRadius: "7px", padding: "12px 16px", margin: "22px 0 22px 0"
@@ -83,21 +85,21 @@ function UserDouches() {
                     </p>
                     <p style={{margin: 0}}>
                         <b>Objectif de temps de la prochaine douche :</b><br />
-                        Super, vous avez atteint l'objectif recommandé, gardez vos bonnes habitudes ! Pour la prochaine douche, essayez d'atteindre l'objectif suivant : <b>5 min</b>
+                        Super, vous avez atteint l'objectif recommandé, gardez vos bonnes habitudes ! Pour la prochaine douche, essayez d'atteindre l'objectif suivant : <b>{formatTemps(budget)}</b>
                     </p>
                 </div>
             );
         }
-        // Utilisateur au-dessus de 5 min
+        // Utilisateur au-dessus de sa durée allouée
         const last3 = douches.slice(-3).map(d => d.duree);
         const moy3 = last3.length ? last3.reduce((a, b) => a + b, 0) / last3.length : moyenne;
-        let objReduit = Math.max(moy3 * 0.90, 300); // -10%, au minimum 5min
+        let objReduit = Math.max(moy3 * 0.90, budget); // -10%, au minimum la durée allouée
         // Limite la chute brutale d’un coup
         const last = douches[douches.length - 1].duree;
         if (last - objReduit > 30) objReduit = last - 30;
         objReduit = Math.round(objReduit);
 
-        if (objReduit <= 330) {
+        if (objReduit <= budget + 30) {
             return (
                 <div style={{
                     background: "#f8f8f8", borderRadius: "7px", padding: "12px 16px", margin: "22px 0 22px 0"
@@ -107,7 +109,7 @@ function UserDouches() {
                     </p>
                     <p style={{margin: 0}}>
                         <b>Objectif de temps de la prochaine douche :</b><br />
-                        Bravo, vous vous rapprochez de l'objectif ! Essayez d’atteindre ou de maintenir 5 minutes à chaque douche.
+                        Bravo, vous vous rapprochez de l'objectif ! Essayez d’atteindre ou de maintenir {formatTemps(budget)} à chaque douche.
                     </p>
                 </div>
             );
@@ -244,6 +246,9 @@ function UserDouches() {
                     <th>Fin</th>
                     <th>Durée (s)</th>
                     <th>Dépassement (s)</th>
+                    <th>Cabine</th>
+                    <th>Volume (L)</th>
+                    <th>Débit max (L/min)</th>
                 </tr>
                 </thead>
                 <tbody>
@@ -253,6 +258,9 @@ function UserDouches() {
                         <td>{d.dateFin}</td>
                         <td>{d.duree}</td>
                         <td>{d.tempsDepasse}</td>
+                        <td>{d.cabine ?? 0}</td>
+                        <td>{d.volumeMl != null ? (d.volumeMl / 1000).toFixed(1) : '—'}</td>
+                        <td>{d.debitMaxMlMin != null ? (d.debitMaxMlMin / 1000).toFixed(1) : '—'}</td>
                     </tr>
                 ))}
                 </tbody>
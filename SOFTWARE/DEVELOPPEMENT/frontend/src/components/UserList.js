@@ -6,6 +6,7 @@ function UserList() {
     const [nom, setNom] = useState('');
     const [prenom, setPrenom] = useState('');
     const [message, setMessage] = useState('');
+    const [cabine, setCabine] = useState(0);
     const navigate = useNavigate();
 
     useEffect(() => {
@@ -20,7 +21,7 @@ function UserList() {
         fetch('http://localhost:8080/ble/sendUserToEsp32', {
             method: 'POST',
             headers: { 'Content-Type': 'application/json' },
-            body: JSON.stringify({ username: user.nom })
+            body: JSON.stringify({ username: user.nom, stall: cabine })
         })
             .then(res => res.json())
             .then(() => {
@@ -73,6 +74,18 @@ function UserList() {
     return (
         <div>
             <h2>Veuillez choisir un utilisateur :</h2>
+            <label>
+                Cabine :{' '}
+                <input
+                    type="number"
+                    min="0"
+                    max="7"
+                    value={cabine}
+                    onChange={e => setCabine(Math.min(7, Math.max(0, parseInt(e.target.value, 10) || 0)))}
+                    style={{ width: '3em' }}
+                />
+            </label>
+            <br />
             {users.map(user => (
                 <button
                     key={user.id}
@@ -17,12 +17,22 @@ ChartJS.register(LineElement, PointElement, LinearScale, CategoryScale, Legend,
 const DOUCHES_PAR_AN = 338;
 const DUREE_OBJECTIF = 300; // 5 min = 300s
 
-// Valeurs par minute
+// Valeurs par minute (pour LITRES_PAR_MIN : l’énergie, le coût et le CO₂
+// suivent le volume d’eau chauffée)
 const LITRES_PAR_MIN = 20;
 const KWH_PAR_MIN = 6.972;
 const EUROS_PAR_MIN = 0.05;
 const CO2_PAR_MIN = 0.942;
 
+// Débit réel (L/min) des douches mesurées par un débitmètre, null sans mesure
+function debitMesure(douches) {
+    const mesurees = douches.filter(d => d.volumeMl != null && d.duree > 0);
+    const secondes = mesurees.reduce((sum, d) => sum + d.duree, 0);
+    if (secondes === 0) return null;
+    const litres = mesurees.reduce((sum, d) => sum + d.volumeMl, 0) / 1000;
+    return litres * 60 / secondes;
+}
+
 function formatTemps(seconds) {
     const m = Math.floor(seconds / 60);
     const s = seconds % 60;
@@ -35,11 +45,15 @@ function UserPrevisions() {
     const [douches, setDouches] = useState([]);
     const [userName, setUserName] = useState('');
     const [userStats, setUserStats] = useState({ total: 0, moyenne: 0 });
+    const [budget, setBudget] = useState(300); // durée allouée sur le minuteur (s)
 
     useEffect(() => {
         fetch(`http://localhost:8080/users/${id}`)
             .then(res => res.json())
-            .then(user => setUserName(`${user.prenom} ${user.nom}`));
+            .then(user => {
+                setUserName(`${user.prenom} ${user.nom}`);
+                setBudget(user.budgetSecondes ?? 300);
+            });
 
         fetch('http://localhost:8080/douches')
             .then(res => res.json())
@@ -65,13 +79,13 @@ function UserPrevisions() {
                     </p>
                     <p style={{margin: 0}}>
                         <b>Objectif de temps de la prochaine douche :</b><br />
-                        Vous n'avez pas encore démarré de douches, essayez de prendre de bonnes habitudes ! Pour votre première douche, essayez d'atteindre l'objectif suivant : <b>5 min</b>
+                        Vous n'avez pas encore démarré de douches, essayez de prendre de bonnes habitudes ! Pour votre première douche, essayez d'atteindre l'objectif suivant : <b>{formatTemps(budget)}</b>
                     </p>
                 </div>
             );
         }
         const moyenne = userStats.moyenne;
-        if (moyenne <= DUREE_OBJECTIF) {
+        if (moyenne <= budget) {
             return (
                 <div style={{
                     background: "#f8f8f8", borderRadius: "7px", padding: "12px 16px", margin: "22px 0 22px 0"
@@ -81,21 +95,21 @@ function UserPrevisions() {
                     </p>
                     <p style={{margin: 0}}>
                         <b>Objectif de temps de la prochaine douche :</b><br />
-                        Super, vous avez atteint l'objectif recommandé, gardez vos bonnes habitudes ! Pour la prochaine douche, essayez d'atteindre l'objectif suivant : <b>5 min</b>
+                        Super, vous avez atteint l'objectif recommandé, gardez vos bonnes habitudes ! Pour la prochaine douche, essayez d'atteindre l'objectif suivant : <b>{formatTemps(budget)}</b>
                     </p>
                 </div>
             );
         }
-        // Utilisateur au-dessus de 5 min
+        // Utilisateur au-dessus de sa durée allouée
         const last3 = douches.slice(-3).map(d => d.duree);
         const moy3 = last3.length ? last3.reduce((a, b) => a + b, 0) / last3.length : moyenne;
-        let objReduit = Math.max(moy3 * 0.90, 300); // -10%, au minimum 5min
+        let objReduit = Math.max(moy3 * 0.90, budget); // -10%, au minimum la durée allouée
         // Limite la chute brutale d’un coup
         const last = douches[douches.length - 1].duree;
         if (last - objReduit > 30) objReduit = last - 30;
         objReduit = Math.round(objReduit);
 
-        if (objReduit <= 330) {
+        if (objReduit <= budget + 30) {
             return (
                 <div style={{
                     background: "#f8f8f8", borderRadius: "7px", padding: "12px 16px", margin: "22px 0 22px 0"
@@ -105,7 +119,7 @@ function UserPrevisions() {
                     </p>
                     <p style={{margin: 0}}>
                         <b>Objectif de temps de la prochaine douche :</b><br />
-                        Bravo, vous vous rapprochez de l'objectif ! Essayez d’atteindre ou de maintenir 5 minutes à chaque douche.
+                        Bravo, vous vous rapprochez de l'objectif ! Essayez d’atteindre ou de maintenir {formatTemps(budget)} à chaque douche.
                     </p>
                 </div>
             );
@@ -128,6 +142,10 @@ function UserPrevisions() {
     // ---- 2. Prévisions et données pour les graphiques ----
     // Si pas de douches, utiliser 5min comme base pour tout
     const dureeMoyenne = douches.length === 0 ? DUREE_OBJECTIF : userStats.moyenne;
+    // Débit mesuré sur les cabines équipées, sinon débit estimé
+    const debit = debitMesure(douches);
+    const litresParMin = debit ?? LITRES_PAR_MIN;
+    const facteurDebit = litresParMin / LITRES_PAR_MIN;
 
     // Par mois pour la courbe (x12), puis étendre à l’année
     const courbeLongueur = 12;
@@ -141,10 +159,10 @@ function UserPrevisions() {
         let litres = 0, kwh = 0, euros = 0, co2 = 0;
         const pointsLitres = [], pointsKwh = [], pointsEuros = [], pointsCO2 = [];
         for (let m = 1; m <= courbeLongueur; m++) {
-            litres += min * douchesParMois * LITRES_PAR_MIN;
-            kwh += min * douchesParMois * KWH_PAR_MIN;
-            euros += min * douchesParMois * EUROS_PAR_MIN;
-            co2 += min * douchesParMois * CO2_PAR_MIN;
+            litres += min * douchesParMois * litresParMin;
+            kwh += min * douchesParMois * KWH_PAR_MIN * facteurDebit;
+            euros += min * douchesParMois * EUROS_PAR_MIN * facteurDebit;
+            co2 += min * douchesParMois * CO2_PAR_MIN * facteurDebit;
             pointsLitres.push(Math.round(litres));
             pointsKwh.push(Number(kwh.toFixed(1)));
             pointsEuros.push(Number(euros.toFixed(2)));
@@ -271,6 +289,11 @@ function UserPrevisions() {
                 <p style={{margin: '4px 0', fontSize: '16px'}}>
                     <strong>Temps moyen par douche :</strong> {formatTemps(userStats.moyenne)}
                 </p>
+                <p style={{margin: '4px 0', fontSize: '16px'}}>
+                    <strong>Débit :</strong> {debit != null
+                        ? `${debit.toFixed(1)} L/min (mesuré)`
+                        : `${LITRES_PAR_MIN} L/min (estimé, pas de débitmètre)`}
+                </p>
             </div>
             {objectifProchaineDouche()}
 